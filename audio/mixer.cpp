@@ -22,6 +22,7 @@
 
 #include "gui/EventRecorder.h"
 
+#include "common/config-manager.h"
 #include "common/util.h"
 #include "common/textconsole.h"
 
@@ -43,7 +44,7 @@ namespace Audio {
  */
 class Channel {
 public:
-	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent);
+	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent, RateConverterType converterType);
 	~Channel();
 
 	/**
@@ -55,7 +56,15 @@ public:
 	 *             16 bits, for a total of 40 bytes.
 	 * @return number of sample pairs processed (which can still be silence!)
 	 */
-	int mix(int16 *data, uint len);
+	int mix(int16 *data, uint len) { return mixInto(data, len); }
+
+	/**
+	 * Mixes the channel's samples into the given 32-bit mixing buffer,
+	 * without dividing by Mixer::kMaxMixerVolume or clamping.
+	 *
+	 * @see RateConverter::flow
+	 */
+	int mix(int32 *data, uint len) { return mixInto(data, len); }
 
 	/**
 	 * Queries whether the channel is still playing or not.
@@ -122,9 +131,11 @@ public:
 	void notifyGlobalVolChange() { updateChannelVolumes(); }
 
 	/**
-	 * Queries how long the channel has been playing.
+	 * Stores the state needed to compute how long the channel has been
+	 * playing in the given slot, so that it can be queried without locking
+	 * the mixer.
 	 */
-	Timestamp getElapsedTime();
+	void publishTiming(MixerImpl::ChannelSlot &slot) const;
 
 	/**
 	 * Queries the channel's sound type.
@@ -166,24 +177,90 @@ private:
 
 	RateConverter *_converter;
 	Common::DisposablePtr<AudioStream> _stream;
+
+	template<typename T>
+	int mixInto(T *data, uint len);
 };
 
 #pragma mark -
 #pragma mark --- Mixer ---
 #pragma mark -
 
+uint32 MixerImpl::makeSlotParams(uint32 handle, byte volume, int8 balance) {
+	const uint32 generation = (handle / NUM_CHANNELS) & 0xFFFF;
+	return (generation << 16) | (volume << 8) | (byte)balance;
+}
+
+bool MixerImpl::slotParamsMatch(uint32 params, uint32 handle) {
+	return (params >> 16) == ((handle / NUM_CHANNELS) & 0xFFFF);
+}
+
+MixerImpl::CommandQueue::CommandQueue() : _pushPos(0), _popPos(0) {
+	for (uint32 i = 0; i < kSize; i++)
+		_cells[i].sequence = i;
+}
+
+bool MixerImpl::CommandQueue::push(const Command &cmd) {
+	// This is a bounded multi-producer queue as described by Dmitry Vyukov:
+	// a producer claims a cell by advancing _pushPos, and then publishes the
+	// command by advancing the sequence number of the cell.
+	uint32 pos = Common::atomicLoad(&_pushPos);
+	for (;;) {
+		Cell &cell = _cells[pos % kSize];
+		const int32 diff = (int32)(Common::atomicLoad(&cell.sequence) - pos);
+
+		if (diff < 0)
+			return false;
+
+		if (diff == 0 && Common::atomicCompareExchange(&_pushPos, pos, pos + 1)) {
+			cell.cmd = cmd;
+			Common::atomicStore(&cell.sequence, pos + 1);
+			return true;
+		}
+
+		pos = Common::atomicLoad(&_pushPos);
+	}
+}
+
+bool MixerImpl::CommandQueue::pop(Command &cmd) {
+	Cell &cell = _cells[_popPos % kSize];
+	if (Common::atomicLoad(&cell.sequence) != _popPos + 1)
+		return false;
+
+	cmd = cell.cmd;
+	Common::atomicStore(&cell.sequence, _popPos + kSize);
+	_popPos++;
+	return true;
+}
+
 MixerImpl::MixerImpl(uint sampleRate)
-	: _mutex(), _sampleRate(sampleRate), _mixerReady(false), _handleSeed(0), _soundTypeSettings() {
+	: _mutex(), _sampleRate(sampleRate), _rateConverterType(kRateConverterLinear), _mixerReady(false), _handleSeed(0),
+	  _highPrecision(false), _mixBuffer(0), _mixBufferSize(0), _ditherSeed(1), _soundTypeSettings() {
 
 	assert(sampleRate > 0);
 
-	for (int i = 0; i != NUM_CHANNELS; i++)
+	// Advanced users can trade some CPU time for less aliasing when game
+	// audio is resampled, by setting this value in their config file directly
+	if (ConfMan.get("audio_resampler") == "sinc")
+		_rateConverterType = kRateConverterFIR;
+
+	// Likewise, mixing through a 32-bit buffer avoids clipping and rounding
+	// each channel separately, but needs some more CPU time
+	if (ConfMan.hasKey("audio_high_precision"))
+		_highPrecision = ConfMan.getBool("audio_high_precision");
+
+	for (int i = 0; i != NUM_CHANNELS; i++) {
 		_channels[i] = 0;
+		_slots[i].handle = kFreeSlot;
+		_slots[i].timingSeq = 0;
+	}
 }
 
 MixerImpl::~MixerImpl() {
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		delete _channels[i];
+
+	free(_mixBuffer);
 }
 
 void MixerImpl::setReady(bool ready) {
@@ -216,11 +293,74 @@ void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
 	chanHandle._val = index + (_handleSeed * NUM_CHANNELS);
 
 	chan->setHandle(chanHandle);
+
+	// Fill in the slot before publishing the handle, so that lock-free
+	// queries never see a partially initialized slot
+	ChannelSlot &slot = _slots[index];
+	Common::atomicStore(&slot.id, (uint32)chan->getId());
+	Common::atomicStore(&slot.type, (uint32)chan->getType());
+	Common::atomicStore(&slot.params, makeSlotParams(chanHandle._val, chan->getVolume(), chan->getBalance()));
+	chan->publishTiming(slot);
+	Common::atomicStore(&slot.handle, chanHandle._val);
+
 	_handleSeed++;
 	if (handle)
 		*handle = chanHandle;
 }
 
+void MixerImpl::deleteChannel(int index) {
+	Common::atomicStore(&_slots[index].handle, (uint32)kFreeSlot);
+	delete _channels[index];
+	_channels[index] = 0;
+}
+
+MixerImpl::ChannelSlot *MixerImpl::findSlot(SoundHandle handle) {
+	if (handle._val == kFreeSlot)
+		return 0;
+
+	ChannelSlot &slot = _slots[handle._val % NUM_CHANNELS];
+	return Common::atomicLoad(&slot.handle) == handle._val ? &slot : 0;
+}
+
+void MixerImpl::queueCommand(CommandType type, SoundHandle handle, int value) {
+	Command cmd;
+	cmd.type = type;
+	cmd.handle = handle._val;
+	cmd.value = value;
+
+	if (_commands.push(cmd))
+		return;
+
+	// The queue is full, so execute the queued commands, followed by this
+	// one, right away
+	Common::StackLock lock(_mutex);
+	executeCommands();
+	executeCommand(cmd);
+}
+
+void MixerImpl::executeCommands() {
+	Command cmd;
+	while (_commands.pop(cmd))
+		executeCommand(cmd);
+}
+
+void MixerImpl::executeCommand(const Command &cmd) {
+	const int index = cmd.handle % NUM_CHANNELS;
+	if (!_channels[index] || _channels[index]->getHandle()._val != cmd.handle)
+		return;
+
+	switch (cmd.type) {
+	case kCommandSetVolume:
+		_channels[index]->setVolume(cmd.value);
+		break;
+	case kCommandSetBalance:
+		_channels[index]->setBalance(cmd.value);
+		break;
+	default:
+		break;
+	}
+}
+
 void MixerImpl::playStream(
 			SoundType type,
 			SoundHandle *handle,
@@ -260,7 +400,7 @@ void MixerImpl::playStream(
 #endif
 
 	// Create the channel
-	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent);
+	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent, _rateConverterType);
 	chan->setVolume(volume);
 	chan->setBalance(balance);
 	insertChannel(handle, chan);
@@ -279,18 +419,74 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 	// Since the mixer callback has been called, the mixer must be ready...
 	_mixerReady = true;
 
-	//  zero the buf
-	memset(buf, 0, 2 * len * sizeof(int16));
+	// Apply the commands which were queued since the last callback
+	executeCommands();
+
+	if (!_highPrecision) {
+		//  zero the buf
+		memset(buf, 0, 2 * len * sizeof(int16));
+
+		// mix all channels
+		return mixChannels(buf, len);
+	}
+
+	// Mix all channels into the 32-bit buffer, then round and clamp only once
+	int32 *mixBuf = prepareMixBuffer(len);
+	const int res = mixChannels(mixBuf, len);
+
+	for (uint i = 0; i != 2 * len; i++) {
+		// Add triangular dither of up to one output LSB before rounding.
+		// The mixing buffer holds samples scaled by kMaxMixerVolume == 256.
+		_ditherSeed = _ditherSeed * 1664525 + 1013904223;
+		const int dither = (int)((_ditherSeed >> 24) + ((_ditherSeed >> 16) & 0xFF)) - 255;
+		const int val = CLIP<int>((mixBuf[i] + dither + 128) >> 8, ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+
+#ifdef OUTPUT_UNSIGNED_AUDIO
+		buf[i] = ((int16)val) ^ 0x8000;
+#else
+		buf[i] = val;
+#endif
+	}
+
+	return res;
+}
 
-	// mix all channels
+int MixerImpl::mixCallbackFloat(byte *samples, uint len) {
+	assert(samples);
+
+	Common::StackLock lock(_mutex);
+
+	float *buf = (float *)samples;
+	// we store stereo, 32-bit float samples
+	assert(len % 8 == 0);
+	len >>= 3;
+
+	// Since the mixer callback has been called, the mixer must be ready...
+	_mixerReady = true;
+
+	// Apply the commands which were queued since the last callback
+	executeCommands();
+
+	int32 *mixBuf = prepareMixBuffer(len);
+	const int res = mixChannels(mixBuf, len);
+
+	const float scale = 1.0f / (kMaxMixerVolume * 32768.0f);
+	for (uint i = 0; i != 2 * len; i++)
+		buf[i] = CLIP<float>(mixBuf[i] * scale, -1.0f, 1.0f);
+
+	return res;
+}
+
+template<typename T>
+int MixerImpl::mixChannels(T *buf, uint len) {
 	int res = 0, tmp;
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		if (_channels[i]) {
 			if (_channels[i]->isFinished()) {
-				delete _channels[i];
-				_channels[i] = 0;
+				deleteChannel(i);
 			} else if (!_channels[i]->isPaused()) {
 				tmp = _channels[i]->mix(buf, len);
+				_channels[i]->publishTiming(_slots[i]);
 
 				if (tmp > res)
 					res = tmp;
@@ -300,23 +496,34 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 	return res;
 }
 
+int32 *MixerImpl::prepareMixBuffer(uint len) {
+	// Only reallocate when the backend asks for a larger buffer than before
+	if (_mixBufferSize < 2 * len) {
+		free(_mixBuffer);
+		_mixBuffer = (int32 *)malloc(2 * len * sizeof(int32));
+		_mixBufferSize = 2 * len;
+
+		if (!_mixBuffer)
+			error("[MixerImpl::prepareMixBuffer] Cannot allocate memory for mixing buffer");
+	}
+
+	memset(_mixBuffer, 0, 2 * len * sizeof(int32));
+	return _mixBuffer;
+}
+
 void MixerImpl::stopAll() {
 	Common::StackLock lock(_mutex);
 	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && !_channels[i]->isPermanent()) {
-			delete _channels[i];
-			_channels[i] = 0;
-		}
+		if (_channels[i] != 0 && !_channels[i]->isPermanent())
+			deleteChannel(i);
 	}
 }
 
 void MixerImpl::stopID(int id) {
 	Common::StackLock lock(_mutex);
 	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && _channels[i]->getId() == id) {
-			delete _channels[i];
-			_channels[i] = 0;
-		}
+		if (_channels[i] != 0 && _channels[i]->getId() == id)
+			deleteChannel(i);
 	}
 }
 
@@ -328,12 +535,13 @@ void MixerImpl::stopHandle(SoundHandle handle) {
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
 		return;
 
-	delete _channels[index];
-	_channels[index] = 0;
+	deleteChannel(index);
 }
 
 void MixerImpl::muteSoundType(SoundType type, bool mute) {
 	assert(0 <= (int)type && (int)type < ARRAYSIZE(_soundTypeSettings));
+
+	Common::StackLock lock(_mutex);
 	_soundTypeSettings[type].mute = mute;
 
 	for (int i = 0; i != NUM_CHANNELS; ++i) {
@@ -348,39 +556,57 @@ bool MixerImpl::isSoundTypeMuted(SoundType type) const {
 }
 
 void MixerImpl::setChannelVolume(SoundHandle handle, byte volume) {
-	Common::StackLock lock(_mutex);
-
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	ChannelSlot *slot = findSlot(handle);
+	if (!slot)
 		return;
 
-	_channels[index]->setVolume(volume);
+	uint32 params;
+	do {
+		params = Common::atomicLoad(&slot->params);
+		if (!slotParamsMatch(params, handle._val))
+			return;
+	} while (!Common::atomicCompareExchange(&slot->params, params, (params & 0xFFFF00FF) | (volume << 8)));
+
+	queueCommand(kCommandSetVolume, handle, volume);
 }
 
 byte MixerImpl::getChannelVolume(SoundHandle handle) {
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	ChannelSlot *slot = findSlot(handle);
+	if (!slot)
 		return 0;
 
-	return _channels[index]->getVolume();
+	const uint32 params = Common::atomicLoad(&slot->params);
+	if (!slotParamsMatch(params, handle._val))
+		return 0;
+
+	return (params >> 8) & 0xFF;
 }
 
 void MixerImpl::setChannelBalance(SoundHandle handle, int8 balance) {
-	Common::StackLock lock(_mutex);
-
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	ChannelSlot *slot = findSlot(handle);
+	if (!slot)
 		return;
 
-	_channels[index]->setBalance(balance);
+	uint32 params;
+	do {
+		params = Common::atomicLoad(&slot->params);
+		if (!slotParamsMatch(params, handle._val))
+			return;
+	} while (!Common::atomicCompareExchange(&slot->params, params, (params & 0xFFFFFF00) | (byte)balance));
+
+	queueCommand(kCommandSetBalance, handle, balance);
 }
 
 int8 MixerImpl::getChannelBalance(SoundHandle handle) {
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	ChannelSlot *slot = findSlot(handle);
+	if (!slot)
 		return 0;
 
-	return _channels[index]->getBalance();
+	const uint32 params = Common::atomicLoad(&slot->params);
+	if (!slotParamsMatch(params, handle._val))
+		return 0;
+
+	return (int8)(params & 0xFF);
 }
 
 uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
@@ -388,13 +614,49 @@ uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
 }
 
 Timestamp MixerImpl::getElapsedTime(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
+	Timestamp ts(0, _sampleRate);
 
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return Timestamp(0, _sampleRate);
+	ChannelSlot *slot = findSlot(handle);
+	if (!slot)
+		return ts;
+
+	// Take a consistent snapshot of the timing fields, which the mixer
+	// might be updating right now
+	uint32 samplesConsumed, mixerTimeStamp, pauseStartTime, pauseTime, paused;
+	uint32 seq;
+	do {
+		seq = Common::atomicLoad(&slot->timingSeq);
+		samplesConsumed = Common::atomicLoad(&slot->samplesConsumed);
+		mixerTimeStamp = Common::atomicLoad(&slot->mixerTimeStamp);
+		pauseStartTime = Common::atomicLoad(&slot->pauseStartTime);
+		pauseTime = Common::atomicLoad(&slot->pauseTime);
+		paused = Common::atomicLoad(&slot->paused);
+
+		if (Common::atomicLoad(&slot->handle) != handle._val)
+			return ts;
+	} while ((seq & 1) || Common::atomicLoad(&slot->timingSeq) != seq);
+
+	if (mixerTimeStamp == 0)
+		return ts;
+
+	uint32 delta;
+	if (paused)
+		delta = pauseStartTime - mixerTimeStamp;
+	else
+		delta = g_system->getMillis(true) - mixerTimeStamp - pauseTime;
+
+	// Convert the number of samples into a time duration.
+
+	ts = ts.addFrames(samplesConsumed);
+	ts = ts.addMsecs(delta);
 
-	return _channels[index]->getElapsedTime();
+	// In theory it would seem like a good idea to limit the approximation
+	// so that it never exceeds the theoretical upper bound set by
+	// _samplesDecoded. Meanwhile, back in the real world, doing so makes
+	// the Broken Sword cutscenes noticeably jerkier. I guess the mixer
+	// isn't invoked at the regular intervals that I first imagined.
+
+	return ts;
 }
 
 void MixerImpl::pauseAll(bool paused) {
@@ -402,6 +664,7 @@ void MixerImpl::pauseAll(bool paused) {
 	for (int i = 0; i != NUM_CHANNELS; i++) {
 		if (_channels[i] != 0) {
 			_channels[i]->pause(paused);
+			_channels[i]->publishTiming(_slots[i]);
 		}
 	}
 }
@@ -411,6 +674,7 @@ void MixerImpl::pauseID(int id, bool paused) {
 	for (int i = 0; i != NUM_CHANNELS; i++) {
 		if (_channels[i] != 0 && _channels[i]->getId() == id) {
 			_channels[i]->pause(paused);
+			_channels[i]->publishTiming(_slots[i]);
 			return;
 		}
 	}
@@ -425,45 +689,59 @@ void MixerImpl::pauseHandle(SoundHandle handle, bool paused) {
 		return;
 
 	_channels[index]->pause(paused);
+	_channels[index]->publishTiming(_slots[index]);
 }
 
 bool MixerImpl::isSoundIDActive(int id) {
-	Common::StackLock lock(_mutex);
-
 #ifdef ENABLE_EVENTRECORDER
 	g_eventRec.updateSubsystems();
 #endif
 
-	for (int i = 0; i != NUM_CHANNELS; i++)
-		if (_channels[i] && _channels[i]->getId() == id)
+	for (int i = 0; i != NUM_CHANNELS; i++) {
+		uint32 handle;
+		bool match;
+		// Retry if the slot was reused while reading it
+		do {
+			handle = Common::atomicLoad(&_slots[i].handle);
+			match = handle != kFreeSlot && Common::atomicLoad(&_slots[i].id) == (uint32)id;
+		} while (Common::atomicLoad(&_slots[i].handle) != handle);
+
+		if (match)
 			return true;
+	}
 	return false;
 }
 
 int MixerImpl::getSoundID(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
-	const int index = handle._val % NUM_CHANNELS;
-	if (_channels[index] && _channels[index]->getHandle()._val == handle._val)
-		return _channels[index]->getId();
-	return 0;
+	ChannelSlot *slot = findSlot(handle);
+	if (!slot)
+		return 0;
+
+	const int id = (int)Common::atomicLoad(&slot->id);
+	return Common::atomicLoad(&slot->handle) == handle._val ? id : 0;
 }
 
 bool MixerImpl::isSoundHandleActive(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
-
 #ifdef ENABLE_EVENTRECORDER
 	g_eventRec.updateSubsystems();
 #endif
 
-	const int index = handle._val % NUM_CHANNELS;
-	return _channels[index] && _channels[index]->getHandle()._val == handle._val;
+	return findSlot(handle) != 0;
 }
 
 bool MixerImpl::hasActiveChannelOfType(SoundType type) {
-	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++)
-		if (_channels[i] && _channels[i]->getType() == type)
+	for (int i = 0; i != NUM_CHANNELS; i++) {
+		uint32 handle;
+		bool match;
+		// Retry if the slot was reused while reading it
+		do {
+			handle = Common::atomicLoad(&_slots[i].handle);
+			match = handle != kFreeSlot && Common::atomicLoad(&_slots[i].type) == (uint32)type;
+		} while (Common::atomicLoad(&_slots[i].handle) != handle);
+
+		if (match)
 			return true;
+	}
 	return false;
 }
 
@@ -497,7 +775,7 @@ int MixerImpl::getVolumeForSoundType(SoundType type) const {
 #pragma mark -
 
 Channel::Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream,
-                 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent)
+                 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent, RateConverterType converterType)
     : _type(type), _mixer(mixer), _id(id), _permanent(permanent), _volume(Mixer::kMaxChannelVolume),
       _balance(0), _pauseLevel(0), _samplesConsumed(0), _samplesDecoded(0), _mixerTimeStamp(0),
       _pauseStartTime(0), _pauseTime(0), _converter(0), _volL(0), _volR(0),
@@ -506,7 +784,7 @@ Channel::Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream,
 	assert(stream);
 
 	// Get a rate converter instance
-	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), reverseStereo);
+	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), reverseStereo, converterType);
 }
 
 Channel::~Channel() {
@@ -576,35 +854,23 @@ void Channel::pause(bool paused) {
 	}
 }
 
-Timestamp Channel::getElapsedTime() {
-	const uint32 rate = _mixer->getOutputRate();
-	uint32 delta = 0;
-
-	Audio::Timestamp ts(0, rate);
+void Channel::publishTiming(MixerImpl::ChannelSlot &slot) const {
+	// Only one thread at a time holds the mixer lock and calls this, so the
+	// sequence counter can be incremented without a read-modify-write
+	const uint32 seq = Common::atomicLoad(&slot.timingSeq);
+	Common::atomicStore(&slot.timingSeq, seq + 1);
 
-	if (_mixerTimeStamp == 0)
-		return ts;
-
-	if (isPaused())
-		delta = _pauseStartTime - _mixerTimeStamp;
-	else
-		delta = g_system->getMillis(true) - _mixerTimeStamp - _pauseTime;
-
-	// Convert the number of samples into a time duration.
+	Common::atomicStore(&slot.samplesConsumed, _samplesConsumed);
+	Common::atomicStore(&slot.mixerTimeStamp, _mixerTimeStamp);
+	Common::atomicStore(&slot.pauseStartTime, _pauseStartTime);
+	Common::atomicStore(&slot.pauseTime, _pauseTime);
+	Common::atomicStore(&slot.paused, isPaused());
 
-	ts = ts.addFrames(_samplesConsumed);
-	ts = ts.addMsecs(delta);
-
-	// In theory it would seem like a good idea to limit the approximation
-	// so that it never exceeds the theoretical upper bound set by
-	// _samplesDecoded. Meanwhile, back in the real world, doing so makes
-	// the Broken Sword cutscenes noticeably jerkier. I guess the mixer
-	// isn't invoked at the regular intervals that I first imagined.
-
-	return ts;
+	Common::atomicStore(&slot.timingSeq, seq + 2);
 }
 
-int Channel::mix(int16 *data, uint len) {
+template<typename T>
+int Channel::mixInto(T *data, uint len) {
 	assert(_stream);
 
 	int res = 0;
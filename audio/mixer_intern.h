@@ -24,8 +24,10 @@
 #define AUDIO_MIXER_INTERN_H
 
 #include "common/scummsys.h"
+#include "common/atomic.h"
 #include "common/mutex.h"
 #include "audio/mixer.h"
+#include "audio/rate.h"
 
 namespace Audio {
 
@@ -50,6 +52,11 @@ namespace Audio {
  * 4) Change the mixer into ready mode via setReady(true).
  * 5) Start audio processing (e.g. by resuming the audio thread, if applicable).
  *
+ * Queries about channels, as well as changes of their volume and balance,
+ * do not lock the mixer, so that engines polling e.g. isSoundHandleActive()
+ * every frame never have to wait for mixCallback() to finish. Operations
+ * which create or destroy channels still lock the mixer.
+ *
  * In the future, we might make it possible for backends to provide
  * (partial) alternative implementations of the mixer, e.g. to make
  * better use of native sound mixing support on low-end devices.
@@ -65,9 +72,19 @@ private:
 	Common::Mutex _mutex;
 
 	const uint _sampleRate;
+	RateConverterType _rateConverterType;
 	bool _mixerReady;
 	uint32 _handleSeed;
 
+	/**
+	 * Whether to mix all channels into a 32-bit buffer first, instead of
+	 * clamping the output after every channel.
+	 */
+	bool _highPrecision;
+	int32 *_mixBuffer;
+	uint _mixBufferSize;
+	uint32 _ditherSeed;
+
 	struct SoundTypeSettings {
 		SoundTypeSettings() : mute(false), volume(kMaxMixerVolume) {}
 
@@ -78,6 +95,89 @@ private:
 	SoundTypeSettings _soundTypeSettings[4];
 	Channel *_channels[NUM_CHANNELS];
 
+public:
+	enum {
+		/** Handle value of free channel slots. */
+		kFreeSlot = 0xFFFFFFFF
+	};
+
+	/**
+	 * The state of a channel which can be queried without locking the
+	 * mixer. Except for the volume and balance, it is only ever written
+	 * while holding the mixer lock.
+	 */
+	struct ChannelSlot {
+		/**
+		 * Handle of the channel in the slot, or kFreeSlot. It is set after,
+		 * and cleared before, the other fields are changed.
+		 */
+		volatile uint32 handle;
+		volatile uint32 id;
+		volatile uint32 type;
+
+		/**
+		 * Volume and balance of the channel, combined with the lower 16 bits
+		 * of its handle generation, so that setChannelVolume() and
+		 * setChannelBalance() can never modify a channel which replaced the
+		 * one they were asked about.
+		 */
+		volatile uint32 params;
+
+		/** Incremented before and after the timing fields are updated. */
+		volatile uint32 timingSeq;
+		volatile uint32 samplesConsumed;
+		volatile uint32 mixerTimeStamp;
+		volatile uint32 pauseStartTime;
+		volatile uint32 pauseTime;
+		volatile uint32 paused;
+	};
+
+private:
+	ChannelSlot _slots[NUM_CHANNELS];
+
+	static uint32 makeSlotParams(uint32 handle, byte volume, int8 balance);
+	static bool slotParamsMatch(uint32 params, uint32 handle);
+
+	enum CommandType {
+		kCommandSetVolume,
+		kCommandSetBalance
+	};
+
+	struct Command {
+		CommandType type;
+		uint32 handle;
+		int value;
+	};
+
+	/**
+	 * A bounded queue of channel commands which any thread can push to
+	 * without locking. Only the thread holding the mixer lock may pop from it.
+	 */
+	class CommandQueue {
+	public:
+		CommandQueue();
+
+		/** @return false if the queue is full. */
+		bool push(const Command &cmd);
+		bool pop(Command &cmd);
+
+	private:
+		enum {
+			kSize = 64
+		};
+
+		struct Cell {
+			volatile uint32 sequence;
+			Command cmd;
+		};
+
+		Cell _cells[kSize];
+		volatile uint32 _pushPos;
+		uint32 _popPos;
+	};
+
+	CommandQueue _commands;
+
 
 public:
 
@@ -128,6 +228,38 @@ public:
 
 protected:
 	void insertChannel(SoundHandle *handle, Channel *chan);
+	void deleteChannel(int index);
+
+	/**
+	 * Return the slot of the channel with the given handle, or 0 if the
+	 * channel is not active.
+	 */
+	ChannelSlot *findSlot(SoundHandle handle);
+
+	/** Store a command for the mixer, or execute it right away if the queue is full. */
+	void queueCommand(CommandType type, SoundHandle handle, int value);
+
+	/**
+	 * Execute all queued commands. Must be called while holding the
+	 * mixer lock.
+	 */
+	void executeCommands();
+	void executeCommand(const Command &cmd);
+
+	/**
+	 * Mix all active channels into the given buffer, and delete the
+	 * channels that have finished.
+	 *
+	 * @return number of sample pairs processed (which can still be silence!)
+	 */
+	template<typename T>
+	int mixChannels(T *buf, uint len);
+
+	/**
+	 * Return the cleared 32-bit mixing buffer, large enough to hold len
+	 * sample pairs.
+	 */
+	int32 *prepareMixBuffer(uint len);
 
 public:
 	/**
@@ -141,6 +273,17 @@ public:
 	 */
 	int mixCallback(byte *samples, uint len);
 
+	/**
+	 * The same as mixCallback(), but stores stereo 32-bit float samples in
+	 * the range -1.0 to 1.0. The channels are always mixed with high
+	 * precision here.
+	 *
+	 * @param samples Sample buffer, in which stereo float samples will be stored.
+	 * @param len Length of the provided buffer to fill (in bytes, should be divisible by 8).
+	 * @return number of sample pairs processed (which can still be silence!)
+	 */
+	int mixCallbackFloat(byte *samples, uint len);
+
 	/**
 	 * Set the internal 'is ready' flag of the mixer.
 	 * Backends should invoke Mixer::setReady(true) once initialisation of
@@ -98,6 +98,12 @@ endif
 ifndef USE_ARM_SOUND_ASM
 MODULE_OBJS += \
 	rate.o
+
+ifdef SCUMMVM_SSE2
+MODULE_OBJS += \
+	rate_sse2.o
+$(MODULE)/rate_sse2.o: CXXFLAGS += -msse2
+endif
 else
 MODULE_OBJS += \
 	rate_arm.o \
@@ -32,9 +32,12 @@
 #include "audio/rate.h"
 #include "audio/mixer.h"
 #include "common/frac.h"
+#include "common/system.h"
 #include "common/textconsole.h"
 #include "common/util.h"
 
+#include <math.h>
+
 namespace Audio {
 
 
@@ -57,6 +60,87 @@ enum {
 	FRAC_HALF_LOW = (1L << (FRAC_BITS_LOW-1))
 };
 
+void mixSamplesScalar(st_sample_t *obuf, const st_sample_t *ibuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r, bool stereo, bool reverseStereo) {
+	for (; osamp > 0; --osamp) {
+		st_sample_t out0, out1;
+		out0 = *ibuf++;
+		out1 = (stereo ? *ibuf++ : out0);
+
+		// output left channel
+		clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+
+		// output right channel
+		clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+
+		obuf += 2;
+	}
+}
+
+MixProc getMixProc() {
+	// The vectorized routines implement the signed output format only
+#ifndef OUTPUT_UNSIGNED_AUDIO
+#ifdef SCUMMVM_SSE2
+	if (g_system->getSimdLevel() >= OSystem::kSimdSSE2)
+		return mixSamplesSSE2;
+#endif
+#endif
+	return mixSamplesScalar;
+}
+
+void accumulateSamplesScalar(int32 *obuf, const st_sample_t *ibuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r, bool stereo, bool reverseStereo) {
+	for (; osamp > 0; --osamp) {
+		st_sample_t out0, out1;
+		out0 = *ibuf++;
+		out1 = (stereo ? *ibuf++ : out0);
+
+		obuf[reverseStereo    ] += out0 * (int)vol_l;
+		obuf[reverseStereo ^ 1] += out1 * (int)vol_r;
+
+		obuf += 2;
+	}
+}
+
+AccumulateProc getAccumulateProc() {
+#ifdef SCUMMVM_SSE2
+	if (g_system->getSimdLevel() >= OSystem::kSimdSSE2)
+		return accumulateSamplesSSE2;
+#endif
+	return accumulateSamplesScalar;
+}
+
+int32 firDotProductScalar(const st_sample_t *samples, const int16 *coeffs, uint taps) {
+	int32 sum = 0;
+	for (uint i = 0; i < taps; ++i)
+		sum += samples[i] * coeffs[i];
+	return sum;
+}
+
+FIRProc getFIRProc() {
+#ifdef SCUMMVM_SSE2
+	if (g_system->getSimdLevel() >= OSystem::kSimdSSE2)
+		return firDotProductSSE2;
+#endif
+	return firDotProductScalar;
+}
+
+/**
+ * The mixing routines used by a rate converter, picked once when it is created.
+ */
+struct MixRoutines {
+	MixProc mixProc;
+	AccumulateProc accumulateProc;
+
+	MixRoutines() : mixProc(getMixProc()), accumulateProc(getAccumulateProc()) {}
+
+	void mix(st_sample_t *obuf, const st_sample_t *ibuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r, bool stereo, bool reverseStereo) const {
+		mixProc(obuf, ibuf, osamp, vol_l, vol_r, stereo, reverseStereo);
+	}
+
+	void mix(int32 *obuf, const st_sample_t *ibuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r, bool stereo, bool reverseStereo) const {
+		accumulateProc(obuf, ibuf, osamp, vol_l, vol_r, stereo, reverseStereo);
+	}
+};
+
 /**
  * Audio rate converter based on simple resampling. Used when no
  * interpolation is required.
@@ -70,6 +154,11 @@ protected:
 	const st_sample_t *inPtr;
 	int inLen;
 
+	/** resampled data, waiting to be mixed into the output buffer */
+	st_sample_t outBuf[INTERMEDIATE_BUFFER_SIZE];
+
+	MixRoutines mixRoutines;
+
 	/** position of how far output is ahead of input */
 	/** Holds what would have been opos-ipos */
 	long opos;
@@ -77,9 +166,17 @@ protected:
 	/** fractional position increment in the output stream */
 	long opos_inc;
 
+	template<typename T>
+	int flowImpl(AudioStream &input, T *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+
 public:
 	SimpleRateConverter(st_rate_t inrate, st_rate_t outrate);
-	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return flowImpl(input, obuf, osamp, vol_l, vol_r);
+	}
+	int flow(AudioStream &input, int32 *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return flowImpl(input, obuf, osamp, vol_l, vol_r);
+	}
 	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
 		return ST_SUCCESS;
 	}
@@ -105,6 +202,7 @@ SimpleRateConverter<stereo, reverseStereo>::SimpleRateConverter(st_rate_t inrate
 	opos_inc = inrate / outrate;
 
 	inLen = 0;
+
 }
 
 /*
@@ -112,44 +210,57 @@ SimpleRateConverter<stereo, reverseStereo>::SimpleRateConverter(st_rate_t inrate
  * Return number of sample pairs processed.
  */
 template<bool stereo, bool reverseStereo>
-int SimpleRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
-	st_sample_t *ostart, *oend;
+template<typename T>
+int SimpleRateConverter<stereo, reverseStereo>::flowImpl(AudioStream &input, T *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	T *ostart, *oend;
 
 	ostart = obuf;
 	oend = obuf + osamp * 2;
 
 	while (obuf < oend) {
+		// Resample as much as fits into the intermediate output buffer,
+		// then mix all of it into obuf in one go
+		st_sample_t *tmp = outBuf;
+		st_sample_t *tmpEnd = outBuf + MIN<st_size_t>(ARRAYSIZE(outBuf) / 2, (oend - obuf) / 2) * (stereo ? 2 : 1);
+		bool endOfInput = false;
+
+		while (tmp < tmpEnd) {
+
+			// read enough input samples so that opos >= 0
+			do {
+				// Check if we have to refill the buffer
+				if (inLen == 0) {
+					inPtr = inBuf;
+					inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
+					if (inLen <= 0) {
+						endOfInput = true;
+						break;
+					}
+				}
+				inLen -= (stereo ? 2 : 1);
+				opos--;
+				if (opos >= 0) {
+					inPtr += (stereo ? 2 : 1);
+				}
+			} while (opos >= 0);
+
+			if (endOfInput)
+				break;
+
+			*tmp++ = *inPtr++;
+			if (stereo)
+				*tmp++ = *inPtr++;
 
-		// read enough input samples so that opos >= 0
-		do {
-			// Check if we have to refill the buffer
-			if (inLen == 0) {
-				inPtr = inBuf;
-				inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
-				if (inLen <= 0)
-					return (obuf - ostart) / 2;
-			}
-			inLen -= (stereo ? 2 : 1);
-			opos--;
-			if (opos >= 0) {
-				inPtr += (stereo ? 2 : 1);
-			}
-		} while (opos >= 0);
-
-		st_sample_t out0, out1;
-		out0 = *inPtr++;
-		out1 = (stereo ? *inPtr++ : out0);
-
-		// Increment output position
-		opos += opos_inc;
-
-		// output left channel
-		clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+			// Increment output position
+			opos += opos_inc;
+		}
 
-		// output right channel
-		clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+		const st_size_t len = (tmp - outBuf) / (stereo ? 2 : 1);
+		mixRoutines.mix(obuf, outBuf, len, vol_l, vol_r, stereo, reverseStereo);
+		obuf += len * 2;
 
-		obuf += 2;
+		if (endOfInput)
+			break;
 	}
 	return (obuf - ostart) / 2;
 }
@@ -183,9 +294,22 @@ protected:
 	/** current sample(s) in the input stream (left/right channel) */
 	st_sample_t icur0, icur1;
 
+	/** interpolated data, waiting to be mixed into the output buffer */
+	st_sample_t outBuf[INTERMEDIATE_BUFFER_SIZE];
+
+	MixRoutines mixRoutines;
+
+	template<typename T>
+	int flowImpl(AudioStream &input, T *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+
 public:
 	LinearRateConverter(st_rate_t inrate, st_rate_t outrate);
-	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return flowImpl(input, obuf, osamp, vol_l, vol_r);
+	}
+	int flow(AudioStream &input, int32 *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return flowImpl(input, obuf, osamp, vol_l, vol_r);
+	}
 	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
 		return ST_SUCCESS;
 	}
@@ -214,6 +338,7 @@ LinearRateConverter<stereo, reverseStereo>::LinearRateConverter(st_rate_t inrate
 	icur0 = icur1 = 0;
 
 	inLen = 0;
+
 }
 
 /*
@@ -221,54 +346,322 @@ LinearRateConverter<stereo, reverseStereo>::LinearRateConverter(st_rate_t inrate
  * Return number of sample pairs processed.
  */
 template<bool stereo, bool reverseStereo>
-int LinearRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
-	st_sample_t *ostart, *oend;
+template<typename T>
+int LinearRateConverter<stereo, reverseStereo>::flowImpl(AudioStream &input, T *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	T *ostart, *oend;
 
 	ostart = obuf;
 	oend = obuf + osamp * 2;
 
 	while (obuf < oend) {
-
-		// read enough input samples so that opos < 0
-		while ((frac_t)FRAC_ONE_LOW <= opos) {
-			// Check if we have to refill the buffer
-			if (inLen == 0) {
-				inPtr = inBuf;
-				inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
-				if (inLen <= 0)
-					return (obuf - ostart) / 2;
+		// Interpolate as much as fits into the intermediate output buffer,
+		// then mix all of it into obuf in one go
+		st_sample_t *tmp = outBuf;
+		st_sample_t *tmpEnd = outBuf + MIN<st_size_t>(ARRAYSIZE(outBuf) / 2, (oend - obuf) / 2) * (stereo ? 2 : 1);
+		bool endOfInput = false;
+
+		while (tmp < tmpEnd) {
+
+			// read enough input samples so that opos < 0
+			while ((frac_t)FRAC_ONE_LOW <= opos) {
+				// Check if we have to refill the buffer
+				if (inLen == 0) {
+					inPtr = inBuf;
+					inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
+					if (inLen <= 0) {
+						endOfInput = true;
+						break;
+					}
+				}
+				inLen -= (stereo ? 2 : 1);
+				ilast0 = icur0;
+				icur0 = *inPtr++;
+				if (stereo) {
+					ilast1 = icur1;
+					icur1 = *inPtr++;
+				}
+				opos -= FRAC_ONE_LOW;
 			}
-			inLen -= (stereo ? 2 : 1);
-			ilast0 = icur0;
-			icur0 = *inPtr++;
-			if (stereo) {
-				ilast1 = icur1;
-				icur1 = *inPtr++;
+
+			if (endOfInput)
+				break;
+
+			// Loop as long as the outpos trails behind, and as long as there is
+			// still space in the intermediate buffer.
+			while (opos < (frac_t)FRAC_ONE_LOW && tmp < tmpEnd) {
+				// interpolate
+				*tmp++ = (st_sample_t)(ilast0 + (((icur0 - ilast0) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
+				if (stereo)
+					*tmp++ = (st_sample_t)(ilast1 + (((icur1 - ilast1) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
+
+				// Increment output position
+				opos += opos_inc;
 			}
-			opos -= FRAC_ONE_LOW;
 		}
 
-		// Loop as long as the outpos trails behind, and as long as there is
-		// still space in the output buffer.
-		while (opos < (frac_t)FRAC_ONE_LOW && obuf < oend) {
-			// interpolate
-			st_sample_t out0, out1;
-			out0 = (st_sample_t)(ilast0 + (((icur0 - ilast0) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
-			out1 = (stereo ?
-						  (st_sample_t)(ilast1 + (((icur1 - ilast1) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW)) :
-						  out0);
+		const st_size_t len = (tmp - outBuf) / (stereo ? 2 : 1);
+		mixRoutines.mix(obuf, outBuf, len, vol_l, vol_r, stereo, reverseStereo);
+		obuf += len * 2;
+
+		if (endOfInput)
+			break;
+	}
+	return (obuf - ostart) / 2;
+}
+
+
+#pragma mark -
+
+
+/**
+ * Audio rate converter based on a windowed-sinc FIR filter.
+ *
+ * The filter is evaluated in polyphase form: for every possible fractional
+ * position of an output sample between two input samples, a set of filter
+ * coefficients is precomputed when the converter is created, so producing an
+ * output sample only takes a single dot product per channel.
+ *
+ * This gives much less aliasing than LinearRateConverter, at the cost of
+ * some more CPU time.
+ */
+template<bool stereo, bool reverseStereo>
+class FIRRateConverter : public RateConverter {
+protected:
+	enum {
+		/** filter length when upsampling; must be a multiple of 8 */
+		kBaseTaps = 32,
+		/** maximum filter length, used when downsampling */
+		kMaxTaps = 64,
+		/** maximum number of precomputed filter phases */
+		kMaxPhases = 256,
+		/** number of input frames which fit in the history buffers */
+		kHistorySize = kMaxTaps + INTERMEDIATE_BUFFER_SIZE
+	};
+
+	st_sample_t inBuf[INTERMEDIATE_BUFFER_SIZE];
+
+	/** input history, one buffer per channel */
+	st_sample_t hist0[kHistorySize], hist1[kHistorySize];
+	/** index of the first input frame in the current filter window */
+	int histPos;
+	/** number of valid input frames in the history buffers */
+	int histLen;
+	/** whether the silence after the end of the input was added to the history */
+	bool padded;
+
+	/** filtered data, waiting to be mixed into the output buffer */
+	st_sample_t outBuf[INTERMEDIATE_BUFFER_SIZE];
+
+	/** filter coefficients, 'taps' entries for each of the 'numPhases' phases */
+	int16 *coeffs;
+	uint taps;
+	uint numPhases;
 
-			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+	st_rate_t inRate, outRate;
 
-			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+	/** position of the output stream between two input frames, in units of 1/outRate */
+	uint32 frac;
 
-			obuf += 2;
+	MixRoutines mixRoutines;
+	FIRProc firProc;
+
+	bool refill(AudioStream &input);
+
+	st_sample_t filter(const st_sample_t *samples, const int16 *phaseCoeffs) {
+		const int32 sum = firProc(samples, phaseCoeffs, taps) + (1 << (kFIRCoeffBits - 1));
+		return (st_sample_t)CLIP<int32>(sum >> kFIRCoeffBits, ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+	}
+
+	template<typename T>
+	int flowImpl(AudioStream &input, T *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+
+public:
+	FIRRateConverter(st_rate_t inrate, st_rate_t outrate);
+	~FIRRateConverter();
+	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return flowImpl(input, obuf, osamp, vol_l, vol_r);
+	}
+	int flow(AudioStream &input, int32 *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return flowImpl(input, obuf, osamp, vol_l, vol_r);
+	}
+	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
+		return ST_SUCCESS;
+	}
+};
+
+
+/*
+ * Prepare processing.
+ */
+template<bool stereo, bool reverseStereo>
+FIRRateConverter<stereo, reverseStereo>::FIRRateConverter(st_rate_t inrate, st_rate_t outrate) {
+	if (inrate >= 131072 || outrate >= 131072) {
+		error("rate effect can only handle rates < 131072");
+	}
+
+	inRate = inrate;
+	outRate = outrate;
+
+	// When downsampling, the cutoff frequency moves down with the output
+	// rate, so a longer filter is needed to keep the transition band narrow
+	taps = kBaseTaps;
+	if (inrate > outrate)
+		taps = MIN<uint>(kMaxTaps, (kBaseTaps * inrate / outrate + 7) & ~7);
+
+	// Use an exact phase for every possible output position if there are
+	// few enough of them, otherwise pick the closest precomputed one
+	uint a = inrate, b = outrate;
+	while (b) {
+		const uint t = a % b;
+		a = b;
+		b = t;
+	}
+	numPhases = MIN<uint>(kMaxPhases, outrate / a);
+
+	// Cutoff frequency relative to the input rate, a bit below the lower
+	// of both Nyquist frequencies to leave room for the transition band
+	const double cutoff = 0.45 * MIN<double>(1.0, (double)outrate / inrate);
+
+	coeffs = new int16[numPhases * taps];
+	for (uint phase = 0; phase < numPhases; ++phase) {
+		double h[kMaxTaps];
+		double sum = 0;
+
+		for (uint i = 0; i < taps; ++i) {
+			// Distance of this tap to the output position, in input frames
+			const double t = (double)i - (taps / 2 - 1) - (double)phase / numPhases;
+			const double x = 2 * cutoff * t;
+			const double sinc = (x == 0) ? 1.0 : sin(M_PI * x) / (M_PI * x);
+
+			// 4-term Blackman-Harris window over the whole filter length
+			const double n = 2 * M_PI * (t + taps / 2) / taps;
+			const double window = 0.35875 - 0.48829 * cos(n) + 0.14128 * cos(2 * n) - 0.01168 * cos(3 * n);
+
+			h[i] = sinc * window;
+			sum += h[i];
+		}
+
+		// Normalize the coefficients of every phase to unity gain, putting
+		// any rounding error on the center tap
+		int16 *phaseCoeffs = coeffs + phase * taps;
+		int total = 0;
+		for (uint i = 0; i < taps; ++i) {
+			phaseCoeffs[i] = (int16)floor(h[i] / sum * (1 << kFIRCoeffBits) + 0.5);
+			total += phaseCoeffs[i];
+		}
+		phaseCoeffs[taps / 2 - 1] += (1 << kFIRCoeffBits) - total;
+	}
+
+	// Start with enough silence in the history so that the first output
+	// frame is centered on the first input frame
+	memset(hist0, 0, sizeof(hist0));
+	memset(hist1, 0, sizeof(hist1));
+	histPos = 0;
+	histLen = taps / 2 - 1;
+	padded = false;
+
+	frac = 0;
+
+	firProc = getFIRProc();
+}
+
+template<bool stereo, bool reverseStereo>
+FIRRateConverter<stereo, reverseStereo>::~FIRRateConverter() {
+	delete[] coeffs;
+}
+
+/*
+ * Drop the input frames the filter window has moved past and read new ones.
+ * Return false if no more input is available.
+ */
+template<bool stereo, bool reverseStereo>
+bool FIRRateConverter<stereo, reverseStereo>::refill(AudioStream &input) {
+	if (histPos >= histLen) {
+		histPos -= histLen;
+		histLen = 0;
+	} else if (histPos > 0) {
+		histLen -= histPos;
+		memmove(hist0, hist0 + histPos, histLen * sizeof(st_sample_t));
+		if (stereo)
+			memmove(hist1, hist1 + histPos, histLen * sizeof(st_sample_t));
+		histPos = 0;
+	}
+
+	const int space = MIN<int>(kHistorySize - histLen, ARRAYSIZE(inBuf) / (stereo ? 2 : 1));
+	const int inLen = input.readBuffer(inBuf, space * (stereo ? 2 : 1));
+	if (inLen <= 0) {
+		// At the end of the stream, add silence after the last input frames,
+		// so that the filter window can be centered on them, too
+		if (padded || !input.endOfStream())
+			return false;
+
+		memset(hist0 + histLen, 0, (taps / 2) * sizeof(st_sample_t));
+		if (stereo)
+			memset(hist1 + histLen, 0, (taps / 2) * sizeof(st_sample_t));
+		histLen += taps / 2;
+		padded = true;
+		return true;
+	}
+
+	const st_sample_t *inPtr = inBuf;
+	for (int i = 0; i < inLen; i += (stereo ? 2 : 1)) {
+		hist0[histLen] = *inPtr++;
+		if (stereo)
+			hist1[histLen] = *inPtr++;
+		histLen++;
+	}
+	return true;
+}
+
+/*
+ * Processed signed long samples from ibuf to obuf.
+ * Return number of sample pairs processed.
+ */
+template<bool stereo, bool reverseStereo>
+template<typename T>
+int FIRRateConverter<stereo, reverseStereo>::flowImpl(AudioStream &input, T *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	T *ostart, *oend;
+
+	ostart = obuf;
+	oend = obuf + osamp * 2;
+
+	while (obuf < oend) {
+		// Filter as much as fits into the intermediate output buffer,
+		// then mix all of it into obuf in one go
+		st_sample_t *tmp = outBuf;
+		st_sample_t *tmpEnd = outBuf + MIN<st_size_t>(ARRAYSIZE(outBuf) / 2, (oend - obuf) / 2) * (stereo ? 2 : 1);
+		bool endOfInput = false;
+
+		while (tmp < tmpEnd) {
+			// Make sure the whole filter window is available
+			if (histPos + (int)taps > histLen) {
+				if (!refill(input)) {
+					endOfInput = true;
+					break;
+				}
+				continue;
+			}
+
+			const uint phase = MIN<uint>((frac * numPhases + outRate / 2) / outRate, numPhases - 1);
+			const int16 *phaseCoeffs = coeffs + phase * taps;
+			*tmp++ = filter(hist0 + histPos, phaseCoeffs);
+			if (stereo)
+				*tmp++ = filter(hist1 + histPos, phaseCoeffs);
 
 			// Increment output position
-			opos += opos_inc;
+			frac += inRate;
+			while (frac >= outRate) {
+				frac -= outRate;
+				histPos++;
+			}
 		}
+
+		const st_size_t len = (tmp - outBuf) / (stereo ? 2 : 1);
+		mixRoutines.mix(obuf, outBuf, len, vol_l, vol_r, stereo, reverseStereo);
+		obuf += len * 2;
+
+		if (endOfInput)
+			break;
 	}
 	return (obuf - ostart) / 2;
 }
@@ -284,20 +677,14 @@ template<bool stereo, bool reverseStereo>
 class CopyRateConverter : public RateConverter {
 	st_sample_t *_buffer;
 	st_size_t _bufferSize;
-public:
-	CopyRateConverter() : _buffer(0), _bufferSize(0) {}
-	~CopyRateConverter() {
-		free(_buffer);
-	}
+	MixRoutines _mixRoutines;
 
-	virtual int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	template<typename T>
+	int flowImpl(AudioStream &input, T *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
 		assert(input.isStereo() == stereo);
 
-		st_sample_t *ptr;
 		st_size_t len;
 
-		st_sample_t *ostart = obuf;
-
 		if (stereo)
 			osamp *= 2;
 
@@ -315,21 +702,23 @@ public:
 		len = input.readBuffer(_buffer, osamp);
 
 		// Mix the data into the output buffer
-		ptr = _buffer;
-		for (; len > 0; len -= (stereo ? 2 : 1)) {
-			st_sample_t out0, out1;
-			out0 = *ptr++;
-			out1 = (stereo ? *ptr++ : out0);
+		len /= (stereo ? 2 : 1);
+		_mixRoutines.mix(obuf, _buffer, len, vol_l, vol_r, stereo, reverseStereo);
+		return len;
+	}
 
-			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+public:
+	CopyRateConverter() : _buffer(0), _bufferSize(0) {}
+	~CopyRateConverter() {
+		free(_buffer);
+	}
 
-			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+	virtual int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return flowImpl(input, obuf, osamp, vol_l, vol_r);
+	}
 
-			obuf += 2;
-		}
-		return (obuf - ostart) / 2;
+	virtual int flow(AudioStream &input, int32 *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return flowImpl(input, obuf, osamp, vol_l, vol_r);
 	}
 
 	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
@@ -341,9 +730,11 @@ public:
 #pragma mark -
 
 template<bool stereo, bool reverseStereo>
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate) {
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, RateConverterType type) {
 	if (inrate != outrate) {
-		if ((inrate % outrate) == 0 && (inrate < 65536)) {
+		if (type == kRateConverterFIR) {
+			return new FIRRateConverter<stereo, reverseStereo>(inrate, outrate);
+		} else if ((inrate % outrate) == 0 && (inrate < 65536)) {
 			return new SimpleRateConverter<stereo, reverseStereo>(inrate, outrate);
 		} else {
 			return new LinearRateConverter<stereo, reverseStereo>(inrate, outrate);
@@ -356,14 +747,14 @@ RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate) {
 /**
  * Create and return a RateConverter object for the specified input and output rates.
  */
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo) {
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo, RateConverterType type) {
 	if (stereo) {
 		if (reverseStereo)
-			return makeRateConverter<true, true>(inrate, outrate);
+			return makeRateConverter<true, true>(inrate, outrate, type);
 		else
-			return makeRateConverter<true, false>(inrate, outrate);
+			return makeRateConverter<true, false>(inrate, outrate, type);
 	} else
-		return makeRateConverter<false, false>(inrate, outrate);
+		return makeRateConverter<false, false>(inrate, outrate, type);
 }
 
 } // End of namespace Audio
@@ -24,6 +24,8 @@
 #define AUDIO_RATE_H
 
 #include "common/scummsys.h"
+#include "common/util.h"
+#include "audio/mixer.h"
 
 namespace Audio {
 /**
@@ -72,6 +74,95 @@ static inline void clampedAdd(int16& a, int b) {
 #endif
 }
 
+/**
+ * Mix a block of samples into an interleaved stereo output buffer.
+ *
+ * Every input sample is scaled by its channel's volume and then added to
+ * the output using the same rounding and clamping as clampedAdd().
+ *
+ * @param obuf          Output buffer, holding osamp sample pairs.
+ * @param ibuf          Input buffer, holding osamp sample pairs if stereo is
+ *                      set, or osamp samples otherwise.
+ * @param osamp         Number of sample pairs to mix.
+ * @param vol_l         Volume of the left channel (0 - Mixer::kMaxMixerVolume).
+ * @param vol_r         Volume of the right channel (0 - Mixer::kMaxMixerVolume).
+ * @param stereo        Whether the input buffer holds stereo samples.
+ * @param reverseStereo Whether the left and right channels should be swapped.
+ */
+typedef void (*MixProc)(st_sample_t *obuf, const st_sample_t *ibuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r, bool stereo, bool reverseStereo);
+
+void mixSamplesScalar(st_sample_t *obuf, const st_sample_t *ibuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r, bool stereo, bool reverseStereo);
+#ifdef SCUMMVM_SSE2
+void mixSamplesSSE2(st_sample_t *obuf, const st_sample_t *ibuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r, bool stereo, bool reverseStereo);
+#endif
+
+/**
+ * Return the fastest mixing routine supported by the host CPU.
+ *
+ * All routines produce bit-identical output.
+ */
+MixProc getMixProc();
+
+/**
+ * Accumulate a block of samples into an interleaved stereo 32-bit mixing
+ * buffer.
+ *
+ * Unlike with MixProc, the scaled samples are neither divided by
+ * Mixer::kMaxMixerVolume nor clamped, so the buffer keeps the full
+ * precision of the volume scaling. The parameters are the same as for
+ * MixProc.
+ */
+typedef void (*AccumulateProc)(int32 *obuf, const st_sample_t *ibuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r, bool stereo, bool reverseStereo);
+
+void accumulateSamplesScalar(int32 *obuf, const st_sample_t *ibuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r, bool stereo, bool reverseStereo);
+#ifdef SCUMMVM_SSE2
+void accumulateSamplesSSE2(int32 *obuf, const st_sample_t *ibuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r, bool stereo, bool reverseStereo);
+#endif
+
+/**
+ * Return the fastest accumulation routine supported by the host CPU.
+ *
+ * All routines produce bit-identical output.
+ */
+AccumulateProc getAccumulateProc();
+
+enum {
+	/** Number of fractional bits of the FIR filter coefficients. */
+	kFIRCoeffBits = 14
+};
+
+/**
+ * Compute the dot product of a block of samples and a set of FIR filter
+ * coefficients.
+ *
+ * @param samples Input samples.
+ * @param coeffs  Filter coefficients, with kFIRCoeffBits fractional bits.
+ * @param taps    Number of samples and coefficients, a multiple of 8.
+ */
+typedef int32 (*FIRProc)(const st_sample_t *samples, const int16 *coeffs, uint taps);
+
+int32 firDotProductScalar(const st_sample_t *samples, const int16 *coeffs, uint taps);
+#ifdef SCUMMVM_SSE2
+int32 firDotProductSSE2(const st_sample_t *samples, const int16 *coeffs, uint taps);
+#endif
+
+/**
+ * Return the fastest FIR filter routine supported by the host CPU.
+ *
+ * All routines produce bit-identical output.
+ */
+FIRProc getFIRProc();
+
+/**
+ * The resampling algorithms available through makeRateConverter().
+ */
+enum RateConverterType {
+	/** Nearest-neighbor or linear interpolation, which is fast but aliases. */
+	kRateConverterLinear,
+	/** Windowed-sinc FIR filter, which sounds better but needs more CPU time. */
+	kRateConverterFIR
+};
+
 class RateConverter {
 public:
 	RateConverter() {}
@@ -82,10 +173,40 @@ public:
 	 */
 	virtual int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) = 0;
 
+	/**
+	 * Like the 16-bit flow(), but accumulates into a 32-bit mixing buffer
+	 * as described for AccumulateProc.
+	 *
+	 * The default implementation goes through the 16-bit flow(), and thus
+	 * does not gain any precision.
+	 *
+	 * @return Number of sample pairs written into the buffer.
+	 */
+	virtual int flow(AudioStream &input, int32 *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		st_sample_t buf[512];
+		int total = 0;
+
+		while (osamp > 0) {
+			const st_size_t len = MIN<st_size_t>(osamp, ARRAYSIZE(buf) / 2);
+			memset(buf, 0, len * 2 * sizeof(st_sample_t));
+
+			const int res = flow(input, buf, len, vol_l, vol_r);
+			for (int i = 0; i < res * 2; ++i)
+				obuf[i] += buf[i] * Mixer::kMaxMixerVolume;
+
+			obuf += res * 2;
+			osamp -= res;
+			total += res;
+			if (res < (int)len)
+				break;
+		}
+		return total;
+	}
+
 	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) = 0;
 };
 
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo = false);
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo = false, RateConverterType type = kRateConverterLinear);
 /** @} */
 } // End of namespace Audio
 
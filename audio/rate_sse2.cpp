@@ -0,0 +1,129 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/mixer.h"
+#include "audio/rate.h"
+
+#include <emmintrin.h>
+
+namespace Audio {
+
+/**
+ * Scale eight samples by their volume and divide the products by
+ * Mixer::kMaxMixerVolume, truncating towards zero like the scalar code.
+ */
+static inline __m128i scaleSamples(__m128i in, __m128i vol) {
+	const __m128i lo = _mm_mullo_epi16(in, vol);
+	const __m128i hi = _mm_mulhi_epi16(in, vol);
+	__m128i p0 = _mm_unpacklo_epi16(lo, hi);
+	__m128i p1 = _mm_unpackhi_epi16(lo, hi);
+
+	// Add 255 to negative products, so the arithmetic shift rounds towards zero
+	p0 = _mm_add_epi32(p0, _mm_srli_epi32(_mm_srai_epi32(p0, 31), 24));
+	p1 = _mm_add_epi32(p1, _mm_srli_epi32(_mm_srai_epi32(p1, 31), 24));
+
+	return _mm_packs_epi32(_mm_srai_epi32(p0, 8), _mm_srai_epi32(p1, 8));
+}
+
+void mixSamplesSSE2(st_sample_t *obuf, const st_sample_t *ibuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r, bool stereo, bool reverseStereo) {
+	STATIC_ASSERT(Mixer::kMaxMixerVolume == 256, mixer_volume_must_match_the_shift_in_scaleSamples);
+
+	// When reversing stereo, the left input channel ends up in the right
+	// output channel but keeps its volume, so swap the volumes and (for
+	// stereo input) the input samples of every pair.
+	const uint32 volPair = reverseStereo ? (vol_r | (vol_l << 16)) : (vol_l | (vol_r << 16));
+	const __m128i vol = _mm_set1_epi32(volPair);
+
+	st_size_t i = 0;
+	if (stereo) {
+		for (; i + 4 <= osamp; i += 4) {
+			__m128i in = _mm_loadu_si128((const __m128i *)(ibuf + i * 2));
+			if (reverseStereo)
+				in = _mm_shufflehi_epi16(_mm_shufflelo_epi16(in, 0xB1), 0xB1);
+
+			__m128i out = _mm_loadu_si128((const __m128i *)(obuf + i * 2));
+			out = _mm_adds_epi16(out, scaleSamples(in, vol));
+			_mm_storeu_si128((__m128i *)(obuf + i * 2), out);
+		}
+	} else {
+		for (; i + 8 <= osamp; i += 8) {
+			const __m128i in = _mm_loadu_si128((const __m128i *)(ibuf + i));
+
+			__m128i out0 = _mm_loadu_si128((const __m128i *)(obuf + i * 2));
+			__m128i out1 = _mm_loadu_si128((const __m128i *)(obuf + i * 2 + 8));
+			out0 = _mm_adds_epi16(out0, scaleSamples(_mm_unpacklo_epi16(in, in), vol));
+			out1 = _mm_adds_epi16(out1, scaleSamples(_mm_unpackhi_epi16(in, in), vol));
+			_mm_storeu_si128((__m128i *)(obuf + i * 2), out0);
+			_mm_storeu_si128((__m128i *)(obuf + i * 2 + 8), out1);
+		}
+	}
+
+	// Mix the remaining samples with the scalar code
+	if (i < osamp)
+		mixSamplesScalar(obuf + i * 2, ibuf + i * (stereo ? 2 : 1), osamp - i, vol_l, vol_r, stereo, reverseStereo);
+}
+
+void accumulateSamplesSSE2(int32 *obuf, const st_sample_t *ibuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r, bool stereo, bool reverseStereo) {
+	// See mixSamplesSSE2() for how reversed stereo is handled
+	const uint32 volPair = reverseStereo ? (vol_r | (vol_l << 16)) : (vol_l | (vol_r << 16));
+	const __m128i vol = _mm_set1_epi32(volPair);
+
+	st_size_t i = 0;
+	for (; i + 4 <= osamp; i += 4) {
+		__m128i in;
+		if (stereo) {
+			in = _mm_loadu_si128((const __m128i *)(ibuf + i * 2));
+			if (reverseStereo)
+				in = _mm_shufflehi_epi16(_mm_shufflelo_epi16(in, 0xB1), 0xB1);
+		} else {
+			in = _mm_loadl_epi64((const __m128i *)(ibuf + i));
+			in = _mm_unpacklo_epi16(in, in);
+		}
+
+		const __m128i lo = _mm_mullo_epi16(in, vol);
+		const __m128i hi = _mm_mulhi_epi16(in, vol);
+
+		__m128i *out = (__m128i *)(obuf + i * 2);
+		_mm_storeu_si128(out, _mm_add_epi32(_mm_loadu_si128(out), _mm_unpacklo_epi16(lo, hi)));
+		_mm_storeu_si128(out + 1, _mm_add_epi32(_mm_loadu_si128(out + 1), _mm_unpackhi_epi16(lo, hi)));
+	}
+
+	// Mix the remaining samples with the scalar code
+	if (i < osamp)
+		accumulateSamplesScalar(obuf + i * 2, ibuf + i * (stereo ? 2 : 1), osamp - i, vol_l, vol_r, stereo, reverseStereo);
+}
+
+int32 firDotProductSSE2(const st_sample_t *samples, const int16 *coeffs, uint taps) {
+	__m128i sum = _mm_setzero_si128();
+	for (uint i = 0; i < taps; i += 8) {
+		const __m128i s = _mm_loadu_si128((const __m128i *)(samples + i));
+		const __m128i c = _mm_loadu_si128((const __m128i *)(coeffs + i));
+		sum = _mm_add_epi32(sum, _mm_madd_epi16(s, c));
+	}
+
+	// Add up the four partial sums
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(sum);
+}
+
+} // End of namespace Audio
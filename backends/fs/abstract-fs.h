@@ -173,6 +173,19 @@ public:
 	 */
 	virtual bool isWritable() const = 0;
 
+	/**
+	 * Query the size and the time of the last modification of the file
+	 * referred by this node, without opening it.
+	 *
+	 * @param size             The size of the file in bytes.
+	 * @param modificationTime The modification time, in seconds since some
+	 *                         backend specific epoch.
+	 *
+	 * @return true if successful, false if the file does not exist or the
+	 *         backend does not support this.
+	 */
+	virtual bool getFileStats(uint32 &size, uint32 &modificationTime) const { return false; }
+
 
 	/**
 	 * Creates a SeekableReadStream instance corresponding to the file
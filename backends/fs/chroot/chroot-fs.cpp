@@ -70,6 +70,10 @@ bool ChRootFilesystemNode::isWritable() const {
 	return _realNode->isWritable();
 }
 
+bool ChRootFilesystemNode::getFileStats(uint32 &size, uint32 &modificationTime) const {
+	return _realNode->getFileStats(size, modificationTime);
+}
+
 AbstractFSNode *ChRootFilesystemNode::getChild(const Common::String &n) const {
 	return new ChRootFilesystemNode(_root, (POSIXFilesystemNode *)_realNode->getChild(n));
 }
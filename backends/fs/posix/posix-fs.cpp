@@ -71,6 +71,16 @@ bool POSIXFilesystemNode::isWritable() const {
 	return access(_path.c_str(), W_OK) == 0;
 }
 
+bool POSIXFilesystemNode::getFileStats(uint32 &size, uint32 &modificationTime) const {
+	struct stat st;
+	if (stat(_path.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+		return false;
+
+	size = (uint32)st.st_size;
+	modificationTime = (uint32)st.st_mtime;
+	return true;
+}
+
 void POSIXFilesystemNode::setFlags() {
 	struct stat st;
 
@@ -287,6 +297,12 @@ AbstractFSNode *POSIXFilesystemNode::getParent() const {
 }
 
 Common::SeekableReadStream *POSIXFilesystemNode::createReadStream() {
+#ifdef USE_MMAP
+	// Big files are mapped into memory, the rest is read with stdio
+	Common::SeekableReadStream *stream = PosixMmapReadStream::makeFromPath(getPath());
+	if (stream)
+		return stream;
+#endif
 	return PosixIoStream::makeFromPath(getPath(), false);
 }
 
@@ -26,6 +26,12 @@
 
 #include <sys/stat.h>
 
+#ifdef USE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 #if defined(ANDROID_PLAIN_PORT)
 #include "backends/platform/android/jni-android.h"
 #include <unistd.h>
@@ -121,3 +127,64 @@ int32 PosixIoStream::size() const {
 
 	return st.st_size;
 }
+
+#ifdef USE_MMAP
+
+PosixMmapReadStream *PosixMmapReadStream::makeFromPath(const Common::String &path) {
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd == -1)
+		return nullptr;
+
+	// Device files and pipes cannot be mapped, and the size of a stream
+	// is limited to 2 GB
+	struct stat st;
+	if (fstat(fd, &st) == -1 || !S_ISREG(st.st_mode) ||
+	    st.st_size < kMinMappedSize || st.st_size > 0x7FFFFFFF) {
+		close(fd);
+		return nullptr;
+	}
+
+	// The mapping stays valid after closing the file. Note that reading a
+	// part of the file which has been truncated meanwhile raises SIGBUS,
+	// which is no concern for game data.
+	void *mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (mapping == MAP_FAILED)
+		return nullptr;
+
+	return new PosixMmapReadStream(mapping, st.st_size);
+}
+
+PosixMmapReadStream::PosixMmapReadStream(void *mapping, uint32 size)
+	: Common::MemoryReadStream((const byte *)mapping, size), _mapping(mapping), _mappingSize(size) {
+}
+
+PosixMmapReadStream::~PosixMmapReadStream() {
+	if (_mapping)
+		munmap(_mapping, _mappingSize);
+}
+
+namespace {
+
+struct MunmapDeleter {
+	explicit MunmapDeleter(uint32 size) : _size(size) {}
+
+	void operator()(const byte *ptr) {
+		munmap(const_cast<byte *>(ptr), _size);
+	}
+
+	uint32 _size;
+};
+
+} // End of anonymous namespace
+
+Common::SharedPtr<const byte> PosixMmapReadStream::getDataOwner() {
+	if (_mapping) {
+		_owner = Common::SharedPtr<const byte>((const byte *)_mapping, MunmapDeleter(_mappingSize));
+		_mapping = nullptr;
+	}
+
+	return _owner;
+}
+
+#endif // USE_MMAP
@@ -24,6 +24,7 @@
 #define BACKENDS_FS_POSIX_POSIXIOSTREAM_H
 
 #include "backends/fs/stdiostream.h"
+#include "common/memstream.h"
 
 /**
  * A file input / output stream using POSIX interfaces
@@ -45,4 +46,42 @@ public:
 	int32 size() const override;
 };
 
+#ifdef USE_MMAP
+
+/**
+ * A read stream for a file mapped into memory. Reading it needs no system
+ * calls, and its data can be accessed without copying with getData().
+ */
+class PosixMmapReadStream : public Common::MemoryReadStream {
+public:
+	enum {
+		/**
+		 * The minimum size of files to map. Smaller files are read faster
+		 * with stdio, since mapping a file has a high constant cost.
+		 */
+		kMinMappedSize = 256 * 1024
+	};
+
+	/**
+	 * Map the file at the given path. Return nullptr if the file is not a
+	 * regular file, smaller than kMinMappedSize or could not be mapped.
+	 */
+	static PosixMmapReadStream *makeFromPath(const Common::String &path);
+	~PosixMmapReadStream();
+
+protected:
+	Common::SharedPtr<const byte> getDataOwner();
+
+private:
+	PosixMmapReadStream(void *mapping, uint32 size);
+
+	void *_mapping;     ///< The mapping, as long as it is not owned by _owner
+	uint32 _mappingSize;
+
+	/** Owns the mapping instead of the stream, once it has been shared by readSpan(). */
+	Common::SharedPtr<const byte> _owner;
+};
+
+#endif
+
 #endif
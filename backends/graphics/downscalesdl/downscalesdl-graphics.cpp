@@ -277,6 +277,8 @@ void DownscaleSdlGraphicsManager::internUpdateScreen() {
 	updateOSD();
 #endif
 
+	fetchDirtyRects();
+
 	// Force a full redraw if requested
 	if (_forceRedraw) {
 		_numDirtyRects = 1;
@@ -38,6 +38,9 @@ void Context::reset() {
 	shadersSupported = false;
 	multitextureSupported = false;
 	framebufferObjectSupported = false;
+	pixelBufferObjectSupported = false;
+	syncSupported = false;
+	bufferStorageSupported = false;
 
 #define GL_FUNC_DEF(ret, name, param) name = nullptr;
 #include "backends/graphics/opengl/opengl-func.h"
@@ -119,6 +122,10 @@ void OpenGLGraphicsManager::initializeGLContext() {
 	bool ARBShadingLanguage100 = false;
 	bool ARBVertexShader = false;
 	bool ARBFragmentShader = false;
+	bool ARBPixelBufferObject = false;
+	bool ARBMapBufferRange = false;
+	bool ARBSync = false;
+	bool ARBBufferStorage = false;
 
 	Common::StringTokenizer tokenizer(extString, " ");
 	while (!tokenizer.empty()) {
@@ -138,6 +145,14 @@ void OpenGLGraphicsManager::initializeGLContext() {
 			g_context.multitextureSupported = true;
 		} else if (token == "GL_EXT_framebuffer_object") {
 			g_context.framebufferObjectSupported = true;
+		} else if (token == "GL_ARB_pixel_buffer_object") {
+			ARBPixelBufferObject = true;
+		} else if (token == "GL_ARB_map_buffer_range") {
+			ARBMapBufferRange = true;
+		} else if (token == "GL_ARB_sync") {
+			ARBSync = true;
+		} else if (token == "GL_ARB_buffer_storage") {
+			ARBBufferStorage = true;
 		}
 	}
 
@@ -157,6 +172,34 @@ void OpenGLGraphicsManager::initializeGLContext() {
 		g_context.shadersSupported = ARBShaderObjects & ARBShadingLanguage100 & ARBVertexShader & ARBFragmentShader;
 	}
 
+	// Pixel buffer objects need OpenGL ES 3.0, which we never create contexts
+	// for. Thus, only desktop OpenGL contexts can make use of them.
+#if !USE_FORCED_GLES && !USE_FORCED_GLES2
+	if (g_context.type == kContextGL) {
+		// Pixel buffer objects are core since OpenGL 2.1, glMapBufferRange
+		// since 3.0, sync objects since 3.2 and immutable buffer storage
+		// since 4.4. Newer contexts are not required to list these as
+		// extensions.
+		int glMajor = 0, glMinor = 0;
+		const char *versionString = (const char *)g_context.glGetString(GL_VERSION);
+		if (versionString) {
+			sscanf(versionString, "%d.%d", &glMajor, &glMinor);
+		}
+		const int glVersion = glMajor * 10 + glMinor;
+
+		ARBPixelBufferObject |= (glVersion >= 21);
+		ARBMapBufferRange |= (glVersion >= 30);
+		ARBSync |= (glVersion >= 32);
+		ARBBufferStorage |= (glVersion >= 44);
+
+		g_context.pixelBufferObjectSupported = ARBPixelBufferObject && ARBMapBufferRange
+		                                    && g_context.glMapBufferRange && g_context.glUnmapBuffer;
+		g_context.syncSupported = ARBSync && g_context.glFenceSync;
+		g_context.bufferStorageSupported = ARBBufferStorage && g_context.glBufferStorage
+		                                && g_context.pixelBufferObjectSupported && g_context.syncSupported;
+	}
+#endif
+
 	// Log context type.
 	switch (g_context.type) {
 	case kContextGL:
@@ -181,6 +224,9 @@ void OpenGLGraphicsManager::initializeGLContext() {
 	debug(5, "OpenGL: Shader support: %d", g_context.shadersSupported);
 	debug(5, "OpenGL: Multitexture support: %d", g_context.multitextureSupported);
 	debug(5, "OpenGL: FBO support: %d", g_context.framebufferObjectSupported);
+	debug(5, "OpenGL: PBO support: %d", g_context.pixelBufferObjectSupported);
+	debug(5, "OpenGL: Sync support: %d", g_context.syncSupported);
+	debug(5, "OpenGL: Buffer storage support: %d", g_context.bufferStorageSupported);
 }
 
 } // End of namespace OpenGL
@@ -76,6 +76,10 @@ typedef float  GLclampf; /* single precision float in [0,1] */
 typedef double GLdouble; /* double precision float */
 typedef double GLclampd; /* double precision float in [0,1] */
 typedef char   GLchar;
+typedef ptrdiff_t GLintptr;
+typedef ptrdiff_t GLsizeiptr;
+typedef uint64 GLuint64;
+typedef struct __GLsync *GLsync;
 #if defined(MACOSX)
 typedef void  *GLhandleARB;
 #else
@@ -259,4 +263,22 @@ typedef GLhandleARB GLshader;
 #define GL_COLOR_ATTACHMENT0              0x8CE0
 #define GL_FRAMEBUFFER                    0x8D40
 
+/* Buffer objects */
+#define GL_PIXEL_UNPACK_BUFFER            0x88EC
+#define GL_STREAM_DRAW                    0x88E0
+
+#define GL_MAP_WRITE_BIT                  0x0002
+#define GL_MAP_INVALIDATE_BUFFER_BIT      0x0008
+#define GL_MAP_UNSYNCHRONIZED_BIT         0x0020
+#define GL_MAP_PERSISTENT_BIT             0x0040
+#define GL_MAP_COHERENT_BIT               0x0080
+
+/* Sync objects */
+#define GL_SYNC_GPU_COMMANDS_COMPLETE     0x9117
+#define GL_SYNC_FLUSH_COMMANDS_BIT        0x00000001
+#define GL_ALREADY_SIGNALED               0x911A
+#define GL_TIMEOUT_EXPIRED                0x911B
+#define GL_CONDITION_SATISFIED            0x911C
+#define GL_WAIT_FAILED                    0x911D
+
 #endif
@@ -142,6 +142,20 @@ GL_FUNC_2_DEF(GLenum, glCheckFramebufferStatus, glCheckFramebufferStatusEXT, (GL
 GL_FUNC_2_DEF(void, glActiveTexture, glActiveTextureARB, (GLenum texture));
 #endif
 
+#if !USE_FORCED_GLES && !USE_FORCED_GLES2
+GL_EXT_FUNC_DEF(void, glGenBuffers, (GLsizei n, GLuint *buffers));
+GL_EXT_FUNC_DEF(void, glDeleteBuffers, (GLsizei n, const GLuint *buffers));
+GL_EXT_FUNC_DEF(void, glBindBuffer, (GLenum target, GLuint buffer));
+GL_EXT_FUNC_DEF(void, glBufferData, (GLenum target, GLsizeiptr size, const void *data, GLenum usage));
+GL_EXT_FUNC_DEF(void, glBufferStorage, (GLenum target, GLsizeiptr size, const void *data, GLbitfield flags));
+GL_EXT_FUNC_DEF(void *, glMapBufferRange, (GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access));
+GL_EXT_FUNC_DEF(GLboolean, glUnmapBuffer, (GLenum target));
+
+GL_EXT_FUNC_DEF(GLsync, glFenceSync, (GLenum condition, GLbitfield flags));
+GL_EXT_FUNC_DEF(GLenum, glClientWaitSync, (GLsync sync, GLbitfield flags, GLuint64 timeout));
+GL_EXT_FUNC_DEF(void, glDeleteSync, (GLsync sync));
+#endif
+
 #ifdef DEFINED_GL_EXT_FUNC_DEF
 #undef DEFINED_GL_EXT_FUNC_DEF
 #undef GL_EXT_FUNC_DEF
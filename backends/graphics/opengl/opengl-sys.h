@@ -118,6 +118,21 @@ struct Context {
 	/** Whether FBO support is available or not. */
 	bool framebufferObjectSupported;
 
+	/**
+	 * Whether pixel buffer objects, which can be mapped with
+	 * glMapBufferRange, are available or not.
+	 */
+	bool pixelBufferObjectSupported;
+
+	/** Whether fence sync objects are available or not. */
+	bool syncSupported;
+
+	/**
+	 * Whether buffers with immutable storage can be created and mapped
+	 * persistently or not.
+	 */
+	bool bufferStorageSupported;
+
 #define GL_FUNC_DEF(ret, name, param) ret (GL_CALL_CONV *name)param
 #include "backends/graphics/opengl/opengl-func.h"
 #undef GL_FUNC_DEF
@@ -37,7 +37,7 @@ GLTexture::GLTexture(GLenum glIntFormat, GLenum glFormat, GLenum glType)
     : _glIntFormat(glIntFormat), _glFormat(glFormat), _glType(glType),
       _width(0), _height(0), _logicalWidth(0), _logicalHeight(0),
       _texCoords(), _glFilter(GL_NEAREST),
-      _glTexture(0) {
+      _glTexture(0), _uploadBuffer(), _mappedArea() {
 	create();
 }
 
@@ -61,6 +61,8 @@ void GLTexture::enableLinearFiltering(bool enable) {
 void GLTexture::destroy() {
 	GL_CALL(glDeleteTextures(1, &_glTexture));
 	_glTexture = 0;
+
+	_uploadBuffer.destroy();
 }
 
 void GLTexture::create() {
@@ -132,6 +134,25 @@ void GLTexture::setSize(uint width, uint height) {
 }
 
 void GLTexture::updateArea(const Common::Rect &area, const Graphics::Surface &src) {
+	// Stream the update through a pixel buffer if possible. Since the data
+	// has to be copied to the buffer anyway, we only copy the area itself
+	// instead of whole texture lines.
+	const uint bytesPerPixel = src.format.bytesPerPixel;
+	byte *dst = (byte *)mapArea(area, bytesPerPixel);
+	if (dst) {
+		const uint rowSize = area.width() * bytesPerPixel;
+		const byte *srcRow = (const byte *)src.getBasePtr(area.left, area.top);
+
+		for (int y = area.top; y < area.bottom; ++y) {
+			memcpy(dst, srcRow, rowSize);
+			dst += rowSize;
+			srcRow += src.pitch;
+		}
+
+		unmapArea();
+		return;
+	}
+
 	// Set the texture on the active texture unit.
 	bind();
 
@@ -157,6 +178,28 @@ void GLTexture::updateArea(const Common::Rect &area, const Graphics::Surface &sr
 	                       _glFormat, _glType, src.getBasePtr(0, area.top)));
 }
 
+void *GLTexture::mapArea(const Common::Rect &area, uint bytesPerPixel) {
+	if (!UploadBuffer::isSupportedByContext() || area.isEmpty()) {
+		return nullptr;
+	}
+
+	_mappedArea = area;
+	return _uploadBuffer.map(area.width() * area.height() * bytesPerPixel);
+}
+
+void GLTexture::unmapArea() {
+	// Set the texture on the active texture unit.
+	bind();
+
+	// The pixel buffer holds exactly the area, thus unlike updateArea we do
+	// not need to upload whole texture lines.
+	const void *pixels = _uploadBuffer.unmap();
+	GL_CALL(glTexSubImage2D(GL_TEXTURE_2D, 0, _mappedArea.left, _mappedArea.top,
+	                        _mappedArea.width(), _mappedArea.height(),
+	                        _glFormat, _glType, pixels));
+	_uploadBuffer.release();
+}
+
 //
 // Surface
 //
@@ -306,7 +349,8 @@ void Texture::updateGLTexture() {
 }
 
 TextureCLUT8::TextureCLUT8(GLenum glIntFormat, GLenum glFormat, GLenum glType, const Graphics::PixelFormat &format)
-    : Texture(glIntFormat, glFormat, glType, format), _clut8Data(), _palette(new byte[256 * format.bytesPerPixel]) {
+    : Texture(glIntFormat, glFormat, glType, format), _clut8Data(), _palette(new byte[256 * format.bytesPerPixel]),
+      _textureDataStale(false) {
 	memset(_palette, 0, sizeof(byte) * format.bytesPerPixel);
 }
 
@@ -391,11 +435,79 @@ inline void doPaletteLookUp(PixelType *dst, const byte *src, uint width, uint he
 }
 } // End of anonymous namespace
 
+bool TextureCLUT8::lookUpToPixelBuffer(const Common::Rect &dirtyArea) {
+	const Graphics::Surface *outSurf = Texture::getSurface();
+	const uint bytesPerPixel = outSurf->format.bytesPerPixel;
+	if (bytesPerPixel != 2 && bytesPerPixel != 4) {
+		return false;
+	}
+
+	// In case we use linear filtering we might need to duplicate the last
+	// pixel row/column to avoid glitches with filtering. See
+	// Texture::updateGLTexture.
+	Common::Rect uploadArea = dirtyArea;
+	if (_glTexture.isLinearFilteringEnabled()) {
+		if (dirtyArea.right == outSurf->w && (uint)outSurf->w != _glTexture.getWidth()) {
+			++uploadArea.right;
+		}
+
+		if (dirtyArea.bottom == outSurf->h && (uint)outSurf->h != _glTexture.getHeight()) {
+			++uploadArea.bottom;
+		}
+	}
+
+	byte *dst = (byte *)_glTexture.mapArea(uploadArea, bytesPerPixel);
+	if (!dst) {
+		return false;
+	}
+
+	const uint dstPitch = uploadArea.width() * bytesPerPixel;
+	const byte *src = (const byte *)_clut8Data.getBasePtr(dirtyArea.left, dirtyArea.top);
+
+	if (bytesPerPixel == 2) {
+		doPaletteLookUp<uint16>((uint16 *)dst, src, dirtyArea.width(), dirtyArea.height(),
+		                        dstPitch, _clut8Data.pitch, (const uint16 *)_palette);
+	} else {
+		doPaletteLookUp<uint32>((uint32 *)dst, src, dirtyArea.width(), dirtyArea.height(),
+		                        dstPitch, _clut8Data.pitch, (const uint32 *)_palette);
+	}
+
+	if (uploadArea.right != dirtyArea.right) {
+		byte *row = dst + (dirtyArea.width() - 1) * bytesPerPixel;
+		for (int y = dirtyArea.top; y < dirtyArea.bottom; ++y) {
+			memcpy(row + bytesPerPixel, row, bytesPerPixel);
+			row += dstPitch;
+		}
+	}
+
+	if (uploadArea.bottom != dirtyArea.bottom) {
+		memcpy(dst + dirtyArea.height() * dstPitch, dst + (dirtyArea.height() - 1) * dstPitch, dstPitch);
+	}
+
+	_glTexture.unmapArea();
+	return true;
+}
+
 void TextureCLUT8::updateGLTexture() {
 	if (!isDirty()) {
 		return;
 	}
 
+	// Write the palette look up straight to a pixel buffer if possible. This
+	// saves copying the converted pixels once more for the upload.
+	if (lookUpToPixelBuffer(getDirtyArea())) {
+		_textureDataStale = true;
+		clearDirty();
+		return;
+	}
+
+	// The texture data buffer lacks updates done through pixel buffers and
+	// we upload whole texture lines from it below. Thus, refresh all of it.
+	if (_textureDataStale) {
+		flagDirty();
+		_textureDataStale = false;
+	}
+
 	// Do the palette look up
 	Graphics::Surface *outSurf = Texture::getSurface();
 
@@ -24,6 +24,7 @@
 #define BACKENDS_GRAPHICS_OPENGL_TEXTURE_H
 
 #include "backends/graphics/opengl/opengl-sys.h"
+#include "backends/graphics/opengl/uploadbuffer.h"
 
 #include "graphics/pixelformat.h"
 #include "graphics/surface.h"
@@ -99,6 +100,26 @@ public:
 	 */
 	void updateArea(const Common::Rect &area, const Graphics::Surface &src);
 
+	/**
+	 * Obtain memory to write image data for an update of the texture to.
+	 *
+	 * This streams the update through a pixel buffer object, in case the
+	 * context supports it. The rows of the area have to be written tightly
+	 * packed, i.e. with a pitch of area.width() * bytesPerPixel. Afterwards
+	 * unmapArea needs to be called to upload the data.
+	 *
+	 * @param area          The area to update.
+	 * @param bytesPerPixel The number of bytes per pixel of the input format.
+	 * @return Pointer to the memory or nullptr in case no pixel buffer is
+	 *         available. In the latter case updateArea has to be used.
+	 */
+	void *mapArea(const Common::Rect &area, uint bytesPerPixel);
+
+	/**
+	 * Upload the image data written to the memory obtained by mapArea.
+	 */
+	void unmapArea();
+
 	/**
 	 * Query the GL texture's width.
 	 */
@@ -143,6 +164,9 @@ private:
 	GLint _glFilter;
 
 	GLuint _glTexture;
+
+	UploadBuffer _uploadBuffer;
+	Common::Rect _mappedArea;
 };
 
 /**
@@ -288,9 +312,10 @@ public:
 protected:
 	const Graphics::PixelFormat _format;
 
-private:
 	GLTexture _glTexture;
 
+private:
+
 	Graphics::Surface _textureData;
 	Graphics::Surface _userPixelData;
 };
@@ -314,8 +339,22 @@ public:
 
 	virtual void updateGLTexture();
 private:
+	/**
+	 * Write the palette look up of the dirty area straight to a pixel buffer
+	 * of the GL texture and upload it from there.
+	 *
+	 * @return true on success, false in case no pixel buffer is available.
+	 */
+	bool lookUpToPixelBuffer(const Common::Rect &dirtyArea);
+
 	Graphics::Surface _clut8Data;
 	byte *_palette;
+
+	/**
+	 * Whether the texture data buffer lacks the look up results of updates
+	 * done through pixel buffers.
+	 */
+	bool _textureDataStale;
 };
 
 #if !USE_FORCED_GL
@@ -0,0 +1,214 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "backends/graphics/opengl/uploadbuffer.h"
+
+#include "common/textconsole.h"
+
+namespace OpenGL {
+
+UploadBuffer::UploadBuffer()
+    : _persistent(false), _segmentSize(0), _current(0),
+      _buffers(), _fences(), _persistentData(nullptr) {
+}
+
+UploadBuffer::~UploadBuffer() {
+	destroy();
+}
+
+#if !USE_FORCED_GLES && !USE_FORCED_GLES2
+
+void UploadBuffer::destroy() {
+	for (uint i = 0; i < kPersistentSegments; ++i) {
+		if (_fences[i]) {
+			GL_CALL_SAFE(glDeleteSync, (_fences[i]));
+			_fences[i] = nullptr;
+		}
+	}
+
+	// Deleting a buffer also unmaps it.
+	for (uint i = 0; i < kStreamBuffers; ++i) {
+		if (_buffers[i]) {
+			GL_CALL_SAFE(glDeleteBuffers, (1, &_buffers[i]));
+			_buffers[i] = 0;
+		}
+	}
+
+	_persistentData = nullptr;
+	_segmentSize = 0;
+	_current = 0;
+}
+
+bool UploadBuffer::allocate(uint size) {
+	if (size <= _segmentSize) {
+		return true;
+	}
+
+	destroy();
+
+	// Keep the segments of a persistent buffer aligned, so that pixel data
+	// can be read from them efficiently.
+	_segmentSize = (size + 63) & ~63;
+	_persistent = g_context.bufferStorageSupported;
+
+	if (_persistent) {
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		const GLsizeiptr bufferSize = (GLsizeiptr)_segmentSize * kPersistentSegments;
+
+		GL_CALL(glGenBuffers(1, &_buffers[0]));
+		GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _buffers[0]));
+		GL_CALL(glBufferStorage(GL_PIXEL_UNPACK_BUFFER, bufferSize, nullptr, flags));
+		GL_ASSIGN(_persistentData, glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bufferSize, flags));
+		GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+
+		if (!_persistentData) {
+			warning("UploadBuffer: Could not map buffer of %d bytes persistently", (int)bufferSize);
+			destroy();
+			return false;
+		}
+	} else {
+		GL_CALL(glGenBuffers(kStreamBuffers, _buffers));
+		for (uint i = 0; i < kStreamBuffers; ++i) {
+			GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _buffers[i]));
+			GL_CALL(glBufferData(GL_PIXEL_UNPACK_BUFFER, _segmentSize, nullptr, GL_STREAM_DRAW));
+		}
+		GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+	}
+
+	return true;
+}
+
+void UploadBuffer::waitForSegment() {
+	GLsync &fence = _fences[_current];
+	if (!fence) {
+		return;
+	}
+
+	// Usually the upload has long finished, since the segment was last used
+	// several frames ago.
+	GLenum result;
+	do {
+		GL_ASSIGN(result, glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000));
+	} while (result == GL_TIMEOUT_EXPIRED);
+
+	if (result == GL_WAIT_FAILED) {
+		warning("UploadBuffer: Waiting for pending upload failed");
+	}
+
+	GL_CALL(glDeleteSync(fence));
+	fence = nullptr;
+}
+
+void *UploadBuffer::map(uint size) {
+	if (!allocate(size)) {
+		return nullptr;
+	}
+
+	if (_persistent) {
+		waitForSegment();
+		return (byte *)_persistentData + _current * _segmentSize;
+	}
+
+	// When the last upload from this buffer has finished, we can write to it
+	// without any synchronization. Otherwise, we let the driver hand out
+	// fresh memory instead of waiting for the upload.
+	GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT;
+
+	GLsync &fence = _fences[_current];
+	if (fence) {
+		GLenum result;
+		GL_ASSIGN(result, glClientWaitSync(fence, 0, 0));
+		if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED) {
+			access = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+		}
+
+		GL_CALL(glDeleteSync(fence));
+		fence = nullptr;
+	}
+
+	void *data;
+	GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _buffers[_current]));
+	GL_ASSIGN(data, glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, access));
+
+	if (!data) {
+		GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+	}
+
+	return data;
+}
+
+const void *UploadBuffer::unmap() {
+	if (_persistent) {
+		// The mapping is coherent, thus the GPU sees all writes without
+		// any explicit flush.
+		GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _buffers[0]));
+		return (const void *)(uintptr)(_current * _segmentSize);
+	}
+
+	GLboolean success;
+	GL_ASSIGN(success, glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER));
+	if (!success) {
+		// This only happens in rare cases like a display mode change. The
+		// area will show garbage until it is updated again.
+		warning("UploadBuffer: Buffer contents got lost while mapped");
+	}
+
+	return nullptr;
+}
+
+void UploadBuffer::release() {
+	if (g_context.syncSupported) {
+		GL_ASSIGN(_fences[_current], glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+	}
+
+	GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+
+	_current = (_current + 1) % (_persistent ? kPersistentSegments : kStreamBuffers);
+}
+
+#else
+
+void UploadBuffer::destroy() {
+}
+
+bool UploadBuffer::allocate(uint size) {
+	return false;
+}
+
+void UploadBuffer::waitForSegment() {
+}
+
+void *UploadBuffer::map(uint size) {
+	return nullptr;
+}
+
+const void *UploadBuffer::unmap() {
+	return nullptr;
+}
+
+void UploadBuffer::release() {
+}
+
+#endif
+
+} // End of namespace OpenGL
@@ -0,0 +1,114 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#ifndef BACKENDS_GRAPHICS_OPENGL_UPLOADBUFFER_H
+#define BACKENDS_GRAPHICS_OPENGL_UPLOADBUFFER_H
+
+#include "backends/graphics/opengl/opengl-sys.h"
+
+namespace OpenGL {
+
+/**
+ * A ring of pixel buffer objects to stream texture uploads through.
+ *
+ * Uploading from client memory makes glTexSubImage2D copy the data before it
+ * returns, which often means waiting for the GPU to finish with the texture.
+ * Uploading from a buffer object lets the driver do the transfer
+ * asynchronously instead.
+ *
+ * In case immutable buffer storage is available, the ring consists of
+ * several segments of one buffer which stays mapped persistently. Fences
+ * make sure a segment is not overwritten while the GPU still reads from it.
+ * Otherwise, two buffer objects are used in turn and mapped for each upload.
+ */
+class UploadBuffer {
+public:
+	UploadBuffer();
+	~UploadBuffer();
+
+	/**
+	 * Whether the active context allows streaming uploads through buffers.
+	 */
+	static bool isSupportedByContext() {
+		return g_context.pixelBufferObjectSupported;
+	}
+
+	/**
+	 * Destroy all OpenGL objects of the buffer.
+	 */
+	void destroy();
+
+	/**
+	 * Obtain memory to write the pixel data of the next upload to.
+	 *
+	 * @param size The number of bytes needed.
+	 * @return Pointer to the memory or nullptr in case the buffer could not
+	 *         be mapped.
+	 */
+	void *map(uint size);
+
+	/**
+	 * Finish writing to the memory returned by map.
+	 *
+	 * This binds the buffer to GL_PIXEL_UNPACK_BUFFER. The upload has to be
+	 * issued right after, followed by a call to release.
+	 *
+	 * @return The pixel data pointer to pass to glTexSubImage2D.
+	 */
+	const void *unmap();
+
+	/**
+	 * Finish the upload started by unmap and unbind the buffer.
+	 */
+	void release();
+
+private:
+	enum {
+		/** Number of segments of a persistently mapped buffer. */
+		kPersistentSegments = 3,
+		/** Number of buffer objects used without persistent mapping. */
+		kStreamBuffers = 2
+	};
+
+	/**
+	 * Make sure the buffer objects can hold uploads of size bytes.
+	 */
+	bool allocate(uint size);
+
+	/**
+	 * Wait until the GPU has finished reading from the current segment.
+	 */
+	void waitForSegment();
+
+	bool _persistent;
+	uint _segmentSize;
+	uint _current;
+
+	GLuint _buffers[kStreamBuffers];
+	GLsync _fences[kPersistentSegments];
+	void *_persistentData;
+};
+
+} // End of namespace OpenGL
+
+#endif
@@ -28,6 +28,7 @@
 #include "common/config-manager.h"
 #include "common/mutex.h"
 #include "common/textconsole.h"
+#include "common/threadpool.h"
 #include "common/translation.h"
 #include "common/util.h"
 #include "common/file.h"
@@ -156,7 +157,8 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 	_screenFormat(Graphics::PixelFormat::createFormatCLUT8()),
 	_cursorFormat(Graphics::PixelFormat::createFormatCLUT8()),
 	_overlayscreen(0), _tmpscreen2(0),
-	_scalerProc(0), _screenChangeCount(0),
+	_scalerProc(0), _scalerThreads(nullptr), _screenChangeCount(0),
+	_dirtyRects(NUM_DIRTY_RECT - 1), _numDirtyRects(0),
 	_mouseData(nullptr), _mouseSurface(nullptr),
 	_mouseOrigSurface(nullptr), _cursorDontScale(false), _cursorPaletteDisabled(true),
 	_currentShakeXOffset(0), _currentShakeYOffset(0),
@@ -193,6 +195,17 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 #endif
 	_scalerType = 0;
 
+	// Spread the scaling of large dirty rects over a few CPU cores. Advanced
+	// users can change the number of threads by setting this value in their
+	// config file directly, with 1 scaling everything on the main thread
+	int scalerThreads = 0;
+	if (ConfMan.hasKey("scaler_threads"))
+		scalerThreads = ConfMan.getInt("scaler_threads");
+	if (scalerThreads <= 0)
+		scalerThreads = MIN<uint>(g_system->getCPUCount(), 4);
+	if (scalerThreads > 1)
+		_scalerThreads = new Common::ThreadPool(scalerThreads);
+
 	_videoMode.fullscreen = ConfMan.getBool("fullscreen");
 	_videoMode.filtering = ConfMan.getBool("filtering");
 #if SDL_VERSION_ATLEAST(2, 0, 0)
@@ -214,6 +227,7 @@ SurfaceSdlGraphicsManager::~SurfaceSdlGraphicsManager() {
 	free(_currentPalette);
 	free(_cursorPalette);
 	delete[] _mouseData;
+	delete _scalerThreads;
 }
 
 bool SurfaceSdlGraphicsManager::hasFeature(OSystem::Feature f) const {
@@ -1219,6 +1233,8 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 	updateOSD();
 #endif
 
+	fetchDirtyRects();
+
 	// Force a full redraw if requested
 	if (_forceRedraw) {
 		_numDirtyRects = 1;
@@ -1278,8 +1294,13 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 					dst_y = real2Aspect(dst_y);
 
 				assert(scalerProc != NULL);
-				scalerProc((byte *)srcSurf->pixels + (r->x * 2 + 2) + (r->y + 1) * srcPitch, srcPitch,
-					(byte *)_hwScreen->pixels + dst_x * 2 + dst_y * dstPitch, dstPitch, dst_w, dst_h);
+				if (_scalerThreads)
+					ScaleParallel(*_scalerThreads, scalerProc, scale1,
+						(byte *)srcSurf->pixels + (r->x * 2 + 2) + (r->y + 1) * srcPitch, srcPitch,
+						(byte *)_hwScreen->pixels + dst_x * 2 + dst_y * dstPitch, dstPitch, dst_w, dst_h);
+				else
+					scalerProc((byte *)srcSurf->pixels + (r->x * 2 + 2) + (r->y + 1) * srcPitch, srcPitch,
+						(byte *)_hwScreen->pixels + dst_x * 2 + dst_y * dstPitch, dstPitch, dst_w, dst_h);
 			}
 
 			r->x = dst_x;
@@ -1554,11 +1575,6 @@ void SurfaceSdlGraphicsManager::addDirtyRect(int x, int y, int w, int h, bool re
 	if (_forceRedraw)
 		return;
 
-	if (_numDirtyRects == NUM_DIRTY_RECT) {
-		_forceRedraw = true;
-		return;
-	}
-
 	int height, width;
 
 	if (!_overlayVisible && !realCoordinates) {
@@ -1576,6 +1592,20 @@ void SurfaceSdlGraphicsManager::addDirtyRect(int x, int y, int w, int h, bool re
 		y--;
 		w += 2;
 		h += 2;
+
+		// Start and end on even pixels. The DotMatrix scaler draws a
+		// pattern which repeats every other pixel, relative to the start
+		// of the rect.
+		if (x & 1) {
+			x--;
+			w++;
+		}
+		if (y & 1) {
+			y--;
+			h++;
+		}
+		w += w & 1;
+		h += h & 1;
 	}
 
 	// clip
@@ -1607,16 +1637,51 @@ void SurfaceSdlGraphicsManager::addDirtyRect(int x, int y, int w, int h, bool re
 		return;
 	}
 
-	if (w > 0 && h > 0) {
+	if (w <= 0 || h <= 0)
+		return;
+
+	if (realCoordinates) {
+		// Only the mouse cursor is added in real coordinates, after the
+		// other rects have been scaled
+		if (_numDirtyRects == NUM_DIRTY_RECT) {
+			_forceRedraw = true;
+			return;
+		}
+
 		SDL_Rect *r = &_dirtyRectList[_numDirtyRects++];
 
 		r->x = x;
 		r->y = y;
 		r->w = w;
 		r->h = h;
+	} else {
+		_dirtyRects.addRect(Common::Rect(x, y, x + w, y + h));
+		if (_dirtyRects.contains(Common::Rect(width, height)))
+			_forceRedraw = true;
 	}
 }
 
+void SurfaceSdlGraphicsManager::fetchDirtyRects() {
+	const Graphics::DirtyRectList::Stats &stats = _dirtyRects.getStats();
+	if (stats.rectsAdded)
+		debug(9, "Dirty rects: %u added with %u pixels, merged into %u with %u pixels (%d saved)",
+		      stats.rectsAdded, stats.pixelsAdded, _dirtyRects.size(), stats.pixelsDirty, stats.pixelsSaved());
+
+	if (!_forceRedraw) {
+		for (uint i = 0; i < _dirtyRects.size(); ++i) {
+			const Common::Rect &rect = _dirtyRects[i];
+			SDL_Rect *r = &_dirtyRectList[_numDirtyRects++];
+
+			r->x = rect.left;
+			r->y = rect.top;
+			r->w = rect.width();
+			r->h = rect.height();
+		}
+	}
+
+	_dirtyRects.clear();
+}
+
 int16 SurfaceSdlGraphicsManager::getHeight() const {
 	return _videoMode.screenHeight;
 }
@@ -25,6 +25,7 @@
 
 #include "backends/graphics/graphics.h"
 #include "backends/graphics/sdl/sdl-graphics.h"
+#include "graphics/dirtyrects.h"
 #include "graphics/pixelformat.h"
 #include "graphics/scaler.h"
 #include "common/events.h"
@@ -324,6 +325,12 @@ protected:
 
 	ScalerProc *_scalerProc;
 	int _scalerType;
+
+	/**
+	 * The threads scaling the dirty rects in parallel, or nullptr if they
+	 * are scaled by the calling thread only.
+	 */
+	Common::ThreadPool *_scalerThreads;
 	int _transactionMode;
 
 	// Indicates whether it is needed to free _hwSurface in destructor
@@ -340,9 +347,18 @@ protected:
 	};
 
 	// Dirty rect management
+	/**
+	 * The rects in virtual coordinates that need to be redrawn. They are
+	 * moved to _dirtyRectList by fetchDirtyRects() before the screen is
+	 * updated. One entry of _dirtyRectList is kept free for the mouse
+	 * cursor, which is added in real coordinates while updating the screen.
+	 */
+	Graphics::DirtyRectList _dirtyRects;
 	SDL_Rect _dirtyRectList[NUM_DIRTY_RECT];
 	int _numDirtyRects;
 
+	void fetchDirtyRects();
+
 	struct MousePos {
 		// The size and hotspot of the original cursor image.
 		int16 w, h;
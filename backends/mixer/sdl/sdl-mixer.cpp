@@ -170,7 +170,14 @@ SDL_AudioSpec SdlMixerManager::getAudioSpec(uint32 outputRate) {
 
 	memset(&desired, 0, sizeof(desired));
 	desired.freq = freq;
-	desired.format = AUDIO_S16SYS;
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	// When the mixer works with high precision anyway, hand the float
+	// samples over to SDL, so they are quantized only by the audio driver
+	if (ConfMan.hasKey("audio_high_precision") && ConfMan.getBool("audio_high_precision"))
+		desired.format = AUDIO_F32SYS;
+	else
+#endif
+		desired.format = AUDIO_S16SYS;
 	desired.channels = 2;
 	desired.samples = roundDownPowerOfTwo(samples);
 	desired.callback = sdlCallback;
@@ -186,6 +193,12 @@ void SdlMixerManager::startAudio() {
 
 void SdlMixerManager::callbackHandler(byte *samples, int len) {
 	assert(_mixer);
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	if (_obtained.format == AUDIO_F32SYS) {
+		_mixer->mixCallbackFloat(samples, len);
+		return;
+	}
+#endif
 	_mixer->mixCallback(samples, len);
 }
 
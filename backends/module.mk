@@ -127,6 +127,7 @@ MODULE_OBJS += \
 	graphics/opengl/opengl-graphics.o \
 	graphics/opengl/shader.o \
 	graphics/opengl/texture.o \
+	graphics/opengl/uploadbuffer.o \
 	graphics/opengl/pipelines/clut8.o \
 	graphics/opengl/pipelines/fixed.o \
 	graphics/opengl/pipelines/pipeline.o \
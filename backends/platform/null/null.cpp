@@ -54,6 +54,10 @@ typedef void (*sighandler_t)(int);
 #include "backends/events/default/default-events.h"
 #include "backends/mixer/null/null-mixer.h"
 #include "backends/mutex/null/null-mutex.h"
+#if defined(POSIX) && defined(NULL_DRIVER_USE_FOR_TEST)
+#include "backends/mutex/pthread/pthread-mutex.h"
+#include <pthread.h>
+#endif
 #include "backends/graphics/null/null-graphics.h"
 #include "audio/mixer_intern.h"
 #include "common/scummsys.h"
@@ -93,6 +97,23 @@ public:
 
 	virtual void addSysArchivesToSearchSet(Common::SearchSet &s, int priority);
 
+#if defined(POSIX) && defined(NULL_DRIVER_USE_FOR_TEST)
+	virtual uint getCPUCount();
+	virtual ThreadRef createThread(ThreadProc proc, void *arg);
+	virtual void joinThread(ThreadRef thread);
+	virtual SemaphoreRef createSemaphore(uint value);
+	virtual void postSemaphore(SemaphoreRef sem);
+	virtual void waitSemaphore(SemaphoreRef sem);
+	virtual void deleteSemaphore(SemaphoreRef sem);
+#endif
+
+#ifdef NULL_DRIVER_USE_FOR_TEST
+	void setSavefileManager(Common::SaveFileManager *saveFileMan) {
+		delete _savefileManager;
+		_savefileManager = saveFileMan;
+	}
+#endif
+
 private:
 #ifdef POSIX
 	timeval _startTime;
@@ -115,6 +136,18 @@ OSystem_NULL::OSystem_NULL() {
 	#else
 		#error Unknown and unsupported FS backend
 	#endif
+
+#ifdef NULL_DRIVER_USE_FOR_TEST
+	// The tests never call initBackend(), but the code they test may
+	// query the backend features
+	_graphicsManager = new NullGraphicsManager();
+#endif
+
+#if defined(POSIX) && defined(NULL_DRIVER_USE_FOR_TEST)
+	// Some tests also access code from several threads, which needs real
+	// mutexes
+	_mutexManager = new PthreadMutexManager();
+#endif
 }
 
 OSystem_NULL::~OSystem_NULL() {
@@ -234,6 +267,84 @@ void OSystem_NULL::addSysArchivesToSearchSet(Common::SearchSet &s, int priority)
 	s.add("gui/themes", new Common::FSDirectory("gui/themes", 4), priority);
 }
 
+#if defined(POSIX) && defined(NULL_DRIVER_USE_FOR_TEST)
+namespace {
+
+struct NullThread {
+	pthread_t thread;
+	OSystem::ThreadProc proc;
+	void *arg;
+};
+
+struct NullSemaphore {
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	uint value;
+};
+
+void *nullThreadEntry(void *data) {
+	NullThread *thread = (NullThread *)data;
+	thread->proc(thread->arg);
+	return nullptr;
+}
+
+} // End of anonymous namespace
+
+uint OSystem_NULL::getCPUCount() {
+	const long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count > 0 ? (uint)count : 1;
+}
+
+OSystem::ThreadRef OSystem_NULL::createThread(ThreadProc proc, void *arg) {
+	NullThread *thread = new NullThread;
+	thread->proc = proc;
+	thread->arg = arg;
+
+	if (pthread_create(&thread->thread, nullptr, nullThreadEntry, thread) != 0) {
+		delete thread;
+		return nullptr;
+	}
+	return (ThreadRef)thread;
+}
+
+void OSystem_NULL::joinThread(ThreadRef thread) {
+	pthread_join(((NullThread *)thread)->thread, nullptr);
+	delete (NullThread *)thread;
+}
+
+OSystem::SemaphoreRef OSystem_NULL::createSemaphore(uint value) {
+	NullSemaphore *sem = new NullSemaphore;
+	pthread_mutex_init(&sem->mutex, nullptr);
+	pthread_cond_init(&sem->cond, nullptr);
+	sem->value = value;
+	return (SemaphoreRef)sem;
+}
+
+void OSystem_NULL::postSemaphore(SemaphoreRef ref) {
+	NullSemaphore *sem = (NullSemaphore *)ref;
+	pthread_mutex_lock(&sem->mutex);
+	sem->value++;
+	pthread_cond_signal(&sem->cond);
+	pthread_mutex_unlock(&sem->mutex);
+}
+
+void OSystem_NULL::waitSemaphore(SemaphoreRef ref) {
+	NullSemaphore *sem = (NullSemaphore *)ref;
+	pthread_mutex_lock(&sem->mutex);
+	while (sem->value == 0)
+		pthread_cond_wait(&sem->cond, &sem->mutex);
+	sem->value--;
+	pthread_mutex_unlock(&sem->mutex);
+}
+
+void OSystem_NULL::deleteSemaphore(SemaphoreRef ref) {
+	NullSemaphore *sem = (NullSemaphore *)ref;
+	pthread_cond_destroy(&sem->cond);
+	pthread_mutex_destroy(&sem->mutex);
+	delete sem;
+}
+#endif
+
 OSystem *OSystem_NULL_create() {
 	return new OSystem_NULL();
 }
@@ -249,8 +360,15 @@ int main(int argc, char *argv[]) {
 	return res;
 }
 #else
+static OSystem_NULL *nullSystem = nullptr;
+
 void Common::install_null_g_system() {
-	g_system = OSystem_NULL_create();
+	nullSystem = new OSystem_NULL();
+	g_system = nullSystem;
+}
+
+void Common::install_null_g_system_savefile_manager(Common::SaveFileManager *saveFileMan) {
+	nullSystem->setSavefileManager(saveFileMan);
 }
 #endif
 
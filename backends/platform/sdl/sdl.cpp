@@ -89,6 +89,7 @@ OSystem_SDL::OSystem_SDL()
 	_initedSDLnet(false),
 #endif
 	_logger(0),
+	_logMutex(0),
 	_eventSource(0),
 	_eventSourceWrapper(nullptr),
 	_window(0) {
@@ -134,6 +135,11 @@ OSystem_SDL::~OSystem_SDL() {
 #endif
 
 	_timerManager = 0;
+	if (_logMutex) {
+		MutexRef logMutex = _logMutex;
+		_logMutex = 0;
+		deleteMutex(logMutex);
+	}
 	delete _mutexManager;
 	_mutexManager = 0;
 
@@ -168,6 +174,7 @@ void OSystem_SDL::init() {
 	// (we check for this to allow subclasses to provide their own).
 	if (_mutexManager == 0)
 		_mutexManager = new SdlMutexManager();
+	_logMutex = createMutex();
 
 	if (_window == 0)
 		_window = new SdlWindow();
@@ -186,6 +193,10 @@ bool OSystem_SDL::hasFeature(Feature f) {
 	if (f == kFeatureJoystickDeadzone || f == kFeatureKbdMouseSpeed) {
 		return _eventSource->isJoystickConnected();
 	}
+	if (f == kFeatureCpuSSE2) return SDL_HasSSE2() == SDL_TRUE;
+#if SDL_VERSION_ATLEAST(2, 0, 4)
+	if (f == kFeatureCpuAVX2) return SDL_HasAVX2() == SDL_TRUE;
+#endif
 	return ModularGraphicsBackend::hasFeature(f);
 }
 
@@ -528,12 +539,18 @@ void OSystem_SDL::logMessage(LogMessageType::Type type, const char *message) {
 	else
 		output = stderr;
 
+	if (_logMutex)
+		lockMutex(_logMutex);
+
 	fputs(message, output);
 	fflush(output);
 
 	// Then log into file (via the logger)
 	if (_logger)
 		_logger->print(message);
+
+	if (_logMutex)
+		unlockMutex(_logMutex);
 }
 
 Common::WriteStream *OSystem_SDL::createLogFile() {
@@ -631,6 +648,69 @@ void OSystem_SDL::delayMillis(uint msecs) {
 		SDL_Delay(msecs);
 }
 
+namespace {
+
+struct SdlThreadStart {
+	OSystem::ThreadProc proc;
+	void *arg;
+};
+
+int SDLCALL sdlThreadEntry(void *data) {
+	SdlThreadStart start = *(SdlThreadStart *)data;
+	delete (SdlThreadStart *)data;
+
+	start.proc(start.arg);
+	return 0;
+}
+
+} // End of anonymous namespace
+
+uint OSystem_SDL::getCPUCount() {
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	return MAX(SDL_GetCPUCount(), 1);
+#else
+	return 1;
+#endif
+}
+
+OSystem::ThreadRef OSystem_SDL::createThread(ThreadProc proc, void *arg) {
+	SdlThreadStart *start = new SdlThreadStart;
+	start->proc = proc;
+	start->arg = arg;
+
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	SDL_Thread *thread = SDL_CreateThread(sdlThreadEntry, "ScummVM worker", start);
+#else
+	SDL_Thread *thread = SDL_CreateThread(sdlThreadEntry, start);
+#endif
+	if (!thread) {
+		warning("Could not create thread: %s", SDL_GetError());
+		delete start;
+	}
+
+	return (ThreadRef)thread;
+}
+
+void OSystem_SDL::joinThread(ThreadRef thread) {
+	SDL_WaitThread((SDL_Thread *)thread, nullptr);
+}
+
+OSystem::SemaphoreRef OSystem_SDL::createSemaphore(uint value) {
+	return (SemaphoreRef)SDL_CreateSemaphore(value);
+}
+
+void OSystem_SDL::postSemaphore(SemaphoreRef sem) {
+	SDL_SemPost((SDL_sem *)sem);
+}
+
+void OSystem_SDL::waitSemaphore(SemaphoreRef sem) {
+	SDL_SemWait((SDL_sem *)sem);
+}
+
+void OSystem_SDL::deleteSemaphore(SemaphoreRef sem) {
+	SDL_DestroySemaphore((SDL_sem *)sem);
+}
+
 void OSystem_SDL::getTimeAndDate(TimeDate &td) const {
 	time_t curTime = time(0);
 	struct tm t = *localtime(&curTime);
@@ -79,6 +79,15 @@ public:
 	virtual void addSysArchivesToSearchSet(Common::SearchSet &s, int priority = 0) override;
 	virtual uint32 getMillis(bool skipRecord = false) override;
 	virtual void delayMillis(uint msecs) override;
+
+	// Worker threads
+	virtual uint getCPUCount() override;
+	virtual ThreadRef createThread(ThreadProc proc, void *arg) override;
+	virtual void joinThread(ThreadRef thread) override;
+	virtual SemaphoreRef createSemaphore(uint value) override;
+	virtual void postSemaphore(SemaphoreRef sem) override;
+	virtual void waitSemaphore(SemaphoreRef sem) override;
+	virtual void deleteSemaphore(SemaphoreRef sem) override;
 	virtual void getTimeAndDate(TimeDate &td) const override;
 	virtual MixerManager *getMixerManager() override;
 	virtual Common::TimerManager *getTimerManager() override;
@@ -148,6 +157,8 @@ protected:
 	virtual Common::String getDefaultLogFileName() { return Common::String(); }
 	virtual Common::WriteStream *createLogFile();
 	Backends::Log::Log *_logger;
+	/** Serializes messages logged by worker threads, like game detectors */
+	MutexRef _logMutex;
 
 #ifdef USE_OPENGL
 	typedef Common::Array<GraphicsMode> GraphicsModeArray;
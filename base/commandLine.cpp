@@ -37,6 +37,7 @@
 #include "common/rendermode.h"
 #include "common/system.h"
 #include "common/textconsole.h"
+#include "common/threadpool.h"
 #include "common/tokenizer.h"
 
 #include "gui/ThemeEngine.h"
@@ -240,6 +241,11 @@ void registerDefaults() {
 	ConfMan.registerDefault("shader", "default");
 	ConfMan.registerDefault("show_fps", false);
 	ConfMan.registerDefault("dirtyrects", true);
+	// Number of threads of the software renderer, 0 = one per CPU core
+	// and 1 = render on the main thread only
+	ConfMan.registerDefault("tinygl_threads", 0);
+	// Whether the software renderer rejects hidden triangles early
+	ConfMan.registerDefault("tinygl_hiz", false);
 	ConfMan.registerDefault("vsync", true);
 
 	// Sound & Music
@@ -317,6 +323,9 @@ void registerDefaults() {
 	// If number of game entries in scummvm.ini exceeds the specified
 	// number, then skip scanning. -1 = scan always
 	ConfMan.registerDefault("gui_list_max_scan_entries", -1);
+	// Number of threads detecting games in several directories at once,
+	// 0 = one per CPU core
+	ConfMan.registerDefault("detection_threads", 0);
 	ConfMan.registerDefault("game", "");
 
 #ifdef USE_FLUIDSYNTH
@@ -1038,19 +1047,49 @@ static DetectedGames getGameList(const Common::FSNode &dir) {
 	return detectionResults.listRecognizedGames();
 }
 
-static DetectedGames recListGames(const Common::FSNode &dir, const Common::String &engineId, const Common::String &gameId, bool recursive) {
-	DetectedGames list = getGameList(dir);
+/** Collect the directories to detect games in, in the order their games are listed */
+static void collectDirectories(const Common::FSNode &dir, bool recursive, Common::Array<Common::FSNode> &dirs) {
+	dirs.push_back(dir);
 
 	if (recursive) {
 		Common::FSList files;
 		dir.getChildren(files, Common::FSNode::kListDirectoriesOnly);
-		for (Common::FSList::const_iterator file = files.begin(); file != files.end(); ++file) {
-			DetectedGames rec = recListGames(*file, engineId, gameId, recursive);
-			for (DetectedGames::const_iterator game = rec.begin(); game != rec.end(); ++game) {
-				if ((game->engineId == engineId && game->gameId == gameId)
-				    || gameId.empty())
-					list.push_back(*game);
-			}
+		for (Common::FSList::const_iterator file = files.begin(); file != files.end(); ++file)
+			collectDirectories(*file, recursive, dirs);
+	}
+}
+
+static DetectedGames recListGames(const Common::FSNode &dir, const Common::String &engineId, const Common::String &gameId, bool recursive) {
+	Common::Array<Common::FSNode> dirs;
+	collectDirectories(dir, recursive, dirs);
+
+	Common::Array<Common::FSList> files;
+	files.resize(dirs.size());
+	for (uint i = 0; i < dirs.size(); i++) {
+		// Collect all files from directory
+		if (!dirs[i].getChildren(files[i], Common::FSNode::kListAll)) {
+			printf("Path %s does not exist or is not a directory.\n", dirs[i].getPath().c_str());
+			files[i].clear();
+		}
+	}
+
+	// Detect the games in all directories at once, on several threads
+	Common::ThreadPool pool(ConfMan.getInt("detection_threads"));
+	Common::Array<DetectionResults> detectionResults = EngineMan.detectGames(files, pool);
+
+	DetectedGames list;
+	for (uint i = 0; i < dirs.size(); i++) {
+		if (detectionResults[i].foundUnknownGames()) {
+			Common::U32String report = detectionResults[i].generateUnknownGameReport(false, 80);
+			g_system->logMessage(LogMessageType::kInfo, report.encode().c_str());
+		}
+
+		// The games in subdirectories are only listed if they match
+		DetectedGames games = detectionResults[i].listRecognizedGames();
+		for (DetectedGames::const_iterator game = games.begin(); game != games.end(); ++game) {
+			if (i == 0 || (game->engineId == engineId && game->gameId == gameId)
+			    || gameId.empty())
+				list.push_back(*game);
 		}
 	}
 
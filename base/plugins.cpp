@@ -616,12 +616,33 @@ void PluginManager::addToPluginsInMemList(Plugin *plugin) {
 
 // Engine plugins
 
+#include "engines/detectioncache.h"
 #include "engines/metaengine.h"
 
+#include "common/threadpool.h"
+
 namespace Common {
 DECLARE_SINGLETON(EngineManager);
 }
 
+EngineManager::EngineManager() : _detectionMutex(0) {
+}
+
+EngineManager::~EngineManager() {
+	if (_detectionMutex)
+		g_system->deleteMutex(_detectionMutex);
+}
+
+DetectionLock::DetectionLock() : _mutex(EngineMan._detectionMutex) {
+	if (_mutex)
+		g_system->lockMutex(_mutex);
+}
+
+DetectionLock::~DetectionLock() {
+	if (_mutex)
+		g_system->unlockMutex(_mutex);
+}
+
 /**
  * This function works for both cached and uncached PluginManagers.
  * For the cached version, most of the logic here will short circuit.
@@ -676,6 +697,42 @@ QualifiedGameList EngineManager::findGameInLoadedPlugins(const Common::String &g
 	return results;
 }
 
+namespace {
+
+void detectGamesWithEngine(const Plugin *plugin, const Common::FSList &fslist, DetectedGames &candidates) {
+	const MetaEngineDetection &metaEngine = plugin->get<MetaEngineDetection>();
+	DetectedGames engineCandidates = metaEngine.detectGames(fslist);
+
+	for (uint i = 0; i < engineCandidates.size(); i++) {
+		engineCandidates[i].path = fslist.begin()->getParent().getPath();
+		engineCandidates[i].shortPath = fslist.begin()->getParent().getDisplayName();
+		candidates.push_back(engineCandidates[i]);
+	}
+}
+
+struct DetectionJobs {
+	const PluginList *plugins;
+	const Common::Array<Common::FSList> *dirs;
+
+	/** The candidates found by each engine in each directory. */
+	Common::Array<DetectedGames> candidates;
+};
+
+void runDetectionJob(void *arg, uint index) {
+	// Every job runs one engine on all directories, so that no detector is
+	// used by several threads at once
+	DetectionJobs *jobs = (DetectionJobs *)arg;
+	const Plugin *plugin = (*jobs->plugins)[index];
+
+	for (uint i = 0; i < jobs->dirs->size(); i++) {
+		const Common::FSList &fslist = (*jobs->dirs)[i];
+		if (!fslist.empty())
+			detectGamesWithEngine(plugin, fslist, jobs->candidates[index * jobs->dirs->size() + i]);
+	}
+}
+
+} // End of anonymous namespace
+
 DetectionResults EngineManager::detectGames(const Common::FSList &fslist) const {
 	DetectedGames candidates;
 	PluginList plugins;
@@ -687,18 +744,59 @@ DetectionResults EngineManager::detectGames(const Common::FSList &fslist) const
 
 	// Iterate over all known games and for each check if it might be
 	// the game in the presented directory.
-	for (iter = plugins.begin(); iter != plugins.end(); ++iter) {
-		const MetaEngineDetection &metaEngine = (*iter)->get<MetaEngineDetection>();
-		DetectedGames engineCandidates = metaEngine.detectGames(fslist);
+	for (iter = plugins.begin(); iter != plugins.end(); ++iter)
+		detectGamesWithEngine(*iter, fslist, candidates);
+
+	// Keep the MD5s computed for the next detection
+	DetectionCacheMan.flush();
+	debug(1, "%s", DetectionCacheMan.getStats().c_str());
+
+	return DetectionResults(candidates);
+}
 
-		for (uint i = 0; i < engineCandidates.size(); i++) {
-			engineCandidates[i].path = fslist.begin()->getParent().getPath();
-			engineCandidates[i].shortPath = fslist.begin()->getParent().getDisplayName();
-			candidates.push_back(engineCandidates[i]);
+Common::Array<DetectionResults> EngineManager::detectGames(const Common::Array<Common::FSList> &dirs, Common::ThreadPool &pool) const {
+	beginDetection(pool);
+	Common::Array<DetectionResults> results = detectGamesOnPool(dirs, pool);
+	endDetection();
+	return results;
+}
+
+void EngineManager::beginDetection(Common::ThreadPool &pool) const {
+	// Whatever the detectors may need from the backend must be set up
+	// before starting the threads
+	if (!_detectionMutex && pool.getThreadCount() > 1)
+		_detectionMutex = g_system->createMutex();
+	DetectionCacheMan.load();
+}
+
+Common::Array<DetectionResults> EngineManager::detectGamesOnPool(const Common::Array<Common::FSList> &dirs, Common::ThreadPool &pool) const {
+	const PluginList &plugins = getPlugins(PLUGIN_TYPE_ENGINE_DETECTION);
+
+	DetectionJobs jobs;
+	jobs.plugins = &plugins;
+	jobs.dirs = &dirs;
+	jobs.candidates.resize(plugins.size() * dirs.size());
+	pool.run(runDetectionJob, &jobs, plugins.size());
+
+	// Merge the candidates in the same order as detectGames() for a single
+	// directory does
+	Common::Array<DetectionResults> results;
+	for (uint i = 0; i < dirs.size(); i++) {
+		DetectedGames candidates;
+		for (uint j = 0; j < plugins.size(); j++) {
+			const DetectedGames &engineCandidates = jobs.candidates[j * dirs.size() + i];
+			for (uint k = 0; k < engineCandidates.size(); k++)
+				candidates.push_back(engineCandidates[k]);
 		}
+		results.push_back(DetectionResults(candidates));
 	}
 
-	return DetectionResults(candidates);
+	return results;
+}
+
+void EngineManager::endDetection() const {
+	DetectionCacheMan.flush();
+	debug(1, "%s", DetectionCacheMan.getStats().c_str());
 }
 
 const PluginList &EngineManager::getPlugins(const PluginType fetchPluginType) const {
@@ -22,11 +22,23 @@
 
 #include "common/archive.h"
 #include "common/fs.h"
+#include "common/streamspan.h"
 #include "common/system.h"
 #include "common/textconsole.h"
 
 namespace Common {
 
+StreamSpan ArchiveMember::mapSpan() const {
+	SeekableReadStream *stream = createReadStream();
+	if (!stream)
+		return StreamSpan();
+
+	// Borrowed spans keep the data alive after the stream is gone
+	StreamSpan span = stream->readSpan(stream->size());
+	delete stream;
+	return span;
+}
+
 GenericArchiveMember::GenericArchiveMember(const String &name, const Archive *parent)
 	: _parent(parent), _name(name) {
 }
@@ -92,6 +104,7 @@ void SearchSet::insert(const Node &node) {
 			break;
 	}
 	_list.insert(it, node);
+	_nameIndexValid = false;
 }
 
 void SearchSet::add(const String &name, Archive *archive, int priority, bool autoFree) {
@@ -173,6 +186,7 @@ void SearchSet::remove(const String &name) {
 		if (it->_autoFree)
 			delete it->_arc;
 		_list.erase(it);
+		_nameIndexValid = false;
 	}
 }
 
@@ -187,6 +201,7 @@ void SearchSet::clear() {
 	}
 
 	_list.clear();
+	_nameIndexValid = false;
 }
 
 void SearchSet::setPriority(const String &name, int priority) {
@@ -205,13 +220,80 @@ void SearchSet::setPriority(const String &name, int priority) {
 	insert(node);
 }
 
+void SearchSet::setUseNameIndex(bool useNameIndex) {
+	_useNameIndex = useNameIndex;
+	_nameIndexValid = false;
+	_nameIndex.clear(true);
+}
+
+bool SearchSet::lookUpNameIndex(const String &name, const Node *&node) const {
+	node = nullptr;
+	if (!_useNameIndex || name.contains('/'))
+		return false;
+
+	if (!_nameIndexValid) {
+		_nameIndex.clear();
+
+		// Archives are visited in search order, so the first archive
+		// containing a name stays in the index
+		for (ArchiveNodeList::const_iterator it = _list.begin(); it != _list.end(); ++it) {
+			ArchiveMemberList members;
+			it->_arc->listMembers(members);
+			for (ArchiveMemberList::const_iterator member = members.begin(); member != members.end(); ++member) {
+				const String memberName = (*member)->getName();
+				if (!_nameIndex.contains(memberName))
+					_nameIndex[memberName] = &*it;
+			}
+		}
+
+		_nameIndexValid = true;
+	}
+
+	NameIndex::const_iterator entry = _nameIndex.find(name);
+	if (entry != _nameIndex.end())
+		node = entry->_value;
+	return true;
+}
+
+bool SearchSet::countLookup(const Node &node, bool found) {
+	node._lookups++;
+	if (found)
+		node._hits++;
+	return found;
+}
+
+void SearchSet::getLookupStats(Array<ArchiveStats> &stats) const {
+	for (ArchiveNodeList::const_iterator it = _list.begin(); it != _list.end(); ++it) {
+		ArchiveStats entry;
+		entry.name = it->_name;
+		entry.lookups = it->_lookups;
+		entry.hits = it->_hits;
+		stats.push_back(entry);
+	}
+}
+
+void SearchSet::resetLookupStats() {
+	for (ArchiveNodeList::iterator it = _list.begin(); it != _list.end(); ++it) {
+		it->_lookups = 0;
+		it->_hits = 0;
+	}
+}
+
 bool SearchSet::hasFile(const String &name) const {
 	if (name.empty())
 		return false;
 
+	const Node *node;
+	if (lookUpNameIndex(name, node)) {
+		if (!node)
+			return false;
+		if (countLookup(*node, node->_arc->hasFile(name)))
+			return true;
+	}
+
 	ArchiveNodeList::const_iterator it = _list.begin();
 	for (; it != _list.end(); ++it) {
-		if (it->_arc->hasFile(name))
+		if (countLookup(*it, it->_arc->hasFile(name)))
 			return true;
 	}
 
@@ -242,9 +324,17 @@ const ArchiveMemberPtr SearchSet::getMember(const String &name) const {
 	if (name.empty())
 		return ArchiveMemberPtr();
 
+	const Node *node;
+	if (lookUpNameIndex(name, node)) {
+		if (!node)
+			return ArchiveMemberPtr();
+		if (countLookup(*node, node->_arc->hasFile(name)))
+			return node->_arc->getMember(name);
+	}
+
 	ArchiveNodeList::const_iterator it = _list.begin();
 	for (; it != _list.end(); ++it) {
-		if (it->_arc->hasFile(name))
+		if (countLookup(*it, it->_arc->hasFile(name)))
 			return it->_arc->getMember(name);
 	}
 
@@ -255,10 +345,22 @@ SeekableReadStream *SearchSet::createReadStreamForMember(const String &name) con
 	if (name.empty())
 		return nullptr;
 
+	const Node *node;
+	if (lookUpNameIndex(name, node)) {
+		if (!node)
+			return nullptr;
+
+		SeekableReadStream *stream = node->_arc->createReadStreamForMember(name);
+		if (countLookup(*node, stream != nullptr))
+			return stream;
+	}
+
+	// Without an index, or if the indexed archive does not know the name
+	// after all, ask all archives
 	ArchiveNodeList::const_iterator it = _list.begin();
 	for (; it != _list.end(); ++it) {
 		SeekableReadStream *stream = it->_arc->createReadStreamForMember(name);
-		if (stream)
+		if (countLookup(*it, stream != nullptr))
 			return stream;
 	}
 
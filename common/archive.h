@@ -24,6 +24,9 @@
 #define COMMON_ARCHIVE_H
 
 #include "common/str.h"
+#include "common/array.h"
+#include "common/hashmap.h"
+#include "common/hash-str.h"
 #include "common/list.h"
 #include "common/ptr.h"
 #include "common/singleton.h"
@@ -42,6 +45,7 @@ namespace Common {
 
 class FSNode;
 class SeekableReadStream;
+class StreamSpan;
 
 
 /**
@@ -56,6 +60,16 @@ class ArchiveMember {
 public:
 	virtual ~ArchiveMember() { }
 	virtual SeekableReadStream *createReadStream() const = 0; /*!< Create a read stream. */
+
+	/**
+	 * Return the whole content of the member as a StreamSpan (see
+	 * common/streamspan.h). This avoids copying the data if the member
+	 * is held in memory or mapped into memory, and copies it otherwise.
+	 *
+	 * @return The content, or an empty span if the member could not be read.
+	 */
+	virtual StreamSpan mapSpan() const;
+
 	virtual String getName() const = 0; /*!< Get the name of the archive member. */
 	virtual String getDisplayName() const { return getName(); } /*!< Get the display name of the archive member. */
 };
@@ -149,13 +163,26 @@ public:
  * priority order. In case of conflicting priorities, insertion order prevails.
  */
 class SearchSet : public Archive {
+public:
+	/**
+	 * Lookup statistics of an archive in the set.
+	 */
+	struct ArchiveStats {
+		String name;   ///< The name of the archive in the set.
+		uint32 lookups; ///< How often the archive has been searched for a file.
+		uint32 hits;    ///< How often it contained the file.
+	};
+
+private:
 	struct Node {
 		int		_priority;
 		String	_name;
 		Archive	*_arc;
 		bool	_autoFree;
+		mutable uint32	_lookups;
+		mutable uint32	_hits;
 		Node(int priority, const String &name, Archive *arc, bool autoFree)
-			: _priority(priority), _name(name), _arc(arc), _autoFree(autoFree) {
+			: _priority(priority), _name(name), _arc(arc), _autoFree(autoFree), _lookups(0), _hits(0) {
 		}
 	};
 	typedef List<Node> ArchiveNodeList;
@@ -166,10 +193,18 @@ class SearchSet : public Archive {
 
 	void insert(const Node& node); //!< Add an archive while keeping the list sorted by descending priority.
 
+	typedef HashMap<String, const Node *, IgnoreCase_Hash, IgnoreCase_EqualTo> NameIndex;
+
+	bool lookUpNameIndex(const String &name, const Node *&node) const;
+	static bool countLookup(const Node &node, bool found);
+
 	bool _ignoreClashes;
+	bool _useNameIndex;
+	mutable bool _nameIndexValid;
+	mutable NameIndex _nameIndex;
 
 public:
-	SearchSet() : _ignoreClashes(false) { }
+	SearchSet() : _ignoreClashes(false), _useNameIndex(false), _nameIndexValid(false) { }
 	virtual ~SearchSet() { clear(); }
 
 	/**
@@ -268,6 +303,36 @@ public:
 	 * in @ref FSDirectory documentation.
 	 */
 	void setIgnoreClashes(bool ignoreClashes) { _ignoreClashes = ignoreClashes; }
+
+	/**
+	 * Look up files in an index of the members of all archives, instead of
+	 * asking every archive in turn.
+	 *
+	 * The index is built from the listMembers() results of the archives when
+	 * it is first needed, and rebuilt after archives are added or removed.
+	 * A name which is in no list is not found, so only enable the index if
+	 * the archives list all files they contain. Names with a path are always
+	 * looked up in every archive, because e.g. FSDirectory only lists the
+	 * file names of the members in its subdirectories.
+	 */
+	void setUseNameIndex(bool useNameIndex);
+
+	/**
+	 * Rebuild the name index before its next use. This needs to be called if
+	 * the members of an archive in the set change.
+	 */
+	void invalidateNameIndex() { _nameIndexValid = false; }
+
+	/**
+	 * Append the lookup statistics of all archives to the given array, in
+	 * search order.
+	 */
+	void getLookupStats(Array<ArchiveStats> &stats) const;
+
+	/**
+	 * Reset the lookup statistics of all archives.
+	 */
+	void resetLookupStats();
 };
 
 
@@ -0,0 +1,434 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/arena.h"
+#include "common/atomic.h"
+#include "common/util.h"
+
+namespace Common {
+
+enum {
+	// The amount of memory a thread cache moves between itself and the
+	// arena at once
+	kCacheBatchBytes = 4096,
+	kMinCacheBatch = 4,
+	kMaxCacheBatch = 64
+};
+
+#pragma mark --- Arena ---
+
+// The list of all arenas is only changed when an arena is created or
+// destroyed, so a simple spin lock is enough to protect it. Unlike a Mutex,
+// it also works for arenas created before g_system exists.
+static Arena *s_arenas = nullptr;
+static volatile uint32 s_arenasLock = 0;
+
+static void lockArenaList() {
+	while (!atomicCompareExchange(&s_arenasLock, 0, 1))
+		;
+}
+
+static void unlockArenaList() {
+	atomicStore(&s_arenasLock, 0);
+}
+
+Arena::Arena(const char *name) : _name(name), _prevArena(nullptr) {
+	lockArenaList();
+	_nextArena = s_arenas;
+	if (_nextArena)
+		_nextArena->_prevArena = this;
+	s_arenas = this;
+	unlockArenaList();
+}
+
+Arena::~Arena() {
+	lockArenaList();
+	if (_prevArena)
+		_prevArena->_nextArena = _nextArena;
+	else
+		s_arenas = _nextArena;
+	if (_nextArena)
+		_nextArena->_prevArena = _prevArena;
+	unlockArenaList();
+}
+
+String Arena::printAllStats() {
+	String out;
+
+	lockArenaList();
+	for (const Arena *arena = s_arenas; arena; arena = arena->_nextArena)
+		arena->printStats(out);
+	unlockArenaList();
+
+	return out;
+}
+
+#pragma mark --- SizeClassArena ---
+
+SizeClassArena::SizeClassArena(const char *name) : Arena(name) {
+	for (uint i = 0; i <= kNumSizeClasses; ++i) {
+		SizeClass &sizeClass = _classes[i];
+		sizeClass.pool = (i < kNumSizeClasses) ? new MemoryPool(getBlockSize(i)) : nullptr;
+		sizeClass.stats.blockSize = (i < kNumSizeClasses) ? getBlockSize(i) : 0;
+		sizeClass.stats.allocations = 0;
+		sizeClass.stats.frees = 0;
+		sizeClass.stats.bytesInUse = 0;
+		sizeClass.stats.peakBytesInUse = 0;
+		sizeClass.stats.bytesReserved = 0;
+	}
+}
+
+SizeClassArena::~SizeClassArena() {
+	for (uint i = 0; i < kNumSizeClasses; ++i)
+		delete _classes[i].pool;
+}
+
+uint SizeClassArena::getSizeClass(size_t size) {
+	// Steps of 16 bytes up to 128 bytes, then four classes for each
+	// doubling of the size
+	if (size <= 128)
+		return size ? (size - 1) >> 4 : 0;
+	if (size <= 256)
+		return 8 + ((size - 129) >> 5);
+	if (size <= 512)
+		return 12 + ((size - 257) >> 6);
+	if (size <= kMaxSmallSize)
+		return 16 + ((size - 513) >> 7);
+	return kNumSizeClasses;
+}
+
+size_t SizeClassArena::getBlockSize(uint sizeClass) {
+	assert(sizeClass < kNumSizeClasses);
+	if (sizeClass < 8)
+		return (sizeClass + 1) * 16;
+
+	const uint shift = (sizeClass - 8) / 4;
+	const uint step = (sizeClass - 8) % 4 + 1;
+	return (128 << shift) + step * (32 << shift);
+}
+
+void SizeClassArena::addAllocations(ClassStats &stats, uint32 count, size_t bytes) {
+	stats.allocations += count;
+	stats.bytesInUse += bytes;
+	if (stats.bytesInUse > stats.peakBytesInUse)
+		stats.peakBytesInUse = stats.bytesInUse;
+}
+
+void SizeClassArena::addFrees(ClassStats &stats, uint32 count, size_t bytes) {
+	stats.frees += count;
+	stats.bytesInUse -= bytes;
+}
+
+void *SizeClassArena::allocate(size_t size) {
+	const uint index = getSizeClass(size);
+	SizeClass &sizeClass = _classes[index];
+	StackLock lock(sizeClass.mutex);
+
+	if (index == kNumSizeClasses) {
+		void *ptr = ::malloc(size);
+		assert(ptr);
+		addAllocations(sizeClass.stats, 1, size);
+		return ptr;
+	}
+
+	addAllocations(sizeClass.stats, 1, sizeClass.stats.blockSize);
+	return sizeClass.pool->allocChunk();
+}
+
+void SizeClassArena::deallocate(void *ptr, size_t size) {
+	if (!ptr)
+		return;
+
+	const uint index = getSizeClass(size);
+	SizeClass &sizeClass = _classes[index];
+	StackLock lock(sizeClass.mutex);
+
+	if (index == kNumSizeClasses) {
+		::free(ptr);
+		addFrees(sizeClass.stats, 1, size);
+		return;
+	}
+
+	addFrees(sizeClass.stats, 1, sizeClass.stats.blockSize);
+	sizeClass.pool->freeChunk(ptr);
+}
+
+void SizeClassArena::freeUnusedPages() {
+	for (uint i = 0; i < kNumSizeClasses; ++i) {
+		StackLock lock(_classes[i].mutex);
+		_classes[i].pool->freeUnusedPages();
+	}
+}
+
+SizeClassArena::ClassStats SizeClassArena::getStats(uint sizeClass) const {
+	assert(sizeClass <= kNumSizeClasses);
+	const SizeClass &entry = _classes[sizeClass];
+	StackLock lock(entry.mutex);
+
+	ClassStats stats = entry.stats;
+	stats.bytesReserved = entry.pool ? entry.pool->getReservedSize() : stats.bytesInUse;
+	return stats;
+}
+
+void SizeClassArena::printStats(String &out) const {
+	out += String::format("Size class arena '%s':\n", getName());
+	out += "    size     allocs      frees     in use       peak   reserved\n";
+
+	for (uint i = 0; i <= kNumSizeClasses; ++i) {
+		const ClassStats stats = getStats(i);
+		if (!stats.allocations)
+			continue;
+
+		if (i == kNumSizeClasses)
+			out += "     big";
+		else
+			out += String::format("%8u", (uint)stats.blockSize);
+		out += String::format(" %10u %10u %10u %10u %10u\n", stats.allocations, stats.frees,
+		                      (uint)stats.bytesInUse, (uint)stats.peakBytesInUse, (uint)stats.bytesReserved);
+	}
+}
+
+#pragma mark --- SizeClassArena::ThreadCache ---
+
+static uint getCacheBatch(size_t blockSize) {
+	return CLIP<uint>(kCacheBatchBytes / blockSize, kMinCacheBatch, kMaxCacheBatch);
+}
+
+SizeClassArena::ThreadCache::ThreadCache(SizeClassArena &arena) : _arena(arena) {
+	for (uint i = 0; i < kNumSizeClasses; ++i) {
+		_lists[i].head = nullptr;
+		_lists[i].count = 0;
+		_lists[i].allocations = 0;
+		_lists[i].frees = 0;
+	}
+}
+
+SizeClassArena::ThreadCache::~ThreadCache() {
+	flush();
+}
+
+void *SizeClassArena::ThreadCache::allocate(size_t size) {
+	const uint index = getSizeClass(size);
+	if (index == kNumSizeClasses)
+		return _arena.allocate(size);
+
+	FreeList &list = _lists[index];
+	if (!list.head)
+		refill(index);
+
+	void *ptr = list.head;
+	list.head = *(void **)ptr;
+	list.count--;
+	list.allocations++;
+	return ptr;
+}
+
+void SizeClassArena::ThreadCache::deallocate(void *ptr, size_t size) {
+	if (!ptr)
+		return;
+
+	const uint index = getSizeClass(size);
+	if (index == kNumSizeClasses) {
+		_arena.deallocate(ptr, size);
+		return;
+	}
+
+	FreeList &list = _lists[index];
+	*(void **)ptr = list.head;
+	list.head = ptr;
+	list.count++;
+	list.frees++;
+
+	// Keep one batch around, so that alternating allocations and frees do
+	// not move blocks back and forth
+	const uint batch = getCacheBatch(getBlockSize(index));
+	if (list.count > 2 * batch)
+		drain(index, batch);
+}
+
+void SizeClassArena::ThreadCache::flush() {
+	for (uint i = 0; i < kNumSizeClasses; ++i)
+		drain(i, 0);
+}
+
+void SizeClassArena::ThreadCache::refill(uint sizeClass) {
+	SizeClass &entry = _arena._classes[sizeClass];
+	FreeList &list = _lists[sizeClass];
+	const uint batch = getCacheBatch(entry.stats.blockSize);
+
+	StackLock lock(entry.mutex);
+	for (uint i = 0; i < batch; ++i) {
+		void *ptr = entry.pool->allocChunk();
+		*(void **)ptr = list.head;
+		list.head = ptr;
+	}
+	list.count += batch;
+
+	// The blocks in the cache count as in use, so only the number of calls
+	// is passed on here
+	entry.stats.frees += list.frees;
+	addAllocations(entry.stats, list.allocations, batch * entry.stats.blockSize);
+	list.allocations = 0;
+	list.frees = 0;
+}
+
+void SizeClassArena::ThreadCache::drain(uint sizeClass, uint keep) {
+	SizeClass &entry = _arena._classes[sizeClass];
+	FreeList &list = _lists[sizeClass];
+	if (list.count <= keep && !list.allocations && !list.frees)
+		return;
+
+	StackLock lock(entry.mutex);
+	const uint count = list.count > keep ? list.count - keep : 0;
+	for (uint i = 0; i < count; ++i) {
+		void *ptr = list.head;
+		list.head = *(void **)ptr;
+		entry.pool->freeChunk(ptr);
+	}
+	list.count -= count;
+
+	entry.stats.allocations += list.allocations;
+	addFrees(entry.stats, list.frees, count * entry.stats.blockSize);
+	list.allocations = 0;
+	list.frees = 0;
+}
+
+#pragma mark --- FrameArena ---
+
+FrameArena::FrameArena(const char *name, size_t blockSize)
+	: Arena(name), _blockSize(blockSize), _curBlock(0), _offset(0),
+	  _bytesInUse(0), _peakBytesInUse(0), _allocations(0), _resets(0) {
+}
+
+FrameArena::~FrameArena() {
+	freeBlocks();
+}
+
+void *FrameArena::allocateFromCurrentBlock(size_t size, size_t alignment) {
+	const Block &block = _blocks[_curBlock];
+	const uintptr base = (uintptr)block.data;
+	const uintptr start = (base + _offset + alignment - 1) & ~(uintptr)(alignment - 1);
+	if (start - base + size > block.size)
+		return nullptr;
+
+	_offset = start - base + size;
+	return (void *)start;
+}
+
+void *FrameArena::allocate(size_t size, size_t alignment) {
+	assert(alignment && !(alignment & (alignment - 1)));
+
+	_allocations++;
+	_bytesInUse += size;
+	if (_bytesInUse > _peakBytesInUse)
+		_peakBytesInUse = _bytesInUse;
+
+	if (!_blocks.empty()) {
+		void *result = allocateFromCurrentBlock(size, alignment);
+		if (result)
+			return result;
+
+		// The blocks after the current one are unused
+		while (_curBlock + 1 < _blocks.size()) {
+			_curBlock++;
+			_offset = 0;
+			result = allocateFromCurrentBlock(size, alignment);
+			if (result)
+				return result;
+		}
+	}
+
+	Block block;
+	block.size = MAX(_blockSize, size + alignment);
+	block.data = (byte *)::malloc(block.size);
+	assert(block.data);
+
+	_blocks.push_back(block);
+	_curBlock = _blocks.size() - 1;
+	_offset = 0;
+
+	void *result = allocateFromCurrentBlock(size, alignment);
+	assert(result);
+	return result;
+}
+
+void FrameArena::reset() {
+	// Replace the blocks by a single one, which is big enough for the
+	// whole next frame if it is like this one
+	if (_blocks.size() > 1) {
+		Block block;
+		block.size = getBytesReserved();
+		freeBlocks();
+
+		block.data = (byte *)::malloc(block.size);
+		assert(block.data);
+		_blocks.push_back(block);
+	}
+
+	_curBlock = 0;
+	_offset = 0;
+	_bytesInUse = 0;
+	_resets++;
+}
+
+void FrameArena::releaseMemory() {
+	freeBlocks();
+	_curBlock = 0;
+	_offset = 0;
+	_bytesInUse = 0;
+}
+
+FrameArena::Mark FrameArena::getMark() const {
+	Mark mark;
+	mark.block = _curBlock;
+	mark.offset = _offset;
+	mark.bytesInUse = _bytesInUse;
+	return mark;
+}
+
+void FrameArena::rewind(const Mark &mark) {
+	assert(mark.block < _curBlock || (mark.block == _curBlock && mark.offset <= _offset));
+	_curBlock = mark.block;
+	_offset = mark.offset;
+	_bytesInUse = mark.bytesInUse;
+}
+
+size_t FrameArena::getBytesReserved() const {
+	size_t size = 0;
+	for (uint i = 0; i < _blocks.size(); ++i)
+		size += _blocks[i].size;
+	return size;
+}
+
+void FrameArena::freeBlocks() {
+	for (uint i = 0; i < _blocks.size(); ++i)
+		::free(_blocks[i].data);
+	_blocks.clear();
+}
+
+void FrameArena::printStats(String &out) const {
+	out += String::format("Frame arena '%s': %u bytes in use, %u peak, %u reserved in %u blocks, %u allocations, %u resets\n",
+	                      getName(), (uint)_bytesInUse, (uint)_peakBytesInUse, (uint)getBytesReserved(),
+	                      _blocks.size(), _allocations, _resets);
+}
+
+} // End of namespace Common
@@ -0,0 +1,386 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_ARENA_H
+#define COMMON_ARENA_H
+
+#include "common/scummsys.h"
+#include "common/array.h"
+#include "common/memorypool.h"
+#include "common/mutex.h"
+#include "common/noncopyable.h"
+#include "common/str.h"
+
+namespace Common {
+
+/**
+ * @defgroup common_arena Arenas
+ * @ingroup common_memory
+ *
+ * @brief Allocators for many small, short lived objects.
+ * @{
+ */
+
+/**
+ * Base class of all arenas.
+ *
+ * Every arena has a name and registers itself in a global list for as long
+ * as it exists, so that the allocation statistics of all arenas can be
+ * shown e.g. by the "arenas" command of the debugger console.
+ */
+class Arena : NonCopyable {
+public:
+	virtual ~Arena();
+
+	/**
+	 * Return the name of this arena, as shown in the statistics.
+	 */
+	const char *getName() const { return _name; }
+
+	/**
+	 * Append a human readable summary of the allocation statistics of this
+	 * arena to the given string.
+	 */
+	virtual void printStats(String &out) const = 0;
+
+	/**
+	 * Return the allocation statistics of all arenas currently in existence.
+	 */
+	static String printAllStats();
+
+protected:
+	explicit Arena(const char *name);
+
+private:
+	const char *_name;
+	Arena *_prevArena;
+	Arena *_nextArena;
+};
+
+/**
+ * A thread-safe allocator for objects of different sizes.
+ *
+ * Requests are rounded up to one of a few size classes, each of which is
+ * served by its own MemoryPool and protected by its own mutex. Requests
+ * bigger than kMaxSmallSize are passed to malloc().
+ *
+ * Unlike with malloc(), the size of a block must be passed again when
+ * freeing it. This saves storing a header with each block.
+ *
+ * Threads which allocate a lot should do so through a ThreadCache, which
+ * only needs to lock the arena once per batch of blocks.
+ */
+class SizeClassArena : public Arena {
+public:
+	enum {
+		/** The biggest size served from the pools. */
+		kMaxSmallSize = 1024,
+		/** The number of size classes. */
+		kNumSizeClasses = 20
+	};
+
+	/**
+	 * The allocation statistics of a size class.
+	 *
+	 * The blocks kept by thread caches count as in use. The allocations and
+	 * frees done through a thread cache are only added once it refills,
+	 * drains or flushes.
+	 */
+	struct ClassStats {
+		size_t blockSize;      ///< The size of the blocks, 0 for the big blocks.
+		uint32 allocations;    ///< The number of allocate() calls.
+		uint32 frees;          ///< The number of deallocate() calls.
+		size_t bytesInUse;     ///< The number of bytes currently allocated.
+		size_t peakBytesInUse; ///< The maximum of bytesInUse.
+		size_t bytesReserved;  ///< The number of bytes held by the pool.
+	};
+
+	/**
+	 * A cache of free blocks, to be used by a single thread.
+	 *
+	 * The cache takes blocks from the arena, and gives them back, in batches.
+	 * Blocks may be freed through a different cache (or the arena itself)
+	 * than the one they have been allocated by.
+	 *
+	 * All cached blocks are returned to the arena when the cache is
+	 * destroyed, which has to happen before the arena is destroyed.
+	 */
+	class ThreadCache : Common::NonCopyable {
+	public:
+		explicit ThreadCache(SizeClassArena &arena);
+		~ThreadCache();
+
+		/**
+		 * Allocate a block of at least the given size.
+		 */
+		void *allocate(size_t size);
+
+		/**
+		 * Free a block allocated from the same arena.
+		 *
+		 * @param ptr  The block, or nullptr.
+		 * @param size The size passed to allocate().
+		 */
+		void deallocate(void *ptr, size_t size);
+
+		/**
+		 * Return all cached blocks to the arena.
+		 */
+		void flush();
+
+	private:
+		struct FreeList {
+			void *head;
+			uint count;
+			uint32 allocations;
+			uint32 frees;
+		};
+
+		void refill(uint sizeClass);
+		void drain(uint sizeClass, uint keep);
+
+		SizeClassArena &_arena;
+		FreeList _lists[kNumSizeClasses];
+	};
+
+	explicit SizeClassArena(const char *name);
+	~SizeClassArena();
+
+	/**
+	 * Allocate a block of at least the given size.
+	 */
+	void *allocate(size_t size);
+
+	/**
+	 * Free a block allocated from this arena.
+	 *
+	 * @param ptr  The block, or nullptr.
+	 * @param size The size passed to allocate().
+	 */
+	void deallocate(void *ptr, size_t size);
+
+	/**
+	 * Call the destructor of an object created with the placement new
+	 * operator for SizeClassArena, and free its memory.
+	 */
+	template<class T>
+	void destroy(T *obj) {
+		if (obj) {
+			obj->~T();
+			deallocate(obj, sizeof(T));
+		}
+	}
+
+	/**
+	 * Release the pool pages which contain no allocated blocks.
+	 * See MemoryPool::freeUnusedPages().
+	 */
+	void freeUnusedPages();
+
+	/**
+	 * Return the statistics of a size class.
+	 *
+	 * @param sizeClass The size class, or kNumSizeClasses for the blocks
+	 *                  bigger than kMaxSmallSize.
+	 */
+	ClassStats getStats(uint sizeClass) const;
+
+	void printStats(String &out) const override;
+
+	/**
+	 * Return the size class serving blocks of the given size, or
+	 * kNumSizeClasses if the size is bigger than kMaxSmallSize.
+	 */
+	static uint getSizeClass(size_t size);
+
+	/**
+	 * Return the size of the blocks of a size class.
+	 */
+	static size_t getBlockSize(uint sizeClass);
+
+private:
+	struct SizeClass {
+		MemoryPool *pool;
+		Mutex mutex;
+		ClassStats stats;
+	};
+
+	static void addAllocations(ClassStats &stats, uint32 count, size_t bytes);
+	static void addFrees(ClassStats &stats, uint32 count, size_t bytes);
+
+	SizeClass _classes[kNumSizeClasses + 1];
+};
+
+/**
+ * An arena for objects which all die at the same time, e.g. at the end of
+ * a frame.
+ *
+ * Allocating just advances a pointer in a big block of memory, and there
+ * is no way to free single objects. Instead, reset() frees everything
+ * allocated since the last reset at once, and rewind() everything
+ * allocated since a Mark was taken.
+ *
+ * Neither of them calls any destructors, so only objects which do not
+ * need to be destroyed should be put into a FrameArena.
+ *
+ * A FrameArena is not thread-safe; use one per thread.
+ */
+class FrameArena : public Arena {
+public:
+	enum {
+		kDefaultBlockSize = 64 * 1024,
+		kDefaultAlignment = 16
+	};
+
+	/**
+	 * A position in the arena to rewind to.
+	 */
+	struct Mark {
+		uint block;
+		size_t offset;
+		size_t bytesInUse;
+	};
+
+	/**
+	 * Frees everything allocated from a FrameArena during its own lifetime
+	 * when it goes out of scope.
+	 */
+	class Scope : Common::NonCopyable {
+	public:
+		explicit Scope(FrameArena &arena) : _arena(arena), _mark(arena.getMark()) {}
+		~Scope() { _arena.rewind(_mark); }
+
+	private:
+		FrameArena &_arena;
+		const Mark _mark;
+	};
+
+	/**
+	 * Create a frame arena.
+	 *
+	 * @param name      The name shown in the statistics.
+	 * @param blockSize The size of the memory blocks requested from malloc().
+	 */
+	explicit FrameArena(const char *name, size_t blockSize = kDefaultBlockSize);
+	~FrameArena();
+
+	/**
+	 * Allocate memory, which stays valid until the next reset().
+	 *
+	 * @param size      The number of bytes.
+	 * @param alignment The alignment of the memory, a power of two.
+	 */
+	void *allocate(size_t size, size_t alignment = kDefaultAlignment);
+
+	/**
+	 * Allocate an uninitialized array of the given type.
+	 */
+	template<class T>
+	T *allocateArray(size_t count) {
+		return (T *)allocate(count * sizeof(T));
+	}
+
+	/**
+	 * Free everything allocated from the arena.
+	 *
+	 * The memory is kept for the next frame. If the last frame needed more
+	 * than one block, the blocks are merged into a single one.
+	 */
+	void reset();
+
+	/**
+	 * Free everything allocated from the arena, and return all memory to
+	 * the system.
+	 */
+	void releaseMemory();
+
+	/**
+	 * Return the current position in the arena.
+	 */
+	Mark getMark() const;
+
+	/**
+	 * Free everything allocated since the given mark was taken. The mark
+	 * must have been taken after the last reset().
+	 */
+	void rewind(const Mark &mark);
+
+	/**
+	 * Return the number of bytes allocated since the last reset.
+	 */
+	size_t getBytesInUse() const { return _bytesInUse; }
+
+	/**
+	 * Return the number of bytes of all memory blocks.
+	 */
+	size_t getBytesReserved() const;
+
+	void printStats(String &out) const override;
+
+private:
+	struct Block {
+		byte *data;
+		size_t size;
+	};
+
+	void *allocateFromCurrentBlock(size_t size, size_t alignment);
+	void freeBlocks();
+
+	const size_t _blockSize;
+	Array<Block> _blocks;
+	uint _curBlock;
+	size_t _offset;
+
+	size_t _bytesInUse;
+	size_t _peakBytesInUse;
+	uint32 _allocations;
+	uint32 _resets;
+};
+
+/** @} */
+
+} // End of namespace Common
+
+/**
+ * A placement new operator, allocating from a SizeClassArena.
+ * Objects created like this are destroyed with SizeClassArena::destroy().
+ */
+inline void *operator new(size_t nbytes, Common::SizeClassArena &arena) {
+	return arena.allocate(nbytes);
+}
+
+inline void operator delete(void *p, Common::SizeClassArena &arena) {
+	// Only called if the constructor throws, in which case the size is not
+	// known. Keeping the block allocated is the only safe choice.
+}
+
+/**
+ * A placement new operator, allocating from a FrameArena.
+ */
+inline void *operator new(size_t nbytes, Common::FrameArena &arena) {
+	return arena.allocate(nbytes);
+}
+
+inline void operator delete(void *p, Common::FrameArena &arena) {
+}
+
+#endif
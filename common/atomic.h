@@ -0,0 +1,135 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_ATOMIC_H
+#define COMMON_ATOMIC_H
+
+#include "common/scummsys.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Common {
+
+/**
+ * @defgroup common_atomic Atomic operations
+ * @ingroup common
+ *
+ * @brief Atomic operations on 32-bit values, for sharing data between
+ *        threads without a mutex.
+ *
+ * All operations are sequentially consistent, i.e. they also act as a
+ * full memory barrier for the surrounding code.
+ * @{
+ */
+
+#if defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7)))
+
+inline uint32 atomicLoad(const volatile uint32 *ptr) {
+	return __atomic_load_n(ptr, __ATOMIC_SEQ_CST);
+}
+
+inline void atomicStore(volatile uint32 *ptr, uint32 val) {
+	__atomic_store_n(ptr, val, __ATOMIC_SEQ_CST);
+}
+
+inline bool atomicCompareExchange(volatile uint32 *ptr, uint32 expected, uint32 desired) {
+	return __atomic_compare_exchange_n(ptr, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+inline uint32 atomicAdd(volatile uint32 *ptr, uint32 val) {
+	return __atomic_add_fetch(ptr, val, __ATOMIC_SEQ_CST);
+}
+
+#elif defined(__GNUC__)
+
+inline uint32 atomicLoad(const volatile uint32 *ptr) {
+	__sync_synchronize();
+	const uint32 val = *ptr;
+	__sync_synchronize();
+	return val;
+}
+
+inline void atomicStore(volatile uint32 *ptr, uint32 val) {
+	__sync_synchronize();
+	*ptr = val;
+	__sync_synchronize();
+}
+
+inline bool atomicCompareExchange(volatile uint32 *ptr, uint32 expected, uint32 desired) {
+	return __sync_bool_compare_and_swap(ptr, expected, desired);
+}
+
+inline uint32 atomicAdd(volatile uint32 *ptr, uint32 val) {
+	return __sync_add_and_fetch(ptr, val);
+}
+
+#elif defined(_MSC_VER)
+
+inline uint32 atomicLoad(const volatile uint32 *ptr) {
+	return (uint32)_InterlockedCompareExchange((volatile long *)ptr, 0, 0);
+}
+
+inline void atomicStore(volatile uint32 *ptr, uint32 val) {
+	_InterlockedExchange((volatile long *)ptr, (long)val);
+}
+
+inline bool atomicCompareExchange(volatile uint32 *ptr, uint32 expected, uint32 desired) {
+	return (uint32)_InterlockedCompareExchange((volatile long *)ptr, (long)desired, (long)expected) == expected;
+}
+
+inline uint32 atomicAdd(volatile uint32 *ptr, uint32 val) {
+	return (uint32)_InterlockedExchangeAdd((volatile long *)ptr, (long)val) + val;
+}
+
+#else
+
+// No atomic operations are known for this compiler. Plain volatile accesses
+// are only sufficient on single core CPUs, and even there the
+// read-modify-write operations below can be interrupted by another thread.
+inline uint32 atomicLoad(const volatile uint32 *ptr) {
+	return *ptr;
+}
+
+inline void atomicStore(volatile uint32 *ptr, uint32 val) {
+	*ptr = val;
+}
+
+inline bool atomicCompareExchange(volatile uint32 *ptr, uint32 expected, uint32 desired) {
+	if (*ptr != expected)
+		return false;
+	*ptr = desired;
+	return true;
+}
+
+inline uint32 atomicAdd(volatile uint32 *ptr, uint32 val) {
+	return *ptr += val;
+}
+
+#endif
+
+/** @} */
+
+} // End of namespace Common
+
+#endif
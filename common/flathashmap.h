@@ -0,0 +1,726 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+// The flat hash map in this file uses the open addressing scheme with
+// control byte groups of Google's SwissTable (Abseil flat_hash_map).
+
+#ifndef COMMON_FLATHASHMAP_H
+#define COMMON_FLATHASHMAP_H
+
+#include "common/scummsys.h"
+#include "common/endian.h"
+#include "common/func.h"
+#include "common/textconsole.h" // For error()
+
+#if defined(SCUMMVM_SSE2) && (defined(__x86_64__) || defined(_M_X64))
+// SSE2 is part of the x86-64 baseline
+#define FLATHASHMAP_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Common {
+
+/**
+ * @defgroup common_flathashmap Flat hash table (FlatHashMap)
+ * @ingroup common
+ *
+ * @brief API for operations on a hash table with inline storage.
+ *
+ * @{
+ */
+
+/**
+ * The control bytes of a group of consecutive FlatHashMap slots, which are
+ * scanned at once. This uses SSE2 where available.
+ */
+class FlatHashMapGroup {
+public:
+	enum {
+		/** Number of slots in a group. */
+#if defined(FLATHASHMAP_USE_SSE2)
+		kWidth = 16
+#else
+		kWidth = 8
+#endif
+	};
+
+	/**
+	 * Control byte values for slots which are not in use. Slots in use
+	 * store 7 bits of the hash of their key instead, which are never
+	 * negative.
+	 */
+	enum {
+		kEmpty = -128,
+		kDeleted = -2
+	};
+
+	/**
+	 * A set of slots of a group, enumerated starting with the lowest index.
+	 */
+	class BitMask {
+	public:
+		explicit BitMask(uint64 mask) : _mask(mask) {}
+
+		/** Whether any slot is in the set. */
+		bool any() const { return _mask != 0; }
+
+		/** Index of the first slot in the set. The set must not be empty. */
+		uint lowest() const { return countTrailingZeros(_mask) >> kShift; }
+
+		/** Remove the first slot from the set. */
+		void clearLowest() { _mask &= _mask - 1; }
+
+	private:
+#if defined(FLATHASHMAP_USE_SSE2)
+		enum { kShift = 0 };
+#else
+		// Portable masks use eight bits per slot, of which only the highest
+		// is set
+		enum { kShift = 3 };
+#endif
+
+		static uint countTrailingZeros(uint64 v) {
+#if GCC_ATLEAST(3, 4)
+			return __builtin_ctzll(v);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+			unsigned long result;
+			_BitScanForward64(&result, v);
+			return result;
+#else
+			uint result = 0;
+			while (!(v & 1)) {
+				v >>= 1;
+				result++;
+			}
+			return result;
+#endif
+		}
+
+		uint64 _mask;
+	};
+
+#if defined(FLATHASHMAP_USE_SSE2)
+	explicit FlatHashMapGroup(const int8 *ctrl) : _ctrl(_mm_loadu_si128((const __m128i *)ctrl)) {}
+
+	BitMask match(int8 h2) const {
+		return BitMask((uint32)_mm_movemask_epi8(_mm_cmpeq_epi8(_ctrl, _mm_set1_epi8(h2))));
+	}
+
+	BitMask matchEmpty() const {
+		return match(kEmpty);
+	}
+
+	BitMask matchEmptyOrDeleted() const {
+		// Only the control bytes of unused slots have their sign bit set
+		return BitMask((uint32)_mm_movemask_epi8(_ctrl));
+	}
+
+private:
+	__m128i _ctrl;
+#else
+	// Without SIMD instructions, the eight control bytes of a group are
+	// checked at once inside a 64-bit integer.
+	explicit FlatHashMapGroup(const int8 *ctrl) : _ctrl(READ_LE_UINT64(ctrl)) {}
+
+	BitMask match(int8 h2) const {
+		// This sets the high bit of all bytes which are zero after the XOR.
+		// It can also set it for a byte next to a match, whose value then is
+		// h2 ^ 1. Such a false positive is a slot in use as well, thus the
+		// key comparison sorts it out.
+		const uint64 x = _ctrl ^ (kLowBits * (uint8)h2);
+		return BitMask((x - kLowBits) & ~x & kHighBits);
+	}
+
+	BitMask matchEmpty() const {
+		// Empty and deleted slots have the high bit set, but only deleted
+		// slots also have the second lowest bit set.
+		return BitMask(_ctrl & ~(_ctrl << 6) & kHighBits);
+	}
+
+	BitMask matchEmptyOrDeleted() const {
+		return BitMask(_ctrl & kHighBits);
+	}
+
+private:
+	static const uint64 kLowBits = 0x0101010101010101ULL;
+	static const uint64 kHighBits = 0x8080808080808080ULL;
+
+	uint64 _ctrl;
+#endif
+};
+
+/**
+ * FlatHashMap<Key,Val> maps objects of type Key to objects of type Val, just
+ * like HashMap, and offers the same interface. Thus, call sites can switch
+ * between both by changing a typedef.
+ *
+ * Unlike HashMap, the keys and values are stored inline in a single array of
+ * slots, and a separate array holds one control byte per slot with 7 bits of
+ * the hash of its key. A lookup compares the control bytes of 16 slots at
+ * once and only touches slots whose control byte matches. This avoids
+ * allocating nodes and chasing pointers, which makes lookups considerably
+ * faster for small keys and values.
+ *
+ * On the other hand, growing the map copies all keys and values, and unused
+ * slots take the full size of a key and value. Inserting into the map
+ * invalidates all iterators and references to values, like HashMap does.
+ */
+template<class Key, class Val, class HashFunc = Hash<Key>, class EqualFunc = EqualTo<Key> >
+class FlatHashMap {
+public:
+	typedef uint size_type;
+
+private:
+
+	typedef FlatHashMap<Key, Val, HashFunc, EqualFunc> FHM_t;
+	typedef FlatHashMapGroup Group;
+
+	struct Node {
+		Val _value;
+		const Key _key;
+		explicit Node(const Key &key) : _value(), _key(key) {}
+	};
+
+	enum {
+		FLATHASHMAP_MIN_CAPACITY = 16,
+
+		// The quotient of the next two constants controls how much the
+		// internal storage of the hashmap may fill up, including deleted
+		// slots, before it is cleaned up or increased automatically.
+		FLATHASHMAP_LOADFACTOR_NUMERATOR = 7,
+		FLATHASHMAP_LOADFACTOR_DENOMINATOR = 8
+	};
+
+	/** Default value, returned by the const getVal. */
+	Val _defaultVal;
+
+	/**
+	 * One control byte per slot. It is followed by copies of the first
+	 * group's control bytes, so that groups can wrap around the end.
+	 */
+	int8 *_ctrl;
+	Node *_slots;       ///< Storage for the nodes, only initialized for slots in use.
+	size_type _mask;    ///< Capacity of the FlatHashMap minus one; the capacity must be a power of two
+	size_type _size;
+	size_type _deleted; ///< Number of slots marked as deleted
+
+	HashFunc _hash;
+	EqualFunc _equal;
+
+	static const size_type NONE_FOUND = (size_type)-1;
+
+	size_type hashOf(const Key &key) const {
+		// Many hash functions, e.g. for integers, leave the high bits unused.
+		// Spread them over the whole value, since the control bytes use the
+		// high bits while the slot index uses the low bits.
+		return (size_type)(_hash(key) * 0x9E3779B1U);
+	}
+
+	static int8 controlByte(size_type hash) {
+		return (int8)((hash >> 25) & 0x7F);
+	}
+
+	bool isFull(size_type idx) const {
+		return _ctrl[idx] >= 0;
+	}
+
+	void setCtrl(size_type idx, int8 ctrl) {
+		_ctrl[idx] = ctrl;
+		if (idx < Group::kWidth)
+			_ctrl[_mask + 1 + idx] = ctrl;
+	}
+
+	void allocStorage(size_type capacity);
+	void freeStorage();
+	void assign(const FHM_t &map);
+	size_type lookup(const Key &key, size_type hash) const;
+	size_type lookup(const Key &key) const { return lookup(key, hashOf(key)); }
+	size_type findFreeSlot(size_type hash) const;
+	size_type lookupAndCreateIfMissing(const Key &key);
+	void eraseSlot(size_type idx);
+	void rehash(size_type newCapacity);
+
+	/**
+	 * Simple FlatHashMap iterator implementation.
+	 */
+	template<class NodeType>
+	class IteratorImpl {
+		friend class FlatHashMap;
+		template<class T> friend class IteratorImpl;
+	protected:
+		typedef const FlatHashMap hashmap_t;
+
+		size_type _idx;
+		hashmap_t *_hashmap;
+
+	protected:
+		IteratorImpl(size_type idx, hashmap_t *hashmap) : _idx(idx), _hashmap(hashmap) {}
+
+		NodeType *deref() const {
+			assert(_hashmap != nullptr);
+			assert(_idx <= _hashmap->_mask);
+			assert(_hashmap->isFull(_idx));
+			return &_hashmap->_slots[_idx];
+		}
+
+	public:
+		IteratorImpl() : _idx(0), _hashmap(nullptr) {}
+		template<class T>
+		IteratorImpl(const IteratorImpl<T> &c) : _idx(c._idx), _hashmap(c._hashmap) {}
+
+		NodeType &operator*() const { return *deref(); }
+		NodeType *operator->() const { return deref(); }
+
+		bool operator==(const IteratorImpl &iter) const { return _idx == iter._idx && _hashmap == iter._hashmap; }
+		bool operator!=(const IteratorImpl &iter) const { return !(*this == iter); }
+
+		IteratorImpl &operator++() {
+			assert(_hashmap);
+			_idx = _hashmap->nextFull(_idx + 1);
+			return *this;
+		}
+
+		IteratorImpl operator++(int) {
+			IteratorImpl old = *this;
+			operator ++();
+			return old;
+		}
+	};
+
+	/**
+	 * Find the first slot in use starting with the given index.
+	 */
+	size_type nextFull(size_type idx) const {
+		for (; idx <= _mask; ++idx) {
+			if (isFull(idx))
+				return idx;
+		}
+		return NONE_FOUND;
+	}
+
+public:
+	typedef IteratorImpl<Node> iterator;
+	typedef IteratorImpl<const Node> const_iterator;
+
+	FlatHashMap();
+	FlatHashMap(const FHM_t &map);
+	~FlatHashMap();
+
+	FHM_t &operator=(const FHM_t &map) {
+		if (this == &map)
+			return *this;
+
+		// Remove the previous content and ...
+		clear();
+		freeStorage();
+		// ... copy the new stuff.
+		assign(map);
+		return *this;
+	}
+
+	bool contains(const Key &key) const;
+
+	Val &operator[](const Key &key);
+	const Val &operator[](const Key &key) const;
+
+	Val &getVal(const Key &key);
+	const Val &getVal(const Key &key) const;
+	const Val &getVal(const Key &key, const Val &defaultVal) const;
+	bool tryGetVal(const Key &key, Val &out) const;
+	void setVal(const Key &key, const Val &val);
+
+	void clear(bool shrinkArray = 0);
+
+	void erase(iterator entry);
+	void erase(const Key &key);
+
+	size_type size() const { return _size; }
+
+	iterator	begin() {
+		return iterator(nextFull(0), this);
+	}
+	iterator	end() {
+		return iterator(NONE_FOUND, this);
+	}
+
+	const_iterator	begin() const {
+		return const_iterator(nextFull(0), this);
+	}
+	const_iterator	end() const {
+		return const_iterator(NONE_FOUND, this);
+	}
+
+	iterator	find(const Key &key) {
+		return iterator(lookup(key), this);
+	}
+
+	const_iterator	find(const Key &key) const {
+		return const_iterator(lookup(key), this);
+	}
+
+	/** Return true if hashmap is empty. */
+	bool empty() const {
+		return (_size == 0);
+	}
+};
+
+//-------------------------------------------------------
+// FlatHashMap functions
+
+/**
+ * Base constructor, creates an empty hashmap.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::FlatHashMap() : _defaultVal() {
+	allocStorage(FLATHASHMAP_MIN_CAPACITY);
+}
+
+/**
+ * Copy constructor, creates a full copy of the given hashmap.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::FlatHashMap(const FHM_t &map) :
+	_defaultVal() {
+	assign(map);
+}
+
+/**
+ * Destructor, frees all used memory.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::~FlatHashMap() {
+	clear();
+	freeStorage();
+}
+
+/**
+ * Internal method for allocating empty storage of the given capacity.
+ *
+ * @note The previous storage is *not* deallocated here -- the caller is
+ *       responsible for doing that!
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::allocStorage(size_type capacity) {
+	assert(capacity >= FLATHASHMAP_MIN_CAPACITY && (capacity & (capacity - 1)) == 0);
+
+	_ctrl = (int8 *)malloc(capacity + Group::kWidth);
+	_slots = (Node *)malloc(capacity * sizeof(Node));
+	if (!_ctrl || !_slots)
+		::error("Common::FlatHashMap: failure to allocate %u slots", capacity);
+
+	memset(_ctrl, Group::kEmpty, capacity + Group::kWidth);
+	_mask = capacity - 1;
+	_size = 0;
+	_deleted = 0;
+}
+
+/**
+ * Internal method for freeing the storage. The nodes have to be destroyed
+ * already.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::freeStorage() {
+	free(_ctrl);
+	free(_slots);
+	_ctrl = nullptr;
+	_slots = nullptr;
+}
+
+/**
+ * Internal method for assigning the content of another FlatHashMap
+ * to this one.
+ *
+ * @note The previous storage here is *not* deallocated here -- the caller is
+ *       responsible for doing that!
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::assign(const FHM_t &map) {
+	allocStorage(map._mask + 1);
+
+	// Both maps use the same hash function, thus we can keep all nodes in
+	// their slots.
+	memcpy(_ctrl, map._ctrl, _mask + 1 + Group::kWidth);
+	for (size_type ctr = 0; ctr <= _mask; ++ctr) {
+		if (map.isFull(ctr)) {
+			new ((void *)&_slots[ctr]) Node(map._slots[ctr]);
+			_size++;
+		} else if (map._ctrl[ctr] == Group::kDeleted) {
+			_deleted++;
+		}
+	}
+	// Perform a sanity check (to help track down hashmap corruption)
+	assert(_size == map._size);
+	assert(_deleted == map._deleted);
+}
+
+/**
+ * Clear all values in the hashmap.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::clear(bool shrinkArray) {
+	for (size_type ctr = 0; ctr <= _mask; ++ctr) {
+		if (isFull(ctr))
+			_slots[ctr].~Node();
+	}
+
+	if (shrinkArray && _mask >= FLATHASHMAP_MIN_CAPACITY) {
+		freeStorage();
+		allocStorage(FLATHASHMAP_MIN_CAPACITY);
+	} else {
+		memset(_ctrl, Group::kEmpty, _mask + 1 + Group::kWidth);
+		_size = 0;
+		_deleted = 0;
+	}
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::rehash(size_type newCapacity) {
+	assert(newCapacity > _size);
+
+#ifndef NDEBUG
+	const size_type old_size = _size;
+#endif
+	const size_type old_mask = _mask;
+	int8 *old_ctrl = _ctrl;
+	Node *old_slots = _slots;
+
+	allocStorage(newCapacity);
+
+	// Move all the old elements over. Since we know that no key exists twice
+	// in the old table, we do not need to look them up first.
+	for (size_type ctr = 0; ctr <= old_mask; ++ctr) {
+		if (old_ctrl[ctr] < 0)
+			continue;
+
+		const size_type hash = hashOf(old_slots[ctr]._key);
+		const size_type idx = findFreeSlot(hash);
+		setCtrl(idx, controlByte(hash));
+		new ((void *)&_slots[idx]) Node(old_slots[ctr]);
+		old_slots[ctr].~Node();
+		_size++;
+	}
+
+	// Perform a sanity check: Old number of elements should match the new one!
+	// This check will fail if some previous operation corrupted this hashmap.
+	assert(_size == old_size);
+
+	free(old_ctrl);
+	free(old_slots);
+}
+
+/**
+ * Internal method for finding the slot of a key.
+ *
+ * The slots are probed in groups, starting at the slot given by the hash. The
+ * distance to the next group grows by one group per step, which visits all
+ * groups of the table since its capacity is a power of two. A group which
+ * contains an empty slot ends the search, since an insertion would have used
+ * that slot.
+ *
+ * @return The index of the slot, or NONE_FOUND if the key is not in the map.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+typename FlatHashMap<Key, Val, HashFunc, EqualFunc>::size_type FlatHashMap<Key, Val, HashFunc, EqualFunc>::lookup(const Key &key, size_type hash) const {
+	const int8 h2 = controlByte(hash);
+	size_type pos = hash & _mask;
+	for (size_type step = Group::kWidth; ; step += Group::kWidth) {
+		const Group group(_ctrl + pos);
+
+		for (Group::BitMask match = group.match(h2); match.any(); match.clearLowest()) {
+			const size_type ctr = (pos + match.lowest()) & _mask;
+			if (_equal(_slots[ctr]._key, key))
+				return ctr;
+		}
+
+		if (group.matchEmpty().any())
+			return NONE_FOUND;
+
+		pos = (pos + step) & _mask;
+	}
+}
+
+/**
+ * Internal method for finding the slot to insert a new key with the given
+ * hash into. This is the first empty or deleted slot of its probe sequence.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+typename FlatHashMap<Key, Val, HashFunc, EqualFunc>::size_type FlatHashMap<Key, Val, HashFunc, EqualFunc>::findFreeSlot(size_type hash) const {
+	size_type pos = hash & _mask;
+	for (size_type step = Group::kWidth; ; step += Group::kWidth) {
+		const Group::BitMask free = Group(_ctrl + pos).matchEmptyOrDeleted();
+		if (free.any())
+			return (pos + free.lowest()) & _mask;
+
+		pos = (pos + step) & _mask;
+	}
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+typename FlatHashMap<Key, Val, HashFunc, EqualFunc>::size_type FlatHashMap<Key, Val, HashFunc, EqualFunc>::lookupAndCreateIfMissing(const Key &key) {
+	size_type hash = hashOf(key);
+	size_type ctr = lookup(key, hash);
+	if (ctr != NONE_FOUND)
+		return ctr;
+
+	// Keep the load factor below a certain threshold. Deleted slots are also
+	// counted, since they lengthen the probe sequences just like used ones.
+	size_type capacity = _mask + 1;
+	if ((_size + _deleted + 1) * FLATHASHMAP_LOADFACTOR_DENOMINATOR >
+	        capacity * FLATHASHMAP_LOADFACTOR_NUMERATOR) {
+		// Only drop the deleted slots in case that frees a good amount of
+		// space. Otherwise, grow the storage.
+		if ((_size + 1) * FLATHASHMAP_LOADFACTOR_DENOMINATOR * 2 >
+		        capacity * FLATHASHMAP_LOADFACTOR_NUMERATOR)
+			capacity *= 2;
+		rehash(capacity);
+	}
+
+	ctr = findFreeSlot(hash);
+	if (_ctrl[ctr] == Group::kDeleted)
+		_deleted--;
+	setCtrl(ctr, controlByte(hash));
+	new ((void *)&_slots[ctr]) Node(key);
+	_size++;
+
+	return ctr;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::eraseSlot(size_type idx) {
+	assert(idx <= _mask);
+	assert(isFull(idx));
+
+	// The slot may be part of the probe sequence of other keys, thus we mark
+	// it as deleted instead of empty.
+	_slots[idx].~Node();
+	setCtrl(idx, Group::kDeleted);
+	_size--;
+	_deleted++;
+}
+
+/**
+ * Check whether the hashmap contains the given key.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+bool FlatHashMap<Key, Val, HashFunc, EqualFunc>::contains(const Key &key) const {
+	return lookup(key) != NONE_FOUND;
+}
+
+/**
+ * Get a value from the hashmap.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::operator[](const Key &key) {
+	return getVal(key);
+}
+
+/**
+ * @overload
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::operator[](const Key &key) const {
+	return getVal(key);
+}
+
+/**
+ * Get a value from the hashmap.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key) {
+	size_type ctr = lookupAndCreateIfMissing(key);
+	return _slots[ctr]._value;
+}
+
+/**
+ * @overload
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key) const {
+	return getVal(key, _defaultVal);
+}
+
+/**
+ * Get a value from the hashmap. If the key is not present, then return @p defaultVal.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key, const Val &defaultVal) const {
+	size_type ctr = lookup(key);
+	if (ctr != NONE_FOUND)
+		return _slots[ctr]._value;
+	else
+		return defaultVal;
+}
+
+/**
+ * Get a value from the hashmap. If the key is not present, return false and
+ * leave @p out untouched.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+bool FlatHashMap<Key, Val, HashFunc, EqualFunc>::tryGetVal(const Key &key, Val &out) const {
+	size_type ctr = lookup(key);
+	if (ctr != NONE_FOUND) {
+		out = _slots[ctr]._value;
+		return true;
+	} else {
+		return false;
+	}
+}
+
+/**
+ * Assign an element specified by @p key to a value @p val.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::setVal(const Key &key, const Val &val) {
+	size_type ctr = lookupAndCreateIfMissing(key);
+	_slots[ctr]._value = val;
+}
+
+/**
+ * Erase an element referred to by an iterator.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::erase(iterator entry) {
+	// Check whether we have a valid iterator
+	assert(entry._hashmap == this);
+	eraseSlot(entry._idx);
+}
+
+/**
+ * Erase an element specified by a key.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::erase(const Key &key) {
+	size_type ctr = lookup(key);
+	if (ctr != NONE_FOUND)
+		eraseSlot(ctr);
+}
+
+/** @} */
+
+} // End of namespace Common
+
+#endif
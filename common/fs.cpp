@@ -125,6 +125,10 @@ bool FSNode::isWritable() const {
 	return _realNode && _realNode->isWritable();
 }
 
+bool FSNode::getFileStats(uint32 &size, uint32 &modificationTime) const {
+	return _realNode && _realNode->getFileStats(size, modificationTime);
+}
+
 SeekableReadStream *FSNode::createReadStream() const {
 	if (_realNode == nullptr)
 		return nullptr;
@@ -222,6 +222,20 @@ public:
 	 */
 	bool isWritable() const;
 
+	/**
+	 * Query the size and the time of the last modification of the file
+	 * referred by this node, without opening it. This can be used to find
+	 * out whether a file has changed.
+	 *
+	 * @param size             The size of the file in bytes.
+	 * @param modificationTime The modification time, in seconds since some
+	 *                         backend specific epoch.
+	 *
+	 * @return True if successful, false if the file does not exist or the
+	 *         backend does not support this.
+	 */
+	bool getFileStats(uint32 &size, uint32 &modificationTime) const;
+
 	/**
 	 * Create a SeekableReadStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
@@ -0,0 +1,263 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "common/hasher.h"
+#include "common/endian.h"
+#include "common/fs.h"
+#include "common/memstream.h"
+#include "common/str.h"
+#include "common/threadpool.h"
+
+namespace Common {
+
+namespace {
+
+const uint64 kXXH64Prime1 = 0x9E3779B185EBCA87ULL;
+const uint64 kXXH64Prime2 = 0xC2B2AE3D27D4EB4FULL;
+const uint64 kXXH64Prime3 = 0x165667B19E3779F9ULL;
+const uint64 kXXH64Prime4 = 0x85EBCA77C2B2AE63ULL;
+const uint64 kXXH64Prime5 = 0x27D4EB2F165667C5ULL;
+
+inline uint64 rotateLeft(uint64 x, int n) {
+	return (x << n) | (x >> (64 - n));
+}
+
+inline uint64 xxh64Round(uint64 acc, uint64 input) {
+	acc += input * kXXH64Prime2;
+	acc = rotateLeft(acc, 31);
+	return acc * kXXH64Prime1;
+}
+
+inline uint64 xxh64MergeRound(uint64 acc, uint64 val) {
+	acc ^= xxh64Round(0, val);
+	return acc * kXXH64Prime1 + kXXH64Prime4;
+}
+
+struct HashFilesJobs {
+	const Array<FSNode> *files;
+	Array<String> *digests;
+	Hasher::Algorithm algorithm;
+	uint32 length;
+};
+
+void hashFileJob(void *arg, uint index) {
+	HashFilesJobs *jobs = (HashFilesJobs *)arg;
+
+	const FSNode &node = (*jobs->files)[index];
+	if (!node.exists())
+		return;
+
+	SeekableReadStream *stream = node.createReadStream();
+	if (!stream)
+		return;
+
+	Hasher hasher(jobs->algorithm);
+	if (hasher.update(*stream, jobs->length))
+		(*jobs->digests)[index] = hasher.finishAsString();
+	delete stream;
+}
+
+} // End of anonymous namespace
+
+Hasher::Hasher(Algorithm algorithm, uint64 seed) : _algorithm(algorithm), _seed(seed) {
+	reset();
+}
+
+void Hasher::reset() {
+	if (_algorithm == kMD5) {
+		md5Start(_md5);
+		return;
+	}
+
+	_acc[0] = _seed + kXXH64Prime1 + kXXH64Prime2;
+	_acc[1] = _seed + kXXH64Prime2;
+	_acc[2] = _seed;
+	_acc[3] = _seed - kXXH64Prime1;
+	_totalSize = 0;
+	_bufferSize = 0;
+}
+
+void Hasher::update(const void *data, uint32 size) {
+	if (_algorithm == kMD5)
+		md5Update(_md5, (const uint8 *)data, size);
+	else
+		xxh64Update((const uint8 *)data, size);
+}
+
+bool Hasher::update(ReadStream &stream, uint32 length) {
+	// Memory streams are hashed in place, there is nothing to gain from
+	// copying their data around
+	MemoryReadStream *memStream = dynamic_cast<MemoryReadStream *>(&stream);
+	if (memStream) {
+		uint32 size = memStream->size() - memStream->pos();
+		if (length != 0 && length < size)
+			size = length;
+		update(memStream->getData() + memStream->pos(), size);
+		memStream->seek(size, SEEK_CUR);
+		return true;
+	}
+
+	byte *buf = (byte *)malloc(kBlockSize);
+	if (!buf)
+		return false;
+
+	const bool restricted = (length != 0);
+	while (!restricted || length > 0) {
+		const uint32 readSize = (restricted && length < kBlockSize) ? length : (uint32)kBlockSize;
+		const uint32 actualSize = stream.read(buf, readSize);
+		if (actualSize == 0)
+			break;
+
+		update(buf, actualSize);
+		if (restricted)
+			length -= actualSize;
+	}
+
+	free(buf);
+	return !stream.err();
+}
+
+void Hasher::finish(uint8 *digest) {
+	if (_algorithm == kMD5)
+		md5Finish(_md5, digest);
+	else
+		WRITE_BE_UINT64(digest, xxh64Finish());
+}
+
+String Hasher::finishAsString() {
+	uint8 digest[kMaxDigestSize];
+	finish(digest);
+
+	String result;
+	for (uint i = 0; i < getDigestSize(); i++)
+		result += String::format("%02x", (int)digest[i]);
+	return result;
+}
+
+uint64 Hasher::xxHash64(const void *data, uint32 size, uint64 seed) {
+	Hasher hasher(kXXH64, seed);
+	hasher.xxh64Update((const uint8 *)data, size);
+	return hasher.xxh64Finish();
+}
+
+void Hasher::hashFiles(const Array<FSNode> &files, Algorithm algorithm, Array<String> &digests, ThreadPool &pool, uint32 length) {
+	digests.clear();
+	digests.resize(files.size());
+
+	HashFilesJobs jobs;
+	jobs.files = &files;
+	jobs.digests = &digests;
+	jobs.algorithm = algorithm;
+	jobs.length = length;
+	pool.run(hashFileJob, &jobs, files.size());
+}
+
+void Hasher::xxh64Update(const uint8 *data, uint32 size) {
+	_totalSize += size;
+
+	if (_bufferSize + size < 32) {
+		memcpy(_buffer + _bufferSize, data, size);
+		_bufferSize += size;
+		return;
+	}
+
+	uint64 acc0 = _acc[0];
+	uint64 acc1 = _acc[1];
+	uint64 acc2 = _acc[2];
+	uint64 acc3 = _acc[3];
+
+	if (_bufferSize) {
+		const uint32 fill = 32 - _bufferSize;
+		memcpy(_buffer + _bufferSize, data, fill);
+		data += fill;
+		size -= fill;
+		_bufferSize = 0;
+
+		acc0 = xxh64Round(acc0, READ_LE_UINT64(_buffer));
+		acc1 = xxh64Round(acc1, READ_LE_UINT64(_buffer + 8));
+		acc2 = xxh64Round(acc2, READ_LE_UINT64(_buffer + 16));
+		acc3 = xxh64Round(acc3, READ_LE_UINT64(_buffer + 24));
+	}
+
+	// The four lanes are independent, so the CPU can work on them in
+	// parallel
+	while (size >= 32) {
+		acc0 = xxh64Round(acc0, READ_LE_UINT64(data));
+		acc1 = xxh64Round(acc1, READ_LE_UINT64(data + 8));
+		acc2 = xxh64Round(acc2, READ_LE_UINT64(data + 16));
+		acc3 = xxh64Round(acc3, READ_LE_UINT64(data + 24));
+		data += 32;
+		size -= 32;
+	}
+
+	_acc[0] = acc0;
+	_acc[1] = acc1;
+	_acc[2] = acc2;
+	_acc[3] = acc3;
+
+	memcpy(_buffer, data, size);
+	_bufferSize = size;
+}
+
+uint64 Hasher::xxh64Finish() {
+	uint64 h;
+	if (_totalSize >= 32) {
+		h = rotateLeft(_acc[0], 1) + rotateLeft(_acc[1], 7) + rotateLeft(_acc[2], 12) + rotateLeft(_acc[3], 18);
+		for (int i = 0; i < 4; i++)
+			h = xxh64MergeRound(h, _acc[i]);
+	} else {
+		h = _seed + kXXH64Prime5;
+	}
+
+	h += _totalSize;
+
+	const uint8 *p = _buffer;
+	uint32 left = _bufferSize;
+	while (left >= 8) {
+		h ^= xxh64Round(0, READ_LE_UINT64(p));
+		h = rotateLeft(h, 27) * kXXH64Prime1 + kXXH64Prime4;
+		p += 8;
+		left -= 8;
+	}
+	if (left >= 4) {
+		h ^= (uint64)READ_LE_UINT32(p) * kXXH64Prime1;
+		h = rotateLeft(h, 23) * kXXH64Prime2 + kXXH64Prime3;
+		p += 4;
+		left -= 4;
+	}
+	while (left > 0) {
+		h ^= (*p) * kXXH64Prime5;
+		h = rotateLeft(h, 11) * kXXH64Prime1;
+		p++;
+		left--;
+	}
+
+	h ^= h >> 33;
+	h *= kXXH64Prime2;
+	h ^= h >> 29;
+	h *= kXXH64Prime3;
+	h ^= h >> 32;
+	return h;
+}
+
+} // End of namespace Common
@@ -0,0 +1,146 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#ifndef COMMON_HASHER_H
+#define COMMON_HASHER_H
+
+#include "common/scummsys.h"
+#include "common/array.h"
+#include "common/md5.h"
+
+namespace Common {
+
+/**
+ * @defgroup common_hasher Hasher
+ * @ingroup common
+ *
+ * @brief API for hashing data, streams and files in large blocks.
+ *
+ * @{
+ */
+
+class FSNode;
+class ReadStream;
+class String;
+class ThreadPool;
+
+/**
+ * Computes a checksum of data which is passed in one or more pieces.
+ *
+ * Two algorithms are supported: MD5, which is what the detection tables
+ * of the engines use, and the much faster non-cryptographic XXH64, which
+ * is meant for cache keys and other fingerprints which never leave the
+ * running ScummVM instance or its caches.
+ */
+class Hasher {
+public:
+	enum Algorithm {
+		kMD5,	///< MD5, with a 16 byte digest
+		kXXH64	///< xxHash64, with an 8 byte digest in big endian order
+	};
+
+	enum {
+		/** The size of the blocks read when hashing a stream. */
+		kBlockSize = 64 * 1024,
+		/** The size of the largest digest of any algorithm. */
+		kMaxDigestSize = 16
+	};
+
+	/**
+	 * Create a hasher.
+	 *
+	 * @param algorithm The algorithm to use.
+	 * @param seed      The seed of the XXH64 computation. Ignored by MD5.
+	 */
+	explicit Hasher(Algorithm algorithm = kMD5, uint64 seed = 0);
+
+	Algorithm getAlgorithm() const { return _algorithm; }
+
+	/** Return the size of the digests of the algorithm in bytes. */
+	uint getDigestSize() const { return _algorithm == kMD5 ? 16 : 8; }
+
+	/** Start a new computation, dropping all data passed so far. */
+	void reset();
+
+	/** Add the given data to the computation. */
+	void update(const void *data, uint32 size);
+
+	/**
+	 * Add the content of the given stream to the computation.
+	 *
+	 * The stream is read in blocks of kBlockSize bytes. The data of memory
+	 * streams, including memory mapped files, is hashed without copying.
+	 *
+	 * @param stream The stream to read from its current position.
+	 * @param length The number of bytes to read; 0 means all.
+	 * @return false if a read error occurred
+	 */
+	bool update(ReadStream &stream, uint32 length = 0);
+
+	/**
+	 * Finish the computation, and store the result in digest, which must
+	 * have room for getDigestSize() bytes. Afterwards, the hasher has to be
+	 * reset before it can be used again.
+	 */
+	void finish(uint8 *digest);
+
+	/** Finish the computation, and return the digest as a lowercase hex string. */
+	String finishAsString();
+
+	/** Compute the XXH64 of the given data in one go. */
+	static uint64 xxHash64(const void *data, uint32 size, uint64 seed = 0);
+
+	/**
+	 * Compute the digests of several files at once, each file on one of
+	 * the threads of the pool.
+	 *
+	 * @param files     The files to hash.
+	 * @param algorithm The algorithm to use.
+	 * @param digests   Receives the digests as hex strings, in the order
+	 *                  of the files. The digests of files which could not
+	 *                  be read are empty.
+	 * @param pool      The threads to use.
+	 * @param length    The number of bytes to hash of each file; 0 means all.
+	 */
+	static void hashFiles(const Array<FSNode> &files, Algorithm algorithm, Array<String> &digests, ThreadPool &pool, uint32 length = 0);
+
+private:
+	void xxh64Update(const uint8 *data, uint32 size);
+	uint64 xxh64Finish();
+
+	Algorithm _algorithm;
+	uint64 _seed;
+
+	MD5Context _md5;
+
+	uint64 _acc[4];
+	uint64 _totalSize;
+	uint8 _buffer[32];
+	uint32 _bufferSize;
+};
+
+/** @} */
+
+} // End of namespace Common
+
+#endif
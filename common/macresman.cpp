@@ -27,6 +27,7 @@
 #include "common/fs.h"
 #include "common/macresman.h"
 #include "common/md5.h"
+#include "common/memstream.h"
 #include "common/substream.h"
 #include "common/textconsole.h"
 #include "common/archive.h"
@@ -61,6 +62,8 @@ MacResManager::MacResManager() {
 	_resMap.reset();
 	_resTypes = nullptr;
 	_resLists = nullptr;
+	_map = nullptr;
+	_nameIndexBuilt = false;
 }
 
 MacResManager::~MacResManager() {
@@ -73,16 +76,20 @@ void MacResManager::close() {
 
 	for (int i = 0; i < _resMap.numTypes; i++) {
 		for (int j = 0; j < _resTypes[i].items; j++)
-			if (_resLists[i][j].nameOffset != -1)
-				delete[] _resLists[i][j].name;
+			delete[] _resLists[i][j].name;
 
 		delete[] _resLists[i];
 	}
 
 	delete[] _resLists; _resLists = nullptr;
 	delete[] _resTypes; _resTypes = nullptr;
+	delete[] _map; _map = nullptr;
 	delete _stream; _stream = nullptr;
 	_resMap.numTypes = 0;
+
+	_resIndex.clear();
+	_nameIndex.clear();
+	_nameIndexBuilt = false;
 }
 
 bool MacResManager::hasDataFork() const {
@@ -427,15 +434,9 @@ SeekableReadStream *MacResManager::getDataFork() {
 }
 
 MacResIDArray MacResManager::getResIDArray(uint32 typeID) {
-	int typeNum = -1;
+	const int typeNum = findType(typeID);
 	MacResIDArray res;
 
-	for (int i = 0; i < _resMap.numTypes; i++)
-		if (_resTypes[i].id == typeID) {
-			typeNum = i;
-			break;
-		}
-
 	if (typeNum == -1)
 		return res;
 
@@ -462,113 +463,125 @@ MacResTagArray MacResManager::getResTagArray() {
 }
 
 String MacResManager::getResName(uint32 typeID, uint16 resID) const {
-	int typeNum = -1;
-
-	for (int i = 0; i < _resMap.numTypes; i++)
-		if (_resTypes[i].id == typeID) {
-			typeNum = i;
-			break;
-		}
-
-	if (typeNum == -1)
+	ResPtr res = _resIndex.getVal(makeResKey(typeID, resID), nullptr);
+	if (!res)
 		return "";
 
-	for (int i = 0; i < _resTypes[typeNum].items; i++)
-		if (_resLists[typeNum][i].id == resID)
-			return _resLists[typeNum][i].name;
-
-	return "";
+	const char *name = getName(*res);
+	return name ? name : "";
 }
 
 SeekableReadStream *MacResManager::getResource(uint32 typeID, uint16 resID) {
-	int typeNum = -1;
-	int resNum = -1;
-
-	for (int i = 0; i < _resMap.numTypes; i++)
-		if (_resTypes[i].id == typeID) {
-			typeNum = i;
-			break;
-		}
-
-	if (typeNum == -1)
+	ResPtr res = _resIndex.getVal(makeResKey(typeID, resID), nullptr);
+	if (!res)
 		return nullptr;
 
-	for (int i = 0; i < _resTypes[typeNum].items; i++)
-		if (_resLists[typeNum][i].id == resID) {
-			resNum = i;
-			break;
-		}
-
-	if (resNum == -1)
-		return nullptr;
+	return readResource(*res);
+}
 
-	_stream->seek(_dataOffset + _resLists[typeNum][resNum].dataOffset);
-	uint32 len = _stream->readUint32BE();
+SeekableReadStream *MacResManager::getResource(const String &fileName) {
+	if (!_nameIndexBuilt)
+		buildNameIndex();
 
-	// Ignore resources with 0 length
-	if (!len)
+	ResPtr res = _nameIndex.getVal(fileName, nullptr);
+	if (!res)
 		return nullptr;
 
-	return _stream->readStream(len);
+	return readResource(*res);
 }
 
-SeekableReadStream *MacResManager::getResource(const String &fileName) {
-	for (uint32 i = 0; i < _resMap.numTypes; i++) {
-		for (uint32 j = 0; j < _resTypes[i].items; j++) {
-			if (_resLists[i][j].nameOffset != -1 && fileName.equalsIgnoreCase(_resLists[i][j].name)) {
-				_stream->seek(_dataOffset + _resLists[i][j].dataOffset);
-				uint32 len = _stream->readUint32BE();
-
-				// Ignore resources with 0 length
-				if (!len)
-					return nullptr;
+SeekableReadStream *MacResManager::getResource(uint32 typeID, const String &fileName) {
+	const int typeNum = findType(typeID);
+	if (typeNum == -1)
+		return nullptr;
 
-				return _stream->readStream(len);
-			}
-		}
+	for (uint32 j = 0; j < _resTypes[typeNum].items; j++) {
+		const char *name = getName(_resLists[typeNum][j]);
+		if (name && fileName.equalsIgnoreCase(name))
+			return readResource(_resLists[typeNum][j]);
 	}
 
 	return nullptr;
 }
 
-SeekableReadStream *MacResManager::getResource(uint32 typeID, const String &fileName) {
-	for (uint32 i = 0; i < _resMap.numTypes; i++) {
-		if (_resTypes[i].id != typeID)
-			continue;
+int MacResManager::findType(uint32 typeID) const {
+	// There are only a few types in a fork, so there is no need to index them
+	for (int i = 0; i < _resMap.numTypes; i++)
+		if (_resTypes[i].id == typeID)
+			return i;
 
-		for (uint32 j = 0; j < _resTypes[i].items; j++) {
-			if (_resLists[i][j].nameOffset != -1 && fileName.equalsIgnoreCase(_resLists[i][j].name)) {
-				_stream->seek(_dataOffset + _resLists[i][j].dataOffset);
-				uint32 len = _stream->readUint32BE();
+	return -1;
+}
 
-				// Ignore resources with 0 length
-				if (!len)
-					return nullptr;
+const char *MacResManager::getName(Resource &res) const {
+	if (res.name || res.nameOffset == -1)
+		return res.name;
+
+	// Names are Pascal strings. Broken maps may cut them off.
+	const uint32 offset = _resMap.nameOffset + (uint16)res.nameOffset;
+	byte len = 0;
+	uint32 available = 0;
+	if (offset < _mapLength) {
+		len = _map[offset];
+		available = MIN<uint32>(len, _mapLength - offset - 1);
+	}
 
-				return _stream->readStream(len);
-			}
+	res.name = new char[len + 1];
+	if (available)
+		memcpy(res.name, _map + offset + 1, available);
+	memset(res.name + available, 0, len + 1 - available);
+	return res.name;
+}
+
+void MacResManager::buildNameIndex() {
+	// Resources earlier in the map take precedence, like they did when
+	// searching the map from its start
+	for (int i = 0; i < _resMap.numTypes; i++) {
+		for (int j = 0; j < _resTypes[i].items; j++) {
+			const char *name = getName(_resLists[i][j]);
+			if (name && !_nameIndex.contains(name))
+				_nameIndex.setVal(name, &_resLists[i][j]);
 		}
 	}
 
-	return nullptr;
+	_nameIndexBuilt = true;
 }
 
-void MacResManager::readMap() {
-	_stream->seek(_mapOffset + 22);
+SeekableReadStream *MacResManager::readResource(const Resource &res) {
+	_stream->seek(_dataOffset + res.dataOffset);
+	uint32 len = _stream->readUint32BE();
+
+	// Ignore resources with 0 length
+	if (!len)
+		return nullptr;
 
-	_resMap.resAttr = _stream->readUint16BE();
-	_resMap.typeOffset = _stream->readUint16BE();
-	_resMap.nameOffset = _stream->readUint16BE();
-	_resMap.numTypes = _stream->readUint16BE();
+	return _stream->readStream(len);
+}
+
+void MacResManager::readMap() {
+	// Read the whole map at once, instead of seeking around in the stream
+	// for every entry
+	_map = new byte[_mapLength];
+	_stream->seek(_mapOffset);
+	const uint32 mapRead = _stream->read(_map, _mapLength);
+	memset(_map + mapRead, 0, _mapLength - mapRead);
+
+	MemoryReadStream map(_map, _mapLength);
+	map.seek(22);
+
+	_resMap.resAttr = map.readUint16BE();
+	_resMap.typeOffset = map.readUint16BE();
+	_resMap.nameOffset = map.readUint16BE();
+	_resMap.numTypes = map.readUint16BE();
 	_resMap.numTypes++;
 
-	_stream->seek(_mapOffset + _resMap.typeOffset + 2);
+	map.seek(_resMap.typeOffset + 2);
 	_resTypes = new ResType[_resMap.numTypes];
 
 	for (int i = 0; i < _resMap.numTypes; i++) {
-		_resTypes[i].id = _stream->readUint32BE();
-		_resTypes[i].items = _stream->readUint16BE();
-		_resTypes[i].offset = _stream->readUint16BE();
+		_resTypes[i].id = map.readUint32BE();
+		_resTypes[i].items = map.readUint16BE();
+		_resTypes[i].offset = map.readUint16BE();
 		_resTypes[i].items++;
 
 		debug(8, "resType: <%s> items: %d offset: %d (0x%x)", tag2str(_resTypes[i].id), _resTypes[i].items,  _resTypes[i].offset, _resTypes[i].offset);
@@ -578,30 +591,25 @@ void MacResManager::readMap() {
 
 	for (int i = 0; i < _resMap.numTypes; i++) {
 		_resLists[i] = new Resource[_resTypes[i].items];
-		_stream->seek(_resTypes[i].offset + _mapOffset + _resMap.typeOffset);
+		map.seek(_resTypes[i].offset + _resMap.typeOffset);
 
 		for (int j = 0; j < _resTypes[i].items; j++) {
 			ResPtr resPtr = _resLists[i] + j;
 
-			resPtr->id = _stream->readUint16BE();
-			resPtr->nameOffset = _stream->readUint16BE();
-			resPtr->dataOffset = _stream->readUint32BE();
-			_stream->readUint32BE();
+			resPtr->id = map.readUint16BE();
+			resPtr->nameOffset = map.readUint16BE();
+			resPtr->dataOffset = map.readUint32BE();
+			map.readUint32BE();
 			resPtr->name = nullptr;
 
 			resPtr->attr = resPtr->dataOffset >> 24;
 			resPtr->dataOffset &= 0xFFFFFF;
-		}
 
-		for (int j = 0; j < _resTypes[i].items; j++) {
-			if (_resLists[i][j].nameOffset != -1) {
-				_stream->seek(_resLists[i][j].nameOffset + _mapOffset + _resMap.nameOffset);
-
-				byte len = _stream->readByte();
-				_resLists[i][j].name = new char[len + 1];
-				_resLists[i][j].name[len] = 0;
-				_stream->read(_resLists[i][j].name, len);
-			}
+			// The first resource with a given type and ID wins, like it did
+			// when searching the map from its start
+			const uint64 key = makeResKey(_resTypes[i].id, resPtr->id);
+			if (!_resIndex.contains(key))
+				_resIndex.setVal(key, resPtr);
 		}
 	}
 }
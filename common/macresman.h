@@ -26,7 +26,10 @@
  */
 
 #include "common/array.h"
+#include "common/flathashmap.h"
 #include "common/fs.h"
+#include "common/hash-str.h"
+#include "common/hashmap.h"
 #include "common/str.h"
 #include "common/str-array.h"
 
@@ -56,6 +59,10 @@ typedef Array<uint32> MacResTagArray;
 /**
  * Class for handling Mac data and resource forks.
  * It can read from raw, MacBinary, and AppleDouble formats.
+ *
+ * The resource map is read in one go when a fork is opened, and indexed
+ * by type and ID. Resource names are only decoded when they are first
+ * needed.
  */
 class MacResManager {
 
@@ -275,11 +282,29 @@ private:
 		int16 nameOffset;
 		byte attr;
 		uint32 dataOffset;
-		char *name;
+		char *name; ///< Decoded on first use by getName()
 	};
 
 	typedef Resource *ResPtr;
 
+	/** Hash functor for the keys of the resource index. */
+	struct ResKeyHash {
+		uint operator()(uint64 key) const {
+			// Tags and IDs only differ in a few bits, so mix them up
+			return (uint)((key * 0x9E3779B97F4A7C15ULL) >> 32);
+		}
+	};
+
+	typedef FlatHashMap<uint64, ResPtr, ResKeyHash> ResIndex;
+	typedef HashMap<String, ResPtr, IgnoreCase_Hash, IgnoreCase_EqualTo> ResNameIndex;
+
+	static uint64 makeResKey(uint32 typeID, uint16 resID) { return ((uint64)typeID << 16) | resID; }
+
+	int findType(uint32 typeID) const;
+	const char *getName(Resource &res) const;
+	void buildNameIndex();
+	SeekableReadStream *readResource(const Resource &res);
+
 	int32 _resForkOffset;
 	uint32 _resForkSize;
 
@@ -290,6 +315,11 @@ private:
 	ResMap _resMap;
 	ResType *_resTypes;
 	ResPtr  *_resLists;
+
+	byte *_map;                ///< The whole resource map, for decoding names
+	ResIndex _resIndex;        ///< Resources by type and ID
+	ResNameIndex _nameIndex;   ///< Resources by name, built on the first lookup by name
+	bool _nameIndexBuilt;
 };
 
 /** @} */
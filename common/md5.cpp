@@ -28,36 +28,25 @@
 
 #include "common/md5.h"
 #include "common/endian.h"
+#include "common/hasher.h"
 #include "common/str.h"
-#include "common/stream.h"
 
 namespace Common {
 
-struct md5_context {
-	uint32 total[2];
-	uint32 state[4];
-	uint8 buffer[64];
-};
-
-static void md5_starts(md5_context *ctx);
-static void md5_update(md5_context *ctx, const uint8 *input, uint32 length);
-static void md5_finish(md5_context *ctx, uint8 digest[16]);
-
-
 #define GET_UINT32(n, b, i)	(n) = READ_LE_UINT32(b + i)
 #define PUT_UINT32(n, b, i)	WRITE_LE_UINT32(b + i, n)
 
-void md5_starts(md5_context *ctx) {
-	ctx->total[0] = 0;
-	ctx->total[1] = 0;
+void md5Start(MD5Context &ctx) {
+	ctx.total[0] = 0;
+	ctx.total[1] = 0;
 
-	ctx->state[0] = 0x67452301;
-	ctx->state[1] = 0xEFCDAB89;
-	ctx->state[2] = 0x98BADCFE;
-	ctx->state[3] = 0x10325476;
+	ctx.state[0] = 0x67452301;
+	ctx.state[1] = 0xEFCDAB89;
+	ctx.state[2] = 0x98BADCFE;
+	ctx.state[3] = 0x10325476;
 }
 
-static void md5_process(md5_context *ctx, const uint8 data[64]) {
+static void md5_process(MD5Context &ctx, const uint8 data[64]) {
 	uint32 X[16], A, B, C, D;
 
 	GET_UINT32(X[0],  data,  0);
@@ -84,10 +73,10 @@ static void md5_process(md5_context *ctx, const uint8 data[64]) {
 	a += F(b,c,d) + X[k] + t; a = S(a,s) + b; \
 }
 
-	A = ctx->state[0];
-	B = ctx->state[1];
-	C = ctx->state[2];
-	D = ctx->state[3];
+	A = ctx.state[0];
+	B = ctx.state[1];
+	C = ctx.state[2];
+	D = ctx.state[3];
 
 #define F(x, y, z) (z ^ (x & (y ^ z)))
 
@@ -173,30 +162,30 @@ static void md5_process(md5_context *ctx, const uint8 data[64]) {
 
 #undef F
 
-	ctx->state[0] += A;
-	ctx->state[1] += B;
-	ctx->state[2] += C;
-	ctx->state[3] += D;
+	ctx.state[0] += A;
+	ctx.state[1] += B;
+	ctx.state[2] += C;
+	ctx.state[3] += D;
 }
 
-void md5_update(md5_context *ctx, const uint8 *input, uint32 length) {
+void md5Update(MD5Context &ctx, const uint8 *input, uint32 length) {
 	uint32 left, fill;
 
 	if (!length)
 		return;
 
-	left = ctx->total[0] & 0x3F;
+	left = ctx.total[0] & 0x3F;
 	fill = 64 - left;
 
-	ctx->total[0] += length;
-	ctx->total[0] &= 0xFFFFFFFF;
+	ctx.total[0] += length;
+	ctx.total[0] &= 0xFFFFFFFF;
 
-	if (ctx->total[0] < length)
-		ctx->total[1]++;
+	if (ctx.total[0] < length)
+		ctx.total[1]++;
 
 	if (left && length >= fill) {
-		memcpy((void *)(ctx->buffer + left), (const void *)input, fill);
-		md5_process(ctx, ctx->buffer);
+		memcpy((void *)(ctx.buffer + left), (const void *)input, fill);
+		md5_process(ctx, ctx.buffer);
 		length -= fill;
 		input  += fill;
 		left = 0;
@@ -209,7 +198,7 @@ void md5_update(md5_context *ctx, const uint8 *input, uint32 length) {
 	}
 
 	if (length) {
-		memcpy((void *)(ctx->buffer + left), (const void *)input, length);
+		memcpy((void *)(ctx.buffer + left), (const void *)input, length);
 	}
 }
 
@@ -220,62 +209,37 @@ static const uint8 md5_padding[64] = {
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
 };
 
-void md5_finish(md5_context *ctx, uint8 digest[16]) {
+void md5Finish(MD5Context &ctx, uint8 digest[16]) {
 	uint32 last, padn;
 	uint32 high, low;
 	uint8 msglen[8];
 
-	high = (ctx->total[0] >> 29) | (ctx->total[1] << 3);
-	low  = (ctx->total[0] <<  3);
+	high = (ctx.total[0] >> 29) | (ctx.total[1] << 3);
+	low  = (ctx.total[0] <<  3);
 
 	PUT_UINT32(low,  msglen, 0);
 	PUT_UINT32(high, msglen, 4);
 
-	last = ctx->total[0] & 0x3F;
+	last = ctx.total[0] & 0x3F;
 	padn = (last < 56) ? (56 - last) : (120 - last);
 
-	md5_update(ctx, md5_padding, padn);
-	md5_update(ctx, msglen, 8);
+	md5Update(ctx, md5_padding, padn);
+	md5Update(ctx, msglen, 8);
 
-	PUT_UINT32(ctx->state[0], digest,  0);
-	PUT_UINT32(ctx->state[1], digest,  4);
-	PUT_UINT32(ctx->state[2], digest,  8);
-	PUT_UINT32(ctx->state[3], digest, 12);
+	PUT_UINT32(ctx.state[0], digest,  0);
+	PUT_UINT32(ctx.state[1], digest,  4);
+	PUT_UINT32(ctx.state[2], digest,  8);
+	PUT_UINT32(ctx.state[3], digest, 12);
 }
 
 
 bool computeStreamMD5(ReadStream &stream, uint8 digest[16], uint32 length) {
-
 #ifdef DISABLE_MD5
 	memset(digest, 0, 16);
 #else
-	md5_context ctx;
-	int i;
-	unsigned char buf[1000];
-	bool restricted = (length != 0);
-	uint32 readlen;
-
-	if (!restricted || sizeof(buf) <= length)
-		readlen = sizeof(buf);
-	else
-		readlen = length;
-
-	md5_starts(&ctx);
-
-	while ((i = stream.read(buf, readlen)) > 0) {
-		md5_update(&ctx, buf, i);
-
-		if (restricted) {
-			length -= i;
-			if (length == 0)
-				break;
-
-			if (sizeof(buf) > length)
-				readlen = length;
-		}
-	}
-
-	md5_finish(&ctx, digest);
+	Hasher hasher(Hasher::kMD5);
+	hasher.update(stream, length);
+	hasher.finish(digest);
 #endif
 	return true;
 }
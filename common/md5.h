@@ -39,6 +39,27 @@ namespace Common {
 class ReadStream;
 class String;
 
+/**
+ * The state of an incremental MD5 computation.
+ *
+ * Most code should use Common::Hasher instead of working with this
+ * directly.
+ */
+struct MD5Context {
+	uint32 total[2];
+	uint32 state[4];
+	uint8 buffer[64];
+};
+
+/** Start a new MD5 computation. */
+void md5Start(MD5Context &ctx);
+
+/** Add the given data to an MD5 computation. */
+void md5Update(MD5Context &ctx, const uint8 *input, uint32 length);
+
+/** Finish an MD5 computation, and store the checksum in digest. */
+void md5Finish(MD5Context &ctx, uint8 digest[16]);
+
 /**
  * Compute the MD5 checksum of the content of the given ReadStream.
  * The 128 bit MD5 checksum is returned directly in the array digest.
@@ -102,6 +102,12 @@ public:
 	 * Return the chunk size used by this memory pool.
 	 */
 	size_t	getChunkSize() const { return _chunkSize; }
+
+	/**
+	 * Return the number of bytes in the pages allocated by this memory
+	 * pool, not counting any internal storage.
+	 */
+	size_t	getReservedSize() const;
 };
 
 /**
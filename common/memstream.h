@@ -23,6 +23,7 @@
 #ifndef COMMON_MEMSTREAM_H
 #define COMMON_MEMSTREAM_H
 
+#include "common/ptr.h"
 #include "common/stream.h"
 #include "common/types.h"
 #include "common/util.h"
@@ -50,6 +51,9 @@ private:
 	DisposeAfterUse::Flag _disposeMemory;
 	bool _eos;
 
+	/** Owns the memory instead of the stream, once it has been shared by readSpan(). */
+	SharedPtr<const byte> _owner;
+
 public:
 
 	/**
@@ -71,6 +75,7 @@ public:
 	}
 
 	uint32 read(void *dataPtr, uint32 dataSize);
+	StreamSpan readSpan(uint32 dataSize);
 
 	bool eos() const { return _eos; }
 	void clearErr() { _eos = false; }
@@ -79,6 +84,21 @@ public:
 	int32 size() const { return _size; }
 
 	bool seek(int32 offs, int whence = SEEK_SET);
+
+	/**
+	 * Return the data of the stream, to access it without copying. The data
+	 * stays valid until the stream is destroyed.
+	 */
+	const byte *getData() const { return _ptrOrig; }
+
+protected:
+	/**
+	 * Return a shared pointer owning the data of the stream, which is
+	 * passed on to the spans returned by readSpan(). If the stream owns its
+	 * data, the ownership is moved to the shared pointer on the first call.
+	 * Returns a null pointer if the data belongs to somebody else.
+	 */
+	virtual SharedPtr<const byte> getDataOwner();
 };
 
 
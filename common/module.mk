@@ -3,6 +3,7 @@ MODULE := common
 MODULE_OBJS := \
 	achievements.o \
 	archive.o \
+	arena.o \
 	base-str.o \
 	config-manager.o \
 	coroutines.o \
@@ -13,6 +14,7 @@ MODULE_OBJS := \
 	file.o \
 	fs.o \
 	gui_options.o \
+	hasher.o \
 	hashmap.o \
 	iff_container.o \
 	ini-file.o \
@@ -27,6 +29,7 @@ MODULE_OBJS := \
 	mutex.o \
 	osd_message_queue.o \
 	platform.o \
+	prefetchstream.o \
 	quicktime.o \
 	random.o \
 	rational.o \
@@ -35,11 +38,13 @@ MODULE_OBJS := \
 	str.o \
 	stream.o \
 	streamdebug.o \
+	streamspan.o \
 	str-enc.o \
 	encodings/singlebyte.o \
 	stuffit.o \
 	system.o \
 	textconsole.o \
+	threadpool.o \
 	tokenizer.o \
 	translation.o \
 	unarj.o \
@@ -0,0 +1,242 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/prefetchstream.h"
+
+namespace Common {
+
+PrefetchReadStream::PrefetchReadStream(SeekableReadStream *parentStream, DisposeAfterUse::Flag disposeParentStream,
+                                       uint32 chunkSize, uint chunkCount)
+	: _parentStream(parentStream, disposeParentStream), _size(parentStream->size()), _chunkSize(chunkSize),
+	  _pos(parentStream->pos()), _eos(false), _err(false), _stallCount(0), _stallTime(0), _thread(0), _workSem(0), _readySem(0),
+	  _windowStart(0), _firstChunk(0), _readyChunks(0), _generation(0), _readError(false),
+	  _readerWaiting(false), _threadWaiting(false), _quit(false) {
+	assert(chunkSize > 0 && chunkCount > 0);
+
+	// Start reading ahead at the current position of the parent stream
+	_windowStart = _pos - _pos % _chunkSize;
+
+	// Without a thread for reading ahead, the parent stream is read directly
+	_workSem = g_system->createSemaphore(0);
+	_readySem = g_system->createSemaphore(0);
+	if (!_workSem || !_readySem)
+		return;
+
+	_chunks.resize(chunkCount);
+	for (uint i = 0; i < chunkCount; i++) {
+		_chunks[i].data = new byte[chunkSize];
+		_chunks[i].size = 0;
+	}
+
+	_thread = g_system->createThread(threadEntry, this);
+	if (!_thread) {
+		for (uint i = 0; i < chunkCount; i++)
+			delete[] _chunks[i].data;
+		_chunks.clear();
+	}
+}
+
+PrefetchReadStream::~PrefetchReadStream() {
+	if (_thread) {
+		_mutex.lock();
+		_quit = true;
+		if (_threadWaiting)
+			g_system->postSemaphore(_workSem);
+		_mutex.unlock();
+
+		g_system->joinThread(_thread);
+	}
+
+	for (uint i = 0; i < _chunks.size(); i++)
+		delete[] _chunks[i].data;
+
+	if (_workSem)
+		g_system->deleteSemaphore(_workSem);
+	if (_readySem)
+		g_system->deleteSemaphore(_readySem);
+}
+
+uint32 PrefetchReadStream::read(void *dataPtr, uint32 dataSize) {
+	if (!_thread)
+		return readDirect(dataPtr, dataSize);
+
+	if (dataSize > _size - _pos) {
+		dataSize = _size - _pos;
+		_eos = true;
+	}
+
+	byte *dst = (byte *)dataPtr;
+	uint32 left = dataSize;
+	while (left > 0) {
+		_mutex.lock();
+
+		const uint32 index = (_pos - _windowStart) / _chunkSize;
+		if (_pos < _windowStart || index >= _chunks.size() || index > _readyChunks) {
+			// The position is not inside the window, or the chunks up to it
+			// have not been read yet. Cancel everything and read ahead from
+			// the new position instead.
+			_windowStart = _pos - _pos % _chunkSize;
+			_firstChunk = 0;
+			_readyChunks = 0;
+			_generation++;
+			_readError = false;
+		} else if (index > 0) {
+			// The chunks before the position are not needed anymore, which
+			// makes room for reading further ahead
+			_windowStart += index * _chunkSize;
+			_firstChunk = (_firstChunk + index) % _chunks.size();
+			_readyChunks -= index;
+		}
+
+		if (_threadWaiting) {
+			_threadWaiting = false;
+			g_system->postSemaphore(_workSem);
+		}
+
+		if (_readyChunks == 0) {
+			if (_readError) {
+				_mutex.unlock();
+				_err = true;
+				break;
+			}
+
+			// The data has not been read ahead in time
+			_readerWaiting = true;
+			_mutex.unlock();
+
+			const uint32 start = g_system->getMillis();
+			g_system->waitSemaphore(_readySem);
+			_stallTime += g_system->getMillis() - start;
+			_stallCount++;
+			continue;
+		}
+
+		// Only this thread can release the first chunk, so it can be read
+		// without holding the mutex
+		const Chunk &chunk = _chunks[_firstChunk];
+		const uint32 offset = _pos - _windowStart;
+		_mutex.unlock();
+
+		if (offset >= chunk.size) {
+			// The parent stream returned less data than expected
+			_err = true;
+			break;
+		}
+
+		const uint32 len = MIN(left, chunk.size - offset);
+		memcpy(dst, chunk.data + offset, len);
+		dst += len;
+		left -= len;
+		_pos += len;
+	}
+
+	return dataSize - left;
+}
+
+uint32 PrefetchReadStream::readDirect(void *dataPtr, uint32 dataSize) {
+	if (_parentStream->pos() != (int32)_pos && !_parentStream->seek(_pos)) {
+		_err = true;
+		return 0;
+	}
+
+	const uint32 len = _parentStream->read(dataPtr, dataSize);
+	_pos += len;
+	if (_parentStream->eos())
+		_eos = true;
+	if (_parentStream->err())
+		_err = true;
+	_parentStream->clearErr();
+	return len;
+}
+
+bool PrefetchReadStream::seek(int32 offset, int whence) {
+	switch (whence) {
+	case SEEK_END:
+		offset += _size;
+		break;
+	case SEEK_CUR:
+		offset += _pos;
+		break;
+	case SEEK_SET:
+	default:
+		break;
+	}
+
+	if (offset < 0 || (uint32)offset > _size)
+		return false;
+
+	// The window is adjusted by the next read, so that seeking back and
+	// forth does not cancel anything
+	_pos = offset;
+	_eos = false;
+	return true;
+}
+
+void PrefetchReadStream::threadEntry(void *arg) {
+	((PrefetchReadStream *)arg)->readAhead();
+}
+
+void PrefetchReadStream::readAhead() {
+	_mutex.lock();
+
+	while (!_quit) {
+		const uint32 chunkPos = _windowStart + _readyChunks * _chunkSize;
+		if (_readyChunks == _chunks.size() || chunkPos >= _size || _readError) {
+			_threadWaiting = true;
+			_mutex.unlock();
+			g_system->waitSemaphore(_workSem);
+			_mutex.lock();
+			continue;
+		}
+
+		// Read the next chunk without holding the mutex. The reader does
+		// not touch chunks which are not ready, and only this thread uses
+		// the parent stream.
+		Chunk &chunk = _chunks[(_firstChunk + _readyChunks) % _chunks.size()];
+		const uint32 generation = _generation;
+		const uint32 expected = MIN(_chunkSize, _size - chunkPos);
+		_mutex.unlock();
+
+		uint32 len = 0;
+		if (_parentStream->seek(chunkPos))
+			len = _parentStream->read(chunk.data, expected);
+		_parentStream->clearErr();
+
+		_mutex.lock();
+		if (generation != _generation)
+			continue;
+
+		chunk.size = len;
+		if (len < expected)
+			_readError = true;
+		_readyChunks++;
+
+		if (_readerWaiting) {
+			_readerWaiting = false;
+			g_system->postSemaphore(_readySem);
+		}
+	}
+
+	_mutex.unlock();
+}
+
+} // End of namespace Common
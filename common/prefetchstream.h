@@ -0,0 +1,160 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_PREFETCHSTREAM_H
+#define COMMON_PREFETCHSTREAM_H
+
+#include "common/array.h"
+#include "common/mutex.h"
+#include "common/noncopyable.h"
+#include "common/ptr.h"
+#include "common/stream.h"
+#include "common/system.h"
+
+namespace Common {
+
+/**
+ * @defgroup common_prefetchstream Prefetch stream
+ * @ingroup common_stream
+ *
+ * @brief A read stream which reads ahead of its consumer on another thread.
+ *
+ * @{
+ */
+
+/**
+ * PrefetchReadStream wraps a SeekableReadStream and reads ahead of the
+ * current position on a background thread, so that consumers reading
+ * mostly sequentially (like video and audio decoders) do not wait for slow
+ * storage.
+ *
+ * The data is read in chunks of a fixed size, and a window of several
+ * chunks starting at the chunk containing the current position is kept.
+ * Seeking inside the window keeps the data read so far, seeking outside of
+ * it cancels the pending reads and starts reading ahead at the new
+ * position.
+ *
+ * The prefetch stream starts at the current position of the parent stream.
+ * Once wrapped, the parent stream is used by the background thread, so it
+ * must not be accessed directly anymore. On backends without worker
+ * threads (see OSystem::createThread()), all reads are simply passed
+ * through to the parent stream.
+ */
+class PrefetchReadStream : public SeekableReadStream, NonCopyable {
+public:
+	enum {
+		kDefaultChunkSize = 64 * 1024,
+		kDefaultChunkCount = 8
+	};
+
+	/**
+	 * Create a prefetch stream.
+	 *
+	 * @param parentStream        The stream to read ahead in.
+	 * @param disposeParentStream Whether to delete the parent stream with this one.
+	 * @param chunkSize           The size of the chunks read at once.
+	 * @param chunkCount          The number of chunks in the read ahead window.
+	 */
+	PrefetchReadStream(SeekableReadStream *parentStream, DisposeAfterUse::Flag disposeParentStream,
+	                   uint32 chunkSize = kDefaultChunkSize, uint chunkCount = kDefaultChunkCount);
+	~PrefetchReadStream();
+
+	bool eos() const { return _eos; }
+	bool err() const { return _err; }
+	void clearErr() { _eos = false; _err = false; }
+	uint32 read(void *dataPtr, uint32 dataSize);
+
+	int32 pos() const { return _pos; }
+	int32 size() const { return _size; }
+	bool seek(int32 offset, int whence = SEEK_SET);
+
+	/**
+	 * Return whether reading ahead is done on a background thread.
+	 */
+	bool isPrefetching() const { return _thread != 0; }
+
+	/**
+	 * Return how often a read had to wait for data, which was not
+	 * read ahead yet.
+	 */
+	uint32 getStallCount() const { return _stallCount; }
+
+	/**
+	 * Return the total time reads had to wait for data, in milliseconds.
+	 */
+	uint32 getStallTime() const { return _stallTime; }
+
+	/**
+	 * Reset the stall counters.
+	 */
+	void resetStallCounters() { _stallCount = 0; _stallTime = 0; }
+
+private:
+	struct Chunk {
+		byte *data;
+		uint32 size;
+	};
+
+	static void threadEntry(void *arg);
+	void readAhead();
+	uint32 readDirect(void *dataPtr, uint32 dataSize);
+
+	DisposablePtr<SeekableReadStream> _parentStream;
+	const uint32 _size;
+	const uint32 _chunkSize;
+	uint32 _pos;
+	bool _eos;
+	bool _err;
+
+	uint32 _stallCount;
+	uint32 _stallTime;
+
+	OSystem::ThreadRef _thread;
+	OSystem::SemaphoreRef _workSem;
+	OSystem::SemaphoreRef _readySem;
+
+	/**
+	 * The state shared with the background thread, guarded by _mutex.
+	 *
+	 * The window is a ring of chunks, starting with _chunks[_firstChunk]
+	 * at the stream position _windowStart. The first _readyChunks chunks
+	 * have been read, and the background thread reads the next one unless
+	 * the window is full. Bumping _generation makes it discard the chunk it
+	 * is reading.
+	 */
+	Mutex _mutex;
+	Array<Chunk> _chunks;
+	uint32 _windowStart;
+	uint _firstChunk;
+	uint _readyChunks;
+	uint32 _generation;
+	bool _readError;
+	bool _readerWaiting;
+	bool _threadWaiting;
+	bool _quit;
+};
+
+/** @} */
+
+} // End of namespace Common
+
+#endif
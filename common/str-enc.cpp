@@ -320,7 +320,7 @@ void String::encodeWindows932(const U32String &src) {
 	if (!reverseTable && windows932ConversionTable) {
 		uint16 *rt = new uint16[0x10000];
 		memset(rt, 0, sizeof(rt[0]) * 0x10000);
-		for (uint highidx = 0; highidx < 58; highidx++)
+		for (uint highidx = 0; highidx < 47; highidx++)
 			for (uint lowidx = 0; lowidx < 192; lowidx++) {
 				uint8 high = 0;
 				uint8 low = lowidx + 0x40;
@@ -477,7 +477,7 @@ void String::encodeWindows950(const U32String &src, bool transliterate) {
 		uint16 *rt = new uint16[0x10000];
 		memset(rt, 0, sizeof(rt[0]) * 0x10000);
 
-		for (uint highidx = 0; highidx < 90; highidx++)
+		for (uint highidx = 0; highidx < 89; highidx++)
 			for (uint lowidx = 0; lowidx < 157; lowidx++) {
 				uint8 high = highidx + 0xa1;
 				uint8 low = 0;
@@ -23,6 +23,7 @@
 #include "common/ptr.h"
 #include "common/stream.h"
 #include "common/memstream.h"
+#include "common/streamspan.h"
 #include "common/substream.h"
 #include "common/str.h"
 
@@ -52,6 +53,10 @@ SeekableReadStream *ReadStream::readStream(uint32 dataSize) {
 	return new MemoryReadStream((byte *)buf, dataSize, DisposeAfterUse::YES);
 }
 
+StreamSpan ReadStream::readSpan(uint32 dataSize) {
+	return StreamSpan::makeCopy(*this, dataSize);
+}
+
 Common::String ReadStream::readString(char terminator) {
 	Common::String result;
 	char c;
@@ -98,6 +103,29 @@ uint32 MemoryReadStream::read(void *dataPtr, uint32 dataSize) {
 	return dataSize;
 }
 
+StreamSpan MemoryReadStream::readSpan(uint32 dataSize) {
+	if (dataSize > _size - _pos) {
+		dataSize = _size - _pos;
+		_eos = true;
+	}
+
+	StreamSpan span = StreamSpan::makeBorrowed(_ptr, dataSize, getDataOwner());
+
+	_ptr += dataSize;
+	_pos += dataSize;
+
+	return span;
+}
+
+SharedPtr<const byte> MemoryReadStream::getDataOwner() {
+	if (_disposeMemory) {
+		_owner = StreamSpan::makeMallocOwner(_ptrOrig);
+		_disposeMemory = DisposeAfterUse::NO;
+	}
+
+	return _owner;
+}
+
 bool MemoryReadStream::seek(int32 offs, int whence) {
 	// Pre-Condition
 	assert(_pos <= _size);
@@ -225,6 +253,19 @@ uint32 SubReadStream::read(void *dataPtr, uint32 dataSize) {
 	return dataSize;
 }
 
+StreamSpan SubReadStream::readSpan(uint32 dataSize) {
+	if (dataSize > _end - _pos) {
+		dataSize = _end - _pos;
+		_eos = true;
+	}
+
+	// Borrow the data from the parent, if it is a memory stream
+	StreamSpan span = _parentStream->readSpan(dataSize);
+	_pos += span.size();
+
+	return span;
+}
+
 SeekableSubReadStream::SeekableSubReadStream(SeekableReadStream *parentStream, uint32 begin, uint32 end, DisposeAfterUse::Flag disposeParentStream)
 	: SubReadStream(parentStream, end, disposeParentStream),
 	_parentStream(parentStream),
@@ -268,6 +309,13 @@ uint32 SafeSeekableSubReadStream::read(void *dataPtr, uint32 dataSize) {
 	return SeekableSubReadStream::read(dataPtr, dataSize);
 }
 
+StreamSpan SafeSeekableSubReadStream::readSpan(uint32 dataSize) {
+	// Make sure the parent stream is at the right position
+	seek(0, SEEK_CUR);
+
+	return SeekableSubReadStream::readSpan(dataSize);
+}
+
 void SeekableReadStream::hexdump(int len, int bytesPerLine, int startOffset) {
 	uint pos_ = pos();
 	uint size_ = size();
@@ -40,6 +40,7 @@ namespace Common {
 
 class ReadStream;
 class SeekableReadStream;
+class StreamSpan;
 
 /**
  * Virtual base class for both ReadStream and WriteStream.
@@ -637,6 +638,19 @@ public:
 	 */
 	SeekableReadStream *readStream(uint32 dataSize);
 
+	/**
+	 * Read the specified amount of data, and return it as a StreamSpan
+	 * (see common/streamspan.h).
+	 *
+	 * Memory streams, including memory mapped files, return a span
+	 * pointing directly into their data. All other streams copy the data
+	 * into a new buffer, like readStream() does.
+	 *
+	 * The returned span might contain less data than requested, in the
+	 * same cases as with readStream().
+	 */
+	virtual StreamSpan readSpan(uint32 dataSize);
+
 	/**
 	 * Reads in a terminated string. Upon successful completion,
 	 * return a string with the content of the line, *without*
@@ -0,0 +1,86 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "common/streamspan.h"
+#include "common/atomic.h"
+#include "common/stream.h"
+
+namespace Common {
+
+namespace {
+
+volatile uint32 borrowedBytes = 0;
+volatile uint32 copiedBytes = 0;
+
+struct FreeDeleter {
+	void operator()(const byte *ptr) {
+		free(const_cast<byte *>(ptr));
+	}
+};
+
+} // End of anonymous namespace
+
+StreamSpan StreamSpan::makeBorrowed(const byte *data, uint32 size, const SharedPtr<const byte> &owner) {
+	StreamSpan span;
+	span._span = Span<const byte>(data, size);
+	span._owner = owner;
+	span._borrowed = true;
+
+	atomicAdd(&borrowedBytes, size);
+	return span;
+}
+
+StreamSpan StreamSpan::makeCopy(ReadStream &stream, uint32 size) {
+	byte *buf = (byte *)malloc(size);
+	if (!buf)
+		return StreamSpan();
+
+	size = stream.read(buf, size);
+
+	StreamSpan span;
+	span._span = Span<const byte>(buf, size);
+	span._owner = makeMallocOwner(buf);
+	span._borrowed = false;
+
+	atomicAdd(&copiedBytes, size);
+	return span;
+}
+
+SharedPtr<const byte> StreamSpan::makeMallocOwner(const byte *data) {
+	return SharedPtr<const byte>(data, FreeDeleter());
+}
+
+uint32 StreamSpan::getBorrowedBytes() {
+	return atomicLoad(&borrowedBytes);
+}
+
+uint32 StreamSpan::getCopiedBytes() {
+	return atomicLoad(&copiedBytes);
+}
+
+void StreamSpan::resetCounters() {
+	atomicStore(&borrowedBytes, 0);
+	atomicStore(&copiedBytes, 0);
+}
+
+} // End of namespace Common
@@ -0,0 +1,106 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#ifndef COMMON_STREAMSPAN_H
+#define COMMON_STREAMSPAN_H
+
+#include "common/scummsys.h"
+#include "common/ptr.h"
+#include "common/span.h"
+
+namespace Common {
+
+/**
+ * @defgroup common_streamspan Stream spans
+ * @ingroup common_stream
+ *
+ * @brief API for reading stream data without copying it.
+ *
+ * @{
+ */
+
+class ReadStream;
+
+/**
+ * A block of read-only data returned by ReadStream::readSpan() or
+ * ArchiveMember::mapSpan().
+ *
+ * Memory streams, including memory mapped files, return spans which point
+ * directly into their data. Such borrowed spans share the ownership of the
+ * data with the stream, so they stay valid after the stream has been
+ * destroyed. The only exception is data which the stream did not own
+ * itself (see DisposeAfterUse::NO), which stays owned by whoever provided
+ * it. All other streams copy the data into a buffer owned by the span.
+ *
+ * Copies of a StreamSpan share the same data.
+ */
+class StreamSpan {
+public:
+	StreamSpan() : _borrowed(false) {}
+
+	/** The data, for parsing it with the Span API. */
+	const Span<const byte> &getSpan() const { return _span; }
+
+	const byte *getData() const { return _span.data(); }
+	uint32 size() const { return _span.size(); }
+	bool empty() const { return _span.size() == 0; }
+
+	/** Whether the data belongs to the stream, instead of being a copy. */
+	bool isBorrowed() const { return _borrowed; }
+
+	/**
+	 * Create a span pointing to data in memory.
+	 *
+	 * @param data  The data.
+	 * @param size  The size of the data in bytes.
+	 * @param owner Keeps the data alive while the span exists. May be null
+	 *              if the data belongs to somebody else.
+	 */
+	static StreamSpan makeBorrowed(const byte *data, uint32 size, const SharedPtr<const byte> &owner);
+
+	/** Create a span by reading up to size bytes of the stream into a new buffer. */
+	static StreamSpan makeCopy(ReadStream &stream, uint32 size);
+
+	/** Return a shared pointer which frees the malloc'ed data once its last copy is gone. */
+	static SharedPtr<const byte> makeMallocOwner(const byte *data);
+
+	/**
+	 * Return the number of bytes in all spans made so far, which were
+	 * borrowed from the streams or copied. The counters wrap around after
+	 * 4 GB.
+	 */
+	static uint32 getBorrowedBytes();
+	static uint32 getCopiedBytes();
+	static void resetCounters();
+
+private:
+	Span<const byte> _span;
+	SharedPtr<const byte> _owner;
+	bool _borrowed;
+};
+
+/** @} */
+
+} // End of namespace Common
+
+#endif
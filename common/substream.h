@@ -65,6 +65,7 @@ public:
 	virtual bool err() const { return _parentStream->err(); }
 	virtual void clearErr() { _eos = false; _parentStream->clearErr(); }
 	virtual uint32 read(void *dataPtr, uint32 dataSize);
+	virtual StreamSpan readSpan(uint32 dataSize);
 };
 
 /*
@@ -131,6 +132,7 @@ public:
 	}
 
 	virtual uint32 read(void *dataPtr, uint32 dataSize);
+	virtual StreamSpan readSpan(uint32 dataSize);
 };
 
 /** @} */
@@ -218,6 +218,22 @@ Common::String OSystem::getDefaultConfigFileName() {
 	return "scummvm.ini";
 }
 
+OSystem::SimdLevel OSystem::getSimdLevel() {
+#ifdef SCUMMVM_AVX2
+	if (hasFeature(kFeatureCpuAVX2))
+		return kSimdAVX2;
+#endif
+#ifdef SCUMMVM_SSE2
+#if defined(__x86_64__) || defined(_M_X64)
+	return kSimdSSE2;
+#else
+	if (hasFeature(kFeatureCpuSSE2))
+		return kSimdSSE2;
+#endif
+#endif
+	return kSimdNone;
+}
+
 Common::String OSystem::getSystemLanguage() const {
 	return "en_US";
 }
@@ -499,7 +499,23 @@ public:
 		/**
 		* For platforms that should not have a Quit button.
 		*/
-		kFeatureNoQuit
+		kFeatureNoQuit,
+
+		/**
+		* The host CPU supports the SSE2 instruction set.
+		*
+		* Code built with SCUMMVM_SSE2 defined may query this to select
+		* vectorized routines at runtime.
+		*/
+		kFeatureCpuSSE2,
+
+		/**
+		* The host CPU supports the AVX2 instruction set.
+		*
+		* Code built with SCUMMVM_AVX2 defined may query this to select
+		* vectorized routines at runtime.
+		*/
+		kFeatureCpuAVX2
 	};
 
 	/**
@@ -522,6 +538,25 @@ public:
 	 */
 	virtual bool getFeatureState(Feature f) { return false; }
 
+	/**
+	 * SIMD instruction sets which vectorized routines may be built for,
+	 * ordered from the least to the most capable.
+	 */
+	enum SimdLevel {
+		kSimdNone,
+		kSimdSSE2,
+		kSimdAVX2
+	};
+
+	/**
+	 * Return the most capable SIMD instruction set which the host CPU
+	 * supports and ScummVM has been built for.
+	 *
+	 * This is based on kFeatureCpuSSE2 and kFeatureCpuAVX2. SSE2 is always
+	 * available on x86-64, even if the backend does not report it.
+	 */
+	SimdLevel getSimdLevel();
+
 	/** @} */
 
 
@@ -1418,6 +1453,82 @@ public:
 	/** @} */
 
 
+	/**
+	 * @defgroup common_system_threads Worker threads
+	 * @ingroup common_system
+	 * @{
+	 *
+	 * Backends may optionally allow creating worker threads, which can be
+	 * used to spread CPU heavy work (like scaling graphics) over several
+	 * CPU cores. This is not a replacement for the removed threading API:
+	 * code using worker threads must still work, by doing all the work
+	 * itself, when createThread() returns 0. Worker threads must not call
+	 * any OSystem methods besides the mutex and semaphore ones, and
+	 * logMessage(), which backends supporting worker threads serialize.
+	 *
+	 * Common::ThreadPool wraps these methods in an easier to use interface.
+	 */
+
+	typedef struct OpaqueThread *ThreadRef;
+	typedef struct OpaqueSemaphore *SemaphoreRef;
+	typedef void (*ThreadProc)(void *arg);
+
+	/**
+	 * Return the number of CPU cores available to worker threads.
+	 */
+	virtual uint getCPUCount() { return 1; }
+
+	/**
+	 * Create a new thread, which runs the given function.
+	 *
+	 * @param proc The function to run.
+	 * @param arg  The argument to pass to the function.
+	 * @return The newly created thread, or 0 if threads are not supported
+	 *         or an error occurred.
+	 */
+	virtual ThreadRef createThread(ThreadProc proc, void *arg) { return 0; }
+
+	/**
+	 * Wait until the given thread has finished, and free its resources.
+	 *
+	 * @param thread The thread to wait for.
+	 */
+	virtual void joinThread(ThreadRef thread) {}
+
+	/**
+	 * Create a new semaphore.
+	 *
+	 * @param value The initial value of the semaphore.
+	 * @return The newly created semaphore, or 0 if an error occurred.
+	 */
+	virtual SemaphoreRef createSemaphore(uint value) { return 0; }
+
+	/**
+	 * Increment the value of the given semaphore, waking up a thread
+	 * waiting for it.
+	 *
+	 * @param sem The semaphore to increment.
+	 */
+	virtual void postSemaphore(SemaphoreRef sem) {}
+
+	/**
+	 * Wait until the value of the given semaphore is positive, and then
+	 * decrement it.
+	 *
+	 * @param sem The semaphore to wait for.
+	 */
+	virtual void waitSemaphore(SemaphoreRef sem) {}
+
+	/**
+	 * Delete the given semaphore. No thread may be waiting for it.
+	 *
+	 * @param sem The semaphore to delete.
+	 */
+	virtual void deleteSemaphore(SemaphoreRef sem) {}
+
+	/** @} */
+
+
 
 	/** @defgroup common_system_sound Sound
 	 *  @ingroup common_system
@@ -0,0 +1,109 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "common/threadpool.h"
+#include "common/atomic.h"
+
+namespace Common {
+
+ThreadPool::ThreadPool(uint numThreads) : _startSem(0), _doneSem(0), _proc(0), _arg(0), _count(0), _nextJob(0), _quit(0) {
+	if (numThreads == 0)
+		numThreads = g_system->getCPUCount();
+	if (numThreads <= 1)
+		return;
+
+	_startSem = g_system->createSemaphore(0);
+	_doneSem = g_system->createSemaphore(0);
+	if (!_startSem || !_doneSem)
+		return;
+
+	for (uint i = 1; i < numThreads; i++) {
+		OSystem::ThreadRef thread = g_system->createThread(workerEntry, this);
+		if (!thread)
+			break;
+		_workers.push_back(thread);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	Common::atomicStore(&_quit, 1);
+	for (uint i = 0; i < _workers.size(); i++)
+		g_system->postSemaphore(_startSem);
+	for (uint i = 0; i < _workers.size(); i++)
+		g_system->joinThread(_workers[i]);
+
+	if (_startSem)
+		g_system->deleteSemaphore(_startSem);
+	if (_doneSem)
+		g_system->deleteSemaphore(_doneSem);
+}
+
+void ThreadPool::run(JobProc proc, void *arg, uint count) {
+	if (count == 0)
+		return;
+
+	// Only wake up the workers if there is something left for them to do
+	if (count == 1 || _workers.empty()) {
+		for (uint i = 0; i < count; i++)
+			proc(arg, i);
+		return;
+	}
+
+	_proc = proc;
+	_arg = arg;
+	_count = count;
+	Common::atomicStore(&_nextJob, 0);
+
+	const uint numWorkers = MIN<uint>(_workers.size(), count - 1);
+	for (uint i = 0; i < numWorkers; i++)
+		g_system->postSemaphore(_startSem);
+
+	runJobs();
+
+	for (uint i = 0; i < numWorkers; i++)
+		g_system->waitSemaphore(_doneSem);
+}
+
+void ThreadPool::runJobs() {
+	for (;;) {
+		const uint32 job = Common::atomicAdd(&_nextJob, 1) - 1;
+		if (job >= _count)
+			break;
+		_proc(_arg, job);
+	}
+}
+
+void ThreadPool::workerEntry(void *arg) {
+	ThreadPool *pool = (ThreadPool *)arg;
+
+	for (;;) {
+		g_system->waitSemaphore(pool->_startSem);
+		if (Common::atomicLoad(&pool->_quit))
+			break;
+
+		pool->runJobs();
+		g_system->postSemaphore(pool->_doneSem);
+	}
+}
+
+} // End of namespace Common
@@ -0,0 +1,106 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#ifndef COMMON_THREADPOOL_H
+#define COMMON_THREADPOOL_H
+
+#include "common/scummsys.h"
+#include "common/array.h"
+#include "common/noncopyable.h"
+#include "common/system.h"
+
+namespace Common {
+
+/**
+ * @defgroup common_threadpool Thread pool
+ * @ingroup common
+ *
+ * @brief A pool of worker threads for splitting CPU heavy work into jobs.
+ * @{
+ */
+
+/**
+ * A pool of worker threads, which run batches of independent jobs.
+ *
+ * The calling thread works on the jobs, too, so on backends without
+ * support for worker threads (see OSystem::createThread()) all jobs are
+ * simply run one after another by the caller.
+ */
+class ThreadPool : NonCopyable {
+public:
+	/**
+	 * The type of the job functions.
+	 *
+	 * @param arg   The argument passed to run().
+	 * @param index The index of the job, from 0 to the job count - 1.
+	 */
+	typedef void (*JobProc)(void *arg, uint index);
+
+	/**
+	 * Create a thread pool.
+	 *
+	 * @param numThreads The number of threads working on jobs, including
+	 *                   the calling thread. If 0, one thread per CPU core
+	 *                   is used.
+	 */
+	explicit ThreadPool(uint numThreads = 0);
+	~ThreadPool();
+
+	/**
+	 * Return the number of threads working on jobs, including the calling
+	 * thread.
+	 */
+	uint getThreadCount() const { return _workers.size() + 1; }
+
+	/**
+	 * Run a batch of jobs, and wait until all of them have finished.
+	 *
+	 * The jobs may run in any order, and concurrently with each other.
+	 * Only one thread at a time may call this.
+	 *
+	 * @param proc  The job function.
+	 * @param arg   The argument to pass to the job function.
+	 * @param count The number of jobs.
+	 */
+	void run(JobProc proc, void *arg, uint count);
+
+private:
+	static void workerEntry(void *arg);
+	void runJobs();
+
+	Array<OSystem::ThreadRef> _workers;
+	OSystem::SemaphoreRef _startSem;
+	OSystem::SemaphoreRef _doneSem;
+
+	JobProc _proc;
+	void *_arg;
+	uint32 _count;
+	volatile uint32 _nextJob;
+	volatile uint32 _quit;
+};
+
+/** @} */
+
+} // End of namespace Common
+
+#endif
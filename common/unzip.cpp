@@ -106,6 +106,10 @@ typedef struct {
 #include "common/fs.h"
 #include "common/unzip.h"
 #include "common/memstream.h"
+#include "common/mutex.h"
+#include "common/ptr.h"
+#include "common/substream.h"
+#include "common/textconsole.h"
 
 #include "common/hashmap.h"
 #include "common/hash-str.h"
@@ -1419,12 +1423,368 @@ int unzGetGlobalComment(unzFile file, char *szComment, uLong uSizeBuf) {
 
 namespace Common {
 
+enum {
+	/**
+	 * Members up to this size are decompressed into memory when they are
+	 * opened. Streaming them would need more memory than that.
+	 */
+	kMaxMemoryMemberSize = 128 * 1024
+};
+
+/**
+ * Opens the streams which the big members read the archive through. Every
+ * member stream gets its own, so that streams of different members never
+ * move each other's position, even when they are used on different threads.
+ */
+class ZipStreamFactory {
+public:
+	virtual ~ZipStreamFactory() {}
+
+	/** Return a new stream over the whole archive, or 0 on failure. */
+	virtual SeekableReadStream *createStream() const = 0;
+};
+
+/** Opens the archive's file again for every member. */
+class ZipNodeStreamFactory : public ZipStreamFactory {
+public:
+	explicit ZipNodeStreamFactory(const FSNode &node) : _node(node) {}
+
+	SeekableReadStream *createStream() const override { return _node.createReadStream(); }
+
+private:
+	FSNode _node;
+};
+
+/**
+ * An archive stream which cannot be opened again, shared by the archive and
+ * the streams of its members. Each of them keeps its own position, and
+ * seeks and reads the stream under the lock.
+ */
+struct ZipSharedStream {
+	ScopedPtr<SeekableReadStream> stream;
+	Mutex mutex;
+
+	explicit ZipSharedStream(SeekableReadStream *s) : stream(s) {}
+};
+
+class ZipSharedReadStream : public SeekableReadStream {
+public:
+	explicit ZipSharedReadStream(const SharedPtr<ZipSharedStream> &shared)
+		: _shared(shared), _pos(0), _size(shared->stream->size()), _eos(false), _err(false) {
+	}
+
+	bool err() const override { return _err; }
+	void clearErr() override { _eos = false; _err = false; }
+	bool eos() const override { return _eos; }
+
+	uint32 read(void *dataPtr, uint32 dataSize) override;
+
+	int32 pos() const override { return _pos; }
+	int32 size() const override { return _size; }
+	bool seek(int32 offset, int whence = SEEK_SET) override;
+
+private:
+	SharedPtr<ZipSharedStream> _shared;
+	int32 _pos;
+	const int32 _size;
+	bool _eos;
+	bool _err;
+};
+
+uint32 ZipSharedReadStream::read(void *dataPtr, uint32 dataSize) {
+	if (dataSize > (uint32)(_size - _pos)) {
+		dataSize = _size - _pos;
+		_eos = true;
+	}
+
+	StackLock lock(_shared->mutex);
+	SeekableReadStream &stream = *_shared->stream;
+	if (!stream.seek(_pos)) {
+		_err = true;
+		return 0;
+	}
+
+	const uint32 count = stream.read(dataPtr, dataSize);
+	if (stream.err())
+		_err = true;
+	stream.clearErr();
+
+	_pos += count;
+	return count;
+}
+
+bool ZipSharedReadStream::seek(int32 offset, int whence) {
+	int32 newPos;
+	switch (whence) {
+	case SEEK_END:
+		newPos = _size + offset;
+		break;
+	case SEEK_CUR:
+		newPos = _pos + offset;
+		break;
+	case SEEK_SET:
+	default:
+		newPos = offset;
+		break;
+	}
+
+	if (newPos < 0 || newPos > _size)
+		return false;
+
+	_pos = newPos;
+	_eos = false;
+	return true;
+}
+
+/** Gives every member a view of the shared archive stream. */
+class ZipSharedStreamFactory : public ZipStreamFactory {
+public:
+	explicit ZipSharedStreamFactory(const SharedPtr<ZipSharedStream> &shared) : _shared(shared) {}
+
+	SeekableReadStream *createStream() const override { return new ZipSharedReadStream(_shared); }
+
+private:
+	SharedPtr<ZipSharedStream> _shared;
+};
+
+#ifdef USE_ZLIB
+
+/**
+ * A stream for a deflated member, which decompresses the data on demand.
+ *
+ * Every stream has its own decompressor and its own stream over the
+ * archive, so several members can be read at the same time. While
+ * decompressing, a copy of the decompressor state is saved at regular
+ * intervals, so that seeking backwards only needs to decompress the data
+ * since the last of these checkpoints before the new position, instead of
+ * everything from the start of the member.
+ */
+class ZipInflateReadStream : public SeekableReadStream {
+public:
+	ZipInflateReadStream(SeekableReadStream *archiveStream, uint32 dataStart,
+	                     uint32 compressedSize, uint32 uncompressedSize, uint32 crc);
+	~ZipInflateReadStream();
+
+	bool err() const override { return _err; }
+	void clearErr() override { _eos = false; }
+	bool eos() const override { return _eos; }
+
+	uint32 read(void *dataPtr, uint32 dataSize) override;
+
+	int32 pos() const override { return _pos; }
+	int32 size() const override { return _uncompressedSize; }
+	bool seek(int32 offset, int whence = SEEK_SET) override;
+
+private:
+	enum {
+		kBufferSize = 16384,
+		/** The minimum distance between checkpoints. */
+		kMinCheckpointInterval = 1024 * 1024,
+		/** The maximum number of checkpoints per member. */
+		kMaxCheckpoints = 64
+	};
+
+	struct Checkpoint {
+		z_stream *state;
+		uint32 compressedPos;
+		uint32 crc;
+	};
+
+	uint32 inflateData(byte *dst, uint32 dataSize);
+	void addCheckpoint();
+	bool restoreCheckpoint(uint index);
+	bool restart();
+
+	ScopedPtr<SeekableReadStream> _archiveStream;
+	const uint32 _dataStart;
+	const uint32 _compressedSize;
+	const uint32 _uncompressedSize;
+	const uint32 _crc;
+
+	z_stream _stream;
+	byte _buffer[kBufferSize];
+	uint32 _compressedPos;
+	uint32 _pos;
+	uint32 _crcSoFar;
+
+	Array<Checkpoint> _checkpoints;
+	uint32 _checkpointInterval;
+
+	bool _eos;
+	bool _err;
+};
+
+ZipInflateReadStream::ZipInflateReadStream(SeekableReadStream *archiveStream, uint32 dataStart,
+                                           uint32 compressedSize, uint32 uncompressedSize, uint32 crc)
+	: _archiveStream(archiveStream), _dataStart(dataStart), _compressedSize(compressedSize),
+	  _uncompressedSize(uncompressedSize), _crc(crc), _stream(), _compressedPos(0), _pos(0), _crcSoFar(0),
+	  _eos(false), _err(false) {
+
+	_checkpointInterval = MAX<uint32>(kMinCheckpointInterval, _uncompressedSize / kMaxCheckpoints);
+
+	// The data has no zlib header, see unzOpenCurrentFile()
+	_err = inflateInit2(&_stream, -MAX_WBITS) != Z_OK;
+	_stream.next_in = _buffer;
+	_stream.avail_in = 0;
+}
+
+ZipInflateReadStream::~ZipInflateReadStream() {
+	for (uint i = 0; i < _checkpoints.size(); ++i) {
+		inflateEnd(_checkpoints[i].state);
+		delete _checkpoints[i].state;
+	}
+	inflateEnd(&_stream);
+}
+
+uint32 ZipInflateReadStream::inflateData(byte *dst, uint32 dataSize) {
+	_stream.next_out = dst;
+	_stream.avail_out = dataSize;
+
+	while (_stream.avail_out) {
+		if (!_stream.avail_in) {
+			const uint32 count = MIN<uint32>(kBufferSize, _compressedSize - _compressedPos);
+			if (!count || !_archiveStream->seek(_dataStart + _compressedPos) || _archiveStream->read(_buffer, count) != count)
+				break;
+
+			_compressedPos += count;
+			_stream.next_in = _buffer;
+			_stream.avail_in = count;
+		}
+
+		if (inflate(&_stream, Z_SYNC_FLUSH) != Z_OK)
+			break;
+	}
+
+	const uint32 produced = dataSize - _stream.avail_out;
+	_crcSoFar = crc32(_crcSoFar, dst, produced);
+	_pos += produced;
+
+	if (produced != dataSize) {
+		warning("ZipInflateReadStream: Corrupt data at offset %u", _pos);
+		_err = true;
+	} else if (_pos == _uncompressedSize && _crcSoFar != _crc) {
+		warning("ZipInflateReadStream: CRC mismatch");
+		_err = true;
+	}
+
+	return produced;
+}
+
+uint32 ZipInflateReadStream::read(void *dataPtr, uint32 dataSize) {
+	if (dataSize > _uncompressedSize - _pos) {
+		dataSize = _uncompressedSize - _pos;
+		_eos = true;
+	}
+
+	byte *dst = (byte *)dataPtr;
+	uint32 total = 0;
+	while (total < dataSize && !_err) {
+		// Stop at the next checkpoint to save the state there. All positions
+		// before the current one have been passed, so are the checkpoints.
+		const uint32 nextCheckpoint = (uint32)MIN<uint64>((uint64)(_checkpoints.size() + 1) * _checkpointInterval, _uncompressedSize);
+		const uint32 count = MIN(dataSize - total, nextCheckpoint - _pos);
+
+		total += inflateData(dst + total, count);
+		if (_pos == nextCheckpoint && _pos < _uncompressedSize && !_err)
+			addCheckpoint();
+	}
+
+	return total;
+}
+
+void ZipInflateReadStream::addCheckpoint() {
+	Checkpoint checkpoint;
+	checkpoint.state = new z_stream;
+	if (inflateCopy(checkpoint.state, &_stream) != Z_OK) {
+		delete checkpoint.state;
+		_err = true;
+		return;
+	}
+
+	// The buffered input is not part of the copy, so the checkpoint
+	// continues with the first byte not yet passed to inflate()
+	checkpoint.compressedPos = _compressedPos - _stream.avail_in;
+	checkpoint.crc = _crcSoFar;
+	_checkpoints.push_back(checkpoint);
+}
+
+bool ZipInflateReadStream::restoreCheckpoint(uint index) {
+	const Checkpoint &checkpoint = _checkpoints[index];
+
+	inflateEnd(&_stream);
+	if (inflateCopy(&_stream, checkpoint.state) != Z_OK) {
+		_err = true;
+		return false;
+	}
+
+	_stream.next_in = _buffer;
+	_stream.avail_in = 0;
+	_compressedPos = checkpoint.compressedPos;
+	_pos = (index + 1) * _checkpointInterval;
+	_crcSoFar = checkpoint.crc;
+	return true;
+}
+
+bool ZipInflateReadStream::restart() {
+	if (inflateReset(&_stream) != Z_OK) {
+		_err = true;
+		return false;
+	}
+
+	_stream.next_in = _buffer;
+	_stream.avail_in = 0;
+	_compressedPos = 0;
+	_pos = 0;
+	_crcSoFar = 0;
+	return true;
+}
+
+bool ZipInflateReadStream::seek(int32 offset, int whence) {
+	int32 newPos;
+	switch (whence) {
+	case SEEK_END:
+		newPos = _uncompressedSize + offset;
+		break;
+	case SEEK_CUR:
+		newPos = _pos + offset;
+		break;
+	case SEEK_SET:
+	default:
+		newPos = offset;
+		break;
+	}
+
+	if (newPos < 0 || (uint32)newPos > _uncompressedSize || _err)
+		return false;
+
+	// Continue from the last checkpoint before the new position, unless it
+	// is closer to decompress on from the current position
+	const uint checkpoint = newPos / _checkpointInterval;
+	if (checkpoint > 0 && checkpoint <= _checkpoints.size() &&
+	    ((uint32)newPos < _pos || checkpoint * _checkpointInterval > _pos)) {
+		if (!restoreCheckpoint(checkpoint - 1))
+			return false;
+	} else if ((uint32)newPos < _pos) {
+		if (!restart())
+			return false;
+	}
+
+	byte tmpBuf[4096];
+	while (_pos < (uint32)newPos && !_err)
+		read(tmpBuf, MIN<uint32>(sizeof(tmpBuf), newPos - _pos));
+
+	_eos = false;
+	return !_err;
+}
+
+#endif // USE_ZLIB
 
 class ZipArchive : public Archive {
 	unzFile _zipFile;
+	ScopedPtr<ZipStreamFactory> _memberStreams;
 
 public:
-	ZipArchive(unzFile zipFile);
+	ZipArchive(unzFile zipFile, ZipStreamFactory *memberStreams);
 
 
 	~ZipArchive();
@@ -1453,7 +1813,7 @@ public:
 };
 */
 
-ZipArchive::ZipArchive(unzFile zipFile) : _zipFile(zipFile) {
+ZipArchive::ZipArchive(unzFile zipFile, ZipStreamFactory *memberStreams) : _zipFile(zipFile), _memberStreams(memberStreams) {
 	assert(_zipFile);
 }
 
@@ -1489,11 +1849,40 @@ SeekableReadStream *ZipArchive::createReadStreamForMember(const String &name) co
 	if (unzLocateFile(_zipFile, name.c_str(), 2) != UNZ_OK)
 		return nullptr;
 
-	unz_file_info fileInfo;
-	if (unzOpenCurrentFile(_zipFile) != UNZ_OK)
+	unz_s *const archive = (unz_s *)_zipFile;
+	const unz_file_info &fileInfo = archive->cur_file_info;
+
+	// Big members are read directly from the archive on demand, instead of
+	// keeping all of their data in memory
+	if (fileInfo.uncompressed_size > kMaxMemoryMemberSize) {
+		uInt localHeaderSize;
+		uLong extraFieldOffset;
+		uInt extraFieldSize;
+		if (unzlocal_CheckCurrentFileCoherencyHeader(archive, &localHeaderSize, &extraFieldOffset, &extraFieldSize) != UNZ_OK)
+			return nullptr;
+
+		const uint32 dataStart = archive->byte_before_the_zipfile + archive->cur_file_info_internal.offset_curfile +
+		                         SIZEZIPLOCALHEADER + localHeaderSize;
+
+		if (fileInfo.compression_method == 0) {
+			SeekableReadStream *stream = _memberStreams->createStream();
+			if (!stream)
+				return nullptr;
+			return new SeekableSubReadStream(stream, dataStart, dataStart + fileInfo.uncompressed_size, DisposeAfterUse::YES);
+		}
+#ifdef USE_ZLIB
+		if (fileInfo.compression_method == Z_DEFLATED) {
+			SeekableReadStream *stream = _memberStreams->createStream();
+			if (!stream)
+				return nullptr;
+			return new ZipInflateReadStream(stream, dataStart, fileInfo.compressed_size,
+			                                fileInfo.uncompressed_size, fileInfo.crc);
+		}
+#endif
 		return nullptr;
+	}
 
-	if (unzGetCurrentFileInfo(_zipFile, &fileInfo, nullptr, 0, nullptr, 0, nullptr, 0) != UNZ_OK)
+	if (unzOpenCurrentFile(_zipFile) != UNZ_OK)
 		return nullptr;
 
 	byte *buffer = (byte *)malloc(fileInfo.uncompressed_size);
@@ -1510,11 +1899,6 @@ SeekableReadStream *ZipArchive::createReadStreamForMember(const String &name) co
 	}
 
 	return new MemoryReadStream(buffer, fileInfo.uncompressed_size, DisposeAfterUse::YES);
-
-	// FIXME: instead of reading all into a memory stream, we could
-	// instead create a new ZipStream class. But then we have to be
-	// careful to handle the case where the client code opens multiple
-	// files in the archive and tries to use them independently.
 }
 
 Archive *makeZipArchive(const String &name) {
@@ -1522,19 +1906,24 @@ Archive *makeZipArchive(const String &name) {
 }
 
 Archive *makeZipArchive(const FSNode &node) {
-	return makeZipArchive(node.createReadStream());
+	unzFile zipFile = unzOpen(node.createReadStream());
+	if (!zipFile)
+		return nullptr;
+	return new ZipArchive(zipFile, new ZipNodeStreamFactory(node));
 }
 
 Archive *makeZipArchive(SeekableReadStream *stream) {
 	if (!stream)
 		return nullptr;
-	unzFile zipFile = unzOpen(stream);
+
+	// The archive and its members all read the same stream
+	SharedPtr<ZipSharedStream> shared(new ZipSharedStream(stream));
+	unzFile zipFile = unzOpen(new ZipSharedReadStream(shared));
 	if (!zipFile) {
-		// stream gets deleted by unzOpen() call if something
-		// goes wrong.
+		// stream gets deleted with the last reference to it
 		return nullptr;
 	}
-	return new ZipArchive(zipFile);
+	return new ZipArchive(zipFile, new ZipSharedStreamFactory(shared));
 }
 
 } // End of namespace Common
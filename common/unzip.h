@@ -52,6 +52,10 @@ Archive *makeZipArchive(const String &name);
  * This factory method creates an Archive instance corresponding to the content
  * of the ZIP compressed file with the given name.
  *
+ * Big members are read from the file on demand, and every stream of a
+ * member opens the file again, so that they can be read on different
+ * threads at the same time.
+ *
  * May return 0 in case of a failure.
  */
 Archive *makeZipArchive(const FSNode &node);
@@ -60,7 +64,12 @@ Archive *makeZipArchive(const FSNode &node);
  * This factory method creates an Archive instance corresponding to the content
  * of the given ZIP compressed datastream.
  * This takes ownership of the stream,  in particular, it is deleted when the
- * ZipArchive is deleted.
+ * ZipArchive and all streams of its members are deleted.
+ *
+ * Big members are read from the stream on demand. As the stream cannot be
+ * opened again, the streams of all the members share it, and take turns in
+ * seeking and reading it under a lock. Prefer makeZipArchive(const FSNode &)
+ * where possible, which gives every member stream its own file handle.
  *
  * May return 0 in case of a failure. In this case stream will still be deleted.
  */
@@ -0,0 +1,75 @@
+#!/usr/bin/env python
+# encoding: utf-8
+#
+# Benchmark for detecting games in many directories, like mass add does.
+#
+# Builds a synthetic tree of fake game directories, filled with random data
+# under file names used by the detection tables of several engines, and times
+# "scummvm --detect --recursive" on it with different numbers of detection
+# threads (see the "detection_threads" config key).
+#
+# Usage: benchmark-detection.py [--dirs N] [--threads 1,0] path/to/scummvm
+import argparse
+import os
+import random
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+# File names looked for by the detectors of various engines, so that their
+# MD5s are computed
+GAME_FILES = (
+	'resource.map', 'resource.000', 'resource.001', '000.lfl', '001.lfl',
+	'monkey.000', 'monkey.001', 'sky.dnr', 'sky.dsk', 'queen.1', 'data.prg',
+	'intro.snd', 'gamedata.dat', 'data.001', 'game.exe', 'install.exe',
+	'text.dat', 'voc.dat', 'logdir', 'picdir', 'viewdir', 'vol.0',
+	'gfx.dat', 'disk1.dat', 'data.dat', 'speech.clu', 'sounds.dat'
+)
+
+def buildTree(root, numDirs, seed):
+	rng = random.Random(seed)
+	for i in range(numDirs):
+		# Group the games like a collection sorted by publisher
+		path = os.path.join(root, 'group%02d' % (i % 16), 'game%04d' % i)
+		os.makedirs(path)
+		for name in rng.sample(GAME_FILES, rng.randint(3, 8)):
+			with open(os.path.join(path, name), 'wb') as f:
+				f.write(os.urandom(rng.randint(1024, 64 * 1024)))
+
+def runDetection(scummvm, root, threads, workDir):
+	# A fresh config and save path for every run, so that no detection cache
+	# is used
+	savePath = os.path.join(workDir, 'saves-%d' % threads)
+	os.makedirs(savePath)
+	config = os.path.join(workDir, 'scummvm-%d.ini' % threads)
+	with open(config, 'w') as f:
+		f.write('[scummvm]\ndetection_threads=%d\nsavepath=%s\n' % (threads, savePath))
+
+	start = time.time()
+	subprocess.call([scummvm, '--config=' + config, '--detect', '--recursive', '--path=' + root],
+	                stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+	return time.time() - start
+
+def main():
+	parser = argparse.ArgumentParser(description='Benchmark detecting games in many directories.')
+	parser.add_argument('scummvm', help='the ScummVM binary')
+	parser.add_argument('--dirs', type=int, default=500, help='the number of fake game directories')
+	parser.add_argument('--threads', default='1,0', help='the thread counts to compare, 0 = one per CPU core')
+	parser.add_argument('--seed', type=int, default=1, help='the seed for the random file names and sizes')
+	args = parser.parse_args()
+
+	workDir = tempfile.mkdtemp(prefix='scummvm-detection-')
+	try:
+		root = os.path.join(workDir, 'games')
+		buildTree(root, args.dirs, args.seed)
+
+		for threads in [int(t) for t in args.threads.split(',')]:
+			elapsed = runDetection(args.scummvm, root, threads, workDir)
+			print('%d directories, detection_threads=%d: %.2f s' % (args.dirs, threads, elapsed))
+	finally:
+		shutil.rmtree(workDir)
+
+if __name__ == '__main__':
+	sys.exit(main())
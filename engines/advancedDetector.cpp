@@ -33,6 +33,7 @@
 #include "gui/gui-manager.h"
 #include "gui/message.h"
 #include "engines/advancedDetector.h"
+#include "engines/detectioncache.h"
 #include "engines/obsolete.h"
 
 /**
@@ -253,7 +254,9 @@ DetectedGames AdvancedMetaEngineDetection::detectGames(const Common::FSList &fsl
 	}
 
 	if (!foundKnownGames) {
-		// Use fallback detector if there were no matches by other means
+		// Use fallback detector if there were no matches by other means. Some
+		// fallback detectors use global state, like SearchMan.
+		DetectionLock lock;
 		ADDetectedGame fallbackDetectionResult = fallbackDetect(allFiles, fslist);
 
 		if (fallbackDetectionResult.desc) {
@@ -467,13 +470,18 @@ bool AdvancedMetaEngineDetection::getFileProperties(const FileMap &allFiles, con
 	if (!allFiles.contains(fname))
 		return false;
 
+	const Common::FSNode node = allFiles[fname];
+	if (DetectionCacheMan.lookup(node, _md5Bytes, fileProps))
+		return true;
+
 	Common::File testFile;
 
-	if (!testFile.open(allFiles[fname]))
+	if (!testFile.open(node))
 		return false;
 
 	fileProps.size = (int32)testFile.size();
 	fileProps.md5 = Common::computeStreamMD5AsString(testFile, _md5Bytes);
+	DetectionCacheMan.store(node, _md5Bytes, fileProps);
 	return true;
 }
 
@@ -499,13 +507,18 @@ bool AdvancedMetaEngine::getFilePropertiesExtern(uint md5Bytes, const FileMap &a
 	if (!allFiles.contains(fname))
 		return false;
 
+	const Common::FSNode node = allFiles[fname];
+	if (DetectionCacheMan.lookup(node, md5Bytes, fileProps))
+		return true;
+
 	Common::File testFile;
 
-	if (!testFile.open(allFiles[fname]))
+	if (!testFile.open(node))
 		return false;
 
 	fileProps.size = (int32)testFile.size();
 	fileProps.md5 = Common::computeStreamMD5AsString(testFile, md5Bytes);
+	DetectionCacheMan.store(node, md5Bytes, fileProps);
 	return true;
 }
 
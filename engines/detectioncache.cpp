@@ -0,0 +1,170 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "engines/detectioncache.h"
+#include "engines/game.h"
+#include "engines/metaengine.h"
+
+#include "common/debug.h"
+#include "common/fs.h"
+#include "common/savefile.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+
+namespace Common {
+DECLARE_SINGLETON(DetectionCache);
+}
+
+/** The name of the cache file, kept with the save files. */
+static const char *const kDetectionCacheFileName = "detection.cache";
+
+/** The first line of the cache file, changed whenever the format changes. */
+static const char *const kDetectionCacheHeader = "ScummVM detection cache 1";
+
+/**
+ * The maximum number of entries kept. When there are more, the cache is
+ * cleared, so that files which have been removed do not accumulate.
+ */
+static const uint kDetectionCacheMaxEntries = 100000;
+
+DetectionCache::DetectionCache() : _loaded(false), _dirty(false), _filesHashed(0), _filesCached(0) {
+}
+
+Common::String DetectionCache::makeKey(const Common::String &path, uint md5Bytes) {
+	return Common::String::format("%u:", md5Bytes) + path;
+}
+
+bool DetectionCache::lookup(const Common::FSNode &node, uint md5Bytes, FileProperties &fileProps) {
+	load();
+
+	uint32 size, modificationTime;
+	const bool hasStats = node.getFileStats(size, modificationTime);
+
+	DetectionLock lock;
+	if (hasStats) {
+		EntryMap::const_iterator entry = _entries.find(makeKey(node.getPath(), md5Bytes));
+		if (entry != _entries.end() && entry->_value.size == size && entry->_value.modificationTime == modificationTime) {
+			fileProps.size = (int32)size;
+			fileProps.md5 = entry->_value.md5;
+			_filesCached++;
+			return true;
+		}
+	}
+
+	_filesHashed++;
+	return false;
+}
+
+void DetectionCache::store(const Common::FSNode &node, uint md5Bytes, const FileProperties &fileProps) {
+	Entry entry;
+	if (!node.getFileStats(entry.size, entry.modificationTime) || entry.size != (uint32)fileProps.size)
+		return;
+
+	entry.md5Bytes = md5Bytes;
+	entry.md5 = fileProps.md5;
+	entry.path = node.getPath();
+
+	DetectionLock lock;
+	if (_entries.size() >= kDetectionCacheMaxEntries)
+		_entries.clear();
+
+	_entries[makeKey(entry.path, md5Bytes)] = entry;
+	_dirty = true;
+}
+
+void DetectionCache::load() {
+	if (_loaded)
+		return;
+
+	// Games detected from the command line are detected before the backend
+	// is fully set up. The cache is loaded by a later call then.
+	Common::SaveFileManager *saveFileMan = g_system->getSavefileManager();
+	if (!saveFileMan)
+		return;
+
+	_loaded = true;
+	Common::InSaveFile *file = saveFileMan->openForLoading(kDetectionCacheFileName);
+	if (!file)
+		return;
+
+	if (file->readLine() != kDetectionCacheHeader) {
+		debug(1, "Ignoring outdated detection cache");
+		delete file;
+		return;
+	}
+
+	// Each line holds the MD5 size, the file size, the modification time,
+	// the MD5 and the path of one file
+	while (!file->eos() && !file->err()) {
+		Common::String line = file->readLine();
+		Entry entry;
+		char md5[33];
+		int pathPos = 0;
+		if (sscanf(line.c_str(), "%u %u %u %32s %n", &entry.md5Bytes, &entry.size, &entry.modificationTime, md5, &pathPos) != 4 || !pathPos)
+			continue;
+
+		entry.md5 = md5;
+		entry.path = line.c_str() + pathPos;
+
+		// Entries stored before loading are more recent
+		const Common::String key = makeKey(entry.path, entry.md5Bytes);
+		if (!_entries.contains(key))
+			_entries[key] = entry;
+	}
+
+	delete file;
+	debug(2, "Loaded %u entries from the detection cache", _entries.size());
+}
+
+void DetectionCache::flush() {
+	load();
+	if (!_dirty || !_loaded)
+		return;
+
+	Common::OutSaveFile *file = g_system->getSavefileManager()->openForSaving(kDetectionCacheFileName);
+	if (!file) {
+		warning("Could not write the detection cache");
+		return;
+	}
+
+	file->writeString(kDetectionCacheHeader);
+	file->writeByte('\n');
+
+	for (EntryMap::const_iterator i = _entries.begin(); i != _entries.end(); ++i) {
+		const Entry &entry = i->_value;
+		file->writeString(Common::String::format("%u %u %u %s %s\n", entry.md5Bytes, entry.size,
+		                                         entry.modificationTime, entry.md5.c_str(), entry.path.c_str()));
+	}
+
+	file->finalize();
+	delete file;
+	_dirty = false;
+}
+
+Common::String DetectionCache::getStats() const {
+	return Common::String::format("Detection: %u files hashed, %u served from the cache", _filesHashed, _filesCached);
+}
+
+void DetectionCache::resetStats() {
+	_filesHashed = 0;
+	_filesCached = 0;
+}
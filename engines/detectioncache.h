@@ -0,0 +1,129 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef ENGINES_DETECTIONCACHE_H
+#define ENGINES_DETECTIONCACHE_H
+
+#include "common/hash-str.h"
+#include "common/hashmap.h"
+#include "common/singleton.h"
+#include "common/str.h"
+
+namespace Common {
+class FSNode;
+}
+
+struct FileProperties;
+
+/**
+ * @defgroup engines_detectioncache Detection cache
+ * @ingroup engines
+ *
+ * @brief A persistent cache of the MD5s computed while detecting games.
+ * @{
+ */
+
+/**
+ * A persistent cache of the file properties used for detecting games.
+ *
+ * Computing the MD5s of the files of every game on each launcher scan,
+ * mass add and command line start is slow for big game collections. The
+ * results are stored in a file, and reused as long as the size and the
+ * modification time of a file stay the same.
+ *
+ * Only the properties of the files are cached, not which games they
+ * match, so changes to the detection tables take effect immediately.
+ *
+ * lookup() and store() may be called by detectors running on several
+ * threads, everything else must be called on the main thread.
+ */
+class DetectionCache : public Common::Singleton<DetectionCache> {
+public:
+	/**
+	 * Look up the properties of a file.
+	 *
+	 * @param node      The file.
+	 * @param md5Bytes  The number of bytes the MD5 is computed for.
+	 * @param fileProps The properties of the file, if they are cached.
+	 * @return true if the properties are cached and the file is unchanged.
+	 */
+	bool lookup(const Common::FSNode &node, uint md5Bytes, FileProperties &fileProps);
+
+	/**
+	 * Store the properties of a file computed after a failed lookup().
+	 * Nothing is stored for files whose modification time is unknown.
+	 */
+	void store(const Common::FSNode &node, uint md5Bytes, const FileProperties &fileProps);
+
+	/**
+	 * Read the cache from its file, if not done yet and the backend has set
+	 * up its save file manager. This is done by lookup(), too.
+	 */
+	void load();
+
+	/**
+	 * Write the cache to its file, if anything has been stored. Before the
+	 * backend has set up its save file manager, this does nothing.
+	 */
+	void flush();
+
+	/**
+	 * Return a line showing how many files were hashed, and how many
+	 * were served from the cache.
+	 */
+	Common::String getStats() const;
+
+	/**
+	 * Reset the statistics returned by getStats().
+	 */
+	void resetStats();
+
+private:
+	friend class Common::Singleton<SingletonBaseType>;
+	DetectionCache();
+
+	struct Entry {
+		uint md5Bytes;
+		uint32 size;
+		uint32 modificationTime;
+		Common::String md5;
+		Common::String path;
+	};
+
+	typedef Common::HashMap<Common::String, Entry> EntryMap;
+
+	static Common::String makeKey(const Common::String &path, uint md5Bytes);
+
+	EntryMap _entries;
+	bool _loaded;
+	bool _dirty;
+
+	uint32 _filesHashed;
+	uint32 _filesCached;
+};
+
+/** Shortcut for accessing the detection cache. */
+#define DetectionCacheMan DetectionCache::instance()
+
+/** @} */
+
+#endif
@@ -22,6 +22,8 @@
 
 #include "common/config-manager.h"
 #include "graphics/renderer.h"
+#include "graphics/tinygl/zhiz.h"
+#include "graphics/tinygl/ztiles.h"
 
 #include "engines/grim/debugger.h"
 #include "engines/grim/md5check.h"
@@ -38,6 +40,8 @@ Debugger::Debugger() :
 	registerCmd("set_renderer", WRAP_METHOD(Debugger, cmd_set_renderer));
 	registerCmd("save", WRAP_METHOD(Debugger, cmd_save));
 	registerCmd("load", WRAP_METHOD(Debugger, cmd_load));
+	registerCmd("tinygl_tiles", WRAP_METHOD(Debugger, cmd_tinygl_tiles));
+	registerCmd("tinygl_hiz", WRAP_METHOD(Debugger, cmd_tinygl_hiz));
 }
 
 Debugger::~Debugger() {
@@ -127,4 +131,52 @@ bool Debugger::cmd_load(int argc, const char **argv) {
 	return true;
 }
 
+bool Debugger::cmd_tinygl_tiles(int argc, const char **argv) {
+	if (argc > 1) {
+		if (strcmp(argv[1], "reset")) {
+			debugPrintf("Usage: tinygl_tiles [reset]\n");
+			return true;
+		}
+		TinyGL::tglResetRenderStats();
+	}
+
+	TinyGL::RenderStats stats;
+	if (!TinyGL::tglGetRenderStats(stats)) {
+		debugPrintf("The software renderer does not render in tiles\n");
+		return true;
+	}
+
+	debugPrintf("%d threads, %d frames, %d batches\n", stats.threads, stats.frames, stats.batches);
+	debugPrintf("Tiled: %d draw calls in %d ms\n", stats.tiledDrawCalls, stats.tiledTime);
+	debugPrintf("Serial: %d draw calls in %d ms\n", stats.serialDrawCalls, stats.serialTime);
+	for (uint i = 0; i < stats.tiles.size(); i++) {
+		const TinyGL::TileStats &tile = stats.tiles[i];
+		debugPrintf("Rows %3d-%3d: %6d tiles, %7d draw calls, %8d pixels per frame\n",
+		            tile.top, tile.bottom - 1, tile.tiles, tile.drawCalls, (uint32)(tile.pixels / MAX<uint32>(stats.frames, 1)));
+	}
+	return true;
+}
+
+bool Debugger::cmd_tinygl_hiz(int argc, const char **argv) {
+	if (argc > 1) {
+		if (strcmp(argv[1], "reset")) {
+			debugPrintf("Usage: tinygl_hiz [reset]\n");
+			return true;
+		}
+		TinyGL::tglResetHierarchicalZStats();
+	}
+
+	TinyGL::HierarchicalZStats stats;
+	if (!TinyGL::tglGetHierarchicalZStats(stats)) {
+		debugPrintf("The software renderer does not reject hidden triangles early, set tinygl_hiz to enable it\n");
+		return true;
+	}
+
+	debugPrintf("Triangles: %d of %d rejected\n", stats.rejectedTriangles, stats.triangles);
+	debugPrintf("Spans: %d of %d rejected\n", stats.rejectedSpans, stats.spans);
+	debugPrintf("Fragments: %d rejected\n", (uint32)stats.rejectedFragments);
+	debugPrintf("Blocks: %d depth bounds read from the z buffer\n", stats.blockUpdates);
+	return true;
+}
+
 }
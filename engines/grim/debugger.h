@@ -40,6 +40,8 @@ public:
 	bool cmd_set_renderer(int argc, const char **argv);
 	bool cmd_save(int argc, const char **argv);
 	bool cmd_load(int argc, const char **argv);
+	bool cmd_tinygl_tiles(int argc, const char **argv);
+	bool cmd_tinygl_hiz(int argc, const char **argv);
 };
 
 }
@@ -27,6 +27,7 @@
 #include "common/scummsys.h"
 #include "common/error.h"
 #include "common/array.h"
+#include "common/system.h"
 
 #include "engines/game.h"
 #include "engines/savestate.h"
@@ -38,6 +39,7 @@ class OSystem;
 
 namespace Common {
 class Keymap;
+class ThreadPool;
 class FSList;
 class OutSaveFile;
 class String;
@@ -519,6 +521,40 @@ public:
 	 */
 	DetectionResults detectGames(const Common::FSList &fslist) const;
 
+	/**
+	 * Detect the games in several directories at once, spreading the work
+	 * over the threads of the given pool.
+	 *
+	 * Each detector is only used by one thread at a time, so it may keep
+	 * state while detecting. While accessing global state, like SearchMan,
+	 * detectors must hold a DetectionLock.
+	 *
+	 * @param dirs The contents of the directories, as passed to detectGames().
+	 * @param pool The threads to run the detection on.
+	 * @return The detection results, one for each directory.
+	 */
+	Common::Array<DetectionResults> detectGames(const Common::Array<Common::FSList> &dirs, Common::ThreadPool &pool) const;
+
+	/**
+	 * Set up what detecting games on the threads of the given pool needs
+	 * from the backend, before detectGamesOnPool() is called on a thread
+	 * other than the main one. This must be called on the main thread.
+	 */
+	void beginDetection(Common::ThreadPool &pool) const;
+
+	/**
+	 * Detect the games in several directories at once, like
+	 * detectGames(dirs, pool). Unlike that, this may be called on any
+	 * thread, between beginDetection() and endDetection().
+	 */
+	Common::Array<DetectionResults> detectGamesOnPool(const Common::Array<Common::FSList> &dirs, Common::ThreadPool &pool) const;
+
+	/**
+	 * Store what was learned while detecting games for the next detection.
+	 * This must be called on the main thread.
+	 */
+	void endDetection() const;
+
 	/** Find a plugin by its engine ID. */
 	const Plugin *findPlugin(const Common::String &engineId) const;
 
@@ -562,9 +598,33 @@ private:
 
 	/** Use heuristics to complete a target lacking an engine ID. */
 	void upgradeTargetForEngineId(const Common::String &target) const;
+
+	friend class Common::Singleton<SingletonBaseType>;
+	friend class DetectionLock;
+	EngineManager();
+	~EngineManager();
+
+	/** Created by the first detection running on several threads. */
+	mutable OSystem::MutexRef _detectionMutex;
 };
 
 /** Convenience shortcut for accessing the engine manager. */
 #define EngineMan EngineManager::instance()
+
+/**
+ * Serializes the accesses of detectors to global state, like SearchMan,
+ * while games are detected on several threads. Otherwise, this does
+ * nothing.
+ *
+ * @see EngineManager::detectGames()
+ */
+class DetectionLock : Common::NonCopyable {
+public:
+	DetectionLock();
+	~DetectionLock();
+
+private:
+	OSystem::MutexRef _mutex;
+};
 /** @} */
 #endif
@@ -29,6 +29,8 @@
 #include "engines/myst3/script.h"
 #include "engines/myst3/state.h"
 
+#include "graphics/tinygl/ztiles.h"
+
 namespace Myst3 {
 
 Console::Console(Myst3Engine *vm) : GUI::Debugger(), _vm(vm) {
@@ -44,6 +46,7 @@ Console::Console(Myst3Engine *vm) : GUI::Debugger(), _vm(vm) {
 	registerCmd("fillInventory",			WRAP_METHOD(Console, Cmd_FillInventory));
 	registerCmd("dumpArchive",			WRAP_METHOD(Console, Cmd_DumpArchive));
 	registerCmd("dumpMasks",			WRAP_METHOD(Console, Cmd_DumpMasks));
+	registerCmd("tinyglTiles",			WRAP_METHOD(Console, Cmd_TinyGLTiles));
 }
 
 Console::~Console() {
@@ -455,6 +458,36 @@ bool Console::Cmd_DumpMasks(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::Cmd_TinyGLTiles(int argc, const char **argv) {
+	if (argc != 1 && (argc != 2 || strcmp(argv[1], "reset"))) {
+		debugPrintf("Show how the software renderer renders in tiles.\n");
+		debugPrintf("Usage :\n");
+		debugPrintf("tinyglTiles [reset]\n");
+		return true;
+	}
+
+	if (argc == 2)
+		TinyGL::tglResetRenderStats();
+
+	TinyGL::RenderStats stats;
+	if (!TinyGL::tglGetRenderStats(stats)) {
+		debugPrintf("The software renderer does not render in tiles\n");
+		return true;
+	}
+
+	debugPrintf("%d threads, %d frames, %d batches\n", stats.threads, stats.frames, stats.batches);
+	debugPrintf("Tiled: %d draw calls in %d ms\n", stats.tiledDrawCalls, stats.tiledTime);
+	debugPrintf("Serial: %d draw calls in %d ms\n", stats.serialDrawCalls, stats.serialTime);
+
+	for (uint i = 0; i < stats.tiles.size(); i++) {
+		const TinyGL::TileStats &tile = stats.tiles[i];
+		debugPrintf("Rows %3d-%3d: %6d tiles, %7d draw calls, %8d pixels per frame\n",
+				tile.top, tile.bottom - 1, tile.tiles, tile.drawCalls, (uint32)(tile.pixels / MAX<uint32>(stats.frames, 1)));
+	}
+
+	return true;
+}
+
 bool Console::dumpFaceMask(uint16 index, int face, Archive::ResourceType type) {
 	ResourceDescription maskDesc = _vm->getFileDescription("", index, face, type);
 
@@ -66,6 +66,8 @@ void TinyGLRenderer::init() {
 	_fb = new TinyGL::FrameBuffer(kOriginalWidth, kOriginalHeight, g_system->getScreenFormat());
 	TinyGL::glInit(_fb, 512);
 	tglEnableDirtyRects(ConfMan.getBool("dirtyrects"));
+	tglSetRenderThreads(ConfMan.getInt("tinygl_threads"));
+	tglEnableHierarchicalZ(ConfMan.getBool("tinygl_hiz"));
 
 	tglMatrixMode(TGL_PROJECTION);
 	tglLoadIdentity();
@@ -115,6 +115,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("resource_id",		WRAP_METHOD(Console, cmdResourceId));
 	registerCmd("resource_info",		WRAP_METHOD(Console, cmdResourceInfo));
 	registerCmd("resource_types",		WRAP_METHOD(Console, cmdResourceTypes));
+	registerCmd("prefetch_stats",		WRAP_METHOD(Console, cmdPrefetchStats));
 	registerCmd("list",				WRAP_METHOD(Console, cmdList));
 	registerCmd("alloc_list",				WRAP_METHOD(Console, cmdAllocList));
 	registerCmd("hexgrep",			WRAP_METHOD(Console, cmdHexgrep));
@@ -346,6 +347,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf(" resource_id - Identifies a resource number by splitting it up in resource type and resource number\n");
 	debugPrintf(" resource_info - Shows info about a resource\n");
 	debugPrintf(" resource_types - Shows the valid resource types\n");
+	debugPrintf(" prefetch_stats - Shows how many resources were decompressed in the background, and the time spent loading\n");
 	debugPrintf(" list - Lists all the resources of a given type\n");
 	debugPrintf(" alloc_list - Lists all allocated resources\n");
 	debugPrintf(" hexgrep - Searches some resources for a particular sequence of bytes, represented as hexadecimal numbers\n");
@@ -1108,6 +1110,39 @@ bool Console::cmdResourceTypes(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdPrefetchStats(int argc, const char **argv) {
+	ResourceManager *resMan = _engine->getResMan();
+
+	if (argc == 2 && !scumm_stricmp(argv[1], "reset")) {
+		resMan->resetLoadStats();
+		debugPrintf("Statistics reset\n");
+		return true;
+	} else if (argc != 1) {
+		debugPrintf("Shows how many resources of each type were decompressed in the background\n");
+		debugPrintf("before they were needed, the time spent loading them on the main thread and\n");
+		debugPrintf("the time the background thread spent decompressing them.\n");
+		debugPrintf("Usage: %s [reset]\n", argv[0]);
+		return true;
+	}
+
+	if (!resMan->isPrefetchAvailable())
+		debugPrintf("Resources are not decompressed in the background on this system\n");
+
+	debugPrintf("%-12s %8s %6s %6s %6s %6s %8s %9s %9s %9s\n", "Type", "Prefetch", "Hits", "Waits", "Misses", "Evict", "Hit rate", "Load ms", "Wait ms", "Unpack ms");
+	for (int i = 0; i < kResourceTypeInvalid; i++) {
+		const ResourceManager::LoadStats &stats = resMan->getLoadStats((ResourceType)i);
+		const uint32 loads = stats.hits + stats.waits + stats.misses;
+		if (!loads && !stats.prefetches)
+			continue;
+
+		debugPrintf("%-12s %8u %6u %6u %6u %6u %7u%% %9u %9u %9u\n", getResourceTypeName((ResourceType)i),
+					stats.prefetches, stats.hits, stats.waits, stats.misses, stats.evictions,
+					loads ? stats.hits * 100 / loads : 0, stats.loadTime, stats.waitTime, stats.decompressTime);
+	}
+
+	return true;
+}
+
 bool Console::cmdHexgrep(int argc, const char **argv) {
 	if (argc < 4) {
 		debugPrintf("Searches some resources for a particular sequence of bytes, represented as decimal or hexadecimal numbers.\n");
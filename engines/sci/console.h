@@ -76,6 +76,7 @@ private:
 	bool cmdResourceId(int argc, const char **argv);
 	bool cmdResourceInfo(int argc, const char **argv);
 	bool cmdResourceTypes(int argc, const char **argv);
+	bool cmdPrefetchStats(int argc, const char **argv);
 	bool cmdList(int argc, const char **argv);
 	bool cmdResourceIntegrityDump(int argc, const char **argv);
 	bool cmdAllocList(int argc, const char **argv);
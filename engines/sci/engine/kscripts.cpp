@@ -46,6 +46,10 @@ reg_t kLoad(EngineState *s, int argc, reg_t *argv) {
 	if (restype == kResourceTypeMemory)
 		return s->_segMan->allocateHunkEntry("kLoad()", resnr);
 
+	// Scripts load resources some time before using them, which gives the
+	// resource manager time to decompress them in the background
+	g_sci->getResMan()->prefetchResource(ResourceId(restype, resnr));
+
 	return make_reg(0, ((restype << 11) | resnr)); // Return the resource identifier as handle
 }
 
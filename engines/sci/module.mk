@@ -69,6 +69,7 @@ MODULE_OBJS := \
 	resource/resource.o \
 	resource/resource_audio.o \
 	resource/resource_patcher.o \
+	resource/resource_prefetcher.o \
 	sound/audio.o \
 	sound/midiparser_sci.o \
 	sound/music.o \
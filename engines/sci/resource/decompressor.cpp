@@ -44,6 +44,28 @@ int Decompressor::unpack(Common::ReadStream *src, byte *dest, uint32 nPacked, ui
 	return (src->eos() || src->err()) ? 1 : 0;
 }
 
+Decompressor *Decompressor::create(ResourceCompression compression) {
+	switch (compression) {
+	case kCompNone:
+		return new Decompressor;
+	case kCompHuffman:
+		return new DecompressorHuffman;
+	case kCompLZW:
+	case kCompLZW1:
+	case kCompLZW1View:
+	case kCompLZW1Pic:
+		return new DecompressorLZW(compression);
+	case kCompDCL:
+		return new DecompressorDCL;
+#ifdef ENABLE_SCI32
+	case kCompSTACpack:
+		return new DecompressorLZS;
+#endif
+	default:
+		return nullptr;
+	}
+}
+
 void Decompressor::init(Common::ReadStream *src, byte *dest, uint32 nPacked,
                         uint32 nUnpacked) {
 	_src = src;
@@ -57,6 +57,13 @@ public:
 
 	virtual int unpack(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
 
+	/**
+	 * Creates a decompressor for the given compression method.
+	 * @param compression	the compression method
+	 * @return the decompressor, or nullptr if the method is not supported
+	 */
+	static Decompressor *create(ResourceCompression compression);
+
 protected:
 	/**
 	 * Initialize decompressor.
@@ -25,6 +25,7 @@
 #include "common/file.h"
 #include "common/fs.h"
 #include "common/macresman.h"
+#include "common/system.h"
 #include "common/textconsole.h"
 #include "common/translation.h"
 #ifdef ENABLE_SCI32
@@ -36,6 +37,7 @@
 #include "sci/resource/resource.h"
 #include "sci/resource/resource_intern.h"
 #include "sci/resource/resource_patcher.h"
+#include "sci/resource/resource_prefetcher.h"
 #include "sci/util.h"
 
 namespace Sci {
@@ -211,6 +213,7 @@ Resource::Resource(ResourceManager *resMan, ResourceId id) : SciSpan<const byte>
 	_fileOffset = 0;
 	_status = kResStatusNoMalloc;
 	_lockers = 0;
+	_prefetched = false;
 	_source = nullptr;
 	_header = nullptr;
 	_headerSize = 0;
@@ -227,6 +230,7 @@ void Resource::unalloc() {
 	delete[] _data;
 	_data = nullptr;
 	_status = kResStatusNoMalloc;
+	_prefetched = false;
 }
 
 void Resource::writeToStream(Common::WriteStream *stream) const {
@@ -600,11 +604,7 @@ Common::SeekableReadStream *ResourceSource::getVolumeFile(ResourceManager *resMa
 	return fileStream;
 }
 
-void ResourceSource::loadResource(ResourceManager *resMan, Resource *res) {
-	Common::SeekableReadStream *fileStream = getVolumeFile(resMan, res);
-	if (!fileStream)
-		return;
-
+ResVersion ResourceSource::seekToResource(ResourceManager *resMan, Resource *res, Common::SeekableReadStream *fileStream) {
 	fileStream->seek(0, SEEK_SET);
 	ResourceType type = resMan->convertResType(fileStream->readByte());
 	ResVersion volVersion = resMan->getVolVersion();
@@ -613,7 +613,16 @@ void ResourceSource::loadResource(ResourceManager *resMan, Resource *res) {
 	if (((type == kResourceTypeMessage && res->getType() == kResourceTypeMessage) || (type == kResourceTypeText && res->getType() == kResourceTypeText)) && g_sci->getLanguage() == Common::KO_KOR)
 		volVersion = kResVersionSci11;
 	fileStream->seek(res->_fileOffset, SEEK_SET);
-	
+	return volVersion;
+}
+
+void ResourceSource::loadResource(ResourceManager *resMan, Resource *res) {
+	Common::SeekableReadStream *fileStream = getVolumeFile(resMan, res);
+	if (!fileStream)
+		return;
+
+	ResVersion volVersion = seekToResource(resMan, res, fileStream);
+
 	int error = res->decompress(volVersion, fileStream);
 	if (error) {
 		warning("Error %d occurred while reading %s from resource file %s: %s",
@@ -986,7 +995,7 @@ void ResourceManager::freeResourceSources() {
 }
 
 ResourceManager::ResourceManager(const bool detectionMode) :
-	_detectionMode(detectionMode) {}
+	_detectionMode(detectionMode), _patcher(nullptr), _prefetcher(nullptr) {}
 
 void ResourceManager::init() {
 	_maxMemoryLRU = 256 * 1024; // 256KiB
@@ -1005,6 +1014,11 @@ void ResourceManager::init() {
 		_patcher = NULL;
 	};
 
+	// Resources are only decompressed ahead of time while playing
+	if (g_sci && !_detectionMode)
+		_prefetcher = new ResourcePrefetcher();
+	resetLoadStats();
+
 	// FIXME: put this in an Init() function, so that we can error out if detection fails completely
 
 	_mapVersion = detectMapVersion();
@@ -1092,6 +1106,9 @@ void ResourceManager::init() {
 }
 
 ResourceManager::~ResourceManager() {
+	// stopping the worker thread before the resources are gone
+	delete _prefetcher;
+
 	// freeing resources
 	ResourceMap::iterator itr = _resMap.begin();
 	while (itr != _resMap.end()) {
@@ -1154,6 +1171,8 @@ void ResourceManager::freeOldResources() {
 		assert(!_LRU.empty());
 		Resource *goner = _LRU.back();
 		removeFromLRU(goner);
+		if (goner->_prefetched)
+			_loadStats[goner->getType()].evictions++;
 		goner->unalloc();
 #ifdef SCI_VERBOSE_RESMAN
 		debug("resMan-debug: LRU: Freeing %s (%d bytes)", goner->_id.toString().c_str(), goner->size);
@@ -1192,14 +1211,23 @@ Resource *ResourceManager::findResource(ResourceId id, bool lock) {
 	} else if (id.getType() == kResourceTypeSync36) {
 		id = remapSync36ResourceId(id);
 	}
+	if (_prefetcher)
+		publishPrefetchedResources();
+
 	Resource *retval = testResource(id);
 
 	if (!retval)
 		return NULL;
 
-	if (retval->_status == kResStatusNoMalloc)
-		loadResource(retval);
-	else if (retval->_status == kResStatusEnqueued)
+	LoadStats &stats = _loadStats[retval->getType()];
+	if (retval->_status == kResStatusNoMalloc) {
+		if (!takePrefetchedResource(id)) {
+			const uint32 start = g_system->getMillis();
+			loadResource(retval);
+			stats.misses++;
+			stats.loadTime += g_system->getMillis() - start;
+		}
+	} else if (retval->_status == kResStatusEnqueued)
 		// The resource is removed from its current position
 		// in the LRU list because it has been requested
 		// again. Below, it will either be locked, or it
@@ -1207,6 +1235,11 @@ Resource *ResourceManager::findResource(ResourceId id, bool lock) {
 		// recent' position.
 		removeFromLRU(retval);
 
+	if (retval->_prefetched) {
+		stats.hits++;
+		retval->_prefetched = false;
+	}
+
 	// Unless an error occurred, the resource is now either
 	// locked or allocated, but never queued or freed.
 
@@ -1232,6 +1265,113 @@ Resource *ResourceManager::findResource(ResourceId id, bool lock) {
 	}
 }
 
+void ResourceManager::prefetchResource(ResourceId id) {
+	if (!_prefetcher || !_prefetcher->isAvailable())
+		return;
+
+	// Patches and audio are loaded differently, and are rarely compressed
+	Resource *res = testResource(id);
+	if (!res || res->_status != kResStatusNoMalloc || res->_source->getSourceType() != kSourceVolume)
+		return;
+	if (_prefetcher->isFull() || _prefetcher->contains(id))
+		return;
+
+	// The volume files are shared, so the compressed data is read here
+	Common::SeekableReadStream *fileStream = res->_source->getVolumeFile(this, res);
+	if (!fileStream)
+		return;
+
+	PrefetchJob job;
+	job.id = id;
+	job.resource = res;
+	job.source = res->_source;
+	job.fileOffset = res->_fileOffset;
+	job.packed = nullptr;
+	job.data = nullptr;
+	job.error = SCI_ERROR_NONE;
+	job.decompressTime = 0;
+
+	ResVersion volVersion = res->_source->seekToResource(this, res, fileStream);
+	// Uncompressed resources are only copied, which isn't worth a job
+	if (!res->readResourceInfo(volVersion, fileStream, job.packedSize, job.compression) &&
+		job.compression != kCompNone && job.packedSize <= SCI_MAX_RESOURCE_SIZE && res->_size <= SCI_MAX_RESOURCE_SIZE) {
+		job.packed = new byte[job.packedSize];
+		job.size = res->_size;
+		if (fileStream->read(job.packed, job.packedSize) != job.packedSize) {
+			delete[] job.packed;
+		} else if (_prefetcher->queue(job)) {
+			_loadStats[res->getType()].prefetches++;
+		}
+	}
+
+	disposeVolumeFileStream(fileStream, res->_source);
+}
+
+bool ResourceManager::takePrefetchedResource(ResourceId id) {
+	if (!_prefetcher)
+		return false;
+
+	const uint32 start = g_system->getMillis();
+	PrefetchJob job;
+	const ResourcePrefetcher::TakeResult result = _prefetcher->take(id, job);
+	if (result == ResourcePrefetcher::kTakeNotQueued || !usePrefetchedResource(job))
+		return false;
+
+	// Finished jobs are counted as hits by findResource()
+	Resource *res = testResource(id);
+	LoadStats &stats = _loadStats[res->getType()];
+	if (result == ResourcePrefetcher::kTakeWaited) {
+		stats.waits++;
+		stats.waitTime += g_system->getMillis() - start;
+		stats.decompressTime += job.decompressTime;
+		res->_prefetched = false;
+	} else if (result == ResourcePrefetcher::kTakeNotStarted) {
+		stats.misses++;
+		stats.loadTime += g_system->getMillis() - start;
+		res->_prefetched = false;
+	}
+	return true;
+}
+
+void ResourceManager::publishPrefetchedResources() {
+	PrefetchJob job;
+	while (_prefetcher->takeFinished(job)) {
+		if (usePrefetchedResource(job)) {
+			Resource *res = testResource(job.id);
+			_loadStats[res->getType()].decompressTime += job.decompressTime;
+			addToLRU(res);
+		}
+	}
+}
+
+bool ResourceManager::usePrefetchedResource(const PrefetchJob &job) {
+	// The resource may have been loaded, replaced or removed since the job
+	// was queued. Errors are left to be reported by the regular loading.
+	Resource *res = testResource(job.id);
+	if (job.error || res != job.resource || res->_status != kResStatusNoMalloc ||
+		res->_source != job.source || res->_fileOffset != job.fileOffset) {
+		delete[] job.data;
+		return false;
+	}
+
+	res->_data = job.data;
+	res->_size = job.size;
+	res->_status = kResStatusAllocated;
+	res->trimAudioSize();
+	if (_patcher)
+		_patcher->applyPatch(*res);
+	res->_prefetched = true;
+	return true;
+}
+
+bool ResourceManager::isPrefetchAvailable() const {
+	return _prefetcher && _prefetcher->isAvailable();
+}
+
+void ResourceManager::resetLoadStats() {
+	memset(_loadStats, 0, sizeof(_loadStats));
+}
+
 void ResourceManager::unlockResource(Resource *res) {
 	assert(res);
 
@@ -2354,29 +2494,8 @@ int Resource::decompress(ResVersion volVersion, Common::SeekableReadStream *file
 		return errorNum;
 
 	// getting a decompressor
-	Decompressor *dec = NULL;
-	switch (compression) {
-	case kCompNone:
-		dec = new Decompressor;
-		break;
-	case kCompHuffman:
-		dec = new DecompressorHuffman;
-		break;
-	case kCompLZW:
-	case kCompLZW1:
-	case kCompLZW1View:
-	case kCompLZW1Pic:
-		dec = new DecompressorLZW(compression);
-		break;
-	case kCompDCL:
-		dec = new DecompressorDCL;
-		break;
-#ifdef ENABLE_SCI32
-	case kCompSTACpack:
-		dec = new DecompressorLZS;
-		break;
-#endif
-	default:
+	Decompressor *dec = Decompressor::create(compression);
+	if (!dec) {
 		error("Resource %s: Compression method %d not supported", _id.toString().c_str(), compression);
 		return SCI_ERROR_UNKNOWN_COMPRESSION;
 	}
@@ -2385,29 +2504,32 @@ int Resource::decompress(ResVersion volVersion, Common::SeekableReadStream *file
 	_data = ptr;
 	_status = kResStatusAllocated;
 	errorNum = ptr ? dec->unpack(file, ptr, szPacked, _size) : SCI_ERROR_RESOURCE_TOO_BIG;
-	if (errorNum) {
+	if (errorNum)
 		unalloc();
-	} else {
-		// At least Lighthouse puts sound effects in RESSCI.00n/RESSCI.PAT
-		// instead of using a RESOURCE.SFX
-		if (getType() == kResourceTypeAudio) {
-			const uint8 headerSize = ptr[1];
-			if (headerSize < 11) {
-				error("Unexpected audio header size for %s: should be >= 11, but got %d", _id.toString().c_str(), headerSize);
-			}
-			const uint32 audioSize = READ_LE_UINT32(ptr + 9);
-			const uint32 calculatedTotalSize = audioSize + headerSize + kResourceHeaderSize;
-			if (calculatedTotalSize != _size) {
-				warning("Unexpected audio file size: the size of %s in %s is %d, but the volume says it should be %d", _id.toString().c_str(), _source->getLocationName().c_str(), calculatedTotalSize, _size);
-			}
-			_size = MIN(_size - kResourceHeaderSize, headerSize + audioSize);
-		}
-	}
+	else
+		trimAudioSize();
 
 	delete dec;
 	return errorNum;
 }
 
+void Resource::trimAudioSize() {
+	// At least Lighthouse puts sound effects in RESSCI.00n/RESSCI.PAT
+	// instead of using a RESOURCE.SFX
+	if (getType() == kResourceTypeAudio) {
+		const uint8 headerSize = _data[1];
+		if (headerSize < 11) {
+			error("Unexpected audio header size for %s: should be >= 11, but got %d", _id.toString().c_str(), headerSize);
+		}
+		const uint32 audioSize = READ_LE_UINT32(_data + 9);
+		const uint32 calculatedTotalSize = audioSize + headerSize + kResourceHeaderSize;
+		if (calculatedTotalSize != _size) {
+			warning("Unexpected audio file size: the size of %s in %s is %d, but the volume says it should be %d", _id.toString().c_str(), _source->getLocationName().c_str(), calculatedTotalSize, _size);
+		}
+		_size = MIN(_size - kResourceHeaderSize, headerSize + audioSize);
+	}
+}
+
 ResourceCompression ResourceManager::getViewCompression() {
 	int viewsTested = 0;
 
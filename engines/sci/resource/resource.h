@@ -146,6 +146,8 @@ enum ResVersion {
 class ResourceManager;
 class ResourceSource;
 class ResourcePatcher;
+class ResourcePrefetcher;
+struct PrefetchJob;
 
 class ResourceId {
 	static inline ResourceType fixupType(ResourceType type) {
@@ -298,6 +300,7 @@ protected:
 	int32 _fileOffset; /**< Offset in file */
 	ResourceStatus _status;
 	uint16 _lockers; /**< Number of places where this resource was locked */
+	bool _prefetched; /**< Decompressed ahead of time, and not used since */
 	ResourceSource *_source;
 	ResourceManager *_resMan;
 
@@ -308,6 +311,7 @@ protected:
 	bool loadFromAudioVolumeSCI11(Common::SeekableReadStream *file);
 	int decompress(ResVersion volVersion, Common::SeekableReadStream *file);
 	int readResourceInfo(ResVersion volVersion, Common::SeekableReadStream *file, uint32 &szPacked, ResourceCompression &compression);
+	void trimAudioSize();
 };
 
 typedef Common::HashMap<ResourceId, Resource *, ResourceIdHash> ResourceMap;
@@ -369,6 +373,37 @@ public:
 	 */
 	void unlockResource(Resource *res);
 
+	/**
+	 * Starts decompressing a resource on a worker thread, so that it is
+	 * ready when findResource() is called for it. Only compressed resources
+	 * in volume files are prefetched, and nothing happens if the backend
+	 * has no threads or too many resources are prefetched already.
+	 * @param id	The resource which is going to be used soon
+	 */
+	void prefetchResource(ResourceId id);
+
+	/**
+	 * Statistics about loading the resources of one type, for the debugger.
+	 */
+	struct LoadStats {
+		uint32 prefetches;	///< Resources queued for decompression on the worker thread
+		uint32 hits;		///< Loads of resources which had been decompressed in time
+		uint32 waits;		///< Loads which waited for the worker thread
+		uint32 misses;		///< Loads on the main thread
+		uint32 evictions;	///< Prefetched resources which were freed before being used
+		uint32 loadTime;	///< Milliseconds spent on loads on the main thread
+		uint32 waitTime;	///< Milliseconds spent waiting for the worker thread
+		uint32 decompressTime;	///< Milliseconds the worker thread spent decompressing
+	};
+
+	/**
+	 * Returns whether resources can be decompressed on a worker thread.
+	 */
+	bool isPrefetchAvailable() const;
+
+	const LoadStats &getLoadStats(ResourceType type) const { return _loadStats[type]; }
+	void resetLoadStats();
+
 	/**
 	 * Tests whether a resource exists.
 	 *
@@ -550,6 +585,9 @@ protected:
 	Common::SeekableReadStream *getVolumeFile(ResourceSource *source);
 	void disposeVolumeFileStream(Common::SeekableReadStream *fileStream, ResourceSource *source);
 	void loadResource(Resource *res);
+	bool takePrefetchedResource(ResourceId id);
+	void publishPrefetchedResources();
+	bool usePrefetchedResource(const PrefetchJob &job);
 	void freeOldResources();
 	bool validateResource(const ResourceId &resourceId, const Common::String &sourceMapLocation, const Common::String &sourceName, const uint32 offset, const uint32 size, const uint32 sourceSize) const;
 	Resource *addResource(ResourceId resId, ResourceSource *src, uint32 offset, uint32 size = 0, const Common::String &sourceMapLocation = Common::String("(no map location)"));
@@ -651,6 +689,8 @@ private:
 	// For better or worse, because the patcher is added as a ResourceSource,
 	// its destruction is managed by freeResourceSources.
 	ResourcePatcher *_patcher;
+	ResourcePrefetcher *_prefetcher;
+	LoadStats _loadStats[kResourceTypeInvalid];
 	bool _hasBadResources;
 };
 
@@ -67,6 +67,13 @@ public:
 	// Auxiliary method, used by loadResource implementations.
 	Common::SeekableReadStream *getVolumeFile(ResourceManager *resMan, Resource *res);
 
+	/**
+	 * Auxiliary method, used by loadResource implementations. Seeks the
+	 * volume file to the header of the resource.
+	 * @return the version of the resource header
+	 */
+	ResVersion seekToResource(ResourceManager *resMan, Resource *res, Common::SeekableReadStream *fileStream);
+
 	/**
 	 * TODO: Document this
 	 */
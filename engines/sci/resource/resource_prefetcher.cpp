@@ -0,0 +1,208 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "common/memstream.h"
+#include "sci/resource/resource_prefetcher.h"
+
+namespace Sci {
+
+ResourcePrefetcher::ResourcePrefetcher() :
+	_thread(nullptr), _workSem(nullptr), _readySem(nullptr), _busy(false), _jobCount(0),
+	_readerWaiting(false), _threadWaiting(false), _quit(false) {
+	// Without a worker thread, resources are only loaded on demand
+	_workSem = g_system->createSemaphore(0);
+	_readySem = g_system->createSemaphore(0);
+	if (_workSem && _readySem)
+		_thread = g_system->createThread(threadEntry, this);
+}
+
+ResourcePrefetcher::~ResourcePrefetcher() {
+	if (_thread) {
+		_mutex.lock();
+		_quit = true;
+		if (_threadWaiting)
+			g_system->postSemaphore(_workSem);
+		_mutex.unlock();
+
+		g_system->joinThread(_thread);
+	}
+
+	for (JobList::iterator it = _queue.begin(); it != _queue.end(); ++it)
+		delete[] it->packed;
+	for (JobList::iterator it = _done.begin(); it != _done.end(); ++it)
+		delete[] it->data;
+
+	if (_workSem)
+		g_system->deleteSemaphore(_workSem);
+	if (_readySem)
+		g_system->deleteSemaphore(_readySem);
+}
+
+bool ResourcePrefetcher::isFull() {
+	Common::StackLock lock(_mutex);
+	return _jobCount >= kMaxJobs;
+}
+
+bool ResourcePrefetcher::contains(ResourceId id) {
+	Common::StackLock lock(_mutex);
+	if (_busy && _current.id == id)
+		return true;
+
+	for (JobList::const_iterator it = _queue.begin(); it != _queue.end(); ++it) {
+		if (it->id == id)
+			return true;
+	}
+	for (JobList::const_iterator it = _done.begin(); it != _done.end(); ++it) {
+		if (it->id == id)
+			return true;
+	}
+	return false;
+}
+
+bool ResourcePrefetcher::queue(const PrefetchJob &job) {
+	Common::StackLock lock(_mutex);
+	if (!_thread || _jobCount >= kMaxJobs) {
+		delete[] job.packed;
+		return false;
+	}
+
+	_queue.push_back(job);
+	_jobCount++;
+
+	if (_threadWaiting) {
+		_threadWaiting = false;
+		g_system->postSemaphore(_workSem);
+	}
+	return true;
+}
+
+bool ResourcePrefetcher::takeFinished(PrefetchJob &job) {
+	Common::StackLock lock(_mutex);
+	if (_done.empty())
+		return false;
+
+	job = _done.front();
+	_done.pop_front();
+	_jobCount--;
+	return true;
+}
+
+ResourcePrefetcher::TakeResult ResourcePrefetcher::take(ResourceId id, PrefetchJob &job) {
+	_mutex.lock();
+
+	if (find(_queue, id, job)) {
+		// Decompressing it right away is faster than waiting for the jobs
+		// before it
+		_mutex.unlock();
+		decompress(job);
+		return kTakeNotStarted;
+	}
+
+	TakeResult result = kTakeFinished;
+	while (!find(_done, id, job)) {
+		if (!_busy || _current.id != id) {
+			_mutex.unlock();
+			return kTakeNotQueued;
+		}
+
+		_readerWaiting = true;
+		_mutex.unlock();
+		g_system->waitSemaphore(_readySem);
+		_mutex.lock();
+		result = kTakeWaited;
+	}
+
+	_mutex.unlock();
+	return result;
+}
+
+bool ResourcePrefetcher::find(JobList &list, ResourceId id, PrefetchJob &job) {
+	for (JobList::iterator it = list.begin(); it != list.end(); ++it) {
+		if (it->id == id) {
+			job = *it;
+			list.erase(it);
+			_jobCount--;
+			return true;
+		}
+	}
+	return false;
+}
+
+void ResourcePrefetcher::decompress(PrefetchJob &job) {
+	const uint32 start = g_system->getMillis();
+	job.data = nullptr;
+
+	Decompressor *dec = Decompressor::create(job.compression);
+	if (!dec) {
+		job.error = SCI_ERROR_UNKNOWN_COMPRESSION;
+	} else {
+		Common::MemoryReadStream src(job.packed, job.packedSize);
+		job.data = new byte[job.size];
+		job.error = dec->unpack(&src, job.data, job.packedSize, job.size);
+		delete dec;
+	}
+
+	delete[] job.packed;
+	job.packed = nullptr;
+	job.decompressTime = g_system->getMillis() - start;
+}
+
+void ResourcePrefetcher::threadEntry(void *arg) {
+	((ResourcePrefetcher *)arg)->run();
+}
+
+void ResourcePrefetcher::run() {
+	_mutex.lock();
+
+	while (!_quit) {
+		if (_queue.empty()) {
+			_threadWaiting = true;
+			_mutex.unlock();
+			g_system->waitSemaphore(_workSem);
+			_mutex.lock();
+			continue;
+		}
+
+		// Only this thread touches the current job while it is busy, apart
+		// from comparing its id
+		_current = _queue.front();
+		_queue.pop_front();
+		_busy = true;
+		_mutex.unlock();
+
+		decompress(_current);
+
+		_mutex.lock();
+		_done.push_back(_current);
+		_busy = false;
+
+		if (_readerWaiting) {
+			_readerWaiting = false;
+			g_system->postSemaphore(_readySem);
+		}
+	}
+
+	_mutex.unlock();
+}
+
+} // End of namespace Sci
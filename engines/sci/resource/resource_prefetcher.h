@@ -0,0 +1,139 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#ifndef SCI_RESOURCE_RESOURCE_PREFETCHER_H
+#define SCI_RESOURCE_RESOURCE_PREFETCHER_H
+
+#include "common/list.h"
+#include "common/mutex.h"
+#include "common/system.h"
+#include "sci/resource/decompressor.h"
+#include "sci/resource/resource.h"
+
+namespace Sci {
+
+/** A resource which is decompressed ahead of time. */
+struct PrefetchJob {
+	ResourceId id;
+	/**
+	 * The resource, its source and offset when the job was queued. The
+	 * resource may be gone or replaced when the job is done, so these
+	 * are only compared, never dereferenced.
+	 */
+	const Resource *resource;
+	const ResourceSource *source;
+	int32 fileOffset;
+
+	ResourceCompression compression;
+	byte *packed;		///< Compressed data, freed after decompressing
+	uint32 packedSize;
+	byte *data;			///< Decompressed data, owned by the taker of the job
+	uint32 size;
+	int error;			///< One of ResourceErrorCodes
+	uint32 decompressTime;	///< Milliseconds spent decompressing the data
+};
+
+/**
+ * Decompresses resources on a worker thread, so that they are ready by the
+ * time the game asks for them.
+ *
+ * The resource manager reads the compressed data on the main thread, as the
+ * volume files are shared, and queues it here. It takes the decompressed
+ * data back on the main thread and adds it to its LRU list.
+ */
+class ResourcePrefetcher {
+public:
+	/** How a job has been taken with take(). */
+	enum TakeResult {
+		kTakeNotQueued,		///< There is no job for the resource
+		kTakeFinished,		///< The job had already been done
+		kTakeWaited,		///< The worker thread was busy with the job
+		kTakeNotStarted		///< The job was decompressed on the calling thread
+	};
+
+	/** The maximum number of jobs which are queued or done but not taken. */
+	static const uint kMaxJobs = 16;
+
+	ResourcePrefetcher();
+	~ResourcePrefetcher();
+
+	/**
+	 * Returns whether the worker thread is running. Nothing can be queued
+	 * without it.
+	 */
+	bool isAvailable() const { return _thread != nullptr; }
+
+	/** Returns whether the queue is full. */
+	bool isFull();
+
+	/** Returns whether there is a job for the given resource. */
+	bool contains(ResourceId id);
+
+	/**
+	 * Queues a job. The prefetcher takes ownership of the packed data, even
+	 * if the job can't be queued.
+	 * @return true if the job has been queued
+	 */
+	bool queue(const PrefetchJob &job);
+
+	/**
+	 * Takes any job which is done, without waiting.
+	 * @return true if a job has been taken
+	 */
+	bool takeFinished(PrefetchJob &job);
+
+	/**
+	 * Takes the job for the given resource, waiting for the worker thread
+	 * if it is busy with it.
+	 */
+	TakeResult take(ResourceId id, PrefetchJob &job);
+
+	/** Decompresses the packed data of a job. */
+	static void decompress(PrefetchJob &job);
+
+private:
+	typedef Common::List<PrefetchJob> JobList;
+
+	static void threadEntry(void *arg);
+	void run();
+	bool find(JobList &list, ResourceId id, PrefetchJob &job);
+
+	OSystem::ThreadRef _thread;
+	OSystem::SemaphoreRef _workSem;
+	OSystem::SemaphoreRef _readySem;
+
+	// Shared with the worker thread, guarded by _mutex
+	Common::Mutex _mutex;
+	JobList _queue;
+	JobList _done;
+	PrefetchJob _current;		///< The job the worker thread is busy with
+	bool _busy;
+	uint _jobCount;		///< Number of jobs in _queue, _done and _current
+	bool _readerWaiting;
+	bool _threadWaiting;
+	bool _quit;
+};
+
+} // End of namespace Sci
+
+#endif	// SCI_RESOURCE_RESOURCE_PREFETCHER_H
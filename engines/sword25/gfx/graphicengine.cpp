@@ -61,6 +61,7 @@ enum {
 namespace Sword25 {
 
 static const uint FRAMETIME_SAMPLE_COUNT = 5;       // Frame duration is averaged over FRAMETIME_SAMPLE_COUNT frames
+static const uint TRANSFORMED_SURFACE_BUDGET = 16 * 1024 * 1024; // Bytes of scaled images kept for the next frames
 
 GraphicEngine::GraphicEngine(Kernel *pKernel) :
 	_width(0),
@@ -71,6 +72,7 @@ GraphicEngine::GraphicEngine(Kernel *pKernel) :
 	_timerActive(true),
 	_frameTimeSampleSlot(0),
 	_thumbnail(NULL),
+	_transformedSurfaces(new Graphics::TransformedSurfaceCache(TRANSFORMED_SURFACE_BUDGET)),
 	ResourceService(pKernel) {
 	_frameTimeSamples.resize(FRAMETIME_SAMPLE_COUNT);
 
@@ -46,6 +46,7 @@
 #include "common/ptr.h"
 #include "common/str.h"
 #include "graphics/surface.h"
+#include "graphics/transformed_surface_cache.h"
 #include "sword25/kernel/common.h"
 #include "sword25/kernel/resservice.h"
 #include "sword25/kernel/persistable.h"
@@ -235,6 +236,12 @@ public:
 	Common::SeekableReadStream *_thumbnail;
 	Common::SeekableReadStream *getThumbnail() { return _thumbnail; }
 
+	/**
+	 * The scaled images drawn by the RenderedImage objects, which share it
+	 * with the graphic engine.
+	 */
+	const Common::SharedPtr<Graphics::TransformedSurfaceCache> &getTransformedSurfaces() { return _transformedSurfaces; }
+
 	// Access methods
 
 	/**
@@ -314,6 +321,8 @@ private:
 
 	Common::ScopedPtr<RenderObjectManager> _renderObjectManagerPtr;
 
+	Common::SharedPtr<Graphics::TransformedSurfaceCache> _transformedSurfaces;
+
 	struct DebugLine {
 		DebugLine(const Vertex &start, const Vertex &end, uint color) :
 			_start(start),
@@ -107,6 +107,8 @@ RenderedImage::RenderedImage(const Common::String &filename, bool &result) :
 	assert(pPackage);
 
 	_backSurface = Kernel::getInstance()->getGfx()->getSurface();
+	_transformedSurfaces = Kernel::getInstance()->getGfx()->getTransformedSurfaces();
+	_surface.setTransformedSurfaceCache(_transformedSurfaces.get());
 
 	// Load file
 	byte *pFileData;
@@ -158,6 +160,8 @@ RenderedImage::RenderedImage(uint width, uint height, bool &result) :
 	_surface.create(width, height, Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0));
 
 	_backSurface = Kernel::getInstance()->getGfx()->getSurface();
+	_transformedSurfaces = Kernel::getInstance()->getGfx()->getTransformedSurfaces();
+	_surface.setTransformedSurfaceCache(_transformedSurfaces.get());
 
 	_doCleanup = true;
 
@@ -167,6 +171,8 @@ RenderedImage::RenderedImage(uint width, uint height, bool &result) :
 
 RenderedImage::RenderedImage() : _isTransparent(true) {
 	_backSurface = Kernel::getInstance()->getGfx()->getSurface();
+	_transformedSurfaces = Kernel::getInstance()->getGfx()->getTransformedSurfaces();
+	_surface.setTransformedSurfaceCache(_transformedSurfaces.get());
 
 	_surface.format = Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0);
 
@@ -178,6 +184,7 @@ RenderedImage::RenderedImage() : _isTransparent(true) {
 // -----------------------------------------------------------------------------
 
 RenderedImage::~RenderedImage() {
+	_transformedSurfaces->invalidate(_surface);
 	if (_doCleanup) {
 		_surface.free();
 	}
@@ -199,6 +206,8 @@ bool RenderedImage::setContent(const byte *pixeldata, uint size, uint offset, ui
 		return false;
 	}
 
+	_transformedSurfaces->invalidate(_surface);
+
 	const byte *in = &pixeldata[offset];
 	byte *out = (byte *)_surface.getPixels();
 
@@ -212,10 +221,13 @@ bool RenderedImage::setContent(const byte *pixeldata, uint size, uint offset, ui
 }
 
 void RenderedImage::replaceContent(byte *pixeldata, int width, int height) {
+	// The new pixels may be where the old ones or another image's were
+	_transformedSurfaces->invalidate(_surface);
 	_surface.w = width;
 	_surface.h = height;
 	_surface.pitch = width * 4;
 	_surface.setPixels(pixeldata);
+	_transformedSurfaces->invalidate(_surface);
 }
 // -----------------------------------------------------------------------------
 
@@ -117,6 +117,7 @@ private:
 	bool _isTransparent;
 
 	Graphics::Surface *_backSurface;
+	Common::SharedPtr<Graphics::TransformedSurfaceCache> _transformedSurfaces;
 
 	void checkForTransparency();
 };
@@ -40,6 +40,7 @@
 #include "common/config-manager.h"
 
 #define DIRTY_RECT_LIMIT 800
+#define TRANSFORMED_SURFACE_BUDGET (32 * 1024 * 1024)
 
 namespace Wintermute {
 
@@ -48,7 +49,7 @@ BaseRenderer *makeOSystemRenderer(BaseGame *inGame) {
 }
 
 //////////////////////////////////////////////////////////////////////////
-BaseRenderOSystem::BaseRenderOSystem(BaseGame *inGame) : BaseRenderer(inGame) {
+BaseRenderOSystem::BaseRenderOSystem(BaseGame *inGame) : BaseRenderer(inGame), _transformedSurfaces(TRANSFORMED_SURFACE_BUDGET) {
 	_renderSurface = new Graphics::Surface();
 	_blankSurface = new Graphics::Surface();
 	_lastFrameIter = _renderQueue.end();
@@ -34,6 +34,7 @@
 #include "graphics/surface.h"
 #include "common/list.h"
 #include "graphics/transform_struct.h"
+#include "graphics/transformed_surface_cache.h"
 
 namespace Wintermute {
 class BaseSurfaceOSystem;
@@ -83,6 +84,11 @@ public:
 
 	void invalidateTicket(RenderTicket *renderTicket);
 	void invalidateTicketsFromSurface(BaseSurfaceOSystem *surf);
+	/**
+	 * The rotated and scaled surfaces shared by the tickets. Surfaces must
+	 * be invalidated in it before their pixels change.
+	 */
+	Graphics::TransformedSurfaceCache &getTransformedSurfaces() { return _transformedSurfaces; }
 	/**
 	 * Insert a new ticket into the queue, adding a dirty rect
 	 * @param renderTicket the ticket to be added.
@@ -150,6 +156,8 @@ private:
 
 	bool _skipThisFrame;
 	int _lastScreenChangeID; // previous value of OSystem::getScreenChangeID()
+
+	Graphics::TransformedSurfaceCache _transformedSurfaces;
 };
 
 } // End of namespace Wintermute
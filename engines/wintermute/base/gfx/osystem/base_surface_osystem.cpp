@@ -55,7 +55,9 @@ BaseSurfaceOSystem::BaseSurfaceOSystem(BaseGame *inGame) : BaseSurface(inGame) {
 
 //////////////////////////////////////////////////////////////////////////
 BaseSurfaceOSystem::~BaseSurfaceOSystem() {
+	BaseRenderOSystem *renderer = static_cast<BaseRenderOSystem *>(_gameRef->_renderer);
 	if (_surface) {
+		renderer->getTransformedSurfaces().invalidate(*_surface);
 		_surface->free();
 		delete _surface;
 		_surface = nullptr;
@@ -65,7 +67,6 @@ BaseSurfaceOSystem::~BaseSurfaceOSystem() {
 	_alphaMask = nullptr;
 
 	_gameRef->addMem(-_width * _height * 4);
-	BaseRenderOSystem *renderer = static_cast<BaseRenderOSystem *>(_gameRef->_renderer);
 	renderer->invalidateTicketsFromSurface(this);
 }
 
@@ -147,6 +148,8 @@ bool BaseSurfaceOSystem::finishLoad() {
 		// FIBITMAP *newImg = FreeImage_ConvertToGreyscale(img); TODO
 	}
 
+	BaseRenderOSystem *renderer = static_cast<BaseRenderOSystem *>(_gameRef->_renderer);
+	renderer->getTransformedSurfaces().invalidate(*_surface);
 	_surface->free();
 	delete _surface;
 
@@ -335,6 +338,7 @@ bool BaseSurfaceOSystem::startPixelOp() {
 	//SDL_LockTexture(_texture, nullptr, &_lockPixels, &_lockPitch);
 	// Any pixel-op makes the caching useless:
 	BaseRenderOSystem *renderer = static_cast<BaseRenderOSystem *>(_gameRef->_renderer);
+	renderer->getTransformedSurfaces().invalidate(*_surface);
 	renderer->invalidateTicketsFromSurface(this);
 	return STATUS_OK;
 }
@@ -462,6 +466,9 @@ bool BaseSurfaceOSystem::drawSprite(int x, int y, Rect32 *rect, Rect32 *newRect,
 }
 
 bool BaseSurfaceOSystem::putSurface(const Graphics::Surface &surface, bool hasAlpha) {
+	BaseRenderOSystem *renderer = static_cast<BaseRenderOSystem *>(_gameRef->_renderer);
+	renderer->getTransformedSurfaces().invalidate(*_surface);
+
 	_loaded = true;
 	if (surface.format == _surface->format && surface.pitch == _surface->pitch && surface.h == _surface->h) {
 		const byte *src = (const byte *)surface.getBasePtr(0, 0);
@@ -476,7 +483,6 @@ bool BaseSurfaceOSystem::putSurface(const Graphics::Surface &surface, bool hasAl
 	} else {
 		_alphaType = Graphics::ALPHA_OPAQUE;
 	}
-	BaseRenderOSystem *renderer = static_cast<BaseRenderOSystem *>(_gameRef->_renderer);
 	renderer->invalidateTicketsFromSurface(this);
 
 	return STATUS_OK;
@@ -29,6 +29,7 @@
 
 #include "engines/wintermute/base/base_game.h"
 #include "engines/wintermute/base/gfx/osystem/render_ticket.h"
+#include "engines/wintermute/base/gfx/osystem/base_render_osystem.h"
 #include "engines/wintermute/base/gfx/osystem/base_surface_osystem.h"
 #include "graphics/transform_tools.h"
 #include "common/textconsole.h"
@@ -43,50 +44,41 @@ RenderTicket::RenderTicket(BaseSurfaceOSystem *owner, const Graphics::Surface *s
 	_wantsDraw(true),
 	_transform(transform) {
 	if (surf) {
-		_surface = new Graphics::Surface();
-		_surface->create((uint16)srcRect->width(), (uint16)srcRect->height(), surf->format);
-		assert(_surface->format.bytesPerPixel == 4);
-		// Get a clipped copy of the surface
-		for (int i = 0; i < _surface->h; i++) {
-			memcpy(_surface->getBasePtr(0, i), surf->getBasePtr(srcRect->left, srcRect->top + i), srcRect->width() * _surface->format.bytesPerPixel);
-		}
-		// Then scale it if necessary
-		//
 		// NB: The numTimesX/numTimesY properties don't yet mix well with
 		// scaling and rotation, but there is no need for that functionality at
 		// the moment.
 		// NB: Mirroring and rotation are probably done in the wrong order.
 		// (Mirroring should most likely be done before rotation. See also
 		// TransformTools.)
-		if (_transform._angle != Graphics::kDefaultAngle) {
-			Graphics::TransparentSurface src(*_surface, false);
-			Graphics::Surface *temp;
-			if (owner->_gameRef->getBilinearFiltering()) {
-				temp = src.rotoscaleT<Graphics::FILTER_BILINEAR>(transform);
+		const bool rotate = _transform._angle != Graphics::kDefaultAngle;
+		const bool scale = (dstRect->width() != srcRect->width() ||
+							dstRect->height() != srcRect->height()) &&
+							_transform._numTimesX * _transform._numTimesY == 1;
+		if (rotate || scale) {
+			// The transformed surface never changes, so it can be shared with
+			// the tickets drawing the same part of the surface in later frames
+			Graphics::TransformedSurfaceCache &cache = static_cast<BaseRenderOSystem *>(owner->_gameRef->_renderer)->getTransformedSurfaces();
+			const Graphics::Surface src = surf->getSubArea(*srcRect);
+			const bool filtering = owner->_gameRef->getBilinearFiltering();
+			if (rotate) {
+				_surface = cache.rotoscale(src, transform, filtering ? Graphics::FILTER_BILINEAR : Graphics::FILTER_NEAREST);
 			} else {
-				temp = src.rotoscaleT<Graphics::FILTER_NEAREST>(transform);
+				_surface = cache.scale(src, dstRect->width(), dstRect->height(), filtering);
+			}
+		} else {
+			Graphics::Surface *copy = new Graphics::Surface();
+			copy->create((uint16)srcRect->width(), (uint16)srcRect->height(), surf->format);
+			assert(copy->format.bytesPerPixel == 4);
+			// Get a clipped copy of the surface
+			for (int i = 0; i < copy->h; i++) {
+				memcpy(copy->getBasePtr(0, i), surf->getBasePtr(srcRect->left, srcRect->top + i), srcRect->width() * copy->format.bytesPerPixel);
 			}
-			_surface->free();
-			delete _surface;
-			_surface = temp;
-		} else if ((dstRect->width() != srcRect->width() ||
-					dstRect->height() != srcRect->height()) &&
-					_transform._numTimesX * _transform._numTimesY == 1) {
-			Graphics::Surface *temp = _surface->scale(dstRect->width(), dstRect->height(), owner->_gameRef->getBilinearFiltering());
-			_surface->free();
-			delete _surface;
-			_surface = temp;
+			_surface = Common::SharedPtr<const Graphics::Surface>(copy, Graphics::SurfaceDeleter());
 		}
-	} else {
-		_surface = nullptr;
 	}
 }
 
 RenderTicket::~RenderTicket() {
-	if (_surface) {
-		_surface->free();
-		delete _surface;
-	}
 }
 
 bool RenderTicket::operator==(const RenderTicket &t) const {
@@ -31,6 +31,7 @@
 
 #include "graphics/transparent_surface.h"
 #include "graphics/surface.h"
+#include "common/ptr.h"
 #include "common/rect.h"
 
 namespace Wintermute {
@@ -54,7 +55,7 @@ public:
 	RenderTicket(BaseSurfaceOSystem *owner, const Graphics::Surface *surf, Common::Rect *srcRect, Common::Rect *dstRest, Graphics::TransformStruct transform);
 	RenderTicket() : _isValid(true), _wantsDraw(false), _transform(Graphics::TransformStruct()) {}
 	~RenderTicket();
-	const Graphics::Surface *getSurface() const { return _surface; }
+	const Graphics::Surface *getSurface() const { return _surface.get(); }
 	// Non-dirty-rects:
 	void drawToSurface(Graphics::Surface *_targetSurface) const;
 	// Dirty-rects:
@@ -71,7 +72,8 @@ public:
 	bool operator==(const RenderTicket &a) const;
 	const Common::Rect *getSrcRect() const { return &_srcRect; }
 private:
-	Graphics::Surface *_surface;
+	// Rotated and scaled surfaces are shared with the renderer's cache
+	Common::SharedPtr<const Graphics::Surface> _surface;
 	Common::Rect _srcRect;
 };
 
@@ -0,0 +1,180 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "graphics/dirtyrects.h"
+
+namespace Graphics {
+
+namespace {
+
+enum {
+	/**
+	 * Rectangles are joined if their bounding box contains at most this
+	 * many pixels which are not covered by them. Redrawing these is
+	 * cheaper than handling one more rectangle.
+	 */
+	kMaxJoinWaste = 64
+};
+
+/** Check whether two rectangles overlap or share (part of) an edge. */
+bool touches(const Common::Rect &r1, const Common::Rect &r2) {
+	return r1.left <= r2.right && r2.left <= r1.right && r1.top <= r2.bottom && r2.top <= r1.bottom;
+}
+
+} // End of anonymous namespace
+
+DirtyRectList::DirtyRectList(uint maxRects) : _maxRects(maxRects) {
+	assert(maxRects > 0);
+	_rects.reserve(maxRects);
+	clear();
+}
+
+void DirtyRectList::clear() {
+	// Keep the storage, the list is usually refilled right away
+	_rects.resize(0);
+
+	_stats.rectsAdded = 0;
+	_stats.pixelsAdded = 0;
+	_stats.pixelsDirty = 0;
+}
+
+bool DirtyRectList::contains(const Common::Rect &r) const {
+	for (uint i = 0; i < _rects.size(); ++i) {
+		if (_rects[i].contains(r))
+			return true;
+	}
+	return false;
+}
+
+void DirtyRectList::addRect(const Common::Rect &r) {
+	if (r.isEmpty())
+		return;
+
+	_stats.rectsAdded++;
+	_stats.pixelsAdded += area(r);
+	insert(r);
+}
+
+void DirtyRectList::insert(Common::Rect rect) {
+	uint i = 0;
+	while (i < _rects.size()) {
+		const Common::Rect &cur = _rects[i];
+		if (cur.contains(rect))
+			return;
+
+		if (touches(cur, rect)) {
+			Common::Rect box(rect);
+			box.extend(cur);
+
+			if (joinCost(rect, cur) <= kMaxJoinWaste) {
+				rect = box;
+				remove(i);
+				i = 0;
+				continue;
+			}
+
+			if (rect.intersects(cur)) {
+				// Overlapping rectangles have to be joined as well, unless
+				// the overlap can be cut off the new one
+				if (!cutOff(rect, cur)) {
+					rect = box;
+					remove(i);
+				}
+
+				// The new rectangle has changed, so the ones checked
+				// before need to be checked again
+				i = 0;
+				continue;
+			}
+		}
+
+		++i;
+	}
+
+	if (_rects.size() == _maxRects) {
+		// Make room by joining the new rectangle with the one that grows
+		// the least. The result may overlap other rectangles, so it needs
+		// to be inserted again.
+		uint best = 0;
+		uint bestGrowth = 0xFFFFFFFF;
+		for (uint j = 0; j < _rects.size(); ++j) {
+			Common::Rect box(rect);
+			box.extend(_rects[j]);
+
+			const uint growth = area(box) - area(_rects[j]);
+			if (growth < bestGrowth) {
+				best = j;
+				bestGrowth = growth;
+			}
+		}
+
+		rect.extend(_rects[best]);
+		remove(best);
+		insert(rect);
+		return;
+	}
+
+	_rects.push_back(rect);
+	_stats.pixelsDirty += area(rect);
+}
+
+uint DirtyRectList::joinCost(const Common::Rect &r1, const Common::Rect &r2) {
+	Common::Rect box(r1);
+	box.extend(r2);
+
+	return area(box) - area(r1) - area(r2) + area(r1.findIntersectingRect(r2));
+}
+
+bool DirtyRectList::cutOff(Common::Rect &r, const Common::Rect &cover) {
+	if (cover.top <= r.top && cover.bottom >= r.bottom) {
+		// The cover spans the whole height of the rectangle
+		if (cover.left <= r.left) {
+			r.left = cover.right;
+			return true;
+		} else if (cover.right >= r.right) {
+			r.right = cover.left;
+			return true;
+		}
+	} else if (cover.left <= r.left && cover.right >= r.right) {
+		// The cover spans the whole width of the rectangle
+		if (cover.top <= r.top) {
+			r.top = cover.bottom;
+			return true;
+		} else if (cover.bottom >= r.bottom) {
+			r.bottom = cover.top;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void DirtyRectList::remove(uint idx) {
+	_stats.pixelsDirty -= area(_rects[idx]);
+
+	// The order of the rectangles does not matter
+	_rects[idx] = _rects.back();
+	_rects.pop_back();
+}
+
+} // End of namespace Graphics
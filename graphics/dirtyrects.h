@@ -0,0 +1,121 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#ifndef GRAPHICS_DIRTYRECTS_H
+#define GRAPHICS_DIRTYRECTS_H
+
+#include "common/array.h"
+#include "common/rect.h"
+
+namespace Graphics {
+
+/**
+ * @defgroup graphics_dirtyrects Dirty rectangles
+ * @ingroup graphics
+ *
+ * @brief List of screen areas that need to be redrawn.
+ *
+ * @{
+ */
+
+/**
+ * A bounded list of dirty rectangles, which merges rectangles as they are
+ * added. Every pixel in the list is only contained in a single rectangle,
+ * so it never has to be redrawn twice.
+ *
+ * Rectangles which overlap or touch are joined, as long as there are only
+ * a few pixels in their bounding box which are not covered by them.
+ * Otherwise, the part of the new rectangle which overlaps an existing one
+ * is cut off, if the remainder still is a rectangle. Once the list is full,
+ * new rectangles are joined with the rectangle which grows the least.
+ */
+class DirtyRectList {
+public:
+	/** Counters of how well the rectangles could be merged. */
+	struct Stats {
+		uint rectsAdded;   /*!< Number of rectangles passed to addRect(). */
+		uint pixelsAdded;  /*!< Sum of the areas of these rectangles. */
+		uint pixelsDirty;  /*!< Area covered by the list. */
+
+		/**
+		 * Number of pixels which do not have to be redrawn, compared to
+		 * drawing every added rectangle. This is negative, if the merged
+		 * rectangles cover more pixels than they have been made of.
+		 */
+		int pixelsSaved() const { return (int)(pixelsAdded - pixelsDirty); }
+	};
+
+	/**
+	 * Create an empty list.
+	 *
+	 * @param maxRects  The maximum number of rectangles in the list.
+	 */
+	explicit DirtyRectList(uint maxRects);
+
+	/** Add a rectangle, merging it with the ones in the list. */
+	void addRect(const Common::Rect &r);
+
+	/** Remove all rectangles and reset the counters. */
+	void clear();
+
+	/** Check whether the given rectangle is inside a rectangle of the list. */
+	bool contains(const Common::Rect &r) const;
+
+	bool empty() const { return _rects.empty(); }
+	uint size() const { return _rects.size(); }
+	const Common::Rect &operator[](uint idx) const { return _rects[idx]; }
+
+	/** Return the counters since the last call to clear(). */
+	const Stats &getStats() const { return _stats; }
+
+private:
+	/** Merge a rectangle into the list, without counting it. */
+	void insert(Common::Rect rect);
+
+	static uint area(const Common::Rect &r) { return (uint)r.width() * r.height(); }
+
+	/**
+	 * Return how many pixels of the bounding box of the two rectangles are
+	 * not covered by either of them.
+	 */
+	static uint joinCost(const Common::Rect &r1, const Common::Rect &r2);
+
+	/**
+	 * Cut off the part of r which is covered by cover, if the remainder is
+	 * still a rectangle. Return false if r has not been changed.
+	 */
+	static bool cutOff(Common::Rect &r, const Common::Rect &cover);
+
+	/** Remove the rectangle at the given index. */
+	void remove(uint idx);
+
+	Common::Array<Common::Rect> _rects;
+	uint _maxRects;
+	Stats _stats;
+};
+
+/** @} */
+
+} // End of namespace Graphics
+
+#endif
@@ -3,6 +3,7 @@ MODULE := graphics
 MODULE_OBJS := \
 	conversion.o \
 	cursorman.o \
+	dirtyrects.o \
 	font.o \
 	fontman.o \
 	fonts/bdf.o \
@@ -37,6 +38,7 @@ MODULE_OBJS := \
 	surface.o \
 	transform_struct.o \
 	transform_tools.o \
+	transformed_surface_cache.o \
 	transparent_surface.o \
 	thumbnail.o \
 	VectorRenderer.o \
@@ -54,6 +56,18 @@ MODULE_OBJS := \
 	opengl/control_shaders.o \
 	opengl/compat_shaders.o
 
+ifdef SCUMMVM_SSE2
+MODULE_OBJS += \
+	transparent_surface_sse2.o
+$(MODULE)/transparent_surface_sse2.o: CXXFLAGS += -msse2
+endif
+
+ifdef SCUMMVM_AVX2
+MODULE_OBJS += \
+	transparent_surface_avx2.o
+$(MODULE)/transparent_surface_avx2.o: CXXFLAGS += -mavx2
+endif
+
 ifdef USE_TINYGL
 MODULE_OBJS += \
 	tinygl/api.o \
@@ -78,7 +92,17 @@ MODULE_OBJS += \
 	tinygl/zmath.o \
 	tinygl/ztriangle.o \
 	tinygl/zblit.o \
-	tinygl/zdirtyrect.o
+	tinygl/zdirtyrect.o \
+	tinygl/zhiz.o \
+	tinygl/zspan.o \
+	tinygl/ztiles.o
+
+ifdef SCUMMVM_SSE2
+MODULE_OBJS += \
+	tinygl/zspan_sse2.o
+$(MODULE)/tinygl/zspan_sse2.o: CXXFLAGS += -msse2
+endif
+
 endif
 
 ifdef USE_SCALERS
@@ -102,6 +126,18 @@ MODULE_OBJS += \
 	scaler/hq2x.o \
 	scaler/hq3x.o
 
+ifdef SCUMMVM_SSE2
+MODULE_OBJS += \
+	scaler/hq_sse2.o
+$(MODULE)/scaler/hq_sse2.o: CXXFLAGS += -msse2
+endif
+
+ifdef SCUMMVM_AVX2
+MODULE_OBJS += \
+	scaler/hq_avx2.o
+$(MODULE)/scaler/hq_avx2.o: CXXFLAGS += -mavx2
+endif
+
 ifdef USE_NASM
 MODULE_OBJS += \
 	scaler/hq2x_i386.o \
@@ -20,11 +20,13 @@
  *
  */
 
+#include "graphics/scaler.h"
 #include "graphics/scaler/intern.h"
 #include "graphics/scaler/scalebit.h"
 #include "common/util.h"
 #include "common/system.h"
 #include "common/textconsole.h"
+#include "common/threadpool.h"
 
 int gBitFormat = 565;
 
@@ -81,6 +83,59 @@ uint32 hqx_green_redBlue_Mask = 0;
 uint32 *RGBtoYUV = 0;
 }
 
+HQPatternProc g_hqPatterns = 0;
+
+void hqPatternsScalar(const uint16 *src, uint32 nextlineSrc, uint16 *flags, int width) {
+	for (int x = 0; x < width; ++x, ++src) {
+		const int w1 = *(src - 1 - nextlineSrc);
+		const int w2 = *(src - nextlineSrc);
+		const int w3 = *(src + 1 - nextlineSrc);
+		const int w4 = *(src - 1);
+		const int w5 = *(src);
+		const int w6 = *(src + 1);
+		const int w7 = *(src - 1 + nextlineSrc);
+		const int w8 = *(src + nextlineSrc);
+		const int w9 = *(src + 1 + nextlineSrc);
+
+		int pattern = 0;
+		const int yuv5 = RGBtoYUV[w5];
+		if (w5 != w1 && diffYUV(yuv5, RGBtoYUV[w1])) pattern |= 0x0001;
+		if (w5 != w2 && diffYUV(yuv5, RGBtoYUV[w2])) pattern |= 0x0002;
+		if (w5 != w3 && diffYUV(yuv5, RGBtoYUV[w3])) pattern |= 0x0004;
+		if (w5 != w4 && diffYUV(yuv5, RGBtoYUV[w4])) pattern |= 0x0008;
+		if (w5 != w6 && diffYUV(yuv5, RGBtoYUV[w6])) pattern |= 0x0010;
+		if (w5 != w7 && diffYUV(yuv5, RGBtoYUV[w7])) pattern |= 0x0020;
+		if (w5 != w8 && diffYUV(yuv5, RGBtoYUV[w8])) pattern |= 0x0040;
+		if (w5 != w9 && diffYUV(yuv5, RGBtoYUV[w9])) pattern |= 0x0080;
+
+		if (w2 != w6 && diffYUV(RGBtoYUV[w2], RGBtoYUV[w6])) pattern |= kHQDiff26;
+		if (w6 != w8 && diffYUV(RGBtoYUV[w6], RGBtoYUV[w8])) pattern |= kHQDiff68;
+		if (w8 != w4 && diffYUV(RGBtoYUV[w8], RGBtoYUV[w4])) pattern |= kHQDiff84;
+		if (w4 != w2 && diffYUV(RGBtoYUV[w4], RGBtoYUV[w2])) pattern |= kHQDiff42;
+
+		flags[x] = pattern;
+	}
+}
+
+static HQPatternProc getHQPatternProc(const Graphics::PixelFormat &format) {
+	// The vectorized routines compute the YUV values on the fly, so they
+	// only handle the formats they have been written for
+	const bool is565 = (format == Graphics::createPixelFormat<565>());
+	if (!is565 && format != Graphics::createPixelFormat<555>())
+		return 0;
+
+	const OSystem::SimdLevel simdLevel = g_system->getSimdLevel();
+#ifdef SCUMMVM_AVX2
+	if (simdLevel >= OSystem::kSimdAVX2)
+		return is565 ? hqPatterns565AVX2 : hqPatterns555AVX2;
+#endif
+#ifdef SCUMMVM_SSE2
+	if (simdLevel >= OSystem::kSimdSSE2)
+		return is565 ? hqPatterns565SSE2 : hqPatterns555SSE2;
+#endif
+	return 0;
+}
+
 void InitLUT(Graphics::PixelFormat format) {
 	uint8 r, g, b;
 	int Y, u, v;
@@ -102,6 +157,8 @@ void InitLUT(Graphics::PixelFormat format) {
 		RGBtoYUV[color] = (Y << 16) | (u << 8) | v;
 	}
 
+	g_hqPatterns = getHQPatternProc(format);
+
 #ifdef USE_NASM
 	hqx_lowbits  = (1 << format.rShift) | (1 << format.gShift) | (1 << format.bShift),
 	hqx_low2bits = (3 << format.rShift) | (3 << format.gShift) | (3 << format.bShift),
@@ -178,6 +235,71 @@ void Normal1x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPit
 	}
 }
 
+namespace {
+
+enum {
+	/** Bands smaller than this are not worth handing to another thread. */
+	kMinScaleBandHeight = 16
+};
+
+struct ScaleBandJob {
+	ScalerProc *scaler;
+	int scaleFactor;
+	const uint8 *srcPtr;
+	uint32 srcPitch;
+	uint8 *dstPtr;
+	uint32 dstPitch;
+	int width;
+	int height;
+	int bandHeight;
+	uint bandCount;
+};
+
+void scaleBand(void *arg, uint index) {
+	const ScaleBandJob &job = *(const ScaleBandJob *)arg;
+
+	const int y = index * job.bandHeight;
+	// The last band also takes the remaining rows
+	const int height = (index == job.bandCount - 1) ? job.height - y : job.bandHeight;
+
+	job.scaler(job.srcPtr + y * job.srcPitch, job.srcPitch,
+	           job.dstPtr + y * job.scaleFactor * job.dstPitch, job.dstPitch, job.width, height);
+}
+
+} // End of anonymous namespace
+
+void ScaleParallel(Common::ThreadPool &pool, ScalerProc *scaler, int scaleFactor,
+					const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
+#if defined(USE_HQ_SCALERS) && defined(USE_NASM)
+	// The assembly versions of the HQ scalers keep their state in global
+	// variables, so only one thread at a time can use them. They are only
+	// used when no vectorized version of the C++ code is available.
+	if ((scaler == HQ2x || scaler == HQ3x) && !g_hqPatterns) {
+		scaler(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+		return;
+	}
+#endif
+
+	ScaleBandJob job;
+	job.scaler = scaler;
+	job.scaleFactor = scaleFactor;
+	job.srcPtr = srcPtr;
+	job.srcPitch = srcPitch;
+	job.dstPtr = dstPtr;
+	job.dstPitch = dstPitch;
+	job.width = width;
+	job.height = height;
+
+	// DotMatrix uses a pattern which repeats every other source row, so
+	// the bands have to start at even rows
+	const int threads = pool.getThreadCount();
+	job.bandHeight = MAX<int>((height + threads - 1) / threads, kMinScaleBandHeight);
+	job.bandHeight = (job.bandHeight + 1) & ~1;
+	job.bandCount = MAX(height / job.bandHeight, 1);
+
+	pool.run(scaleBand, &job, job.bandCount);
+}
+
 #ifdef USE_SCALERS
 
 
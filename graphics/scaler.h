@@ -26,12 +26,29 @@
 #include "common/scummsys.h"
 #include "graphics/surface.h"
 
+namespace Common {
+class ThreadPool;
+}
+
 extern void InitScalers(uint32 BitFormat);
 extern void DestroyScalers();
 
 typedef void ScalerProc(const uint8 *srcPtr, uint32 srcPitch,
 							uint8 *dstPtr, uint32 dstPitch, int width, int height);
 
+/**
+ * Scale an area just like calling the scaler directly, but split it into
+ * bands of rows, which the threads of the given pool scale concurrently.
+ * Since the scalers read the rows around each band straight from the
+ * source, the output is identical to scaling the whole area at once.
+ *
+ * @param pool        The thread pool to use.
+ * @param scaler      The scaler to use.
+ * @param scaleFactor The scale factor of the scaler.
+ */
+extern void ScaleParallel(Common::ThreadPool &pool, ScalerProc *scaler, int scaleFactor,
+							const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height);
+
 #define DECLARE_SCALER(x)	\
 	extern void x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, \
 					uint32 dstPitch, int width, int height)
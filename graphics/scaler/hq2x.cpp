@@ -21,6 +21,7 @@
  */
 
 #include "graphics/scaler/intern.h"
+#include "common/util.h"
 
 #ifdef USE_NASM
 // Assembly version of HQ2x
@@ -29,17 +30,13 @@ extern "C" {
 
 #if !defined(_WIN32) && !defined(MACOSX) && !defined(__OS2__)
 #define hq2x_16 _hq2x_16
+#define RGBtoYUV _RGBtoYUV
 #endif
 
 void hq2x_16(const byte *, byte *, uint32, uint32, uint32, uint32);
 
 }
-
-void HQ2x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
-	hq2x_16(srcPtr, dstPtr, width, height, srcPitch, dstPitch);
-}
-
-#else
+#endif
 
 #define PIXEL00_0	*(q) = w5;
 #define PIXEL00_10	*(q) = interpolate16_3_1<ColorMask >(w5, w1);
@@ -96,6 +93,10 @@ void HQ2x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
 extern "C" uint32   *RGBtoYUV;
 #define YUV(x)	RGBtoYUV[w ## x]
 
+// Check whether two neighbours of w5 differ. This has either been computed
+// by the vectorized HQPatternProc, or needs to be looked up.
+#define DIFF_YUV(x, y)	(patternProc ? (pattern & kHQDiff ## x ## y) : diffYUV(YUV(x), YUV(y)))
+
 /*
  * The HQ2x high quality 2x graphics filter.
  * Original author Maxim Stepin (see http://www.hiend3d.com/hq2x.html).
@@ -122,6 +123,9 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 	//	 | w7 | w8 | w9 |
 	//	 +----+----+----+
 
+	const HQPatternProc patternProc = g_hqPatterns;
+	uint16 flags[kHQFlagsChunk];
+
 	while (height--) {
 		w1 = *(p - 1 - nextlineSrc);
 		w4 = *(p - 1);
@@ -131,8 +135,10 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 		w5 = *(p);
 		w8 = *(p + nextlineSrc);
 
-		int tmpWidth = width;
-		while (tmpWidth--) {
+		for (int x = 0; x < width; ++x) {
+			if (patternProc && !(x % kHQFlagsChunk))
+				patternProc(p, nextlineSrc, flags, MIN<int>(kHQFlagsChunk, width - x));
+
 			p++;
 
 			w3 = *(p - nextlineSrc);
@@ -140,17 +146,21 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			w9 = *(p + nextlineSrc);
 
 			int pattern = 0;
-			const int yuv5 = YUV(5);
-			if (w5 != w1 && diffYUV(yuv5, YUV(1))) pattern |= 0x0001;
-			if (w5 != w2 && diffYUV(yuv5, YUV(2))) pattern |= 0x0002;
-			if (w5 != w3 && diffYUV(yuv5, YUV(3))) pattern |= 0x0004;
-			if (w5 != w4 && diffYUV(yuv5, YUV(4))) pattern |= 0x0008;
-			if (w5 != w6 && diffYUV(yuv5, YUV(6))) pattern |= 0x0010;
-			if (w5 != w7 && diffYUV(yuv5, YUV(7))) pattern |= 0x0020;
-			if (w5 != w8 && diffYUV(yuv5, YUV(8))) pattern |= 0x0040;
-			if (w5 != w9 && diffYUV(yuv5, YUV(9))) pattern |= 0x0080;
+			if (patternProc) {
+				pattern = flags[x % kHQFlagsChunk];
+			} else {
+				const int yuv5 = YUV(5);
+				if (w5 != w1 && diffYUV(yuv5, YUV(1))) pattern |= 0x0001;
+				if (w5 != w2 && diffYUV(yuv5, YUV(2))) pattern |= 0x0002;
+				if (w5 != w3 && diffYUV(yuv5, YUV(3))) pattern |= 0x0004;
+				if (w5 != w4 && diffYUV(yuv5, YUV(4))) pattern |= 0x0008;
+				if (w5 != w6 && diffYUV(yuv5, YUV(6))) pattern |= 0x0010;
+				if (w5 != w7 && diffYUV(yuv5, YUV(7))) pattern |= 0x0020;
+				if (w5 != w8 && diffYUV(yuv5, YUV(8))) pattern |= 0x0040;
+				if (w5 != w9 && diffYUV(yuv5, YUV(9))) pattern |= 0x0080;
+			}
 
-			switch (pattern) {
+			switch (pattern & kHQPatternMask) {
 			case 0:
 			case 1:
 			case 4:
@@ -283,7 +293,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 18:
 			case 50:
 				PIXEL00_22
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_10
 				} else {
 					PIXEL01_20
@@ -296,7 +306,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL00_20
 				PIXEL01_22
 				PIXEL10_21
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL11_10
 				} else {
 					PIXEL11_20
@@ -306,7 +316,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 76:
 				PIXEL00_21
 				PIXEL01_20
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_10
 				} else {
 					PIXEL10_20
@@ -315,7 +325,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 10:
 			case 138:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_10
 				} else {
 					PIXEL00_20
@@ -371,7 +381,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 22:
 			case 54:
 				PIXEL00_22
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
@@ -384,7 +394,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL00_20
 				PIXEL01_22
 				PIXEL10_21
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
@@ -394,7 +404,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 108:
 				PIXEL00_21
 				PIXEL01_20
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
@@ -403,7 +413,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 11:
 			case 139:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
@@ -414,7 +424,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 19:
 			case 51:
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL00_11
 					PIXEL01_10
 				} else {
@@ -427,7 +437,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 146:
 			case 178:
 				PIXEL00_22
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_10
 					PIXEL11_12
 				} else {
@@ -439,7 +449,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 84:
 			case 85:
 				PIXEL00_20
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL01_11
 					PIXEL11_10
 				} else {
@@ -452,7 +462,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 113:
 				PIXEL00_20
 				PIXEL01_22
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL10_12
 					PIXEL11_10
 				} else {
@@ -464,7 +474,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 204:
 				PIXEL00_21
 				PIXEL01_20
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_10
 					PIXEL11_11
 				} else {
@@ -474,7 +484,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 73:
 			case 77:
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL00_12
 					PIXEL10_10
 				} else {
@@ -486,7 +496,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 42:
 			case 170:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_10
 					PIXEL10_11
 				} else {
@@ -498,7 +508,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 14:
 			case 142:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_10
 					PIXEL01_12
 				} else {
@@ -558,12 +568,12 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 26:
 			case 31:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
@@ -574,13 +584,13 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 82:
 			case 214:
 				PIXEL00_22
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
 				}
 				PIXEL10_21
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
@@ -590,12 +600,12 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 248:
 				PIXEL00_21
 				PIXEL01_22
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
@@ -603,13 +613,13 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 74:
 			case 107:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
 				}
 				PIXEL01_21
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
@@ -617,7 +627,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_22
 				break;
 			case 27:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
@@ -628,7 +638,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 86:
 				PIXEL00_22
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
@@ -640,7 +650,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL00_21
 				PIXEL01_22
 				PIXEL10_10
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
@@ -649,7 +659,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 106:
 				PIXEL00_10
 				PIXEL01_21
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
@@ -658,7 +668,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 30:
 				PIXEL00_10
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
@@ -670,7 +680,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL00_22
 				PIXEL01_10
 				PIXEL10_21
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
@@ -679,7 +689,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 120:
 				PIXEL00_21
 				PIXEL01_22
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
@@ -687,7 +697,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_10
 				break;
 			case 75:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
@@ -769,12 +779,12 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_12
 				break;
 			case 58:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_10
 				} else {
 					PIXEL00_70
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_10
 				} else {
 					PIXEL01_70
@@ -784,13 +794,13 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 83:
 				PIXEL00_11
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_10
 				} else {
 					PIXEL01_70
 				}
 				PIXEL10_21
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL11_10
 				} else {
 					PIXEL11_70
@@ -799,25 +809,25 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 92:
 				PIXEL00_21
 				PIXEL01_11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_10
 				} else {
 					PIXEL10_70
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL11_10
 				} else {
 					PIXEL11_70
 				}
 				break;
 			case 202:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_10
 				} else {
 					PIXEL00_70
 				}
 				PIXEL01_21
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_10
 				} else {
 					PIXEL10_70
@@ -825,13 +835,13 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_11
 				break;
 			case 78:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_10
 				} else {
 					PIXEL00_70
 				}
 				PIXEL01_12
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_10
 				} else {
 					PIXEL10_70
@@ -839,12 +849,12 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_22
 				break;
 			case 154:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_10
 				} else {
 					PIXEL00_70
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_10
 				} else {
 					PIXEL01_70
@@ -854,13 +864,13 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 114:
 				PIXEL00_22
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_10
 				} else {
 					PIXEL01_70
 				}
 				PIXEL10_12
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL11_10
 				} else {
 					PIXEL11_70
@@ -869,34 +879,34 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 89:
 				PIXEL00_12
 				PIXEL01_22
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_10
 				} else {
 					PIXEL10_70
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL11_10
 				} else {
 					PIXEL11_70
 				}
 				break;
 			case 90:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_10
 				} else {
 					PIXEL00_70
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_10
 				} else {
 					PIXEL01_70
 				}
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_10
 				} else {
 					PIXEL10_70
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL11_10
 				} else {
 					PIXEL11_70
@@ -904,7 +914,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 55:
 			case 23:
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL00_11
 					PIXEL01_0
 				} else {
@@ -917,7 +927,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 182:
 			case 150:
 				PIXEL00_22
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_0
 					PIXEL11_12
 				} else {
@@ -929,7 +939,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 213:
 			case 212:
 				PIXEL00_20
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL01_11
 					PIXEL11_0
 				} else {
@@ -942,7 +952,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 240:
 				PIXEL00_20
 				PIXEL01_22
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL10_12
 					PIXEL11_0
 				} else {
@@ -954,7 +964,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 232:
 				PIXEL00_21
 				PIXEL01_20
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_0
 					PIXEL11_11
 				} else {
@@ -964,7 +974,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 109:
 			case 105:
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL00_12
 					PIXEL10_0
 				} else {
@@ -976,7 +986,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 171:
 			case 43:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_0
 					PIXEL10_11
 				} else {
@@ -988,7 +998,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 143:
 			case 15:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_0
 					PIXEL01_12
 				} else {
@@ -1001,7 +1011,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 124:
 				PIXEL00_21
 				PIXEL01_11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
@@ -1009,7 +1019,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_10
 				break;
 			case 203:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
@@ -1020,7 +1030,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 62:
 				PIXEL00_10
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
@@ -1032,7 +1042,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL00_11
 				PIXEL01_10
 				PIXEL10_21
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
@@ -1040,7 +1050,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 118:
 				PIXEL00_22
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
@@ -1052,7 +1062,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL00_12
 				PIXEL01_22
 				PIXEL10_10
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
@@ -1061,7 +1071,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 110:
 				PIXEL00_10
 				PIXEL01_12
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
@@ -1069,7 +1079,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_22
 				break;
 			case 155:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
@@ -1129,24 +1139,24 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 220:
 				PIXEL00_21
 				PIXEL01_11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_10
 				} else {
 					PIXEL10_70
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
 				}
 				break;
 			case 158:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_10
 				} else {
 					PIXEL00_70
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
@@ -1155,13 +1165,13 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_12
 				break;
 			case 234:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_10
 				} else {
 					PIXEL00_70
 				}
 				PIXEL01_21
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
@@ -1170,25 +1180,25 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 242:
 				PIXEL00_22
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_10
 				} else {
 					PIXEL01_70
 				}
 				PIXEL10_12
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
 				}
 				break;
 			case 59:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_10
 				} else {
 					PIXEL01_70
@@ -1199,12 +1209,12 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 121:
 				PIXEL00_12
 				PIXEL01_22
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL11_10
 				} else {
 					PIXEL11_70
@@ -1212,26 +1222,26 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 87:
 				PIXEL00_11
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
 				}
 				PIXEL10_21
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL11_10
 				} else {
 					PIXEL11_70
 				}
 				break;
 			case 79:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
 				}
 				PIXEL01_12
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_10
 				} else {
 					PIXEL10_70
@@ -1239,88 +1249,88 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_22
 				break;
 			case 122:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_10
 				} else {
 					PIXEL00_70
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_10
 				} else {
 					PIXEL01_70
 				}
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL11_10
 				} else {
 					PIXEL11_70
 				}
 				break;
 			case 94:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_10
 				} else {
 					PIXEL00_70
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
 				}
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_10
 				} else {
 					PIXEL10_70
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL11_10
 				} else {
 					PIXEL11_70
 				}
 				break;
 			case 218:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_10
 				} else {
 					PIXEL00_70
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_10
 				} else {
 					PIXEL01_70
 				}
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_10
 				} else {
 					PIXEL10_70
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
 				}
 				break;
 			case 91:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_10
 				} else {
 					PIXEL01_70
 				}
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_10
 				} else {
 					PIXEL10_70
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL11_10
 				} else {
 					PIXEL11_70
@@ -1351,12 +1361,12 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_12
 				break;
 			case 186:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_10
 				} else {
 					PIXEL00_70
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_10
 				} else {
 					PIXEL01_70
@@ -1366,13 +1376,13 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 115:
 				PIXEL00_11
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_10
 				} else {
 					PIXEL01_70
 				}
 				PIXEL10_12
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL11_10
 				} else {
 					PIXEL11_70
@@ -1381,25 +1391,25 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 93:
 				PIXEL00_12
 				PIXEL01_11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_10
 				} else {
 					PIXEL10_70
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL11_10
 				} else {
 					PIXEL11_70
 				}
 				break;
 			case 206:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_10
 				} else {
 					PIXEL00_70
 				}
 				PIXEL01_12
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_10
 				} else {
 					PIXEL10_70
@@ -1410,7 +1420,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 201:
 				PIXEL00_12
 				PIXEL01_20
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_10
 				} else {
 					PIXEL10_70
@@ -1419,7 +1429,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 174:
 			case 46:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_10
 				} else {
 					PIXEL00_70
@@ -1431,7 +1441,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 179:
 			case 147:
 				PIXEL00_11
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_10
 				} else {
 					PIXEL01_70
@@ -1444,7 +1454,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL00_20
 				PIXEL01_11
 				PIXEL10_12
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL11_10
 				} else {
 					PIXEL11_70
@@ -1464,12 +1474,12 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 126:
 				PIXEL00_10
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
 				}
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
@@ -1477,21 +1487,21 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_10
 				break;
 			case 219:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
 				}
 				PIXEL01_10
 				PIXEL10_10
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
 				}
 				break;
 			case 125:
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL00_12
 					PIXEL10_0
 				} else {
@@ -1503,7 +1513,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 221:
 				PIXEL00_12
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL01_11
 					PIXEL11_0
 				} else {
@@ -1513,7 +1523,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_10
 				break;
 			case 207:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_0
 					PIXEL01_12
 				} else {
@@ -1526,7 +1536,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 238:
 				PIXEL00_10
 				PIXEL01_12
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_0
 					PIXEL11_11
 				} else {
@@ -1536,7 +1546,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 190:
 				PIXEL00_10
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_0
 					PIXEL11_12
 				} else {
@@ -1546,7 +1556,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_11
 				break;
 			case 187:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_0
 					PIXEL10_11
 				} else {
@@ -1559,7 +1569,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 243:
 				PIXEL00_11
 				PIXEL01_10
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL10_12
 					PIXEL11_0
 				} else {
@@ -1568,7 +1578,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				}
 				break;
 			case 119:
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL00_11
 					PIXEL01_0
 				} else {
@@ -1582,7 +1592,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 233:
 				PIXEL00_12
 				PIXEL01_20
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_0
 				} else {
 					PIXEL10_100
@@ -1591,7 +1601,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 175:
 			case 47:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_0
 				} else {
 					PIXEL00_100
@@ -1603,7 +1613,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 183:
 			case 151:
 				PIXEL00_11
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_0
 				} else {
 					PIXEL01_100
@@ -1616,7 +1626,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL00_20
 				PIXEL01_11
 				PIXEL10_12
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL11_0
 				} else {
 					PIXEL11_100
@@ -1625,25 +1635,25 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 250:
 				PIXEL00_10
 				PIXEL01_10
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
 				}
 				break;
 			case 123:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
 				}
 				PIXEL01_10
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
@@ -1651,12 +1661,12 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_10
 				break;
 			case 95:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
@@ -1666,13 +1676,13 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 222:
 				PIXEL00_10
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
 				}
 				PIXEL10_10
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
@@ -1681,12 +1691,12 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 252:
 				PIXEL00_21
 				PIXEL01_11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL11_0
 				} else {
 					PIXEL11_100
@@ -1695,25 +1705,25 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 249:
 				PIXEL00_12
 				PIXEL01_22
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_0
 				} else {
 					PIXEL10_100
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
 				}
 				break;
 			case 235:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
 				}
 				PIXEL01_21
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_0
 				} else {
 					PIXEL10_100
@@ -1721,13 +1731,13 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_11
 				break;
 			case 111:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_0
 				} else {
 					PIXEL00_100
 				}
 				PIXEL01_12
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
@@ -1735,12 +1745,12 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_22
 				break;
 			case 63:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_0
 				} else {
 					PIXEL00_100
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
@@ -1749,12 +1759,12 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_21
 				break;
 			case 159:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_0
 				} else {
 					PIXEL01_100
@@ -1764,13 +1774,13 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 215:
 				PIXEL00_11
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_0
 				} else {
 					PIXEL01_100
 				}
 				PIXEL10_21
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
@@ -1778,13 +1788,13 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 246:
 				PIXEL00_22
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
 				}
 				PIXEL10_12
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL11_0
 				} else {
 					PIXEL11_100
@@ -1792,17 +1802,17 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 254:
 				PIXEL00_10
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
 				}
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL11_0
 				} else {
 					PIXEL11_100
@@ -1811,43 +1821,43 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 253:
 				PIXEL00_12
 				PIXEL01_11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_0
 				} else {
 					PIXEL10_100
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL11_0
 				} else {
 					PIXEL11_100
 				}
 				break;
 			case 251:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
 				}
 				PIXEL01_10
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_0
 				} else {
 					PIXEL10_100
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
 				}
 				break;
 			case 239:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_0
 				} else {
 					PIXEL00_100
 				}
 				PIXEL01_12
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_0
 				} else {
 					PIXEL10_100
@@ -1855,17 +1865,17 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_11
 				break;
 			case 127:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_0
 				} else {
 					PIXEL00_100
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
 				}
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
@@ -1873,12 +1883,12 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_10
 				break;
 			case 191:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_0
 				} else {
 					PIXEL00_100
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_0
 				} else {
 					PIXEL01_100
@@ -1887,18 +1897,18 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_12
 				break;
 			case 223:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_0
 				} else {
 					PIXEL01_100
 				}
 				PIXEL10_10
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
@@ -1906,35 +1916,35 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 247:
 				PIXEL00_11
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_0
 				} else {
 					PIXEL01_100
 				}
 				PIXEL10_12
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL11_0
 				} else {
 					PIXEL11_100
 				}
 				break;
 			case 255:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_0
 				} else {
 					PIXEL00_100
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_0
 				} else {
 					PIXEL01_100
 				}
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_0
 				} else {
 					PIXEL10_100
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL11_0
 				} else {
 					PIXEL11_100
@@ -1961,10 +1971,17 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 
 void HQ2x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
 	extern int gBitFormat;
+#ifdef USE_NASM
+	// The assembly version is faster than the C++ one, unless the latter
+	// can use a vectorized HQPatternProc
+	if (!g_hqPatterns) {
+		hq2x_16(srcPtr, dstPtr, width, height, srcPitch, dstPitch);
+		return;
+	}
+#endif
 	if (gBitFormat == 565)
 		HQ2x_implementation<Graphics::ColorMasks<565> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
 	else
 		HQ2x_implementation<Graphics::ColorMasks<555> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
 }
 
-#endif // Assembly version
@@ -21,6 +21,7 @@
  */
 
 #include "graphics/scaler/intern.h"
+#include "common/util.h"
 
 #ifdef USE_NASM
 // Assembly version of HQ3x
@@ -29,18 +30,14 @@ extern "C" {
 
 #if !defined(_WIN32) && !defined(MACOSX) && !defined(__OS2__)
 #define hq3x_16 _hq3x_16
+#define RGBtoYUV _RGBtoYUV
 #endif
 
 
 void hq3x_16(const byte *, byte *, uint32, uint32, uint32, uint32);
 
 }
-
-void HQ3x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
-	hq3x_16(srcPtr, dstPtr, width, height, srcPitch, dstPitch);
-}
-
-#else
+#endif
 
 #define PIXEL00_1M  *(q) = interpolate16_3_1<ColorMask >(w5, w1);
 #define PIXEL00_1U  *(q) = interpolate16_3_1<ColorMask >(w5, w2);
@@ -99,6 +96,10 @@ void HQ3x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
 extern "C" uint32   *RGBtoYUV;
 #define YUV(x)	RGBtoYUV[w ## x]
 
+// Check whether two neighbours of w5 differ. This has either been computed
+// by the vectorized HQPatternProc, or needs to be looked up.
+#define DIFF_YUV(x, y)	(patternProc ? (pattern & kHQDiff ## x ## y) : diffYUV(YUV(x), YUV(y)))
+
 /*
  * The HQ3x high quality 3x graphics filter.
  * Original author Maxim Stepin (see http://www.hiend3d.com/hq3x.html).
@@ -126,6 +127,9 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 	//	 | w7 | w8 | w9 |
 	//	 +----+----+----+
 
+	const HQPatternProc patternProc = g_hqPatterns;
+	uint16 flags[kHQFlagsChunk];
+
 	while (height--) {
 		w1 = *(p - 1 - nextlineSrc);
 		w4 = *(p - 1);
@@ -135,8 +139,10 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 		w5 = *(p);
 		w8 = *(p + nextlineSrc);
 
-		int tmpWidth = width;
-		while (tmpWidth--) {
+		for (int x = 0; x < width; ++x) {
+			if (patternProc && !(x % kHQFlagsChunk))
+				patternProc(p, nextlineSrc, flags, MIN<int>(kHQFlagsChunk, width - x));
+
 			p++;
 
 			w3 = *(p - nextlineSrc);
@@ -144,17 +150,21 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			w9 = *(p + nextlineSrc);
 
 			int pattern = 0;
-			const int yuv5 = YUV(5);
-			if (w5 != w1 && diffYUV(yuv5, YUV(1))) pattern |= 0x0001;
-			if (w5 != w2 && diffYUV(yuv5, YUV(2))) pattern |= 0x0002;
-			if (w5 != w3 && diffYUV(yuv5, YUV(3))) pattern |= 0x0004;
-			if (w5 != w4 && diffYUV(yuv5, YUV(4))) pattern |= 0x0008;
-			if (w5 != w6 && diffYUV(yuv5, YUV(6))) pattern |= 0x0010;
-			if (w5 != w7 && diffYUV(yuv5, YUV(7))) pattern |= 0x0020;
-			if (w5 != w8 && diffYUV(yuv5, YUV(8))) pattern |= 0x0040;
-			if (w5 != w9 && diffYUV(yuv5, YUV(9))) pattern |= 0x0080;
+			if (patternProc) {
+				pattern = flags[x % kHQFlagsChunk];
+			} else {
+				const int yuv5 = YUV(5);
+				if (w5 != w1 && diffYUV(yuv5, YUV(1))) pattern |= 0x0001;
+				if (w5 != w2 && diffYUV(yuv5, YUV(2))) pattern |= 0x0002;
+				if (w5 != w3 && diffYUV(yuv5, YUV(3))) pattern |= 0x0004;
+				if (w5 != w4 && diffYUV(yuv5, YUV(4))) pattern |= 0x0008;
+				if (w5 != w6 && diffYUV(yuv5, YUV(6))) pattern |= 0x0010;
+				if (w5 != w7 && diffYUV(yuv5, YUV(7))) pattern |= 0x0020;
+				if (w5 != w8 && diffYUV(yuv5, YUV(8))) pattern |= 0x0040;
+				if (w5 != w9 && diffYUV(yuv5, YUV(9))) pattern |= 0x0080;
+			}
 
-			switch (pattern) {
+			switch (pattern & kHQPatternMask) {
 			case 0:
 			case 1:
 			case 4:
@@ -352,7 +362,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 18:
 			case 50:
 				PIXEL00_1M
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_C
 					PIXEL02_1M
 					PIXEL12_C
@@ -375,7 +385,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_1
 				PIXEL11
 				PIXEL20_1M
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL12_C
 					PIXEL21_C
 					PIXEL22_1M
@@ -392,7 +402,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL02_2
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_C
 					PIXEL20_1M
 					PIXEL21_C
@@ -405,7 +415,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 10:
 			case 138:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_1M
 					PIXEL01_C
 					PIXEL10_C
@@ -498,7 +508,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 22:
 			case 54:
 				PIXEL00_1M
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_C
 					PIXEL02_C
 					PIXEL12_C
@@ -521,7 +531,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_1
 				PIXEL11
 				PIXEL20_1M
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL12_C
 					PIXEL21_C
 					PIXEL22_C
@@ -538,7 +548,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL02_2
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_C
 					PIXEL20_C
 					PIXEL21_C
@@ -551,7 +561,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 11:
 			case 139:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL10_C
@@ -569,7 +579,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 19:
 			case 51:
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL00_1L
 					PIXEL01_C
 					PIXEL02_1M
@@ -588,7 +598,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 146:
 			case 178:
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_C
 					PIXEL02_1M
 					PIXEL12_C
@@ -607,7 +617,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 84:
 			case 85:
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL02_1U
 					PIXEL12_C
 					PIXEL21_C
@@ -626,7 +636,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 112:
 			case 113:
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL12_C
 					PIXEL20_1L
 					PIXEL21_C
@@ -645,7 +655,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 200:
 			case 204:
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_C
 					PIXEL20_1M
 					PIXEL21_C
@@ -664,7 +674,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 73:
 			case 77:
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL00_1U
 					PIXEL10_C
 					PIXEL20_1M
@@ -683,7 +693,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 42:
 			case 170:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_1M
 					PIXEL01_C
 					PIXEL10_C
@@ -702,7 +712,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 14:
 			case 142:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_1M
 					PIXEL01_C
 					PIXEL02_1R
@@ -809,7 +819,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 26:
 			case 31:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_C
 					PIXEL10_C
 				} else {
@@ -817,7 +827,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL10_3
 				}
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL02_C
 					PIXEL12_C
 				} else {
@@ -832,7 +842,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 82:
 			case 214:
 				PIXEL00_1M
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_C
 					PIXEL02_C
 				} else {
@@ -843,7 +853,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11
 				PIXEL12_C
 				PIXEL20_1M
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL21_C
 					PIXEL22_C
 				} else {
@@ -857,7 +867,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL01_1
 				PIXEL02_1M
 				PIXEL11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_C
 					PIXEL20_C
 				} else {
@@ -865,7 +875,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL20_4
 				}
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL12_C
 					PIXEL22_C
 				} else {
@@ -875,7 +885,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 74:
 			case 107:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_C
 					PIXEL01_C
 				} else {
@@ -886,7 +896,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL20_C
 					PIXEL21_C
 				} else {
@@ -896,7 +906,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1M
 				break;
 			case 27:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL10_C
@@ -914,7 +924,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 86:
 				PIXEL00_1M
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_C
 					PIXEL02_C
 					PIXEL12_C
@@ -936,7 +946,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL20_1M
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL12_C
 					PIXEL21_C
 					PIXEL22_C
@@ -952,7 +962,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL02_1M
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_C
 					PIXEL20_C
 					PIXEL21_C
@@ -965,7 +975,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 30:
 				PIXEL00_1M
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_C
 					PIXEL02_C
 					PIXEL12_C
@@ -987,7 +997,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_1
 				PIXEL11
 				PIXEL20_1M
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL12_C
 					PIXEL21_C
 					PIXEL22_C
@@ -1003,7 +1013,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL02_1M
 				PIXEL11
 				PIXEL12_C
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_C
 					PIXEL20_C
 					PIXEL21_C
@@ -1015,7 +1025,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1M
 				break;
 			case 75:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL10_C
@@ -1164,13 +1174,13 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1D
 				break;
 			case 58:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_1M
 				} else {
 					PIXEL00_2
 				}
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL02_1M
 				} else {
 					PIXEL02_2
@@ -1185,7 +1195,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 83:
 				PIXEL00_1L
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL02_1M
 				} else {
 					PIXEL02_2
@@ -1195,7 +1205,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL12_C
 				PIXEL20_1M
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL22_1M
 				} else {
 					PIXEL22_2
@@ -1208,20 +1218,20 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_C
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL20_1M
 				} else {
 					PIXEL20_2
 				}
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL22_1M
 				} else {
 					PIXEL22_2
 				}
 				break;
 			case 202:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_1M
 				} else {
 					PIXEL00_2
@@ -1231,7 +1241,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL20_1M
 				} else {
 					PIXEL20_2
@@ -1240,7 +1250,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1R
 				break;
 			case 78:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_1M
 				} else {
 					PIXEL00_2
@@ -1250,7 +1260,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL20_1M
 				} else {
 					PIXEL20_2
@@ -1259,13 +1269,13 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1M
 				break;
 			case 154:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_1M
 				} else {
 					PIXEL00_2
 				}
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL02_1M
 				} else {
 					PIXEL02_2
@@ -1280,7 +1290,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 114:
 				PIXEL00_1M
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL02_1M
 				} else {
 					PIXEL02_2
@@ -1290,7 +1300,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL12_C
 				PIXEL20_1L
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL22_1M
 				} else {
 					PIXEL22_2
@@ -1303,26 +1313,26 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_C
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL20_1M
 				} else {
 					PIXEL20_2
 				}
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL22_1M
 				} else {
 					PIXEL22_2
 				}
 				break;
 			case 90:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_1M
 				} else {
 					PIXEL00_2
 				}
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL02_1M
 				} else {
 					PIXEL02_2
@@ -1330,13 +1340,13 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_C
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL20_1M
 				} else {
 					PIXEL20_2
 				}
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL22_1M
 				} else {
 					PIXEL22_2
@@ -1344,7 +1354,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 55:
 			case 23:
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL00_1L
 					PIXEL01_C
 					PIXEL02_C
@@ -1363,7 +1373,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 182:
 			case 150:
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_C
 					PIXEL02_C
 					PIXEL12_C
@@ -1382,7 +1392,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 213:
 			case 212:
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL02_1U
 					PIXEL12_C
 					PIXEL21_C
@@ -1401,7 +1411,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 241:
 			case 240:
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL12_C
 					PIXEL20_1L
 					PIXEL21_C
@@ -1420,7 +1430,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 236:
 			case 232:
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_C
 					PIXEL20_C
 					PIXEL21_C
@@ -1439,7 +1449,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 109:
 			case 105:
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL00_1U
 					PIXEL10_C
 					PIXEL20_C
@@ -1458,7 +1468,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 171:
 			case 43:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL10_C
@@ -1477,7 +1487,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 143:
 			case 15:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL02_1R
@@ -1500,7 +1510,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL02_1U
 				PIXEL11
 				PIXEL12_C
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_C
 					PIXEL20_C
 					PIXEL21_C
@@ -1512,7 +1522,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1M
 				break;
 			case 203:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL10_C
@@ -1530,7 +1540,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 62:
 				PIXEL00_1M
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_C
 					PIXEL02_C
 					PIXEL12_C
@@ -1552,7 +1562,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_1
 				PIXEL11
 				PIXEL20_1M
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL12_C
 					PIXEL21_C
 					PIXEL22_C
@@ -1564,7 +1574,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 118:
 				PIXEL00_1M
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_C
 					PIXEL02_C
 					PIXEL12_C
@@ -1586,7 +1596,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL20_1M
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL12_C
 					PIXEL21_C
 					PIXEL22_C
@@ -1602,7 +1612,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL02_1R
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_C
 					PIXEL20_C
 					PIXEL21_C
@@ -1614,7 +1624,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1M
 				break;
 			case 155:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL10_C
@@ -1724,12 +1734,12 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL02_1U
 				PIXEL10_C
 				PIXEL11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL20_1M
 				} else {
 					PIXEL20_2
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL12_C
 					PIXEL21_C
 					PIXEL22_C
@@ -1740,12 +1750,12 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				}
 				break;
 			case 158:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_1M
 				} else {
 					PIXEL00_2
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_C
 					PIXEL02_C
 					PIXEL12_C
@@ -1761,7 +1771,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1D
 				break;
 			case 234:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_1M
 				} else {
 					PIXEL00_2
@@ -1770,7 +1780,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL02_1M
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_C
 					PIXEL20_C
 					PIXEL21_C
@@ -1784,7 +1794,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 242:
 				PIXEL00_1M
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL02_1M
 				} else {
 					PIXEL02_2
@@ -1792,7 +1802,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_1
 				PIXEL11
 				PIXEL20_1L
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL12_C
 					PIXEL21_C
 					PIXEL22_C
@@ -1803,7 +1813,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				}
 				break;
 			case 59:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL10_C
@@ -1812,7 +1822,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL01_3
 					PIXEL10_3
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL02_1M
 				} else {
 					PIXEL02_2
@@ -1829,7 +1839,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL02_1M
 				PIXEL11
 				PIXEL12_C
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_C
 					PIXEL20_C
 					PIXEL21_C
@@ -1838,7 +1848,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL20_4
 					PIXEL21_3
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL22_1M
 				} else {
 					PIXEL22_2
@@ -1846,7 +1856,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 87:
 				PIXEL00_1L
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_C
 					PIXEL02_C
 					PIXEL12_C
@@ -1859,14 +1869,14 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11
 				PIXEL20_1M
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL22_1M
 				} else {
 					PIXEL22_2
 				}
 				break;
 			case 79:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL10_C
@@ -1878,7 +1888,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL02_1R
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL20_1M
 				} else {
 					PIXEL20_2
@@ -1887,20 +1897,20 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1M
 				break;
 			case 122:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_1M
 				} else {
 					PIXEL00_2
 				}
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL02_1M
 				} else {
 					PIXEL02_2
 				}
 				PIXEL11
 				PIXEL12_C
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_C
 					PIXEL20_C
 					PIXEL21_C
@@ -1909,19 +1919,19 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL20_4
 					PIXEL21_3
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL22_1M
 				} else {
 					PIXEL22_2
 				}
 				break;
 			case 94:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_1M
 				} else {
 					PIXEL00_2
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_C
 					PIXEL02_C
 					PIXEL12_C
@@ -1932,38 +1942,38 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				}
 				PIXEL10_C
 				PIXEL11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL20_1M
 				} else {
 					PIXEL20_2
 				}
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL22_1M
 				} else {
 					PIXEL22_2
 				}
 				break;
 			case 218:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_1M
 				} else {
 					PIXEL00_2
 				}
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL02_1M
 				} else {
 					PIXEL02_2
 				}
 				PIXEL10_C
 				PIXEL11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL20_1M
 				} else {
 					PIXEL20_2
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL12_C
 					PIXEL21_C
 					PIXEL22_C
@@ -1974,7 +1984,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				}
 				break;
 			case 91:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL10_C
@@ -1983,20 +1993,20 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL01_3
 					PIXEL10_3
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL02_1M
 				} else {
 					PIXEL02_2
 				}
 				PIXEL11
 				PIXEL12_C
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL20_1M
 				} else {
 					PIXEL20_2
 				}
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL22_1M
 				} else {
 					PIXEL22_2
@@ -2047,13 +2057,13 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1D
 				break;
 			case 186:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_1M
 				} else {
 					PIXEL00_2
 				}
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL02_1M
 				} else {
 					PIXEL02_2
@@ -2068,7 +2078,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 115:
 				PIXEL00_1L
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL02_1M
 				} else {
 					PIXEL02_2
@@ -2078,7 +2088,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL12_C
 				PIXEL20_1L
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL22_1M
 				} else {
 					PIXEL22_2
@@ -2091,20 +2101,20 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_C
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL20_1M
 				} else {
 					PIXEL20_2
 				}
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL22_1M
 				} else {
 					PIXEL22_2
 				}
 				break;
 			case 206:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_1M
 				} else {
 					PIXEL00_2
@@ -2114,7 +2124,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL20_1M
 				} else {
 					PIXEL20_2
@@ -2130,7 +2140,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL20_1M
 				} else {
 					PIXEL20_2
@@ -2140,7 +2150,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 174:
 			case 46:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_1M
 				} else {
 					PIXEL00_2
@@ -2158,7 +2168,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 147:
 				PIXEL00_1L
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL02_1M
 				} else {
 					PIXEL02_2
@@ -2180,7 +2190,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL12_C
 				PIXEL20_1L
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL22_1M
 				} else {
 					PIXEL22_2
@@ -2210,7 +2220,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 126:
 				PIXEL00_1M
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_C
 					PIXEL02_C
 					PIXEL12_C
@@ -2220,7 +2230,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL12_3
 				}
 				PIXEL11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_C
 					PIXEL20_C
 					PIXEL21_C
@@ -2232,7 +2242,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1M
 				break;
 			case 219:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL10_C
@@ -2244,7 +2254,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL02_1M
 				PIXEL11
 				PIXEL20_1M
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL12_C
 					PIXEL21_C
 					PIXEL22_C
@@ -2255,7 +2265,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				}
 				break;
 			case 125:
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL00_1U
 					PIXEL10_C
 					PIXEL20_C
@@ -2273,7 +2283,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1M
 				break;
 			case 221:
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL02_1U
 					PIXEL12_C
 					PIXEL21_C
@@ -2291,7 +2301,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL20_1M
 				break;
 			case 207:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL02_1R
@@ -2309,7 +2319,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1R
 				break;
 			case 238:
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_C
 					PIXEL20_C
 					PIXEL21_C
@@ -2327,7 +2337,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL12_1
 				break;
 			case 190:
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_C
 					PIXEL02_C
 					PIXEL12_C
@@ -2345,7 +2355,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL21_1
 				break;
 			case 187:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL10_C
@@ -2363,7 +2373,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1D
 				break;
 			case 243:
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL12_C
 					PIXEL20_1L
 					PIXEL21_C
@@ -2381,7 +2391,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11
 				break;
 			case 119:
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL00_1L
 					PIXEL01_C
 					PIXEL02_C
@@ -2406,7 +2416,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL20_C
 				} else {
 					PIXEL20_2
@@ -2416,7 +2426,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 175:
 			case 47:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_C
 				} else {
 					PIXEL00_2
@@ -2434,7 +2444,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 151:
 				PIXEL00_1L
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL02_C
 				} else {
 					PIXEL02_2
@@ -2456,7 +2466,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL12_C
 				PIXEL20_1L
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL22_C
 				} else {
 					PIXEL22_2
@@ -2467,7 +2477,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL01_C
 				PIXEL02_1M
 				PIXEL11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_C
 					PIXEL20_C
 				} else {
@@ -2475,7 +2485,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL20_4
 				}
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL12_C
 					PIXEL22_C
 				} else {
@@ -2484,7 +2494,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				}
 				break;
 			case 123:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_C
 					PIXEL01_C
 				} else {
@@ -2495,7 +2505,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_C
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL20_C
 					PIXEL21_C
 				} else {
@@ -2505,7 +2515,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1M
 				break;
 			case 95:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_C
 					PIXEL10_C
 				} else {
@@ -2513,7 +2523,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL10_3
 				}
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL02_C
 					PIXEL12_C
 				} else {
@@ -2527,7 +2537,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 222:
 				PIXEL00_1M
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_C
 					PIXEL02_C
 				} else {
@@ -2538,7 +2548,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11
 				PIXEL12_C
 				PIXEL20_1M
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL21_C
 					PIXEL22_C
 				} else {
@@ -2552,7 +2562,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL02_1U
 				PIXEL11
 				PIXEL12_C
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_C
 					PIXEL20_C
 				} else {
@@ -2560,7 +2570,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL20_4
 				}
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL22_C
 				} else {
 					PIXEL22_2
@@ -2572,13 +2582,13 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL02_1M
 				PIXEL10_C
 				PIXEL11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL20_C
 				} else {
 					PIXEL20_2
 				}
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL12_C
 					PIXEL22_C
 				} else {
@@ -2587,7 +2597,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				}
 				break;
 			case 235:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_C
 					PIXEL01_C
 				} else {
@@ -2598,7 +2608,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL20_C
 				} else {
 					PIXEL20_2
@@ -2607,7 +2617,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1R
 				break;
 			case 111:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_C
 				} else {
 					PIXEL00_2
@@ -2617,7 +2627,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL20_C
 					PIXEL21_C
 				} else {
@@ -2627,13 +2637,13 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1M
 				break;
 			case 63:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_C
 				} else {
 					PIXEL00_2
 				}
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL02_C
 					PIXEL12_C
 				} else {
@@ -2647,7 +2657,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1M
 				break;
 			case 159:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_C
 					PIXEL10_C
 				} else {
@@ -2655,7 +2665,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL10_3
 				}
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL02_C
 				} else {
 					PIXEL02_2
@@ -2669,7 +2679,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 215:
 				PIXEL00_1L
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL02_C
 				} else {
 					PIXEL02_2
@@ -2678,7 +2688,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11
 				PIXEL12_C
 				PIXEL20_1M
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL21_C
 					PIXEL22_C
 				} else {
@@ -2688,7 +2698,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 246:
 				PIXEL00_1M
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_C
 					PIXEL02_C
 				} else {
@@ -2700,7 +2710,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL12_C
 				PIXEL20_1L
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL22_C
 				} else {
 					PIXEL22_2
@@ -2708,7 +2718,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 254:
 				PIXEL00_1M
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_C
 					PIXEL02_C
 				} else {
@@ -2716,14 +2726,14 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL02_4
 				}
 				PIXEL11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_C
 					PIXEL20_C
 				} else {
 					PIXEL10_3
 					PIXEL20_4
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL12_C
 					PIXEL21_C
 					PIXEL22_C
@@ -2740,20 +2750,20 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_C
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL20_C
 				} else {
 					PIXEL20_2
 				}
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL22_C
 				} else {
 					PIXEL22_2
 				}
 				break;
 			case 251:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_C
 					PIXEL01_C
 				} else {
@@ -2762,7 +2772,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				}
 				PIXEL02_1M
 				PIXEL11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL10_C
 					PIXEL20_C
 					PIXEL21_C
@@ -2771,7 +2781,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL20_2
 					PIXEL21_3
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL12_C
 					PIXEL22_C
 				} else {
@@ -2780,7 +2790,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				}
 				break;
 			case 239:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_C
 				} else {
 					PIXEL00_2
@@ -2790,7 +2800,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL20_C
 				} else {
 					PIXEL20_2
@@ -2799,7 +2809,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1R
 				break;
 			case 127:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL10_C
@@ -2808,7 +2818,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL01_3
 					PIXEL10_3
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL02_C
 					PIXEL12_C
 				} else {
@@ -2816,7 +2826,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL12_3
 				}
 				PIXEL11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL20_C
 					PIXEL21_C
 				} else {
@@ -2826,13 +2836,13 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1M
 				break;
 			case 191:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_C
 				} else {
 					PIXEL00_2
 				}
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL02_C
 				} else {
 					PIXEL02_2
@@ -2845,14 +2855,14 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1D
 				break;
 			case 223:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_C
 					PIXEL10_C
 				} else {
 					PIXEL00_4
 					PIXEL10_3
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL01_C
 					PIXEL02_C
 					PIXEL12_C
@@ -2863,7 +2873,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				}
 				PIXEL11
 				PIXEL20_1M
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL21_C
 					PIXEL22_C
 				} else {
@@ -2874,7 +2884,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 247:
 				PIXEL00_1L
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL02_C
 				} else {
 					PIXEL02_2
@@ -2884,20 +2894,20 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL12_C
 				PIXEL20_1L
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL22_C
 				} else {
 					PIXEL22_2
 				}
 				break;
 			case 255:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_YUV(4, 2)) {
 					PIXEL00_C
 				} else {
 					PIXEL00_2
 				}
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_YUV(2, 6)) {
 					PIXEL02_C
 				} else {
 					PIXEL02_2
@@ -2905,13 +2915,13 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_C
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_YUV(8, 4)) {
 					PIXEL20_C
 				} else {
 					PIXEL20_2
 				}
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_YUV(6, 8)) {
 					PIXEL22_C
 				} else {
 					PIXEL22_2
@@ -2938,10 +2948,17 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 
 void HQ3x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
 	extern int gBitFormat;
+#ifdef USE_NASM
+	// The assembly version is faster than the C++ one, unless the latter
+	// can use a vectorized HQPatternProc
+	if (!g_hqPatterns) {
+		hq3x_16(srcPtr, dstPtr, width, height, srcPitch, dstPitch);
+		return;
+	}
+#endif
 	if (gBitFormat == 565)
 		HQ3x_implementation<Graphics::ColorMasks<565> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
 	else
 		HQ3x_implementation<Graphics::ColorMasks<555> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
 }
 
-#endif // Assembly version
@@ -0,0 +1,122 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "graphics/scaler/intern.h"
+
+#include <immintrin.h>
+
+namespace {
+
+/**
+ * The Y, U and V components of sixteen pixels, as computed by InitLUT(),
+ * except for the offset of U and V, which does not matter for diffYUV().
+ */
+struct YUVVector {
+	__m256i y, u, v;
+};
+
+inline __m256i expand5(__m256i c) {
+	return _mm256_or_si256(_mm256_slli_epi16(c, 3), _mm256_srli_epi16(c, 2));
+}
+
+template<int bitFormat>
+inline YUVVector loadYUV(const uint16 *src) {
+	const __m256i c = _mm256_loadu_si256((const __m256i *)src);
+	const __m256i mask5 = _mm256_set1_epi16(0x1F);
+
+	__m256i r, g;
+	if (bitFormat == 565) {
+		r = expand5(_mm256_srli_epi16(c, 11));
+		g = _mm256_and_si256(_mm256_srli_epi16(c, 5), _mm256_set1_epi16(0x3F));
+		g = _mm256_or_si256(_mm256_slli_epi16(g, 2), _mm256_srli_epi16(g, 4));
+	} else {
+		r = expand5(_mm256_and_si256(_mm256_srli_epi16(c, 10), mask5));
+		g = expand5(_mm256_and_si256(_mm256_srli_epi16(c, 5), mask5));
+	}
+	const __m256i b = expand5(_mm256_and_si256(c, mask5));
+
+	YUVVector yuv;
+	yuv.y = _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(r, g), b), 2);
+	yuv.u = _mm256_srai_epi16(_mm256_sub_epi16(r, b), 2);
+	yuv.v = _mm256_srai_epi16(_mm256_sub_epi16(_mm256_sub_epi16(_mm256_add_epi16(g, g), r), b), 3);
+	return yuv;
+}
+
+inline __m256i absDiffGreater(__m256i a, __m256i b, int threshold) {
+	const __m256i diff = _mm256_sub_epi16(a, b);
+	const __m256i absDiff = _mm256_max_epi16(diff, _mm256_sub_epi16(_mm256_setzero_si256(), diff));
+	return _mm256_cmpgt_epi16(absDiff, _mm256_set1_epi16(threshold));
+}
+
+/** Return the given flag for all pixels for which diffYUV() is true. */
+inline __m256i diffYUV(const YUVVector &a, const YUVVector &b, int flag) {
+	const __m256i diff = _mm256_or_si256(_mm256_or_si256(absDiffGreater(a.y, b.y, 48),
+	                                               absDiffGreater(a.u, b.u, 7)),
+	                                  absDiffGreater(a.v, b.v, 6));
+	return _mm256_and_si256(diff, _mm256_set1_epi16(flag));
+}
+
+template<int bitFormat>
+void hqPatternsAVX2(const uint16 *src, uint32 nextlineSrc, uint16 *flags, int width) {
+	int x = 0;
+	for (; x + 16 <= width; x += 16) {
+		const uint16 *p = src + x;
+
+		const YUVVector w1 = loadYUV<bitFormat>(p - 1 - nextlineSrc);
+		const YUVVector w2 = loadYUV<bitFormat>(p - nextlineSrc);
+		const YUVVector w3 = loadYUV<bitFormat>(p + 1 - nextlineSrc);
+		const YUVVector w4 = loadYUV<bitFormat>(p - 1);
+		const YUVVector w5 = loadYUV<bitFormat>(p);
+		const YUVVector w6 = loadYUV<bitFormat>(p + 1);
+		const YUVVector w7 = loadYUV<bitFormat>(p - 1 + nextlineSrc);
+		const YUVVector w8 = loadYUV<bitFormat>(p + nextlineSrc);
+		const YUVVector w9 = loadYUV<bitFormat>(p + 1 + nextlineSrc);
+
+		__m256i pattern = _mm256_or_si256(diffYUV(w5, w1, 0x0001), diffYUV(w5, w2, 0x0002));
+		pattern = _mm256_or_si256(pattern, _mm256_or_si256(diffYUV(w5, w3, 0x0004), diffYUV(w5, w4, 0x0008)));
+		pattern = _mm256_or_si256(pattern, _mm256_or_si256(diffYUV(w5, w6, 0x0010), diffYUV(w5, w7, 0x0020)));
+		pattern = _mm256_or_si256(pattern, _mm256_or_si256(diffYUV(w5, w8, 0x0040), diffYUV(w5, w9, 0x0080)));
+		pattern = _mm256_or_si256(pattern, _mm256_or_si256(diffYUV(w2, w6, kHQDiff26), diffYUV(w6, w8, kHQDiff68)));
+		pattern = _mm256_or_si256(pattern, _mm256_or_si256(diffYUV(w8, w4, kHQDiff84), diffYUV(w4, w2, kHQDiff42)));
+
+		_mm256_storeu_si256((__m256i *)(flags + x), pattern);
+	}
+
+	// AVX2 implies SSE2, which handles most of the remaining pixels
+	if (x < width) {
+		if (bitFormat == 565)
+			hqPatterns565SSE2(src + x, nextlineSrc, flags + x, width - x);
+		else
+			hqPatterns555SSE2(src + x, nextlineSrc, flags + x, width - x);
+	}
+}
+
+} // End of anonymous namespace
+
+void hqPatterns565AVX2(const uint16 *src, uint32 nextlineSrc, uint16 *flags, int width) {
+	hqPatternsAVX2<565>(src, nextlineSrc, flags, width);
+}
+
+void hqPatterns555AVX2(const uint16 *src, uint32 nextlineSrc, uint16 *flags, int width) {
+	hqPatternsAVX2<555>(src, nextlineSrc, flags, width);
+}
@@ -524,4 +524,52 @@ static inline bool diffYUV(int yuv1, int yuv2) {
 */
 }
 
+#ifdef USE_HQ_SCALERS
+/**
+ * Flags computed for every source pixel by the hq scaler family. The low
+ * byte holds the pattern, i.e. which of the neighbours w1-w9 differ from
+ * the center pixel w5 according to diffYUV(). The remaining bits tell
+ * whether the direct neighbours of w5 differ from each other.
+ */
+enum {
+	kHQPatternMask = 0x00FF,
+	kHQDiff26      = 0x0100,
+	kHQDiff68      = 0x0200,
+	kHQDiff84      = 0x0400,
+	kHQDiff42      = 0x0800,
+
+	/** Number of pixels the hq scalers compute the flags for at once. */
+	kHQFlagsChunk  = 256
+};
+
+/**
+ * Compute the hq flags for a row of pixels. Like the scalers themselves,
+ * this also reads the pixels above and below the row, as well as the pixel
+ * left of its start and the one right of its end.
+ */
+typedef void (*HQPatternProc)(const uint16 *src, uint32 nextlineSrc, uint16 *flags, int width);
+
+/**
+ * The vectorized HQPatternProc used by HQ2x and HQ3x, or 0 if there is none
+ * for the CPU and pixel format. This is set up by InitLUT().
+ */
+extern HQPatternProc g_hqPatterns;
+
+/**
+ * Compute the hq flags from the RGBtoYUV table, for any pixel format. The
+ * vectorized versions use this for the pixels at the end of a row.
+ */
+void hqPatternsScalar(const uint16 *src, uint32 nextlineSrc, uint16 *flags, int width);
+
+#ifdef SCUMMVM_SSE2
+void hqPatterns565SSE2(const uint16 *src, uint32 nextlineSrc, uint16 *flags, int width);
+void hqPatterns555SSE2(const uint16 *src, uint32 nextlineSrc, uint16 *flags, int width);
+#endif
+
+#ifdef SCUMMVM_AVX2
+void hqPatterns565AVX2(const uint16 *src, uint32 nextlineSrc, uint16 *flags, int width);
+void hqPatterns555AVX2(const uint16 *src, uint32 nextlineSrc, uint16 *flags, int width);
+#endif
+#endif
+
 #endif
@@ -27,6 +27,7 @@
  */
 
 #include "graphics/tinygl/zgl.h"
+#include "graphics/tinygl/ztiles.h"
 
 // glVertex
 
@@ -690,3 +691,23 @@ void tglEnableDirtyRects(bool enable) {
 	TinyGL::GLContext *c = TinyGL::gl_get_context();
 	c->_enableDirtyRectangles = enable;
 }
+
+void tglEnableHierarchicalZ(bool enable) {
+	TinyGL::GLContext *c = TinyGL::gl_get_context();
+	c->fb->enableHierarchicalZ(enable);
+}
+
+void tglSetRenderThreads(int count) {
+	TinyGL::GLContext *c = TinyGL::gl_get_context();
+	delete c->_tileRenderer;
+	c->_tileRenderer = nullptr;
+	if (count == 1)
+		return;
+
+	// Without worker threads, the draw calls are simply executed in order
+	TinyGL::TileRenderer *renderer = new TinyGL::TileRenderer(c, MAX(count, 0));
+	if (renderer->getThreadCount() > 1)
+		c->_tileRenderer = renderer;
+	else
+		delete renderer;
+}
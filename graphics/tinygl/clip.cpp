@@ -287,8 +287,8 @@ void gl_draw_triangle(GLContext *c, GLVertex *p0, GLVertex *p1, GLVertex *p2) {
 }
 
 static void gl_draw_triangle_clip(GLContext *c, GLVertex *p0, GLVertex *p1, GLVertex *p2, int clip_bit) {
-	int co, c_and, co1, cc[3], edge_flag_tmp, clip_mask;
-	GLVertex tmp1, tmp2, *q[3];
+	int co, c_and, co1, cc[3], clip_mask;
+	GLVertex tmp1, tmp2, tmp3, *q[3];
 	float tt;
 
 	cc[0] = p0->clip_code;
@@ -339,14 +339,15 @@ static void gl_draw_triangle_clip(GLContext *c, GLVertex *p0, GLVertex *p1, GLVe
 			tt = clip_proc[clip_bit](&tmp2.pc, &q[0]->pc, &q[2]->pc);
 			updateTmp(c, &tmp2, q[0], q[2], tt);
 
+			// The edge flag is changed on a copy, as the same vertices may
+			// be drawn by several threads at once
 			tmp1.edge_flag = q[0]->edge_flag;
-			edge_flag_tmp = q[2]->edge_flag;
-			q[2]->edge_flag = 0;
-			gl_draw_triangle_clip(c, &tmp1, q[1], q[2], clip_bit + 1);
+			tmp3 = *q[2];
+			tmp3.edge_flag = 0;
+			gl_draw_triangle_clip(c, &tmp1, q[1], &tmp3, clip_bit + 1);
 
 			tmp2.edge_flag = 1;
 			tmp1.edge_flag = 0;
-			q[2]->edge_flag = edge_flag_tmp;
 			gl_draw_triangle_clip(c, &tmp2, &tmp1, q[2], clip_bit + 1);
 		} else {
 			// two points outside
@@ -411,11 +412,14 @@ void gl_draw_triangle_fill(GLContext *c, GLVertex *p0, GLVertex *p1, GLVertex *p
 #ifdef TINYGL_PROFILE
 		count_triangles_textured++;
 #endif
+		// Texture mapping stores temporary coordinates in the points, so
+		// draw copies: the vertices may be shared with other threads
+		ZBufferPoint zp0 = p0->zp, zp1 = p1->zp, zp2 = p2->zp;
 		c->fb->setTexture(c->current_texture->images[0].pixmap, c->texture_wrap_s, c->texture_wrap_t);
 		if (c->current_shade_model == TGL_SMOOTH) {
-			c->fb->fillTriangleTextureMappingPerspectiveSmooth(&p0->zp, &p1->zp, &p2->zp);
+			c->fb->fillTriangleTextureMappingPerspectiveSmooth(&zp0, &zp1, &zp2);
 		} else {
-			c->fb->fillTriangleTextureMappingPerspectiveFlat(&p0->zp, &p1->zp, &p2->zp);
+			c->fb->fillTriangleTextureMappingPerspectiveFlat(&zp0, &zp1, &zp2);
 		}
 	} else if (c->current_shade_model == TGL_SMOOTH) {
 		c->fb->fillTriangleSmooth(&p0->zp, &p1->zp, &p2->zp);
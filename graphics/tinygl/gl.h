@@ -850,6 +850,12 @@ void tglTexCoordPointer(TGLint size, TGLenum type, TGLsizei stride, const TGLvoi
 void tglPolygonOffset(TGLfloat factor, TGLfloat units);
 
 void tglEnableDirtyRects(bool enable);
+// Number of threads rendering the screen in tiles, 0 = one per CPU core and
+// 1 = no tiles. Only call this between frames.
+void tglSetRenderThreads(int count);
+// Reject hidden triangles and spans early, using the depth bounds of blocks
+// of the z buffer. Only call this between frames.
+void tglEnableHierarchicalZ(bool enable);
 
 void tglDebug(int mode);
 
@@ -29,6 +29,7 @@
 #include "graphics/tinygl/zgl.h"
 #include "graphics/tinygl/zblit.h"
 #include "graphics/tinygl/zdirtyrect.h"
+#include "graphics/tinygl/ztiles.h"
 
 namespace TinyGL {
 
@@ -231,9 +232,10 @@ void glInit(void *zbuffer1, int textureSize) {
 	const int kDrawCallMemory = 5 * 1024 * 1024;
 
 	c->_currentAllocatorIndex = 0;
-	c->_drawCallAllocator[0].initialize(kDrawCallMemory);
-	c->_drawCallAllocator[1].initialize(kDrawCallMemory);
+	c->_drawCallAllocator[0] = new Common::FrameArena("TinyGL draw calls", kDrawCallMemory);
+	c->_drawCallAllocator[1] = new Common::FrameArena("TinyGL draw calls", kDrawCallMemory);
 	c->_enableDirtyRectangles = true;
+	c->_tileRenderer = nullptr;
 
 	Graphics::Internal::tglBlitResetScissorRect();
 }
@@ -243,6 +245,9 @@ void glClose() {
 
 	tglDisposeDrawCallLists(c);
 	tglDisposeResources(c);
+	delete c->_tileRenderer;
+	delete c->_drawCallAllocator[0];
+	delete c->_drawCallAllocator[1];
 
 	specbuf_cleanup(c);
 	for (int i = 0; i < 3; i++)
@@ -251,6 +256,7 @@ void glClose() {
 	gl_free(c->vertex);
 
 	delete c;
+	gl_ctx = nullptr;
 }
 
 } // end of namespace TinyGL
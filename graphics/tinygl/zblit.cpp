@@ -198,6 +198,11 @@ public:
 			dstBuf.shiftBy(c->fb->xsize);
 			srcBuf.shiftBy(_surface.w);
 		}
+
+		// The depth bounds of the blocks are read again when triangles are
+		// tested against them
+		if (c->fb->_hierarchicalZ)
+			c->fb->_hierarchicalZ->invalidate(Common::Rect(dstX, dstY, dstX + clampWidth, dstY + clampHeight));
 	}
 
 	template <bool kDisableColoring, bool kDisableBlending, bool kEnableAlphaBlending>
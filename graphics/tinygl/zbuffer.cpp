@@ -93,10 +93,13 @@ FrameBuffer::FrameBuffer(int width, int height, const Graphics::PixelBuffer &fra
 	memset(this->_zbuf, 0, size);
 
 	this->frame_buffer_allocated = 0;
+	this->zbuffer_allocated = 1;
 	this->pbuf = frame_buffer;
 
 	this->current_texture = NULL;
 	this->shadow_mask_buf = NULL;
+	this->_spanFillers = getSpanFillers(this->cmode);
+	this->_hierarchicalZ = NULL;
 
 	this->buffer.pbuf = this->pbuf.getRawBuffer();
 	this->buffer.zbuf = this->_zbuf;
@@ -121,9 +124,12 @@ FrameBuffer::FrameBuffer(int width, int height, const Graphics::PixelFormat &for
 	byte *pixelBuffer = (byte *)gl_malloc(this->ysize * this->linesize);
 	this->pbuf.set(this->cmode, pixelBuffer);
 	this->frame_buffer_allocated = 1;
+	this->zbuffer_allocated = 1;
 
 	this->current_texture = NULL;
 	this->shadow_mask_buf = NULL;
+	this->_spanFillers = getSpanFillers(this->cmode);
+	this->_hierarchicalZ = NULL;
 
 	this->buffer.pbuf = this->pbuf.getRawBuffer();
 	this->buffer.zbuf = this->_zbuf;
@@ -136,7 +142,27 @@ FrameBuffer::FrameBuffer(int width, int height, const Graphics::PixelFormat &for
 FrameBuffer::~FrameBuffer() {
 	if (frame_buffer_allocated)
 		pbuf.free();
-	gl_free(_zbuf);
+	if (zbuffer_allocated)
+		gl_free(_zbuf);
+	delete _hierarchicalZ;
+}
+
+void FrameBuffer::shareBuffers(const FrameBuffer &other) {
+	*this = other;
+	this->frame_buffer_allocated = 0;
+	this->zbuffer_allocated = 0;
+	// Only the owner of the z buffer keeps its depth bounds
+	this->_hierarchicalZ = NULL;
+}
+
+void FrameBuffer::enableHierarchicalZ(bool enable) {
+	if (enable && !_hierarchicalZ) {
+		_hierarchicalZ = new HierarchicalZ(xsize, ysize);
+		_hierarchicalZ->invalidate();
+	} else if (!enable) {
+		delete _hierarchicalZ;
+		_hierarchicalZ = NULL;
+	}
 }
 
 Buffer *FrameBuffer::genOffscreenBuffer() {
@@ -166,6 +192,8 @@ void FrameBuffer::clear(int clearZ, int z, int clearColor, int r, int g, int b)
 			// Cannot use memset, use a variant working on integers (slow)
 			memset_l(this->_zbuf, z, this->xsize * this->ysize);
 		}
+		if (_hierarchicalZ)
+			_hierarchicalZ->fill(Common::Rect(this->xsize, this->ysize), z);
 	}
 	if (clearColor) {
 		byte *pp = this->pbuf.getRawBuffer();
@@ -212,6 +240,8 @@ void FrameBuffer::clearRegion(int x, int y, int w, int h, int clearZ, int z, int
 				zbuf += this->xsize;
 			}
 		}
+		if (_hierarchicalZ)
+			_hierarchicalZ->fill(Common::Rect(x, y, x + w, y + h), z);
 	}
 	if (clearColor) {
 		int height = h;
@@ -304,6 +334,8 @@ void FrameBuffer::blitOffscreenBuffer(Buffer *buf) {
 		case 0x1: blitPixel(0x0, from_z, to_z, sizeof(int), from, to, pixel_bytes); // fall through
 		case 0x0: break;
 		}
+		if (_hierarchicalZ)
+			_hierarchicalZ->invalidate();
 	}
 #undef UNROLL_COUNT
 }
@@ -317,12 +349,16 @@ void FrameBuffer::selectOffscreenBuffer(Buffer *buf) {
 		this->pbuf = this->buffer.pbuf;
 		this->_zbuf = this->buffer.zbuf;
 	}
+	if (_hierarchicalZ)
+		_hierarchicalZ->invalidate();
 }
 
 void FrameBuffer::clearOffscreenBuffer(Buffer *buf) {
 	memset(buf->pbuf, 0, this->ysize * this->linesize);
 	memset(buf->zbuf, 0, this->ysize * this->xsize * sizeof(unsigned int));
 	buf->used = false;
+	if (_hierarchicalZ && buf->zbuf == _zbuf)
+		_hierarchicalZ->fill(Common::Rect(this->xsize, this->ysize), 0);
 }
 
 void FrameBuffer::setTexture(const Graphics::TexelBuffer *texture, unsigned int wraps, unsigned int wrapt) {
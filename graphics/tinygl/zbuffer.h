@@ -32,6 +32,8 @@
 #include "graphics/pixelbuffer.h"
 #include "graphics/tinygl/texelbuffer.h"
 #include "graphics/tinygl/gl.h"
+#include "graphics/tinygl/zspan.h"
+#include "graphics/tinygl/zhiz.h"
 #include "common/rect.h"
 
 namespace TinyGL {
@@ -105,6 +107,20 @@ struct FrameBuffer {
 	FrameBuffer(int xsize, int ysize, const Graphics::PixelFormat &format);
 	~FrameBuffer();
 
+	/**
+	 * Make this frame buffer draw into the color and z buffers of @p other,
+	 * and copy its state. The buffers stay owned by @p other.
+	 */
+	void shareBuffers(const FrameBuffer &other);
+
+	/**
+	 * Enable or disable keeping the depth bounds of blocks of the z buffer,
+	 * which are used to reject hidden triangles and spans early. This is
+	 * disabled by default, since it only pays off in scenes with a lot of
+	 * occlusion.
+	 */
+	void enableHierarchicalZ(bool enable);
+
 	Buffer *genOffscreenBuffer();
 	void delOffscreenBuffer(Buffer *buffer);
 	void clear(int clear_z, int z, int clear_color, int r, int g, int b);
@@ -480,6 +496,7 @@ struct FrameBuffer {
 	int shadow_color_g;
 	int shadow_color_b;
 	int frame_buffer_allocated;
+	int zbuffer_allocated;
 
 	unsigned char *dctable;
 	int *ctable;
@@ -487,6 +504,8 @@ struct FrameBuffer {
 	int _textureSize;
 	int _textureSizeMask;
 	unsigned int wrapS, wrapT;
+	const SpanFillers *_spanFillers; // 0 if triangles are drawn one pixel at a time
+	HierarchicalZ *_hierarchicalZ; // 0 if depths are only tested pixel by pixel
 
 	FORCEINLINE bool isBlendingEnabled() const { return _blendingEnabled; }
 	FORCEINLINE void getBlendingFactors(int &sourceFactor, int &destinationFactor) const { sourceFactor = _sourceBlendingFactor; destinationFactor = _destinationBlendingFactor; }
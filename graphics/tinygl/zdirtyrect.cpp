@@ -28,6 +28,7 @@
 
 #include "graphics/tinygl/zdirtyrect.h"
 #include "graphics/tinygl/zgl.h"
+#include "graphics/tinygl/ztiles.h"
 #include "graphics/tinygl/gl.h"
 #include "common/debug.h"
 #include "common/math.h"
@@ -195,12 +196,20 @@ static void tglPresentBufferDirtyRects(TinyGL::GLContext *c) {
 
 	if (!rectangles.empty()) {
 		// Execute draw calls.
-		for (DrawCallIterator it = c->_drawCallsQueue.begin(); it != c->_drawCallsQueue.end(); ++it) {
-			Common::Rect drawCallRegion = (*it)->getDirtyRegion();
+		if (c->_tileRenderer) {
+			Common::Array<Common::Rect> dirtyRegions;
 			for (RectangleIterator itRect = rectangles.begin(); itRect != rectangles.end(); ++itRect) {
-				Common::Rect dirtyRegion = (*itRect).rectangle;
-				if (dirtyRegion.intersects(drawCallRegion)) {
-					(*it)->execute(dirtyRegion, true);
+				dirtyRegions.push_back((*itRect).rectangle);
+			}
+			c->_tileRenderer->render(c->_drawCallsQueue, dirtyRegions);
+		} else {
+			for (DrawCallIterator it = c->_drawCallsQueue.begin(); it != c->_drawCallsQueue.end(); ++it) {
+				Common::Rect drawCallRegion = (*it)->getDirtyRegion();
+				for (RectangleIterator itRect = rectangles.begin(); itRect != rectangles.end(); ++itRect) {
+					Common::Rect dirtyRegion = (*itRect).rectangle;
+					if (dirtyRegion.intersects(drawCallRegion)) {
+						(*it)->execute(dirtyRegion, true);
+					}
 				}
 			}
 		}
@@ -236,22 +245,29 @@ static void tglPresentBufferDirtyRects(TinyGL::GLContext *c) {
 	tglDisposeResources(c);
 
 	c->_currentAllocatorIndex = (c->_currentAllocatorIndex + 1) & 0x1;
-	c->_drawCallAllocator[c->_currentAllocatorIndex].reset();
+	c->_drawCallAllocator[c->_currentAllocatorIndex]->reset();
 }
 
 static void tglPresentBufferSimple(TinyGL::GLContext *c) {
 	typedef Common::List<Graphics::DrawCall *>::const_iterator DrawCallIterator;
 
-	for (DrawCallIterator it = c->_drawCallsQueue.begin(); it != c->_drawCallsQueue.end(); ++it) {
-		(*it)->execute(true);
-		delete *it;
+	if (c->_tileRenderer) {
+		c->_tileRenderer->render(c->_drawCallsQueue, Common::Array<Common::Rect>());
+		for (DrawCallIterator it = c->_drawCallsQueue.begin(); it != c->_drawCallsQueue.end(); ++it) {
+			delete *it;
+		}
+	} else {
+		for (DrawCallIterator it = c->_drawCallsQueue.begin(); it != c->_drawCallsQueue.end(); ++it) {
+			(*it)->execute(true);
+			delete *it;
+		}
 	}
 
 	c->_drawCallsQueue.clear();
 
 	tglDisposeResources(c);
 
-	c->_drawCallAllocator[c->_currentAllocatorIndex].reset();
+	c->_drawCallAllocator[c->_currentAllocatorIndex]->reset();
 }
 
 void tglPresentBuffer() {
@@ -295,7 +311,7 @@ RasterizationDrawCall::RasterizationDrawCall() : DrawCall(DrawCall_Rasterization
 	_drawTriangleBack = c->draw_triangle_back;
 	memcpy(_vertex, c->vertex, sizeof(TinyGL::GLVertex) * _vertexCount);
 	_state = captureState();
-	if (c->_enableDirtyRectangles) {
+	if (c->_enableDirtyRectangles || c->_tileRenderer) {
 		computeDirtyRegion();
 	}
 }
@@ -314,6 +330,14 @@ void RasterizationDrawCall::computeDirtyRegion() {
 		int left = xmax, right = 0, top = ymax, bottom = 0;
 		for (int i = 0; i < _vertexCount; i++) {
 			TinyGL::GLVertex *v = &_vertex[i];
+			if (v->clip_code & 0x30) {
+				// The screen coordinates of vertices clipped by the near or
+				// far plane are meaningless, so assume the whole screen
+				left = top = 0;
+				right = xmax;
+				bottom = ymax;
+				break;
+			}
 			if (v->clip_code)
 				gl_transform_to_viewport(c, v);
 			left =   MIN(left,   v->clip_code & 0x1 ?    0 : v->zp.x);
@@ -340,8 +364,29 @@ void RasterizationDrawCall::execute(bool restoreState) const {
 	if (restoreState) {
 		backupState = captureState();
 	}
-	applyState(_state);
+	applyState(c, _state);
 
+	rasterize(c);
+
+	if (restoreState) {
+		applyState(c, backupState);
+	}
+}
+
+void RasterizationDrawCall::execute(TinyGL::GLContext *c, const Common::Rect &clippingRectangle) const {
+	c->fb->setScissorRectangle(clippingRectangle);
+	applyState(c, _state);
+	rasterize(c);
+	c->fb->resetScissorRectangle();
+}
+
+bool RasterizationDrawCall::canRenderInTiles() const {
+	// Quad strips modify their vertices, and the shadow mask is written
+	// outside of the scissor rectangle
+	return _state.beginType != TGL_QUAD_STRIP && _state.shadowMode == 0;
+}
+
+void RasterizationDrawCall::rasterize(TinyGL::GLContext *c) const {
 	TinyGL::GLVertex *prevVertex = c->vertex;
 	int prevVertexCount = c->vertex_cnt;
 
@@ -393,17 +438,21 @@ void RasterizationDrawCall::execute(bool restoreState) const {
 		}
 		break;
 	case TGL_TRIANGLE_FAN:
-		for(int i = 1; i < cnt; i += 2) {
+		// Stop before reading past the last vertex
+		for(int i = 1; i < cnt - 1; i += 2) {
 			gl_draw_triangle(c, &c->vertex[0], &c->vertex[i], &c->vertex[i + 1]);
 		}
 		break;
 	case TGL_QUADS:
 		for(int i = 0; i < cnt; i += 4) {
-			c->vertex[i + 2].edge_flag = 0;
-			gl_draw_triangle(c, &c->vertex[i], &c->vertex[i + 1], &c->vertex[i + 2]);
-			c->vertex[i + 2].edge_flag = 1;
-			c->vertex[i + 0].edge_flag = 0;
-			gl_draw_triangle(c, &c->vertex[i], &c->vertex[i + 2], &c->vertex[i + 3]);
+			// Change the edge flags on copies, so that the draw call can be
+			// executed more than once, and by several threads at once
+			TinyGL::GLVertex v0 = c->vertex[i], v2 = c->vertex[i + 2];
+			v2.edge_flag = 0;
+			gl_draw_triangle(c, &c->vertex[i], &c->vertex[i + 1], &v2);
+			v2.edge_flag = 1;
+			v0.edge_flag = 0;
+			gl_draw_triangle(c, &v0, &v2, &c->vertex[i + 3]);
 		}
 		break;
 	case TGL_QUAD_STRIP:
@@ -427,10 +476,6 @@ void RasterizationDrawCall::execute(bool restoreState) const {
 
 	c->vertex = prevVertex;
 	c->vertex_cnt = prevVertexCount;
-
-	if (restoreState) {
-		applyState(backupState);
-	}
 }
 
 RasterizationDrawCall::RasterizationState RasterizationDrawCall::captureState() const {
@@ -469,8 +514,7 @@ RasterizationDrawCall::RasterizationState RasterizationDrawCall::captureState()
 	return state;
 }
 
-void RasterizationDrawCall::applyState(const RasterizationDrawCall::RasterizationState &state) const {
-	TinyGL::GLContext *c = TinyGL::gl_get_context();
+void RasterizationDrawCall::applyState(TinyGL::GLContext *c, const RasterizationDrawCall::RasterizationState &state) const {
 	c->fb->setBlendingFactors(state.sfactor, state.dfactor);
 	c->fb->enableBlending(state.enableBlending);
 	c->fb->enableAlphaTest(state.alphaTest);
@@ -693,5 +737,5 @@ bool RasterizationDrawCall::RasterizationState::operator==(const RasterizationSt
 
 void *Internal::allocateFrame(int size) {
 	TinyGL::GLContext *c = TinyGL::gl_get_context();
-	return c->_drawCallAllocator[c->_currentAllocatorIndex].allocate(size);
+	return c->_drawCallAllocator[c->_currentAllocatorIndex]->allocate(size);
 }
@@ -97,6 +97,20 @@ public:
 	virtual void execute(bool restoreState) const;
 	virtual void execute(const Common::Rect &clippingRectangle, bool restoreState) const;
 
+	/**
+	 * Execute the draw call on another context than the current one, e.g.
+	 * one of the contexts used for rendering tiles in parallel. The state
+	 * of the context is not restored.
+	 */
+	void execute(TinyGL::GLContext *c, const Common::Rect &clippingRectangle) const;
+
+	/**
+	 * Check whether the draw call only changes the pixels inside its dirty
+	 * region, and can be executed concurrently with other draw calls on
+	 * pixels outside of that region.
+	 */
+	bool canRenderInTiles() const;
+
 	void *operator new(size_t size) {
 		return ::Internal::allocateFrame(size);
 	}
@@ -104,6 +118,7 @@ public:
 	void operator delete(void *p) { }
 private:
 	void computeDirtyRegion();
+	void rasterize(TinyGL::GLContext *c) const;
 	typedef void (*gl_draw_triangle_func_ptr)(TinyGL::GLContext *c, TinyGL::GLVertex *p0, TinyGL::GLVertex *p1, TinyGL::GLVertex *p2);
 	int _vertexCount;
 	TinyGL::GLVertex *_vertex;
@@ -141,7 +156,7 @@ private:
 	RasterizationState _state;
 
 	RasterizationState captureState() const;
-	void applyState(const RasterizationState &state) const;
+	void applyState(TinyGL::GLContext *c, const RasterizationState &state) const;
 };
 
 // Encapsulate a blit call: it might execute either a color buffer or z buffer blit.
@@ -0,0 +1,234 @@
+/* ResidualVM - A 3D game interpreter
+ *
+ * ResidualVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "graphics/tinygl/zhiz.h"
+#include "graphics/tinygl/zgl.h"
+
+namespace TinyGL {
+
+// Return whether every depth in [zMin, zMax] fails the depth test against
+// every depth of a block in [blockMin, blockMax], as compared by
+// FrameBuffer::compareDepth()
+static inline bool failsDepthTest(uint32 blockMin, uint32 blockMax, uint32 zMin, uint32 zMax, int depthFunc) {
+	switch (depthFunc) {
+	case TGL_NEVER:
+		return true;
+	case TGL_LESS:
+		return blockMin >= zMax;
+	case TGL_EQUAL:
+		return blockMin > zMax || blockMax < zMin;
+	case TGL_LEQUAL:
+		return blockMin > zMax;
+	case TGL_GREATER:
+		return blockMax <= zMin;
+	case TGL_GEQUAL:
+		return blockMax < zMin;
+	default:
+		return false;
+	}
+}
+
+HierarchicalZ::HierarchicalZ(int width, int height) : _width(width), _height(height) {
+	_columns = (width + kBlockSize - 1) >> kBlockShift;
+	_rows = (height + kBlockSize - 1) >> kBlockShift;
+	_min.resize(_columns * _rows);
+	_max.resize(_columns * _rows);
+	_state.resize(_columns * _rows);
+	fill(Common::Rect(width, height), 0);
+	resetStats();
+}
+
+bool HierarchicalZ::getBlocks(const Common::Rect &rect, int &left, int &top, int &right, int &bottom) const {
+	left = MAX<int>(rect.left, 0);
+	top = MAX<int>(rect.top, 0);
+	right = MIN<int>(rect.right, _width);
+	bottom = MIN<int>(rect.bottom, _height);
+	if (left >= right || top >= bottom)
+		return false;
+
+	left >>= kBlockShift;
+	top >>= kBlockShift;
+	right = ((right - 1) >> kBlockShift) + 1;
+	bottom = ((bottom - 1) >> kBlockShift) + 1;
+	return true;
+}
+
+void HierarchicalZ::fill(const Common::Rect &rect, uint32 z) {
+	int left, top, right, bottom;
+	if (!getBlocks(rect, left, top, right, bottom))
+		return;
+
+	for (int row = top; row < bottom; row++) {
+		for (int column = left; column < right; column++) {
+			const Common::Rect block(column << kBlockShift, row << kBlockShift,
+			                         MIN<int>((column + 1) << kBlockShift, _width), MIN<int>((row + 1) << kBlockShift, _height));
+			const int i = row * _columns + column;
+			if (rect.contains(block)) {
+				_min[i] = _max[i] = z;
+				_state[i] = kExact;
+			} else if (_state[i] != kUnknown) {
+				_min[i] = MIN(_min[i], z);
+				_max[i] = MAX(_max[i], z);
+				_state[i] = kLoose;
+			}
+		}
+	}
+}
+
+void HierarchicalZ::extend(const Common::Rect &rect, uint32 zMin, uint32 zMax) {
+	int left, top, right, bottom;
+	if (!getBlocks(rect, left, top, right, bottom))
+		return;
+
+	for (int row = top; row < bottom; row++) {
+		for (int i = row * _columns + left; i < row * _columns + right; i++) {
+			if (_state[i] != kUnknown) {
+				_min[i] = MIN(_min[i], zMin);
+				_max[i] = MAX(_max[i], zMax);
+				_state[i] = kLoose;
+			}
+		}
+	}
+}
+
+void HierarchicalZ::invalidate(const Common::Rect &rect) {
+	int left, top, right, bottom;
+	if (!getBlocks(rect, left, top, right, bottom))
+		return;
+
+	for (int row = top; row < bottom; row++) {
+		for (int i = row * _columns + left; i < row * _columns + right; i++)
+			_state[i] = kUnknown;
+	}
+}
+
+void HierarchicalZ::invalidate() {
+	for (uint i = 0; i < _state.size(); i++)
+		_state[i] = kUnknown;
+}
+
+void HierarchicalZ::update(const uint32 *zbuf, int column, int row) {
+	const int left = column << kBlockShift;
+	const int top = row << kBlockShift;
+	const int right = MIN<int>(left + kBlockSize, _width);
+	const int bottom = MIN<int>(top + kBlockSize, _height);
+
+	uint32 zMin = 0xFFFFFFFF, zMax = 0;
+	for (int y = top; y < bottom; y++) {
+		const uint32 *z = zbuf + y * _width;
+		for (int x = left; x < right; x++) {
+			zMin = MIN(zMin, z[x]);
+			zMax = MAX(zMax, z[x]);
+		}
+	}
+
+	const int i = row * _columns + column;
+	_min[i] = zMin;
+	_max[i] = zMax;
+	_state[i] = kExact;
+	_stats.blockUpdates++;
+}
+
+bool HierarchicalZ::rejectBlock(const uint32 *zbuf, int column, int row, uint32 zMin, uint32 zMax, int depthFunc) {
+	const int i = row * _columns + column;
+	if (_state[i] == kUnknown)
+		update(zbuf, column, row);
+	if (failsDepthTest(_min[i], _max[i], zMin, zMax, depthFunc))
+		return true;
+
+	// Loose bounds are only read again if the exact ones could reject the
+	// pixels, as the depths of the block are somewhere between them
+	if (_state[i] == kExact || !failsDepthTest(_max[i], _min[i], zMin, zMax, depthFunc))
+		return false;
+	update(zbuf, column, row);
+	return failsDepthTest(_min[i], _max[i], zMin, zMax, depthFunc);
+}
+
+bool HierarchicalZ::rejectTriangle(const uint32 *zbuf, const Common::Rect &rect, uint32 zMin, uint32 zMax, int depthFunc, uint32 area) {
+	int left, top, right, bottom;
+	if (!getBlocks(rect, left, top, right, bottom))
+		return false;
+
+	// The bounds which are known are tested first, so that visible triangles
+	// are mostly accepted without reading the z buffer
+	_stats.triangles++;
+	for (int row = top; row < bottom; row++) {
+		for (int i = row * _columns + left; i < row * _columns + right; i++) {
+			if (_state[i] == kExact && !failsDepthTest(_min[i], _max[i], zMin, zMax, depthFunc))
+				return false;
+		}
+	}
+	for (int row = top; row < bottom; row++) {
+		for (int column = left; column < right; column++) {
+			if (!rejectBlock(zbuf, column, row, zMin, zMax, depthFunc))
+				return false;
+		}
+	}
+
+	_stats.rejectedTriangles++;
+	_stats.rejectedFragments += area;
+	return true;
+}
+
+bool HierarchicalZ::rejectSpan(const uint32 *zbuf, int left, int right, int y, uint32 zMin, uint32 zMax, int depthFunc) {
+	left = MAX<int>(left, 0);
+	right = MIN<int>(right, _width);
+	if (left >= right || y < 0 || y >= _height)
+		return false;
+
+	_stats.spans++;
+	const int row = y >> kBlockShift;
+	for (int i = row * _columns + (left >> kBlockShift); i <= row * _columns + ((right - 1) >> kBlockShift); i++) {
+		if (_state[i] == kUnknown || !failsDepthTest(_min[i], _max[i], zMin, zMax, depthFunc))
+			return false;
+	}
+
+	_stats.rejectedSpans++;
+	_stats.rejectedFragments += right - left;
+	return true;
+}
+
+void HierarchicalZ::resetStats() {
+	_stats.triangles = 0;
+	_stats.rejectedTriangles = 0;
+	_stats.spans = 0;
+	_stats.rejectedSpans = 0;
+	_stats.rejectedFragments = 0;
+	_stats.blockUpdates = 0;
+}
+
+bool tglGetHierarchicalZStats(HierarchicalZStats &stats) {
+	GLContext *c = gl_get_context();
+	if (!c || !c->fb->_hierarchicalZ)
+		return false;
+
+	stats = c->fb->_hierarchicalZ->getStats();
+	return true;
+}
+
+void tglResetHierarchicalZStats() {
+	GLContext *c = gl_get_context();
+	if (c && c->fb->_hierarchicalZ)
+		c->fb->_hierarchicalZ->resetStats();
+}
+
+} // end of namespace TinyGL
@@ -0,0 +1,129 @@
+/* ResidualVM - A 3D game interpreter
+ *
+ * ResidualVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRAPHICS_TINYGL_ZHIZ_H
+#define GRAPHICS_TINYGL_ZHIZ_H
+
+#include "common/array.h"
+#include "common/rect.h"
+
+namespace TinyGL {
+
+/**
+ * Statistics of the early depth test since the frame buffer was created or
+ * the statistics were reset.
+ */
+struct HierarchicalZStats {
+	uint32 triangles;         ///< The number of triangles tested against the depth bounds.
+	uint32 rejectedTriangles; ///< The number of triangles which were not drawn at all.
+	uint32 spans;             ///< The number of spans tested against the depth bounds.
+	uint32 rejectedSpans;     ///< The number of spans which were not drawn.
+	uint64 rejectedFragments; ///< The pixels of the rejected spans, plus the area of the rejected triangles.
+	uint32 blockUpdates;      ///< How often the depth bounds of a block were read from the z buffer.
+};
+
+/**
+ * The bounds of the depths of square blocks of a z buffer, which allow
+ * rejecting whole triangles and spans which fail the depth test before
+ * interpolating anything.
+ *
+ * The bounds of a block are either exact, loose, or unknown. Writing
+ * depths into a block only widens its bounds, so that they stay valid.
+ * Unknown bounds are read again from the z buffer when the block is
+ * tested, and loose ones when exact bounds could reject what is tested.
+ */
+class HierarchicalZ {
+public:
+	/** The size of the blocks, as a power of two. */
+	static const int kBlockShift = 4;
+	static const int kBlockSize = 1 << kBlockShift;
+
+	/** Create the depth bounds of a z buffer, which must be filled with zeros. */
+	HierarchicalZ(int width, int height);
+
+	/** Note that the depths of a rectangle were all set to @p z. */
+	void fill(const Common::Rect &rect, uint32 z);
+
+	/** Note that some depths of a rectangle were set to values in [zMin, zMax]. */
+	void extend(const Common::Rect &rect, uint32 zMin, uint32 zMax);
+
+	/** Note that the depths of a rectangle were changed in any way. */
+	void invalidate(const Common::Rect &rect);
+
+	/** Note that the whole z buffer was changed, or replaced. */
+	void invalidate();
+
+	/**
+	 * Return whether all the pixels of a triangle fail the depth test.
+	 *
+	 * @param zbuf       The z buffer.
+	 * @param rect       A rectangle containing all the pixels of the triangle.
+	 * @param zMin, zMax The bounds of the depths of the triangle.
+	 * @param depthFunc  The depth function, as passed to tglDepthFunc().
+	 * @param area       The number of pixels of the triangle, for the statistics.
+	 */
+	bool rejectTriangle(const uint32 *zbuf, const Common::Rect &rect, uint32 zMin, uint32 zMax, int depthFunc, uint32 area);
+
+	/**
+	 * Return whether all the pixels of the columns @p left to @p right - 1
+	 * of a row fail the depth test.
+	 */
+	bool rejectSpan(const uint32 *zbuf, int left, int right, int y, uint32 zMin, uint32 zMax, int depthFunc);
+
+	const HierarchicalZStats &getStats() const { return _stats; }
+	void resetStats();
+
+private:
+	enum BlockState {
+		kExact,
+		kLoose,
+		kUnknown
+	};
+
+	bool getBlocks(const Common::Rect &rect, int &left, int &top, int &right, int &bottom) const;
+	void update(const uint32 *zbuf, int column, int row);
+	bool rejectBlock(const uint32 *zbuf, int column, int row, uint32 zMin, uint32 zMax, int depthFunc);
+
+	int _width, _height;
+	int _columns, _rows;
+	Common::Array<uint32> _min, _max;
+	Common::Array<byte> _state;
+
+	HierarchicalZStats _stats;
+};
+
+/**
+ * Get the statistics of the early depth test of the current context.
+ *
+ * @return False if the frame buffer of the current context does not keep
+ *         the depth bounds of its z buffer.
+ */
+bool tglGetHierarchicalZStats(HierarchicalZStats &stats);
+
+/**
+ * Reset the statistics of the early depth test of the current context.
+ */
+void tglResetHierarchicalZStats();
+
+} // end of namespace TinyGL
+
+#endif
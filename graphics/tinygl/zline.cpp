@@ -63,6 +63,10 @@ FORCEINLINE void FrameBuffer::drawLine(const ZBufferPoint *p1, const ZBufferPoin
 		drawLine<kInterpRGB, kInterpZ, kDepthWrite, true>(p1, p2);
 	else
 		drawLine<kInterpRGB, kInterpZ, kDepthWrite, false>(p1, p2);
+	if (kInterpZ && kDepthWrite && _hierarchicalZ) {
+		_hierarchicalZ->invalidate(Common::Rect(MIN(p1->x, p2->x), MIN(p1->y, p2->y),
+		                                        MAX(p1->x, p2->x) + 1, MAX(p1->y, p2->y) + 1));
+	}
 }
 
 template <bool kInterpRGB, bool kInterpZ, bool kDepthWrite, bool kEnableScissor>
@@ -145,10 +149,13 @@ void FrameBuffer::plot(ZBufferPoint *p) {
 	const unsigned int pixelOffset = p->y * xsize + p->x;
 	const int col = RGB_TO_PIXEL(p->r, p->g, p->b);
 	const unsigned int z = p->z;
-	if (_depthWrite && _depthTestEnabled)
+	if (_depthWrite && _depthTestEnabled) {
 		putPixel<true>(pixelOffset, col, p->x, p->y, z);
-	else 
+		if (_hierarchicalZ)
+			_hierarchicalZ->extend(Common::Rect(p->x, p->y, p->x + 1, p->y + 1), z, z);
+	} else {
 		putPixel<false>(pixelOffset, col, p->x, p->y, z);
+	}
 }
 
 void FrameBuffer::fillLineFlatZ(ZBufferPoint *p1, ZBufferPoint *p2) {
@@ -0,0 +1,63 @@
+/* ResidualVM - A 3D game interpreter
+ *
+ * ResidualVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/system.h"
+
+#include "graphics/tinygl/zspan.h"
+#include "graphics/tinygl/gl.h"
+
+namespace TinyGL {
+
+const SpanFillers *getSpanFillers(const Graphics::PixelFormat &format) {
+	// The fillers write whole bytes per channel, and only an alpha channel
+	// may be missing
+	if (format.bytesPerPixel != 4 || format.rLoss != 0 || format.gLoss != 0 || format.bLoss != 0 ||
+			(format.aLoss != 0 && format.aLoss != 8))
+		return 0;
+
+#ifdef SCUMMVM_SSE2
+	if (g_system->getSimdLevel() >= OSystem::kSimdSSE2)
+		return &spanFillersSSE2;
+#endif
+	return 0;
+}
+
+void initSpanState(SpanState &state, const Graphics::PixelFormat &format, bool depthTest, int depthFunc, bool depthWrite, bool blending) {
+	bool less = true, equal = true, greater = true;
+	if (depthTest) {
+		less = (depthFunc == TGL_LESS || depthFunc == TGL_LEQUAL || depthFunc == TGL_NOTEQUAL || depthFunc == TGL_ALWAYS);
+		equal = (depthFunc == TGL_EQUAL || depthFunc == TGL_LEQUAL || depthFunc == TGL_GEQUAL || depthFunc == TGL_ALWAYS);
+		greater = (depthFunc == TGL_GREATER || depthFunc == TGL_GEQUAL || depthFunc == TGL_NOTEQUAL || depthFunc == TGL_ALWAYS);
+	}
+	state.depthLess = less ? 0xFFFFFFFF : 0;
+	state.depthEqual = equal ? 0xFFFFFFFF : 0;
+	state.depthGreater = greater ? 0xFFFFFFFF : 0;
+	state.depthWrite = depthWrite;
+	state.blending = blending;
+	state.rShift = format.rShift;
+	state.gShift = format.gShift;
+	state.bShift = format.bShift;
+	state.aShift = format.aShift;
+	state.alphaMask = format.aLoss == 0 ? 0xFF << format.aShift : 0;
+}
+
+} // end of namespace TinyGL
@@ -0,0 +1,103 @@
+/* ResidualVM - A 3D game interpreter
+ *
+ * ResidualVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRAPHICS_TINYGL_ZSPAN_H
+#define GRAPHICS_TINYGL_ZSPAN_H
+
+#include "common/scummsys.h"
+
+#include "graphics/pixelformat.h"
+
+namespace TinyGL {
+
+/**
+ * The state of the frame buffer used by the span fillers, which stays the
+ * same for all the spans of a triangle.
+ */
+struct SpanState {
+	// The depth test compares the depth in the z buffer with the one of the
+	// pixel, as FrameBuffer::compareDepth() does
+	uint32 depthLess;    ///< All bits set if pixels pass when the depth in the z buffer is less.
+	uint32 depthEqual;   ///< All bits set if pixels pass when the depths are equal.
+	uint32 depthGreater; ///< All bits set if pixels pass when the depth in the z buffer is greater.
+	bool depthWrite;     ///< Whether the depths of the drawn pixels are written to the z buffer.
+	bool blending;       ///< Whether pixels are blended with TGL_SRC_ALPHA and TGL_ONE_MINUS_SRC_ALPHA.
+	uint rShift, gShift, bShift, aShift;
+	uint32 alphaMask;    ///< The bits of the alpha channel, or 0 if the format has no alpha.
+};
+
+/**
+ * A run of pixels of a row of a triangle.
+ *
+ * The colors and depths are in the fixed point formats of ZBufferPoint,
+ * so the color channels are written as bits 8 to 15 of their values.
+ */
+struct Span {
+	uint32 *pixels;  ///< The first pixel of the span in the 32 bpp color buffer.
+	uint32 *zbuf;    ///< The depth of the first pixel in the z buffer.
+	int count;       ///< The number of pixels.
+	uint32 z, r, g, b, a;
+	int32 dzdx, drdx, dgdx, dbdx, dadx;
+};
+
+/**
+ * Vectorized routines drawing spans of pixels, with the same result as the
+ * putPixel helpers of FrameBuffer::fillTriangle without alpha test.
+ */
+struct SpanFillers {
+	/** Draw a span with a flat or interpolated color. */
+	void (*fillColor)(const SpanState &state, const Span &span);
+
+	/** Return a bit mask of the pixels of a span of at most 8 pixels which pass the depth test. */
+	uint32 (*testDepth)(const SpanState &state, const Span &span);
+
+	/**
+	 * Draw texels modulated by the color of a span of at most 8 pixels.
+	 *
+	 * @param texels The texels of the pixels, as 0xAARRGGBB.
+	 * @param mask   A bit mask of the pixels to draw.
+	 */
+	void (*fillTexels)(const SpanState &state, const Span &span, const uint32 *texels, uint32 mask);
+};
+
+/**
+ * Return the fastest span fillers for a frame buffer format supported on
+ * this CPU, or 0 if there are none. Only formats of 32 bits per pixel with
+ * 8 bits per color channel are supported.
+ */
+const SpanFillers *getSpanFillers(const Graphics::PixelFormat &format);
+
+/**
+ * Set up the state of the span fillers for drawing triangles.
+ *
+ * @param depthTest Whether the depth test is enabled, with the given function.
+ * @param blending  Whether blending with TGL_SRC_ALPHA and TGL_ONE_MINUS_SRC_ALPHA is enabled.
+ */
+void initSpanState(SpanState &state, const Graphics::PixelFormat &format, bool depthTest, int depthFunc, bool depthWrite, bool blending);
+
+#ifdef SCUMMVM_SSE2
+extern const SpanFillers spanFillersSSE2;
+#endif
+
+} // end of namespace TinyGL
+
+#endif
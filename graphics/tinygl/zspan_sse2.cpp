@@ -0,0 +1,272 @@
+/* ResidualVM - A 3D game interpreter
+ *
+ * ResidualVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "graphics/tinygl/zspan.h"
+
+#include <emmintrin.h>
+
+namespace TinyGL {
+
+namespace {
+
+/**
+ * The span state, prepared for processing four pixels at once.
+ */
+struct SpanVectors {
+	__m128i depthLess, depthEqual, depthGreater;
+	__m128i rShift, gShift, bShift, aShift;
+	__m128i alphaMask;
+
+	explicit SpanVectors(const SpanState &state) {
+		depthLess = _mm_set1_epi32(state.depthLess);
+		depthEqual = _mm_set1_epi32(state.depthEqual);
+		depthGreater = _mm_set1_epi32(state.depthGreater);
+		rShift = _mm_cvtsi32_si128(state.rShift);
+		gShift = _mm_cvtsi32_si128(state.gShift);
+		bShift = _mm_cvtsi32_si128(state.bShift);
+		aShift = _mm_cvtsi32_si128(state.aShift);
+		alphaMask = _mm_set1_epi32(state.alphaMask);
+	}
+};
+
+/** Return the values of four pixels, starting at v and stepping by d. */
+inline __m128i ramp(uint32 v, int32 d) {
+	// Step in unsigned arithmetic, which wraps around like the scalar loops
+	const uint32 step = d;
+	return _mm_setr_epi32(v, v + step, v + 2 * step, v + 3 * step);
+}
+
+/** Return the step of the values of four pixels to the next four. */
+inline __m128i quadStep(int32 d) {
+	return _mm_set1_epi32(4 * (uint32)d);
+}
+
+/** Return bits 8 to 15 of fixed point colors. */
+inline __m128i colorByte(__m128i c) {
+	return _mm_and_si128(_mm_srli_epi32(c, 8), _mm_set1_epi32(0xFF));
+}
+
+inline __m128i select(__m128i mask, __m128i a, __m128i b) {
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+inline __m128i testDepth(const SpanVectors &v, __m128i z, __m128i zDst) {
+	// SSE2 only compares signed integers
+	const __m128i bias = _mm_set1_epi32((int)0x80000000);
+	const __m128i zs = _mm_xor_si128(z, bias);
+	const __m128i zd = _mm_xor_si128(zDst, bias);
+	const __m128i less = _mm_and_si128(_mm_cmplt_epi32(zd, zs), v.depthLess);
+	const __m128i equal = _mm_and_si128(_mm_cmpeq_epi32(zd, zs), v.depthEqual);
+	const __m128i greater = _mm_and_si128(_mm_cmpgt_epi32(zd, zs), v.depthGreater);
+	return _mm_or_si128(_mm_or_si128(less, equal), greater);
+}
+
+/** Return (a * b) >> 8 of channels of at most 16 bits, truncated to 8 bits. */
+inline __m128i multiply(__m128i a, __m128i b) {
+	return _mm_and_si128(_mm_srli_epi32(_mm_mullo_epi16(a, b), 8), _mm_set1_epi32(0xFF));
+}
+
+/**
+ * Return the colors of four pixels, with the channels given as bytes,
+ * written to the destination pixels as FrameBuffer::writePixel() does.
+ */
+template <bool kBlending>
+inline __m128i shade(const SpanVectors &v, __m128i r, __m128i g, __m128i b, __m128i a, __m128i dst) {
+	if (!kBlending) {
+		return _mm_or_si128(_mm_or_si128(_mm_sll_epi32(r, v.rShift), _mm_sll_epi32(g, v.gShift)),
+		                    _mm_or_si128(_mm_sll_epi32(b, v.bShift), _mm_and_si128(_mm_sll_epi32(a, v.aShift), v.alphaMask)));
+	}
+
+	const __m128i mask = _mm_set1_epi32(0xFF);
+	const __m128i invA = _mm_sub_epi32(mask, a);
+	const __m128i rDst = _mm_and_si128(_mm_srl_epi32(dst, v.rShift), mask);
+	const __m128i gDst = _mm_and_si128(_mm_srl_epi32(dst, v.gShift), mask);
+	const __m128i bDst = _mm_and_si128(_mm_srl_epi32(dst, v.bShift), mask);
+	// The sums are at most 510, which fits into the low 16 bits of the lanes
+	r = _mm_min_epi16(_mm_add_epi32(multiply(r, a), multiply(rDst, invA)), mask);
+	g = _mm_min_epi16(_mm_add_epi32(multiply(g, a), multiply(gDst, invA)), mask);
+	b = _mm_min_epi16(_mm_add_epi32(multiply(b, a), multiply(bDst, invA)), mask);
+	return _mm_or_si128(_mm_or_si128(_mm_sll_epi32(r, v.rShift), _mm_sll_epi32(g, v.gShift)),
+	                    _mm_or_si128(_mm_sll_epi32(b, v.bShift), v.alphaMask));
+}
+
+template <bool kBlending, bool kDepthWrite>
+inline void fillColorQuad(const SpanVectors &v, uint32 *pixels, uint32 *zbuf, __m128i z, __m128i r, __m128i g, __m128i b, __m128i a) {
+	const __m128i zDst = _mm_loadu_si128((const __m128i *)zbuf);
+	const __m128i pass = testDepth(v, z, zDst);
+	if (_mm_movemask_epi8(pass) == 0)
+		return;
+
+	const __m128i dst = _mm_loadu_si128((const __m128i *)pixels);
+	const __m128i color = shade<kBlending>(v, colorByte(r), colorByte(g), colorByte(b), colorByte(a), dst);
+	_mm_storeu_si128((__m128i *)pixels, select(pass, color, dst));
+	if (kDepthWrite)
+		_mm_storeu_si128((__m128i *)zbuf, select(pass, z, zDst));
+}
+
+template <bool kBlending, bool kDepthWrite>
+void fillColor(const SpanState &state, const Span &span) {
+	const SpanVectors v(state);
+	__m128i z = ramp(span.z, span.dzdx);
+	__m128i r = ramp(span.r, span.drdx);
+	__m128i g = ramp(span.g, span.dgdx);
+	__m128i b = ramp(span.b, span.dbdx);
+	__m128i a = ramp(span.a, span.dadx);
+	const __m128i dz = quadStep(span.dzdx);
+	const __m128i dr = quadStep(span.drdx);
+	const __m128i dg = quadStep(span.dgdx);
+	const __m128i db = quadStep(span.dbdx);
+	const __m128i da = quadStep(span.dadx);
+
+	uint32 *pixels = span.pixels;
+	uint32 *zbuf = span.zbuf;
+	int n = span.count;
+	for (; n >= 4; n -= 4) {
+		fillColorQuad<kBlending, kDepthWrite>(v, pixels, zbuf, z, r, g, b, a);
+		pixels += 4;
+		zbuf += 4;
+		z = _mm_add_epi32(z, dz);
+		r = _mm_add_epi32(r, dr);
+		g = _mm_add_epi32(g, dg);
+		b = _mm_add_epi32(b, db);
+		a = _mm_add_epi32(a, da);
+	}
+
+	if (n > 0) {
+		// Draw the last pixels in a copy, so that nothing past the end of
+		// the span is accessed
+		uint32 tailPixels[4], tailZ[4];
+		memcpy(tailPixels, pixels, n * sizeof(uint32));
+		memcpy(tailZ, zbuf, n * sizeof(uint32));
+		fillColorQuad<kBlending, kDepthWrite>(v, tailPixels, tailZ, z, r, g, b, a);
+		memcpy(pixels, tailPixels, n * sizeof(uint32));
+		memcpy(zbuf, tailZ, n * sizeof(uint32));
+	}
+}
+
+void fillColorSSE2(const SpanState &state, const Span &span) {
+	if (state.blending) {
+		if (state.depthWrite)
+			fillColor<true, true>(state, span);
+		else
+			fillColor<true, false>(state, span);
+	} else {
+		if (state.depthWrite)
+			fillColor<false, true>(state, span);
+		else
+			fillColor<false, false>(state, span);
+	}
+}
+
+uint32 testDepthSSE2(const SpanState &state, const Span &span) {
+	const SpanVectors v(state);
+	uint32 zDst[8];
+	memcpy(zDst, span.zbuf, span.count * sizeof(uint32));
+
+	const __m128i z0 = ramp(span.z, span.dzdx);
+	const __m128i z1 = _mm_add_epi32(z0, quadStep(span.dzdx));
+	const __m128i pass0 = testDepth(v, z0, _mm_loadu_si128((const __m128i *)zDst));
+	const __m128i pass1 = testDepth(v, z1, _mm_loadu_si128((const __m128i *)(zDst + 4)));
+	const uint32 mask = _mm_movemask_ps(_mm_castsi128_ps(pass0)) | (_mm_movemask_ps(_mm_castsi128_ps(pass1)) << 4);
+	return mask & ((1 << span.count) - 1);
+}
+
+template <bool kBlending, bool kDepthWrite>
+inline void fillTexelQuad(const SpanVectors &v, uint32 *pixels, uint32 *zbuf, const uint32 *texels, uint32 mask,
+                          __m128i z, __m128i r, __m128i g, __m128i b, __m128i a) {
+	const __m128i bits = _mm_setr_epi32(1, 2, 4, 8);
+	const __m128i pass = _mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(mask), bits), bits);
+
+	// Modulate the texels by the color, as the lights do
+	const __m128i byteMask = _mm_set1_epi32(0xFF);
+	const __m128i wordMask = _mm_set1_epi32(0xFFFF);
+	const __m128i texel = _mm_loadu_si128((const __m128i *)texels);
+	const __m128i cA = multiply(_mm_srli_epi32(texel, 24), _mm_and_si128(_mm_srli_epi32(a, 8), wordMask));
+	const __m128i cR = multiply(_mm_and_si128(_mm_srli_epi32(texel, 16), byteMask), _mm_and_si128(_mm_srli_epi32(r, 8), wordMask));
+	const __m128i cG = multiply(_mm_and_si128(_mm_srli_epi32(texel, 8), byteMask), _mm_and_si128(_mm_srli_epi32(g, 8), wordMask));
+	const __m128i cB = multiply(_mm_and_si128(texel, byteMask), _mm_and_si128(_mm_srli_epi32(b, 8), wordMask));
+
+	const __m128i dst = _mm_loadu_si128((const __m128i *)pixels);
+	_mm_storeu_si128((__m128i *)pixels, select(pass, shade<kBlending>(v, cR, cG, cB, cA, dst), dst));
+	if (kDepthWrite)
+		_mm_storeu_si128((__m128i *)zbuf, select(pass, z, _mm_loadu_si128((const __m128i *)zbuf)));
+}
+
+template <bool kBlending, bool kDepthWrite>
+void fillTexels(const SpanState &state, const Span &span, const uint32 *texels, uint32 mask) {
+	const SpanVectors v(state);
+	const __m128i z0 = ramp(span.z, span.dzdx);
+	const __m128i r0 = ramp(span.r, span.drdx);
+	const __m128i g0 = ramp(span.g, span.dgdx);
+	const __m128i b0 = ramp(span.b, span.dbdx);
+	const __m128i a0 = ramp(span.a, span.dadx);
+
+	uint32 pixels[8], zbuf[8];
+	uint32 *p = span.pixels, *pz = span.zbuf;
+	if (span.count < 8) {
+		// Draw short spans in a copy, so that nothing past their end is accessed
+		memcpy(pixels, span.pixels, span.count * sizeof(uint32));
+		memcpy(zbuf, span.zbuf, span.count * sizeof(uint32));
+		p = pixels;
+		pz = zbuf;
+	}
+
+	if (mask & 0x0F)
+		fillTexelQuad<kBlending, kDepthWrite>(v, p, pz, texels, mask, z0, r0, g0, b0, a0);
+	if (mask & 0xF0) {
+		fillTexelQuad<kBlending, kDepthWrite>(v, p + 4, pz + 4, texels + 4, mask >> 4,
+		                                      _mm_add_epi32(z0, quadStep(span.dzdx)),
+		                                      _mm_add_epi32(r0, quadStep(span.drdx)),
+		                                      _mm_add_epi32(g0, quadStep(span.dgdx)),
+		                                      _mm_add_epi32(b0, quadStep(span.dbdx)),
+		                                      _mm_add_epi32(a0, quadStep(span.dadx)));
+	}
+
+	if (span.count < 8) {
+		memcpy(span.pixels, pixels, span.count * sizeof(uint32));
+		memcpy(span.zbuf, zbuf, span.count * sizeof(uint32));
+	}
+}
+
+void fillTexelsSSE2(const SpanState &state, const Span &span, const uint32 *texels, uint32 mask) {
+	if (state.blending) {
+		if (state.depthWrite)
+			fillTexels<true, true>(state, span, texels, mask);
+		else
+			fillTexels<true, false>(state, span, texels, mask);
+	} else {
+		if (state.depthWrite)
+			fillTexels<false, true>(state, span, texels, mask);
+		else
+			fillTexels<false, false>(state, span, texels, mask);
+	}
+}
+
+} // End of anonymous namespace
+
+extern const SpanFillers spanFillersSSE2 = {
+	fillColorSSE2,
+	testDepthSSE2,
+	fillTexelsSSE2
+};
+
+} // end of namespace TinyGL
@@ -0,0 +1,267 @@
+/* ResidualVM - A 3D game interpreter
+ *
+ * ResidualVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/atomic.h"
+#include "common/system.h"
+
+#include "graphics/tinygl/ztiles.h"
+#include "graphics/tinygl/zdirtyrect.h"
+#include "graphics/tinygl/zgl.h"
+
+namespace TinyGL {
+
+TileRenderer::TileRenderer(GLContext *c, uint numThreads) : _context(c), _pool(numThreads), _clip(false), _nextTile(0) {
+	// Every thread draws with a context of its own, into the frame buffer of
+	// the rendered context
+	_threadContexts.resize(_pool.getThreadCount());
+	for (uint i = 0; i < _threadContexts.size(); i++) {
+		GLContext *threadContext = new GLContext();
+		threadContext->fb = new FrameBuffer(*c->fb);
+		threadContext->fb->shareBuffers(*c->fb);
+		threadContext->_textureSize = c->_textureSize;
+		_threadContexts[i] = threadContext;
+	}
+
+	resetStats();
+}
+
+TileRenderer::~TileRenderer() {
+	for (uint i = 0; i < _threadContexts.size(); i++) {
+		delete _threadContexts[i]->fb;
+		delete _threadContexts[i];
+	}
+}
+
+void TileRenderer::render(const Common::List<Graphics::DrawCall *> &drawCalls, const Common::Array<Common::Rect> &rectangles) {
+	_stats.frames++;
+	if (drawCalls.empty())
+		return;
+
+	prepareTiles(rectangles);
+
+	// Copy the state which is not part of the draw calls
+	for (uint i = 0; i < _threadContexts.size(); i++) {
+		GLContext *threadContext = _threadContexts[i];
+		threadContext->fb->shareBuffers(*_context->fb);
+		threadContext->render_mode = _context->render_mode;
+		threadContext->current_cull_face = _context->current_cull_face;
+		threadContext->vertex_n = _context->vertex_n;
+	}
+
+	DrawCallIterator it = drawCalls.begin();
+	while (it != drawCalls.end()) {
+		const uint32 start = g_system->getMillis();
+		if (canRenderInTiles(*it)) {
+			_batch.resize(0);
+			for (; it != drawCalls.end() && canRenderInTiles(*it); ++it)
+				_batch.push_back((const Graphics::RasterizationDrawCall *)*it);
+
+			renderBatch();
+			_stats.tiledTime += g_system->getMillis() - start;
+		} else {
+			for (; it != drawCalls.end() && !canRenderInTiles(*it); ++it) {
+				renderSerial(*it);
+				_stats.serialDrawCalls++;
+			}
+			_stats.serialTime += g_system->getMillis() - start;
+		}
+	}
+}
+
+bool TileRenderer::canRenderInTiles(const Graphics::DrawCall *drawCall) const {
+	return drawCall->getType() == Graphics::DrawCall::DrawCall_Rasterization &&
+		_context->render_mode != TGL_SELECT &&
+		((const Graphics::RasterizationDrawCall *)drawCall)->canRenderInTiles();
+}
+
+void TileRenderer::prepareTiles(const Common::Array<Common::Rect> &rectangles) {
+	_clip = !rectangles.empty();
+	if (_clip) {
+		_rectangles = rectangles;
+	} else {
+		_rectangles.resize(1);
+		_rectangles[0] = Common::Rect(_context->fb->xsize, _context->fb->ysize);
+	}
+
+	// Split the rectangles at the borders of the bands of rows of the screen
+	_tiles.resize(0);
+	_rectangleTiles.resize(0);
+	for (uint i = 0; i < _rectangles.size(); i++) {
+		const Common::Rect &rect = _rectangles[i];
+		_rectangleTiles.push_back(_tiles.size());
+		if (rect.isEmpty())
+			continue;
+
+		for (int top = rect.top; top < rect.bottom; ) {
+			Tile tile;
+			tile.band = top / kTileHeight;
+			const int bottom = MIN<int>(rect.bottom, (tile.band + 1) * kTileHeight);
+			tile.rect = Common::Rect(rect.left, top, rect.right, bottom);
+			tile.firstCall = 0;
+			tile.callCount = 0;
+			_tiles.push_back(tile);
+			top = bottom;
+		}
+	}
+	_rectangleTiles.push_back(_tiles.size());
+
+	const uint bands = (_context->fb->ysize + kTileHeight - 1) / kTileHeight;
+	if (_stats.tiles.size() != bands)
+		resetStats();
+}
+
+void TileRenderer::renderSerial(const Graphics::DrawCall *drawCall) const {
+	if (!_clip) {
+		drawCall->execute(true);
+		return;
+	}
+
+	const Common::Rect drawCallRegion = drawCall->getDirtyRegion();
+	for (uint i = 0; i < _rectangles.size(); i++) {
+		if (_rectangles[i].intersects(drawCallRegion))
+			drawCall->execute(_rectangles[i], true);
+	}
+}
+
+void TileRenderer::renderBatch() {
+	// Count the draw calls of the tiles, and give each tile its range of
+	// the binned draw calls
+	for (uint i = 0; i < _tiles.size(); i++)
+		_tiles[i].callCount = 0;
+
+	for (uint pass = 0; pass < 2; pass++) {
+		for (uint i = 0; i < _batch.size(); i++) {
+			const Common::Rect drawCallRegion = _batch[i]->getDirtyRegion();
+			for (uint j = 0; j < _rectangles.size(); j++) {
+				if (!_rectangles[j].intersects(drawCallRegion))
+					continue;
+
+				for (uint k = _rectangleTiles[j]; k < _rectangleTiles[j + 1]; k++) {
+					Tile &tile = _tiles[k];
+					if (!tile.rect.intersects(drawCallRegion))
+						continue;
+
+					if (pass == 0) {
+						tile.callCount++;
+					} else {
+						_tileCalls[tile.firstCall + tile.callCount++] = _batch[i];
+
+						TileStats &stats = _stats.tiles[tile.band];
+						const Common::Rect covered = tile.rect.findIntersectingRect(drawCallRegion);
+						stats.drawCalls++;
+						stats.pixels += covered.width() * covered.height();
+					}
+				}
+			}
+		}
+
+		if (pass == 0) {
+			uint32 firstCall = 0;
+			for (uint i = 0; i < _tiles.size(); i++) {
+				_tiles[i].firstCall = firstCall;
+				firstCall += _tiles[i].callCount;
+				_tiles[i].callCount = 0;
+			}
+			_tileCalls.resize(firstCall);
+		}
+	}
+
+	for (uint i = 0; i < _tiles.size(); i++) {
+		if (_tiles[i].callCount)
+			_stats.tiles[_tiles[i].band].tiles++;
+	}
+
+	_stats.batches++;
+	_stats.tiledDrawCalls += _batch.size();
+
+	Common::atomicStore(&_nextTile, 0);
+	_pool.run(renderTilesProc, this, _threadContexts.size());
+
+	// The threads do not keep the depth bounds of the z buffer, which would
+	// be shared between neighboring tiles
+	HierarchicalZ *hierarchicalZ = _context->fb->_hierarchicalZ;
+	if (hierarchicalZ) {
+		for (uint i = 0; i < _tiles.size(); i++) {
+			if (_tiles[i].callCount)
+				hierarchicalZ->invalidate(_tiles[i].rect);
+		}
+	}
+}
+
+void TileRenderer::renderTilesProc(void *arg, uint thread) {
+	((TileRenderer *)arg)->renderTiles(thread);
+}
+
+void TileRenderer::renderTiles(uint thread) {
+	GLContext *c = _threadContexts[thread];
+	for (;;) {
+		const uint32 index = Common::atomicAdd(&_nextTile, 1) - 1;
+		if (index >= _tiles.size())
+			break;
+
+		const Tile &tile = _tiles[index];
+		for (uint32 i = 0; i < tile.callCount; i++)
+			_tileCalls[tile.firstCall + i]->execute(c, tile.rect);
+	}
+}
+
+void TileRenderer::getStats(RenderStats &stats) const {
+	stats = _stats;
+}
+
+void TileRenderer::resetStats() {
+	_stats.threads = getThreadCount();
+	_stats.frames = 0;
+	_stats.batches = 0;
+	_stats.tiledDrawCalls = 0;
+	_stats.serialDrawCalls = 0;
+	_stats.tiledTime = 0;
+	_stats.serialTime = 0;
+
+	const int height = _context->fb->ysize;
+	_stats.tiles.resize((height + kTileHeight - 1) / kTileHeight);
+	for (uint i = 0; i < _stats.tiles.size(); i++) {
+		TileStats &tile = _stats.tiles[i];
+		tile.top = i * kTileHeight;
+		tile.bottom = MIN<int>(height, (i + 1) * kTileHeight);
+		tile.tiles = 0;
+		tile.drawCalls = 0;
+		tile.pixels = 0;
+	}
+}
+
+bool tglGetRenderStats(RenderStats &stats) {
+	GLContext *c = gl_get_context();
+	if (!c || !c->_tileRenderer)
+		return false;
+
+	c->_tileRenderer->getStats(stats);
+	return true;
+}
+
+void tglResetRenderStats() {
+	GLContext *c = gl_get_context();
+	if (c && c->_tileRenderer)
+		c->_tileRenderer->resetStats();
+}
+
+} // end of namespace TinyGL
@@ -0,0 +1,151 @@
+/* ResidualVM - A 3D game interpreter
+ *
+ * ResidualVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRAPHICS_TINYGL_ZTILES_H
+#define GRAPHICS_TINYGL_ZTILES_H
+
+#include "common/array.h"
+#include "common/list.h"
+#include "common/rect.h"
+#include "common/threadpool.h"
+
+namespace Graphics {
+	class DrawCall;
+	class RasterizationDrawCall;
+}
+
+namespace TinyGL {
+
+struct GLContext;
+
+/**
+ * Statistics of a band of rows of the screen, which is rendered in tiles.
+ */
+struct TileStats {
+	int top, bottom;  ///< The rows of the screen.
+	uint32 tiles;     ///< How often tiles were rendered in these rows.
+	uint32 drawCalls; ///< How many draw calls were executed in these tiles.
+	uint64 pixels;    ///< The area covered by the dirty regions of these draw calls inside the tiles.
+};
+
+/**
+ * Statistics of the tile renderer since it was created or reset.
+ */
+struct RenderStats {
+	uint threads;            ///< The number of threads rendering tiles.
+	uint32 frames;           ///< The number of frames rendered.
+	uint32 batches;          ///< The number of batches of draw calls rendered in tiles.
+	uint32 tiledDrawCalls;   ///< The number of draw calls rendered in tiles.
+	uint32 serialDrawCalls;  ///< The number of draw calls rendered by the calling thread only.
+	uint32 tiledTime;        ///< The time spent on rendering batches in tiles, in milliseconds.
+	uint32 serialTime;       ///< The time spent on the other draw calls, in milliseconds.
+	Common::Array<TileStats> tiles; ///< The statistics of the bands of rows, from top to bottom.
+};
+
+/**
+ * Renders the draw calls of a frame in tiles on several threads.
+ *
+ * Runs of consecutive rasterization draw calls are binned into the tiles
+ * overlapped by their dirty regions. Each tile is a band of rows of a dirty
+ * rectangle, and executes its draw calls in order, clipped to the tile, on
+ * a context of its own thread. Other draw calls, e.g. blits, are executed by
+ * the calling thread between the runs. As every pixel is drawn by the same
+ * draw calls in the same order as when executing the draw calls one after
+ * another, the result is identical.
+ */
+class TileRenderer {
+public:
+	/** The number of rows of the screen in a tile. */
+	static const int kTileHeight = 32;
+
+	/**
+	 * Create a tile renderer for a context.
+	 *
+	 * @param c          The context to render.
+	 * @param numThreads The number of threads, including the calling thread.
+	 *                   If 0, one thread per CPU core is used.
+	 */
+	TileRenderer(GLContext *c, uint numThreads);
+	~TileRenderer();
+
+	/** Return the number of threads rendering tiles. */
+	uint getThreadCount() const { return _pool.getThreadCount(); }
+
+	/**
+	 * Execute draw calls, with the same result as executing each of them
+	 * clipped to each of the given rectangles which intersect its dirty
+	 * region. The rectangles must not intersect. If there are no
+	 * rectangles, the draw calls are executed without clipping.
+	 */
+	void render(const Common::List<Graphics::DrawCall *> &drawCalls, const Common::Array<Common::Rect> &rectangles);
+
+	void getStats(RenderStats &stats) const;
+	void resetStats();
+
+private:
+	struct Tile {
+		Common::Rect rect;
+		uint band;
+		uint32 firstCall;
+		uint32 callCount;
+	};
+
+	typedef Common::List<Graphics::DrawCall *>::const_iterator DrawCallIterator;
+
+	bool canRenderInTiles(const Graphics::DrawCall *drawCall) const;
+	void prepareTiles(const Common::Array<Common::Rect> &rectangles);
+	void renderSerial(const Graphics::DrawCall *drawCall) const;
+	void renderBatch();
+
+	static void renderTilesProc(void *arg, uint thread);
+	void renderTiles(uint thread);
+
+	GLContext *_context;
+	Common::ThreadPool _pool;
+	Common::Array<GLContext *> _threadContexts;
+
+	bool _clip;
+	Common::Array<Common::Rect> _rectangles;
+	Common::Array<uint> _rectangleTiles; // Index of the first tile of each rectangle, and the tile count
+	Common::Array<Tile> _tiles;
+	Common::Array<const Graphics::RasterizationDrawCall *> _batch;
+	Common::Array<const Graphics::RasterizationDrawCall *> _tileCalls;
+	volatile uint32 _nextTile;
+
+	RenderStats _stats;
+};
+
+/**
+ * Get the statistics of the tile renderer of the current context.
+ *
+ * @return False if the current context does not render in tiles.
+ */
+bool tglGetRenderStats(RenderStats &stats);
+
+/**
+ * Reset the statistics of the tile renderer of the current context.
+ */
+void tglResetRenderStats();
+
+} // end of namespace TinyGL
+
+#endif
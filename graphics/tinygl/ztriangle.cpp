@@ -107,6 +107,188 @@ FORCEINLINE static void putPixelTextureMappingPerspective(FrameBuffer *buffer, i
 	}
 }
 
+// Clip a span starting at column x to the scissor rectangle, and step its
+// interpolated values to the first pixel which is drawn
+template <bool kEnableScissor>
+FORCEINLINE static bool clipSpan(const FrameBuffer *buffer, Span &span, int x) {
+	if (kEnableScissor) {
+		const Common::Rect &clip = buffer->_clipRectangle;
+		if (x + span.count > clip.right)
+			span.count = clip.right - x;
+		if (x < clip.left) {
+			const int skip = clip.left - x;
+			if (skip >= span.count)
+				return false;
+			span.count -= skip;
+			span.pixels += skip;
+			span.zbuf += skip;
+			span.z += skip * (uint32)span.dzdx;
+			span.r += skip * (uint32)span.drdx;
+			span.g += skip * (uint32)span.dgdx;
+			span.b += skip * (uint32)span.dbdx;
+			span.a += skip * (uint32)span.dadx;
+		}
+	}
+	return span.count > 0;
+}
+
+template <bool kEnableScissor>
+FORCEINLINE static uint32 scissorMask(const FrameBuffer *buffer, int x, int count) {
+	if (!kEnableScissor)
+		return 0xFF;
+	const int first = MAX<int>(buffer->_clipRectangle.left - x, 0);
+	const int last = MIN<int>(buffer->_clipRectangle.right - x, count);
+	if (first >= last)
+		return 0;
+	return ((1 << last) - 1) & ~((1 << first) - 1);
+}
+
+// Draw up to NB_INTERP pixels of a perspective textured span with the span
+// fillers. Only the texels of the pixels which pass the depth test are read.
+template <bool kSmoothMode, bool kEnableScissor>
+FORCEINLINE static void fillTextureSpan(FrameBuffer *buffer, const SpanState &state, uint32 *pixels,
+                        const Graphics::TexelBuffer *texture, unsigned int *pz, int x, int count,
+                        unsigned int &z, int &t, int &s, unsigned int &r, unsigned int &g, unsigned int &b, unsigned int &a,
+                        int dzdx, int dsdx, int dtdx, int drdx, int dgdx, int dbdx, int dadx) {
+	Span span;
+	span.pixels = pixels;
+	span.zbuf = pz;
+	span.count = count;
+	span.z = z;
+	span.r = r;
+	span.g = g;
+	span.b = b;
+	span.a = a;
+	span.dzdx = dzdx;
+	span.drdx = kSmoothMode ? drdx : 0;
+	span.dgdx = kSmoothMode ? dgdx : 0;
+	span.dbdx = kSmoothMode ? dbdx : 0;
+	span.dadx = kSmoothMode ? dadx : 0;
+
+	const uint32 mask = buffer->_spanFillers->testDepth(state, span) & scissorMask<kEnableScissor>(buffer, x, count);
+	if (mask) {
+		uint32 texels[NB_INTERP];
+		for (int i = 0; i < count; i++) {
+			if (mask & (1 << i)) {
+				uint8 c_a, c_r, c_g, c_b;
+				texture->getARGBAt(buffer->wrapS, buffer->wrapT, s + i * dsdx, t + i * dtdx, c_a, c_r, c_g, c_b);
+				texels[i] = (c_a << 24) | (c_r << 16) | (c_g << 8) | c_b;
+			}
+		}
+		buffer->_spanFillers->fillTexels(state, span, texels, mask);
+	}
+
+	z += count * (unsigned int)dzdx;
+	s += count * dsdx;
+	t += count * dtdx;
+	if (kSmoothMode) {
+		a += count * (unsigned int)dadx;
+		r += count * (unsigned int)drdx;
+		g += count * (unsigned int)dgdx;
+		b += count * (unsigned int)dbdx;
+	}
+}
+
+// The depths of a triangle are stepped in integers from the first vertex of
+// a left edge, so they are an affine function of the pixel coordinates,
+// modulo 2^32. Widen [zMin, zMax] to its bounds over a rectangle.
+static void getDepthBounds(const ZBufferPoint *p, int dzdx, int dzdy, const Common::Rect &rect, int64 &zMin, int64 &zMax) {
+	for (int i = 0; i < 4; i++) {
+		const int x = (i & 1) ? rect.right - 1 : rect.left;
+		const int y = (i & 2) ? rect.bottom - 1 : rect.top;
+		const int64 z = (int64)(uint32)p->z + (int64)(x - p->x) * dzdx + (int64)(y - p->y) * dzdy;
+		zMin = MIN(zMin, z);
+		zMax = MAX(zMax, z);
+	}
+}
+
+// Return the bounds of the depths of a span, or false if they wrap around
+FORCEINLINE static bool getSpanDepthBounds(unsigned int z, int dzdx, int count, int64 &zMin, int64 &zMax) {
+	const int64 zLast = (int64)z + (int64)dzdx * (count - 1);
+	zMin = MIN<int64>(z, zLast);
+	zMax = MAX<int64>(z, zLast);
+	return zMin >= 0 && zMax <= 0xFFFFFFFF;
+}
+
+// Clip the columns of a span to the scissor rectangle
+template <bool kEnableScissor>
+FORCEINLINE static void clipColumns(const FrameBuffer *buffer, int x, int count, int &left, int &right) {
+	left = x;
+	right = x + count;
+	if (kEnableScissor) {
+		left = MAX<int>(left, buffer->_clipRectangle.left);
+		right = MIN<int>(right, buffer->_clipRectangle.right);
+	}
+}
+
+// Return whether all the pixels of a span fail the depth test, according to
+// the depth bounds of the blocks of the z buffer
+template <bool kEnableScissor>
+FORCEINLINE static bool rejectSpan(FrameBuffer *buffer, int x, int y, int count, unsigned int z, int dzdx) {
+	int64 zMin, zMax;
+	if (count <= 0 || !getSpanDepthBounds(z, dzdx, count, zMin, zMax))
+		return false;
+
+	int left, right;
+	clipColumns<kEnableScissor>(buffer, x, count, left, right);
+	return buffer->_hierarchicalZ->rejectSpan(buffer->getZBuffer(), left, right, y, (uint32)zMin, (uint32)zMax, buffer->getDepthFunc());
+}
+
+// Collects the columns and depths of the spans written into a row of blocks
+// of the z buffer, to widen the depth bounds of the blocks they cover
+struct SpanDepthWrites {
+	HierarchicalZ *hierarchicalZ;
+	int row, left, right;
+	int64 zMin, zMax;
+
+	SpanDepthWrites(HierarchicalZ *h) : hierarchicalZ(h), row(-1), left(0), right(0), zMin(0), zMax(0) {}
+
+	template <bool kEnableScissor>
+	FORCEINLINE void add(const FrameBuffer *buffer, int x, int y, int count, unsigned int z, int dzdx) {
+		if (count <= 0)
+			return;
+
+		if ((y >> HierarchicalZ::kBlockShift) != row) {
+			flush();
+			row = y >> HierarchicalZ::kBlockShift;
+			zMin = 0xFFFFFFFF;
+			zMax = 0;
+		}
+
+		int spanLeft, spanRight;
+		clipColumns<kEnableScissor>(buffer, x, count, spanLeft, spanRight);
+		if (spanLeft >= spanRight)
+			return;
+
+		int64 spanMin, spanMax;
+		if (!getSpanDepthBounds(z, dzdx, count, spanMin, spanMax)) {
+			// Forget the bounds of the blocks, as the depths wrap around
+			spanMin = -1;
+		}
+		if (left >= right) {
+			left = spanLeft;
+			right = spanRight;
+		} else {
+			left = MIN(left, spanLeft);
+			right = MAX(right, spanRight);
+		}
+		zMin = MIN(zMin, spanMin);
+		zMax = MAX(zMax, spanMax);
+	}
+
+	void flush() {
+		if (left >= right)
+			return;
+
+		const Common::Rect rect(left, row << HierarchicalZ::kBlockShift, right, (row + 1) << HierarchicalZ::kBlockShift);
+		if (zMin < 0)
+			hierarchicalZ->invalidate(rect);
+		else
+			hierarchicalZ->extend(rect, (uint32)zMin, (uint32)zMax);
+		left = right = 0;
+	}
+};
+
 template <bool kInterpRGB, bool kInterpZ, bool kInterpST, bool kInterpSTZ, int kDrawLogic, bool kDepthWrite, bool kAlphaTestEnabled, bool kEnableScissor, bool kBlendingEnabled>
 void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint *p2) {
 	const Graphics::TexelBuffer *texture;
@@ -152,6 +334,25 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 		p2 = tp;
 	}
 
+	// Skip triangles which have no rows inside the scissor rectangle. This
+	// matters when a scene is rendered in tiles, each with its own scissor
+	// rectangle. The shadow mask is written regardless of the scissor.
+	if (kEnableScissor && kDrawLogic != DRAW_SHADOW_MASK &&
+			(p2->y < _clipRectangle.top || p0->y >= _clipRectangle.bottom))
+		return;
+
+	// Draw the spans with the vectorized span fillers, if they handle the
+	// state of the frame buffer
+	const bool useSpanFillers = !kAlphaTestEnabled && kInterpZ && _spanFillers &&
+			(kDrawLogic == DRAW_FLAT || kDrawLogic == DRAW_SMOOTH) && (kInterpRGB || !(kInterpST || kInterpSTZ)) &&
+			(!kBlendingEnabled || isAlphaBlendingEnabled());
+	SpanState spanState;
+	uint32 *pixels = NULL;
+	if (useSpanFillers) {
+		initSpanState(spanState, cmode, _depthTestEnabled, _depthFunc, kDepthWrite, kBlendingEnabled);
+		pixels = (uint32 *)pbuf.getRawBuffer();
+	}
+
 	// we compute dXdx and dXdy for all interpolated values
 
 	fdx1 = (float)(p1->x - p0->x);
@@ -177,6 +378,30 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 		dzdy = (int)(fdx1 * d2 - fdx2 * d1);
 	}
 
+	// Skip triangles which are hidden everywhere, according to the depth
+	// bounds of the blocks of the z buffer they overlap
+	const bool useHierarchicalZ = kInterpZ && kDrawLogic != DRAW_SHADOW_MASK && _depthTestEnabled && _hierarchicalZ;
+	if (useHierarchicalZ) {
+		// The left edge may be one pixel away from the vertices
+		Common::Rect rect(MIN(p0->x, MIN(p1->x, p2->x)) - 1, p0->y, MAX(p0->x, MAX(p1->x, p2->x)) + 2, p2->y + 1);
+		if (kEnableScissor)
+			rect.clip(_clipRectangle);
+		if (!rect.isEmpty()) {
+			// Part of the triangle is stepped from the second vertex
+			int64 zMin = (uint32)p0->z, zMax = (uint32)p0->z;
+			getDepthBounds(p0, dzdx, dzdy, rect, zMin, zMax);
+			getDepthBounds(p1, dzdx, dzdy, rect, zMin, zMax);
+			if (zMin >= 0 && zMax <= 0xFFFFFFFF &&
+					_hierarchicalZ->rejectTriangle(_zbuf, rect, (uint32)zMin, (uint32)zMax, _depthFunc, (uint32)(0.5f / fabs(fz0))))
+				return;
+		}
+	}
+
+	// The depths written by a triangle only move away from the bound which
+	// its depth function tests against, so the depth bounds of a row of
+	// blocks are only widened once all its spans are drawn
+	SpanDepthWrites depthWrites(_hierarchicalZ);
+
 	if (kInterpRGB) {
 		d1 = (float)(p1->r - p0->r);
 		d2 = (float)(p2->r - p0->r);
@@ -361,8 +586,34 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 		// we draw all the scan line of the part
 		while (nb_lines > 0) {
 			int x = x1;
-			{
-				if (kDrawLogic == DRAW_DEPTH_ONLY ||
+			// Rows outside the scissor rectangle are stepped over, but not
+			// drawn, and so are hidden spans
+			bool drawSpan = !kEnableScissor || kDrawLogic == DRAW_SHADOW_MASK ||
+					(y >= _clipRectangle.top && y < _clipRectangle.bottom);
+			if (useHierarchicalZ && drawSpan)
+				drawSpan = !rejectSpan<kEnableScissor>(this, x1, y, (x2 >> 16) - x1 + 1, z1, dzdx);
+			if (drawSpan) {
+				if (useHierarchicalZ && kDepthWrite)
+					depthWrites.add<kEnableScissor>(this, x1, y, (x2 >> 16) - x1 + 1, z1, dzdx);
+
+				if (useSpanFillers && !(kInterpST || kInterpSTZ)) {
+					Span span;
+					span.pixels = pixels + pp1 + x1;
+					span.zbuf = pz1 + x1;
+					span.count = (x2 >> 16) - x1 + 1;
+					span.z = z1;
+					span.r = r1;
+					span.g = g1;
+					span.b = b1;
+					span.a = a1;
+					span.dzdx = dzdx;
+					span.drdx = drdx;
+					span.dgdx = dgdx;
+					span.dbdx = dbdx;
+					span.dadx = dadx;
+					if (clipSpan<kEnableScissor>(this, span, x1))
+						_spanFillers->fillColor(spanState, span);
+				} else if (kDrawLogic == DRAW_DEPTH_ONLY ||
 						(kDrawLogic == DRAW_FLAT && !(kInterpST || kInterpSTZ))) {
 					int pp;
 					int n;
@@ -392,7 +643,7 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 						if (kDrawLogic == DRAW_FLAT) {
 							putPixelFlat<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, pp, pz, 0, x, y, z, r, g, b, a, dzdx);
 							putPixelFlat<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, pp, pz, 1, x, y, z, r, g, b, a, dzdx);
-							putPixelFlat<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, pp, pz, 2, x, y, z, r, g, g, a, dzdx);
+							putPixelFlat<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, pp, pz, 2, x, y, z, r, g, b, a, dzdx);
 							putPixelFlat<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, pp, pz, 3, x, y, z, r, g, b, a, dzdx);
 						}
 						if (kInterpZ) {
@@ -536,9 +787,14 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 							fz += fndzdx;
 							zinv = (float)(1.0 / fz);
 						}
-						for (int _a = 0; _a < NB_INTERP; _a++) {
-							putPixelTextureMappingPerspective<kDepthWrite, kInterpRGB, kDrawLogic == DRAW_SMOOTH, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, texture, wrapS, wrapT,
-							                           pz, _a, x, y, z, t, s, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx);
+						if (useSpanFillers) {
+							fillTextureSpan<kDrawLogic == DRAW_SMOOTH, kEnableScissor>(this, spanState, pixels + buf, texture, pz, x, NB_INTERP,
+							                           z, t, s, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx);
+						} else {
+							for (int _a = 0; _a < NB_INTERP; _a++) {
+								putPixelTextureMappingPerspective<kDepthWrite, kInterpRGB, kDrawLogic == DRAW_SMOOTH, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, texture, wrapS, wrapT,
+								                           pz, _a, x, y, z, t, s, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx);
+							}
 						}
 						pz += NB_INTERP;
 						buf += NB_INTERP;
@@ -558,6 +814,11 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 						dtdx = (int)((dtzdx - tt * fdzdx) * zinv);
 					}
 
+					if (useSpanFillers && n >= 0) {
+						fillTextureSpan<kDrawLogic == DRAW_SMOOTH, kEnableScissor>(this, spanState, pixels + buf, texture, pz, x, n + 1,
+						                           z, t, s, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx);
+						n = -1;
+					}
 					while (n >= 0) {
 						putPixelTextureMappingPerspective<kDepthWrite, kInterpRGB, kDrawLogic == DRAW_SMOOTH, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, texture, wrapS, wrapT,
 						                           pz, 0, x, y, z, t, s, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx);
@@ -619,6 +880,9 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 			y++;
 		}
 	}
+
+	if (useHierarchicalZ && kDepthWrite)
+		depthWrites.flush();
 }
 
 template <bool kInterpRGB, bool kInterpZ, bool kInterpST, bool kInterpSTZ, int kDrawMode, bool kDepthWrite, bool kEnableAlphaTest, bool kEnableScissor>
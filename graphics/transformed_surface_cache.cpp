@@ -0,0 +1,170 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "graphics/transformed_surface_cache.h"
+
+namespace Graphics {
+
+namespace {
+
+struct TransparentSurfaceDeleter {
+	void operator()(TransparentSurface *ptr) {
+		ptr->free();
+		delete ptr;
+	}
+};
+
+} // End of anonymous namespace
+
+TransformedSurfaceCache::Key::Key(const Surface &source) :
+	pixels((const byte *)source.getPixels()), w(source.w), h(source.h), pitch(source.pitch),
+	rotated(false), angle(0), newWidth(0), newHeight(0), filteringMode(FILTER_NEAREST) {
+}
+
+uint TransformedSurfaceCache::KeyHash::operator()(const Key &key) const {
+	uint hash = (uint)(size_t)key.pixels;
+	const uint values[] = {
+		key.w, key.h, key.pitch, key.rotated, (uint)key.angle, (uint)key.zoom.x, (uint)key.zoom.y,
+		(uint)key.hotspot.x, (uint)key.hotspot.y, key.newWidth, key.newHeight, key.filteringMode
+	};
+	for (int i = 0; i < ARRAYSIZE(values); i++)
+		hash = hash * 31 + values[i];
+	return hash;
+}
+
+bool TransformedSurfaceCache::KeyEqual::operator()(const Key &a, const Key &b) const {
+	return a.pixels == b.pixels && a.w == b.w && a.h == b.h && a.pitch == b.pitch &&
+	       a.rotated == b.rotated && a.angle == b.angle && a.zoom == b.zoom && a.hotspot == b.hotspot &&
+	       a.newWidth == b.newWidth && a.newHeight == b.newHeight && a.filteringMode == b.filteringMode;
+}
+
+TransformedSurfaceCache::TransformedSurfaceCache(uint32 memoryBudget) :
+	_memoryBudget(memoryBudget), _memoryUsage(0), _hits(0), _misses(0) {
+}
+
+TransformedSurfaceCache::~TransformedSurfaceCache() {
+	clear();
+}
+
+TransformedSurfaceCache::SurfacePtr TransformedSurfaceCache::rotoscale(const Surface &source, const TransformStruct &transform, TFilteringMode filteringMode) {
+	// rotoscaleT() only depends on these members of the transform
+	Key key(source);
+	key.rotated = true;
+	key.angle = transform._angle;
+	key.zoom = transform._zoom;
+	key.hotspot = transform._hotspot;
+	key.filteringMode = filteringMode;
+
+	SurfacePtr surface = find(key);
+	if (surface)
+		return surface;
+
+	const TransparentSurface src(source, false);
+	if (filteringMode == FILTER_BILINEAR)
+		return insert(key, src.rotoscaleT<FILTER_BILINEAR>(transform));
+	else
+		return insert(key, src.rotoscaleT<FILTER_NEAREST>(transform));
+}
+
+TransformedSurfaceCache::SurfacePtr TransformedSurfaceCache::scale(const Surface &source, uint16 newWidth, uint16 newHeight, bool filtering) {
+	Key key(source);
+	key.newWidth = newWidth;
+	key.newHeight = newHeight;
+	key.filteringMode = filtering ? FILTER_BILINEAR : FILTER_NEAREST;
+
+	SurfacePtr surface = find(key);
+	if (surface)
+		return surface;
+
+	const TransparentSurface src(source, false);
+	return insert(key, src.scale(newWidth, newHeight, filtering));
+}
+
+void TransformedSurfaceCache::invalidate(const Surface &source) {
+	if (!source.getPixels())
+		return;
+
+	const byte *begin = (const byte *)source.getPixels();
+	const byte *end = begin + source.pitch * source.h;
+	EntryList::iterator entry = _entries.begin();
+	while (entry != _entries.end()) {
+		const byte *entryBegin = entry->key.pixels;
+		const byte *entryEnd = entryBegin + entry->key.pitch * entry->key.h;
+		if (entryBegin < end && begin < entryEnd)
+			entry = erase(entry);
+		else
+			++entry;
+	}
+}
+
+void TransformedSurfaceCache::clear() {
+	_entries.clear();
+	_index.clear();
+	_memoryUsage = 0;
+}
+
+void TransformedSurfaceCache::setMemoryBudget(uint32 memoryBudget) {
+	_memoryBudget = memoryBudget;
+	shrink(memoryBudget);
+}
+
+TransformedSurfaceCache::SurfacePtr TransformedSurfaceCache::find(const Key &key) {
+	EntryList::iterator entry = _index.getVal(key, _entries.end());
+	if (entry == _entries.end()) {
+		_misses++;
+		return SurfacePtr();
+	}
+
+	_hits++;
+	if (entry != _entries.begin()) {
+		_entries.push_front(*entry);
+		_entries.erase(entry);
+		_index[key] = _entries.begin();
+	}
+	return _entries.front().surface;
+}
+
+TransformedSurfaceCache::SurfacePtr TransformedSurfaceCache::insert(const Key &key, TransparentSurface *surface) {
+	const SurfacePtr result(surface, TransparentSurfaceDeleter());
+	const uint32 size = surface->pitch * surface->h;
+	if (size > _memoryBudget)
+		return result;
+
+	shrink(_memoryBudget - size);
+	_entries.push_front(Entry(key, result, size));
+	_index[key] = _entries.begin();
+	_memoryUsage += size;
+	return result;
+}
+
+TransformedSurfaceCache::EntryList::iterator TransformedSurfaceCache::erase(EntryList::iterator entry) {
+	_memoryUsage -= entry->size;
+	_index.erase(entry->key);
+	return _entries.erase(entry);
+}
+
+void TransformedSurfaceCache::shrink(uint32 memoryBudget) {
+	while (_memoryUsage > memoryBudget)
+		erase(_entries.reverse_begin());
+}
+
+} // End of namespace Graphics
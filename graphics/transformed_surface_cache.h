@@ -0,0 +1,145 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRAPHICS_TRANSFORMED_SURFACE_CACHE_H
+#define GRAPHICS_TRANSFORMED_SURFACE_CACHE_H
+
+#include "common/hashmap.h"
+#include "common/list.h"
+#include "common/ptr.h"
+#include "graphics/transparent_surface.h"
+
+namespace Graphics {
+
+/**
+ * @defgroup graphics_transformed_surface_cache Transformed surface cache
+ * @ingroup graphics
+ *
+ * @brief TransformedSurfaceCache class.
+ *
+ * @{
+ */
+
+/**
+ * A cache of the surfaces returned by TransparentSurface::rotoscaleT() and
+ * TransparentSurface::scale(), for sprites which are drawn with the same
+ * transform on every frame.
+ *
+ * Source surfaces are identified by their pixels, so that all the surfaces
+ * sharing the same pixels, like a TransparentSurface created without copying
+ * the data, find the same results. Whoever changes or frees the pixels of a
+ * source surface must call invalidate() first.
+ *
+ * The transformed surfaces are shared with the callers, which must not
+ * change them. They stay valid when the cache drops them. The cache only
+ * keeps as many surfaces as fit in its memory budget, and drops the least
+ * recently used ones first.
+ */
+class TransformedSurfaceCache {
+public:
+	typedef Common::SharedPtr<const TransparentSurface> SurfacePtr;
+
+	/**
+	 * Create an empty cache.
+	 *
+	 * @param memoryBudget The number of bytes of pixels the cache may keep.
+	 */
+	explicit TransformedSurfaceCache(uint32 memoryBudget);
+	~TransformedSurfaceCache();
+
+	/** Return source.rotoscaleT<filteringMode>(transform), which is cached. */
+	SurfacePtr rotoscale(const Surface &source, const TransformStruct &transform, TFilteringMode filteringMode);
+
+	/** Return source.scale(newWidth, newHeight, filtering), which is cached. */
+	SurfacePtr scale(const Surface &source, uint16 newWidth, uint16 newHeight, bool filtering);
+
+	/**
+	 * Drop the transformed surfaces of all the sources sharing pixels with
+	 * @p source. This must be called before changing or freeing them.
+	 */
+	void invalidate(const Surface &source);
+
+	/** Drop all the transformed surfaces. */
+	void clear();
+
+	/** Change the memory budget, dropping surfaces which do not fit anymore. */
+	void setMemoryBudget(uint32 memoryBudget);
+	uint32 getMemoryBudget() const { return _memoryBudget; }
+
+	/** Return the number of bytes of pixels kept by the cache. */
+	uint32 getMemoryUsage() const { return _memoryUsage; }
+
+	/** Return how many transformed surfaces were found in the cache. */
+	uint32 getHits() const { return _hits; }
+
+	/** Return how many transformed surfaces had to be computed. */
+	uint32 getMisses() const { return _misses; }
+
+private:
+	struct Key {
+		const byte *pixels;
+		uint16 w, h, pitch;
+		bool rotated;
+		int32 angle;
+		Common::Point zoom, hotspot;
+		uint16 newWidth, newHeight;
+		byte filteringMode;
+
+		Key(const Surface &source);
+	};
+
+	struct KeyHash {
+		uint operator()(const Key &key) const;
+	};
+
+	struct KeyEqual {
+		bool operator()(const Key &a, const Key &b) const;
+	};
+
+	struct Entry {
+		Key key;
+		SurfacePtr surface;
+		uint32 size;
+
+		Entry(const Key &k, const SurfacePtr &s, uint32 sz) : key(k), surface(s), size(sz) {}
+	};
+
+	typedef Common::List<Entry> EntryList;
+
+	SurfacePtr find(const Key &key);
+	SurfacePtr insert(const Key &key, TransparentSurface *surface);
+	EntryList::iterator erase(EntryList::iterator entry);
+	void shrink(uint32 memoryBudget);
+
+	EntryList _entries; ///< The cached surfaces, the most recently used first.
+	Common::HashMap<Key, EntryList::iterator, KeyHash, KeyEqual> _index;
+	uint32 _memoryBudget;
+	uint32 _memoryUsage;
+	uint32 _hits;
+	uint32 _misses;
+};
+
+/** @} */
+
+} // End of namespace Graphics
+
+#endif
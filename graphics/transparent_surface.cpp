@@ -33,9 +33,12 @@
 #include "common/rect.h"
 #include "common/math.h"
 #include "common/textconsole.h"
+#include "common/system.h"
 #include "graphics/conversion.h"
 #include "graphics/primitives.h"
 #include "graphics/transparent_surface.h"
+#include "graphics/transparent_surface_blend.h"
+#include "graphics/transformed_surface_cache.h"
 #include "graphics/transform_tools.h"
 
 namespace Graphics {
@@ -60,14 +63,10 @@ static const int kRIndex = 0;
 
 void doBlitOpaqueFast(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep);
 void doBlitBinaryFast(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep);
-void doBlitAlphaBlend(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color);
-void doBlitAdditiveBlend(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color);
-void doBlitSubtractiveBlend(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color);
-void doBlitMultiplyBlend(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color);
 
-TransparentSurface::TransparentSurface() : Surface(), _alphaMode(ALPHA_FULL) {}
+TransparentSurface::TransparentSurface() : Surface(), _alphaMode(ALPHA_FULL), _transformedSurfaces(nullptr) {}
 
-TransparentSurface::TransparentSurface(const Surface &surf, bool copyData) : Surface(), _alphaMode(ALPHA_FULL) {
+TransparentSurface::TransparentSurface(const Surface &surf, bool copyData) : Surface(), _alphaMode(ALPHA_FULL), _transformedSurfaces(nullptr) {
 	if (copyData) {
 		copyFrom(surf);
 	} else {
@@ -304,20 +303,21 @@ void doBlitSubtractiveBlend(byte *ino, byte *outo, uint32 width, uint32 height,
 			for (uint32 j = 0; j < width; j++) {
 
 				out[kAIndex] = 255;
+				// The product of four bytes does not fit in an int
 				if (cb != 255) {
-					out[kBIndex] = MAX(out[kBIndex] - ((in[kBIndex] * cb  * (out[kBIndex]) * in[kAIndex]) >> 24), 0);
+					out[kBIndex] = MAX<int>(out[kBIndex] - (((uint32)in[kBIndex] * cb * out[kBIndex] * in[kAIndex]) >> 24), 0);
 				} else {
 					out[kBIndex] = MAX(out[kBIndex] - (in[kBIndex] * (out[kBIndex]) * in[kAIndex] >> 16), 0);
 				}
 
 				if (cg != 255) {
-					out[kGIndex] = MAX(out[kGIndex] - ((in[kGIndex] * cg  * (out[kGIndex]) * in[kAIndex]) >> 24), 0);
+					out[kGIndex] = MAX<int>(out[kGIndex] - (((uint32)in[kGIndex] * cg * out[kGIndex] * in[kAIndex]) >> 24), 0);
 				} else {
 					out[kGIndex] = MAX(out[kGIndex] - (in[kGIndex] * (out[kGIndex]) * in[kAIndex] >> 16), 0);
 				}
 
 				if (cr != 255) {
-					out[kRIndex] = MAX(out[kRIndex] - ((in[kRIndex] * cr * (out[kRIndex]) * in[kAIndex]) >> 24), 0);
+					out[kRIndex] = MAX<int>(out[kRIndex] - (((uint32)in[kRIndex] * cr * out[kRIndex] * in[kAIndex]) >> 24), 0);
 				} else {
 					out[kRIndex] = MAX(out[kRIndex] - (in[kRIndex] * (out[kRIndex]) * in[kAIndex] >> 16), 0);
 				}
@@ -397,6 +397,30 @@ void doBlitMultiplyBlend(byte *ino, byte *outo, uint32 width, uint32 height, uin
 
 }
 
+const BlendBlitters blendBlittersScalar = {
+	doBlitAlphaBlend,
+	doBlitAdditiveBlend,
+	doBlitSubtractiveBlend,
+	doBlitMultiplyBlend
+};
+
+const BlendBlitters *g_blendBlitters = 0;
+
+static const BlendBlitters *getBlendBlitters() {
+#ifdef SCUMM_LITTLE_ENDIAN
+	const OSystem::SimdLevel simdLevel = g_system->getSimdLevel();
+#ifdef SCUMMVM_AVX2
+	if (simdLevel >= OSystem::kSimdAVX2)
+		return &blendBlittersAVX2;
+#endif
+#ifdef SCUMMVM_SSE2
+	if (simdLevel >= OSystem::kSimdSSE2)
+		return &blendBlittersSSE2;
+#endif
+#endif
+	return &blendBlittersScalar;
+}
+
 Common::Rect TransparentSurface::blit(Graphics::Surface &target, int posX, int posY, int flipping, Common::Rect *pPartRect, uint color, int width, int height, TSpriteBlendMode blendMode) {
 
 	Common::Rect retSize;
@@ -460,10 +484,18 @@ Common::Rect TransparentSurface::blit(Graphics::Surface &target, int posX, int p
 	Graphics::Surface *img = nullptr;
 	Graphics::Surface *imgScaled = nullptr;
 	byte *savedPixels = nullptr;
+	TransformedSurfaceCache::SurfacePtr imgCached;
 	if ((width != srcImage.w) || (height != srcImage.h)) {
-		// Scale the image
-		img = imgScaled = srcImage.scale(width, height);
-		savedPixels = (byte *)img->getPixels();
+		if (_transformedSurfaces) {
+			// The cached image is shared, so only a view of it is clipped
+			imgCached = _transformedSurfaces->scale(srcImage, width, height, false);
+			srcImage.init(imgCached->w, imgCached->h, imgCached->pitch, const_cast<void *>(imgCached->getPixels()), imgCached->format);
+			img = &srcImage;
+		} else {
+			// Scale the image
+			img = imgScaled = srcImage.scale(width, height);
+			savedPixels = (byte *)img->getPixels();
+		}
 	} else {
 		img = &srcImage;
 	}
@@ -519,15 +551,17 @@ Common::Rect TransparentSurface::blit(Graphics::Surface &target, int posX, int p
 		} else if (color == 0xFFFFFFFF && blendMode == BLEND_NORMAL && _alphaMode == ALPHA_BINARY) {
 			doBlitBinaryFast(ino, outo, img->w, img->h, target.pitch, inStep, inoStep);
 		} else {
+			if (!g_blendBlitters)
+				g_blendBlitters = getBlendBlitters();
 			if (blendMode == BLEND_ADDITIVE) {
-				doBlitAdditiveBlend(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
+				g_blendBlitters->additiveBlend(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
 			} else if (blendMode == BLEND_SUBTRACTIVE) {
-				doBlitSubtractiveBlend(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
+				g_blendBlitters->subtractiveBlend(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
 			} else if (blendMode == BLEND_MULTIPLY) {
-				doBlitMultiplyBlend(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
+				g_blendBlitters->multiplyBlend(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
 			} else {
 				assert(blendMode == BLEND_NORMAL);
-				doBlitAlphaBlend(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
+				g_blendBlitters->alphaBlend(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
 			}
 		}
 
@@ -607,10 +641,18 @@ Common::Rect TransparentSurface::blitClip(Graphics::Surface &target, Common::Rec
 	Graphics::Surface *img = nullptr;
 	Graphics::Surface *imgScaled = nullptr;
 	byte *savedPixels = nullptr;
+	TransformedSurfaceCache::SurfacePtr imgCached;
 	if ((width != srcImage.w) || (height != srcImage.h)) {
-		// Scale the image
-		img = imgScaled = srcImage.scale(width, height);
-		savedPixels = (byte *)img->getPixels();
+		if (_transformedSurfaces) {
+			// The cached image is shared, so only a view of it is clipped
+			imgCached = _transformedSurfaces->scale(srcImage, width, height, false);
+			srcImage.init(imgCached->w, imgCached->h, imgCached->pitch, const_cast<void *>(imgCached->getPixels()), imgCached->format);
+			img = &srcImage;
+		} else {
+			// Scale the image
+			img = imgScaled = srcImage.scale(width, height);
+			savedPixels = (byte *)img->getPixels();
+		}
 	} else {
 		img = &srcImage;
 	}
@@ -666,15 +708,17 @@ Common::Rect TransparentSurface::blitClip(Graphics::Surface &target, Common::Rec
 		} else if (color == 0xFFFFFFFF && blendMode == BLEND_NORMAL && _alphaMode == ALPHA_BINARY) {
 			doBlitBinaryFast(ino, outo, img->w, img->h, target.pitch, inStep, inoStep);
 		} else {
+			if (!g_blendBlitters)
+				g_blendBlitters = getBlendBlitters();
 			if (blendMode == BLEND_ADDITIVE) {
-				doBlitAdditiveBlend(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
+				g_blendBlitters->additiveBlend(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
 			} else if (blendMode == BLEND_SUBTRACTIVE) {
-				doBlitSubtractiveBlend(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
+				g_blendBlitters->subtractiveBlend(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
 			} else if (blendMode == BLEND_MULTIPLY) {
-				doBlitMultiplyBlend(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
+				g_blendBlitters->multiplyBlend(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
 			} else {
 				assert(blendMode == BLEND_NORMAL);
-				doBlitAlphaBlend(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
+				g_blendBlitters->alphaBlend(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
 			}
 		}
 
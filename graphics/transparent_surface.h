@@ -45,6 +45,8 @@
 
 namespace Graphics {
 
+class TransformedSurfaceCache;
+
 /**
  * @defgroup graphics_transparent_surface Transparent surface
  * @ingroup graphics
@@ -179,8 +181,16 @@ struct TransparentSurface : public Graphics::Surface {
 
 	AlphaType getAlphaMode() const;
 	void setAlphaMode(AlphaType);
+
+	/**
+	 * Set the cache of the scaled images used by blit() and blitClip().
+	 * Without one, the image is scaled again on each blit. The caller must
+	 * invalidate the cache whenever the pixels of this surface change.
+	 */
+	void setTransformedSurfaceCache(TransformedSurfaceCache *cache) { _transformedSurfaces = cache; }
 private:
 	AlphaType _alphaMode;
+	TransformedSurfaceCache *_transformedSurfaces;
 };
 
 /**
@@ -0,0 +1,278 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "graphics/transparent_surface_blend.h"
+
+#include <immintrin.h>
+
+namespace Graphics {
+
+namespace {
+
+// The blenders work on eight pixels at once. blend() computes the color
+// channels of four pixels, unpacked to 16 bits, and finish() merges the
+// packed result with the target pixels. The alpha channel is the lowest
+// byte of each pixel.
+
+inline __m256i alphaMask() {
+	return _mm256_set1_epi32(0xFF);
+}
+
+/** Copy the alpha channel of four unpacked pixels to their other channels. */
+inline __m256i alpha16(__m256i c) {
+	return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(c, 0), 0);
+}
+
+inline __m256i select(__m256i mask, __m256i a, __m256i b) {
+	return _mm256_or_si256(_mm256_and_si256(mask, a), _mm256_andnot_si256(mask, b));
+}
+
+/** Return a mask of the pixels whose alpha is 0. */
+inline __m256i transparent(__m256i src) {
+	return _mm256_cmpeq_epi32(_mm256_and_si256(src, alphaMask()), _mm256_setzero_si256());
+}
+
+/** Return a mask of the pixels whose alpha, modulated by @p ca, is 0. */
+inline __m256i transparent(__m256i src, __m256i ca) {
+	const __m256i a = _mm256_madd_epi16(_mm256_and_si256(src, alphaMask()), ca);
+	return _mm256_cmpgt_epi32(_mm256_set1_epi32(256), a);
+}
+
+/**
+ * Return the color modulation of the channels of four unpacked pixels. The
+ * scalar functions shift by 8 instead of multiplying by 255 and shifting by
+ * 16 for channels which are not modulated, which is what 256 does.
+ */
+inline __m256i colorFactors(uint32 color, bool fullAs256) {
+	int16 c[3];
+	for (int i = 0; i < 3; i++) {
+		c[i] = (color >> (i * 8)) & 0xFF;
+		if (fullAs256 && c[i] == 255)
+			c[i] = 256;
+	}
+	return _mm256_setr_epi16(0, c[0], c[1], c[2], 0, c[0], c[1], c[2], 0, c[0], c[1], c[2], 0, c[0], c[1], c[2]);
+}
+
+/** The alpha of the pixels of a sprite, modulated by the alpha of the color. */
+inline __m256i modulatedAlpha(__m256i s, __m256i ca) {
+	return _mm256_srli_epi16(_mm256_mullo_epi16(alpha16(s), ca), 8);
+}
+
+struct AlphaBlend {
+	explicit AlphaBlend(uint32 color) {}
+
+	__m256i blend(__m256i s, __m256i d) const {
+		const __m256i a = alpha16(s);
+		const __m256i blended = _mm256_add_epi16(_mm256_mullo_epi16(s, a), _mm256_mullo_epi16(d, _mm256_sub_epi16(_mm256_set1_epi16(255), a)));
+		return _mm256_srli_epi16(blended, 8);
+	}
+
+	__m256i finish(__m256i src, __m256i dst, __m256i blended) const {
+		return select(transparent(src), dst, _mm256_or_si256(blended, alphaMask()));
+	}
+};
+
+struct AlphaBlendColor {
+	__m256i ca, factors;
+
+	explicit AlphaBlendColor(uint32 color) {
+		ca = _mm256_set1_epi16(color >> 24);
+		factors = colorFactors(color, false);
+	}
+
+	__m256i blend(__m256i s, __m256i d) const {
+		const __m256i ina = modulatedAlpha(s, ca);
+		const __m256i background = _mm256_srli_epi16(_mm256_mullo_epi16(d, _mm256_sub_epi16(_mm256_set1_epi16(255), ina)), 8);
+		return _mm256_add_epi16(background, _mm256_mulhi_epu16(_mm256_mullo_epi16(s, ina), factors));
+	}
+
+	__m256i finish(__m256i src, __m256i dst, __m256i blended) const {
+		return select(transparent(src, ca), dst, _mm256_or_si256(blended, alphaMask()));
+	}
+};
+
+struct AdditiveBlend {
+	explicit AdditiveBlend(uint32 color) {}
+
+	__m256i blend(__m256i s, __m256i d) const {
+		return _mm256_srli_epi16(_mm256_mullo_epi16(s, alpha16(s)), 8);
+	}
+
+	__m256i finish(__m256i src, __m256i dst, __m256i added) const {
+		return _mm256_adds_epu8(dst, _mm256_andnot_si256(alphaMask(), added));
+	}
+};
+
+struct AdditiveBlendColor {
+	__m256i ca, factors;
+
+	explicit AdditiveBlendColor(uint32 color) {
+		ca = _mm256_set1_epi16(color >> 24);
+		factors = colorFactors(color, true);
+	}
+
+	__m256i blend(__m256i s, __m256i d) const {
+		return _mm256_mulhi_epu16(_mm256_mullo_epi16(s, modulatedAlpha(s, ca)), factors);
+	}
+
+	__m256i finish(__m256i src, __m256i dst, __m256i added) const {
+		return _mm256_adds_epu8(dst, _mm256_andnot_si256(alphaMask(), added));
+	}
+};
+
+struct SubtractiveBlend {
+	explicit SubtractiveBlend(uint32 color) {}
+
+	__m256i blend(__m256i s, __m256i d) const {
+		return _mm256_mulhi_epu16(_mm256_mullo_epi16(s, d), alpha16(s));
+	}
+
+	__m256i finish(__m256i src, __m256i dst, __m256i subtracted) const {
+		return _mm256_subs_epu8(dst, _mm256_andnot_si256(alphaMask(), subtracted));
+	}
+};
+
+struct SubtractiveBlendColor {
+	__m256i factors;
+
+	explicit SubtractiveBlendColor(uint32 color) {
+		factors = colorFactors(color, true);
+	}
+
+	__m256i blend(__m256i s, __m256i d) const {
+		// The product of the four bytes is shifted by 24, or by 16 when the
+		// channel is not modulated
+		const __m256i product = _mm256_mulhi_epu16(_mm256_mullo_epi16(s, d), _mm256_mullo_epi16(alpha16(s), factors));
+		return _mm256_srli_epi16(product, 8);
+	}
+
+	__m256i finish(__m256i src, __m256i dst, __m256i subtracted) const {
+		return _mm256_or_si256(_mm256_subs_epu8(dst, _mm256_andnot_si256(alphaMask(), subtracted)), alphaMask());
+	}
+};
+
+struct MultiplyBlend {
+	explicit MultiplyBlend(uint32 color) {}
+
+	__m256i blend(__m256i s, __m256i d) const {
+		const __m256i c = _mm256_srli_epi16(_mm256_mullo_epi16(s, alpha16(s)), 8);
+		return _mm256_srli_epi16(_mm256_mullo_epi16(c, d), 8);
+	}
+
+	__m256i finish(__m256i src, __m256i dst, __m256i multiplied) const {
+		return select(_mm256_or_si256(transparent(src), alphaMask()), dst, multiplied);
+	}
+};
+
+struct MultiplyBlendColor {
+	__m256i ca, factors;
+
+	explicit MultiplyBlendColor(uint32 color) {
+		ca = _mm256_set1_epi16(color >> 24);
+		factors = colorFactors(color, true);
+	}
+
+	__m256i blend(__m256i s, __m256i d) const {
+		const __m256i c = _mm256_mulhi_epu16(_mm256_mullo_epi16(s, modulatedAlpha(s, ca)), factors);
+		return _mm256_srli_epi16(_mm256_mullo_epi16(c, d), 8);
+	}
+
+	__m256i finish(__m256i src, __m256i dst, __m256i multiplied) const {
+		return select(alphaMask(), dst, multiplied);
+	}
+};
+
+template<class Blender, bool kFlipped>
+void blendRows(const Blender &blender, BlendBlitProc scalar, byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inoStep, uint32 color) {
+	const __m256i zero = _mm256_setzero_si256();
+	const uint32 vectorWidth = width & ~7;
+	const int32 inStep = kFlipped ? -4 : 4;
+
+	for (uint32 i = 0; i < height; i++) {
+		byte *in = ino;
+		byte *out = outo;
+		for (uint32 j = 0; j < vectorWidth; j += 8) {
+			__m256i src;
+			if (kFlipped)
+				src = _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i *)(in - 28)), _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+			else
+				src = _mm256_loadu_si256((const __m256i *)in);
+			const __m256i dst = _mm256_loadu_si256((const __m256i *)out);
+
+			const __m256i lo = blender.blend(_mm256_unpacklo_epi8(src, zero), _mm256_unpacklo_epi8(dst, zero));
+			const __m256i hi = blender.blend(_mm256_unpackhi_epi8(src, zero), _mm256_unpackhi_epi8(dst, zero));
+			_mm256_storeu_si256((__m256i *)out, blender.finish(src, dst, _mm256_packus_epi16(lo, hi)));
+
+			in += 8 * inStep;
+			out += 32;
+		}
+		if (vectorWidth < width)
+			scalar(in, out, width - vectorWidth, 1, pitch, inStep, inoStep, color);
+
+		outo += pitch;
+		ino += inoStep;
+	}
+}
+
+template<class Blender, class ColorBlender>
+void blend(BlendBlitProc scalar, byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	if (inStep != 4 && inStep != -4) {
+		scalar(ino, outo, width, height, pitch, inStep, inoStep, color);
+	} else if (color == 0xFFFFFFFF) {
+		if (inStep < 0)
+			blendRows<Blender, true>(Blender(color), scalar, ino, outo, width, height, pitch, inoStep, color);
+		else
+			blendRows<Blender, false>(Blender(color), scalar, ino, outo, width, height, pitch, inoStep, color);
+	} else {
+		if (inStep < 0)
+			blendRows<ColorBlender, true>(ColorBlender(color), scalar, ino, outo, width, height, pitch, inoStep, color);
+		else
+			blendRows<ColorBlender, false>(ColorBlender(color), scalar, ino, outo, width, height, pitch, inoStep, color);
+	}
+}
+
+void doBlitAlphaBlendAVX2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	blend<AlphaBlend, AlphaBlendColor>(doBlitAlphaBlend, ino, outo, width, height, pitch, inStep, inoStep, color);
+}
+
+void doBlitAdditiveBlendAVX2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	blend<AdditiveBlend, AdditiveBlendColor>(doBlitAdditiveBlend, ino, outo, width, height, pitch, inStep, inoStep, color);
+}
+
+void doBlitSubtractiveBlendAVX2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	blend<SubtractiveBlend, SubtractiveBlendColor>(doBlitSubtractiveBlend, ino, outo, width, height, pitch, inStep, inoStep, color);
+}
+
+void doBlitMultiplyBlendAVX2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	blend<MultiplyBlend, MultiplyBlendColor>(doBlitMultiplyBlend, ino, outo, width, height, pitch, inStep, inoStep, color);
+}
+
+} // End of anonymous namespace
+
+const BlendBlitters blendBlittersAVX2 = {
+	doBlitAlphaBlendAVX2,
+	doBlitAdditiveBlendAVX2,
+	doBlitSubtractiveBlendAVX2,
+	doBlitMultiplyBlendAVX2
+};
+
+} // End of namespace Graphics
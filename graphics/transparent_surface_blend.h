@@ -0,0 +1,87 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRAPHICS_TRANSPARENTSURFACE_BLEND_H
+#define GRAPHICS_TRANSPARENTSURFACE_BLEND_H
+
+#include "common/scummsys.h"
+
+namespace Graphics {
+
+/**
+ * Blend the pixels of a sprite into a surface, as done by
+ * TransparentSurface::blit().
+ *
+ * @param ino     The first pixel of the sprite to draw.
+ * @param outo    The first pixel of the target surface.
+ * @param width   The number of pixels of each row.
+ * @param height  The number of rows.
+ * @param pitch   The pitch of the target surface.
+ * @param inStep  The step in bytes from a pixel of the sprite to the next
+ *                one, which is negative when the sprite is flipped.
+ * @param inoStep The step in bytes from a row of the sprite to the next one.
+ * @param color   The color modulation, in 0xAARRGGBB format.
+ */
+typedef void (*BlendBlitProc)(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color);
+
+/**
+ * The blending functions of TransparentSurface::blit(), for each blend mode.
+ */
+struct BlendBlitters {
+	BlendBlitProc alphaBlend;
+	BlendBlitProc additiveBlend;
+	BlendBlitProc subtractiveBlend;
+	BlendBlitProc multiplyBlend;
+};
+
+void doBlitAlphaBlend(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color);
+void doBlitAdditiveBlend(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color);
+void doBlitSubtractiveBlend(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color);
+void doBlitMultiplyBlend(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color);
+
+/**
+ * The blending functions working one pixel at a time. The vectorized ones
+ * use them for the pixels at the end of a row.
+ */
+extern const BlendBlitters blendBlittersScalar;
+
+/**
+ * The blending functions used by TransparentSurface::blit() and blitClip(),
+ * or 0 until they are chosen for the CPU by the first blit.
+ */
+extern const BlendBlitters *g_blendBlitters;
+
+// The vectorized functions expect the pixels in little endian byte order.
+// They pass sprites with a step other than 4 or -4 bytes between pixels to
+// the scalar functions.
+
+#ifdef SCUMMVM_SSE2
+extern const BlendBlitters blendBlittersSSE2;
+#endif
+
+#ifdef SCUMMVM_AVX2
+extern const BlendBlitters blendBlittersAVX2;
+#endif
+
+} // End of namespace Graphics
+
+#endif
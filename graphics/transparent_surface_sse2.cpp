@@ -0,0 +1,278 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "graphics/transparent_surface_blend.h"
+
+#include <emmintrin.h>
+
+namespace Graphics {
+
+namespace {
+
+// The blenders work on four pixels at once. blend() computes the color
+// channels of two pixels, unpacked to 16 bits, and finish() merges the
+// packed result with the target pixels. The alpha channel is the lowest
+// byte of each pixel.
+
+inline __m128i alphaMask() {
+	return _mm_set1_epi32(0xFF);
+}
+
+/** Copy the alpha channel of two unpacked pixels to their other channels. */
+inline __m128i alpha16(__m128i c) {
+	return _mm_shufflehi_epi16(_mm_shufflelo_epi16(c, 0), 0);
+}
+
+inline __m128i select(__m128i mask, __m128i a, __m128i b) {
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+/** Return a mask of the pixels whose alpha is 0. */
+inline __m128i transparent(__m128i src) {
+	return _mm_cmpeq_epi32(_mm_and_si128(src, alphaMask()), _mm_setzero_si128());
+}
+
+/** Return a mask of the pixels whose alpha, modulated by @p ca, is 0. */
+inline __m128i transparent(__m128i src, __m128i ca) {
+	const __m128i a = _mm_madd_epi16(_mm_and_si128(src, alphaMask()), ca);
+	return _mm_cmplt_epi32(a, _mm_set1_epi32(256));
+}
+
+/**
+ * Return the color modulation of the channels of two unpacked pixels. The
+ * scalar functions shift by 8 instead of multiplying by 255 and shifting by
+ * 16 for channels which are not modulated, which is what 256 does.
+ */
+inline __m128i colorFactors(uint32 color, bool fullAs256) {
+	int16 c[3];
+	for (int i = 0; i < 3; i++) {
+		c[i] = (color >> (i * 8)) & 0xFF;
+		if (fullAs256 && c[i] == 255)
+			c[i] = 256;
+	}
+	return _mm_setr_epi16(0, c[0], c[1], c[2], 0, c[0], c[1], c[2]);
+}
+
+/** The alpha of the pixels of a sprite, modulated by the alpha of the color. */
+inline __m128i modulatedAlpha(__m128i s, __m128i ca) {
+	return _mm_srli_epi16(_mm_mullo_epi16(alpha16(s), ca), 8);
+}
+
+struct AlphaBlend {
+	explicit AlphaBlend(uint32 color) {}
+
+	__m128i blend(__m128i s, __m128i d) const {
+		const __m128i a = alpha16(s);
+		const __m128i blended = _mm_add_epi16(_mm_mullo_epi16(s, a), _mm_mullo_epi16(d, _mm_sub_epi16(_mm_set1_epi16(255), a)));
+		return _mm_srli_epi16(blended, 8);
+	}
+
+	__m128i finish(__m128i src, __m128i dst, __m128i blended) const {
+		return select(transparent(src), dst, _mm_or_si128(blended, alphaMask()));
+	}
+};
+
+struct AlphaBlendColor {
+	__m128i ca, factors;
+
+	explicit AlphaBlendColor(uint32 color) {
+		ca = _mm_set1_epi16(color >> 24);
+		factors = colorFactors(color, false);
+	}
+
+	__m128i blend(__m128i s, __m128i d) const {
+		const __m128i ina = modulatedAlpha(s, ca);
+		const __m128i background = _mm_srli_epi16(_mm_mullo_epi16(d, _mm_sub_epi16(_mm_set1_epi16(255), ina)), 8);
+		return _mm_add_epi16(background, _mm_mulhi_epu16(_mm_mullo_epi16(s, ina), factors));
+	}
+
+	__m128i finish(__m128i src, __m128i dst, __m128i blended) const {
+		return select(transparent(src, ca), dst, _mm_or_si128(blended, alphaMask()));
+	}
+};
+
+struct AdditiveBlend {
+	explicit AdditiveBlend(uint32 color) {}
+
+	__m128i blend(__m128i s, __m128i d) const {
+		return _mm_srli_epi16(_mm_mullo_epi16(s, alpha16(s)), 8);
+	}
+
+	__m128i finish(__m128i src, __m128i dst, __m128i added) const {
+		return _mm_adds_epu8(dst, _mm_andnot_si128(alphaMask(), added));
+	}
+};
+
+struct AdditiveBlendColor {
+	__m128i ca, factors;
+
+	explicit AdditiveBlendColor(uint32 color) {
+		ca = _mm_set1_epi16(color >> 24);
+		factors = colorFactors(color, true);
+	}
+
+	__m128i blend(__m128i s, __m128i d) const {
+		return _mm_mulhi_epu16(_mm_mullo_epi16(s, modulatedAlpha(s, ca)), factors);
+	}
+
+	__m128i finish(__m128i src, __m128i dst, __m128i added) const {
+		return _mm_adds_epu8(dst, _mm_andnot_si128(alphaMask(), added));
+	}
+};
+
+struct SubtractiveBlend {
+	explicit SubtractiveBlend(uint32 color) {}
+
+	__m128i blend(__m128i s, __m128i d) const {
+		return _mm_mulhi_epu16(_mm_mullo_epi16(s, d), alpha16(s));
+	}
+
+	__m128i finish(__m128i src, __m128i dst, __m128i subtracted) const {
+		return _mm_subs_epu8(dst, _mm_andnot_si128(alphaMask(), subtracted));
+	}
+};
+
+struct SubtractiveBlendColor {
+	__m128i factors;
+
+	explicit SubtractiveBlendColor(uint32 color) {
+		factors = colorFactors(color, true);
+	}
+
+	__m128i blend(__m128i s, __m128i d) const {
+		// The product of the four bytes is shifted by 24, or by 16 when the
+		// channel is not modulated
+		const __m128i product = _mm_mulhi_epu16(_mm_mullo_epi16(s, d), _mm_mullo_epi16(alpha16(s), factors));
+		return _mm_srli_epi16(product, 8);
+	}
+
+	__m128i finish(__m128i src, __m128i dst, __m128i subtracted) const {
+		return _mm_or_si128(_mm_subs_epu8(dst, _mm_andnot_si128(alphaMask(), subtracted)), alphaMask());
+	}
+};
+
+struct MultiplyBlend {
+	explicit MultiplyBlend(uint32 color) {}
+
+	__m128i blend(__m128i s, __m128i d) const {
+		const __m128i c = _mm_srli_epi16(_mm_mullo_epi16(s, alpha16(s)), 8);
+		return _mm_srli_epi16(_mm_mullo_epi16(c, d), 8);
+	}
+
+	__m128i finish(__m128i src, __m128i dst, __m128i multiplied) const {
+		return select(_mm_or_si128(transparent(src), alphaMask()), dst, multiplied);
+	}
+};
+
+struct MultiplyBlendColor {
+	__m128i ca, factors;
+
+	explicit MultiplyBlendColor(uint32 color) {
+		ca = _mm_set1_epi16(color >> 24);
+		factors = colorFactors(color, true);
+	}
+
+	__m128i blend(__m128i s, __m128i d) const {
+		const __m128i c = _mm_mulhi_epu16(_mm_mullo_epi16(s, modulatedAlpha(s, ca)), factors);
+		return _mm_srli_epi16(_mm_mullo_epi16(c, d), 8);
+	}
+
+	__m128i finish(__m128i src, __m128i dst, __m128i multiplied) const {
+		return select(alphaMask(), dst, multiplied);
+	}
+};
+
+template<class Blender, bool kFlipped>
+void blendRows(const Blender &blender, BlendBlitProc scalar, byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inoStep, uint32 color) {
+	const __m128i zero = _mm_setzero_si128();
+	const uint32 vectorWidth = width & ~3;
+	const int32 inStep = kFlipped ? -4 : 4;
+
+	for (uint32 i = 0; i < height; i++) {
+		byte *in = ino;
+		byte *out = outo;
+		for (uint32 j = 0; j < vectorWidth; j += 4) {
+			__m128i src;
+			if (kFlipped)
+				src = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)(in - 12)), _MM_SHUFFLE(0, 1, 2, 3));
+			else
+				src = _mm_loadu_si128((const __m128i *)in);
+			const __m128i dst = _mm_loadu_si128((const __m128i *)out);
+
+			const __m128i lo = blender.blend(_mm_unpacklo_epi8(src, zero), _mm_unpacklo_epi8(dst, zero));
+			const __m128i hi = blender.blend(_mm_unpackhi_epi8(src, zero), _mm_unpackhi_epi8(dst, zero));
+			_mm_storeu_si128((__m128i *)out, blender.finish(src, dst, _mm_packus_epi16(lo, hi)));
+
+			in += 4 * inStep;
+			out += 16;
+		}
+		if (vectorWidth < width)
+			scalar(in, out, width - vectorWidth, 1, pitch, inStep, inoStep, color);
+
+		outo += pitch;
+		ino += inoStep;
+	}
+}
+
+template<class Blender, class ColorBlender>
+void blend(BlendBlitProc scalar, byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	if (inStep != 4 && inStep != -4) {
+		scalar(ino, outo, width, height, pitch, inStep, inoStep, color);
+	} else if (color == 0xFFFFFFFF) {
+		if (inStep < 0)
+			blendRows<Blender, true>(Blender(color), scalar, ino, outo, width, height, pitch, inoStep, color);
+		else
+			blendRows<Blender, false>(Blender(color), scalar, ino, outo, width, height, pitch, inoStep, color);
+	} else {
+		if (inStep < 0)
+			blendRows<ColorBlender, true>(ColorBlender(color), scalar, ino, outo, width, height, pitch, inoStep, color);
+		else
+			blendRows<ColorBlender, false>(ColorBlender(color), scalar, ino, outo, width, height, pitch, inoStep, color);
+	}
+}
+
+void doBlitAlphaBlendSSE2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	blend<AlphaBlend, AlphaBlendColor>(doBlitAlphaBlend, ino, outo, width, height, pitch, inStep, inoStep, color);
+}
+
+void doBlitAdditiveBlendSSE2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	blend<AdditiveBlend, AdditiveBlendColor>(doBlitAdditiveBlend, ino, outo, width, height, pitch, inStep, inoStep, color);
+}
+
+void doBlitSubtractiveBlendSSE2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	blend<SubtractiveBlend, SubtractiveBlendColor>(doBlitSubtractiveBlend, ino, outo, width, height, pitch, inStep, inoStep, color);
+}
+
+void doBlitMultiplyBlendSSE2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	blend<MultiplyBlend, MultiplyBlendColor>(doBlitMultiplyBlend, ino, outo, width, height, pitch, inStep, inoStep, color);
+}
+
+} // End of anonymous namespace
+
+const BlendBlitters blendBlittersSSE2 = {
+	doBlitAlphaBlendSSE2,
+	doBlitAdditiveBlendSSE2,
+	doBlitSubtractiveBlendSSE2,
+	doBlitMultiplyBlendSSE2
+};
+
+} // End of namespace Graphics
@@ -23,6 +23,8 @@
 // NB: This is really only necessary if USE_READLINE is defined
 #define FORBIDDEN_SYMBOL_ALLOW_ALL
 
+#include "common/arena.h"
+#include "common/archive.h"
 #include "common/file.h"
 #include "common/debug.h"
 #include "common/debug-channels.h"
@@ -30,7 +32,6 @@
 
 #ifndef DISABLE_MD5
 #include "common/md5.h"
-#include "common/archive.h"
 #include "common/macresman.h"
 #include "common/stream.h"
 #endif
@@ -74,6 +75,8 @@ Debugger::Debugger() {
 	registerCmd("md5mac",			WRAP_METHOD(Debugger, cmdMd5Mac));
 #endif
 	registerCmd("exec",				WRAP_METHOD(Debugger, cmdExecFile));
+	registerCmd("arenas",			WRAP_METHOD(Debugger, cmdArenas));
+	registerCmd("searchstats",		WRAP_METHOD(Debugger, cmdSearchStats));
 
 	registerCmd("debuglevel",		WRAP_METHOD(Debugger, cmdDebugLevel));
 	registerCmd("debugflag_list",		WRAP_METHOD(Debugger, cmdDebugFlagsList));
@@ -713,6 +716,35 @@ bool Debugger::cmdMd5Mac(int argc, const char **argv) {
 }
 #endif
 
+bool Debugger::cmdArenas(int argc, const char **argv) {
+	Common::String stats = Common::Arena::printAllStats();
+	if (stats.empty())
+		debugPrintf("No arenas in use\n");
+	else
+		debugPrintf("%s", stats.c_str());
+	return true;
+}
+
+bool Debugger::cmdSearchStats(int argc, const char **argv) {
+	if (argc == 2 && !strcmp(argv[1], "reset")) {
+		SearchMan.resetLookupStats();
+		return true;
+	} else if (argc != 1) {
+		debugPrintf("Usage: %s [reset]\n", argv[0]);
+		return true;
+	}
+
+	Common::Array<Common::SearchSet::ArchiveStats> stats;
+	SearchMan.getLookupStats(stats);
+
+	debugPrintf("   lookups       hits     misses  archive\n");
+	for (uint i = 0; i < stats.size(); i++) {
+		debugPrintf("%10u %10u %10u  %s\n", stats[i].lookups, stats[i].hits,
+		            stats[i].lookups - stats[i].hits, stats[i].name.c_str());
+	}
+	return true;
+}
+
 bool Debugger::cmdDebugLevel(int argc, const char **argv) {
 	if (argc == 1) { // print level
 		debugPrintf("Debugging is currently %s (set at level %d)\n", (gDebugLevel >= 0) ? "enabled" : "disabled", gDebugLevel);
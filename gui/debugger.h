@@ -238,6 +238,8 @@ protected:
 	bool cmdMd5(int argc, const char **argv);
 	bool cmdMd5Mac(int argc, const char **argv);
 #endif
+	bool cmdArenas(int argc, const char **argv);
+	bool cmdSearchStats(int argc, const char **argv);
 	bool cmdDebugLevel(int argc, const char **argv);
 	bool cmdDebugFlagsList(int argc, const char **argv);
 	bool cmdDebugFlagEnable(int argc, const char **argv);
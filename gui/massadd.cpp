@@ -45,7 +45,13 @@ enum {
 	// Upper bound (im milliseconds) we want to spend in handleTickle.
 	// Setting this low makes the GUI more responsive but also slows
 	// down the scanning.
-	kMaxScanTime = 50
+	kMaxScanTime = 50,
+
+	// The maximum number of directories scanned at once by the threads.
+	// Each engine scans all directories of a batch one after another on
+	// one thread, so this is also the granularity of the scan time, and
+	// the longest time closing the dialog waits for the scan to stop.
+	kMaxScanBatchSize = 16
 };
 
 enum {
@@ -57,6 +63,11 @@ enum {
 
 MassAddDialog::MassAddDialog(const Common::FSNode &startDir)
 	: Dialog("MassAdd"),
+	_threadPool(ConfMan.getInt("detection_threads")),
+	_scanThread(0),
+	_stopScan(false),
+	_scanFinished(false),
+	_detecting(false),
 	_dirsScanned(0),
 	_oldGamesCount(0),
 	_dirTotal(0),
@@ -116,6 +127,44 @@ MassAddDialog::MassAddDialog(const Common::FSNode &startDir)
 	}
 }
 
+MassAddDialog::~MassAddDialog() {
+	stopScan();
+}
+
+void MassAddDialog::open() {
+	Dialog::open();
+
+	// Detect the games on a thread of its own, so that the GUI only has to
+	// merge the results. Without threads, handleTickle() scans the
+	// directories itself, a few at a time.
+	if (!_detecting) {
+		EngineMan.beginDetection(_threadPool);
+		_detecting = true;
+		_scanThread = g_system->createThread(scanThread, this);
+	}
+}
+
+void MassAddDialog::close() {
+	stopScan();
+	Dialog::close();
+}
+
+void MassAddDialog::stopScan() {
+	if (_scanThread) {
+		{
+			Common::StackLock lock(_scanMutex);
+			_stopScan = true;
+		}
+		g_system->joinThread(_scanThread);
+		_scanThread = 0;
+	}
+
+	if (_detecting) {
+		EngineMan.endDetection();
+		_detecting = false;
+	}
+}
+
 struct GameTargetLess {
 	bool operator()(const DetectedGame &x, const DetectedGame &y) const {
 		return x.preferredTarget.compareToIgnoreCase(y.preferredTarget) < 0;
@@ -168,98 +217,172 @@ void MassAddDialog::handleCommand(CommandSender *sender, uint32 cmd, uint32 data
 	}
 }
 
-void MassAddDialog::handleTickle() {
-	if (_scanStack.empty())
-		return;	// We have finished scanning
+struct ListDirectoriesJob {
+	const Common::Array<Common::FSNode> *dirs;
+	Common::Array<Common::FSList> *files;
+	Common::Array<bool> *listed;
+};
 
-	uint32 t = g_system->getMillis();
+static void listDirectory(void *arg, uint index) {
+	ListDirectoriesJob *job = (ListDirectoriesJob *)arg;
+	(*job->listed)[index] = (*job->dirs)[index].getChildren((*job->files)[index], Common::FSNode::kListAll);
+}
 
-	// Perform a breadth-first scan of the filesystem.
-	while (!_scanStack.empty() && (g_system->getMillis() - t) < kMaxScanTime) {
-		Common::FSNode dir = _scanStack.pop();
+void MassAddDialog::scanThread(void *arg) {
+	MassAddDialog *dialog = (MassAddDialog *)arg;
 
-		Common::FSList files;
-		if (!dir.getChildren(files, Common::FSNode::kListAll)) {
-			continue;
+	for (;;) {
+		{
+			Common::StackLock lock(dialog->_scanMutex);
+			if (dialog->_stopScan)
+				break;
 		}
+		if (dialog->_scanStack.empty())
+			break;
 
-		// Run the detector on the dir
-		DetectionResults detectionResults = EngineMan.detectGames(files);
+		dialog->scanDirectories();
+	}
 
-		if (detectionResults.foundUnknownGames()) {
-			Common::U32String report = detectionResults.generateUnknownGameReport(false, 80);
-			g_system->logMessage(LogMessageType::kInfo, report.encode().c_str());
-		}
+	Common::StackLock lock(dialog->_scanMutex);
+	dialog->_scanFinished = true;
+}
 
-		// Just add all detected games / game variants. If we get more than one,
-		// that either means the directory contains multiple games, or the detector
-		// could not fully determine which game variant it was seeing. In either
-		// case, let the user choose which entries he wants to keep.
-		//
-		// However, we only add games which are not already in the config file.
-		DetectedGames candidates = detectionResults.listRecognizedGames();
-		for (DetectedGames::const_iterator cand = candidates.begin(); cand != candidates.end(); ++cand) {
-			const DetectedGame &result = *cand;
-
-			Common::String path = dir.getPath();
-
-			// Remove trailing slashes
-			while (path != "/" && path.lastChar() == '/')
-				path.deleteLastChar();
-
-			// Check for existing config entries for this path/engineid/gameid/lang/platform combination
-			if (_pathToTargets.contains(path)) {
-				Common::String resultPlatformCode = Common::getPlatformCode(result.platform);
-				Common::String resultLanguageCode = Common::getLanguageCode(result.language);
-
-				bool duplicate = false;
-				const StringArray &targets = _pathToTargets[path];
-				for (StringArray::const_iterator iter = targets.begin(); iter != targets.end(); ++iter) {
-					// If the engineid, gameid, platform and language match -> skip it
-					Common::ConfigManager::Domain *dom = ConfMan.getDomain(*iter);
-					assert(dom);
-
-					if ((*dom)["engineid"] == result.engineId &&
-						(*dom)["gameid"] == result.gameId &&
-					    (*dom)["platform"] == resultPlatformCode &&
-					    (*dom)["language"] == resultLanguageCode) {
-						duplicate = true;
-						break;
-					}
-				}
-				if (duplicate) {
-					_oldGamesCount++;
-					continue;	// Skip duplicates
-				}
-			}
-			_games.push_back(result);
+void MassAddDialog::scanDirectories() {
+	// Take a batch of directories from the stack. Listing and scanning them
+	// is done on the threads of the pool, the results are then merged by
+	// handleTickle() on the GUI thread.
+	Common::Array<Common::FSNode> dirs;
+	while (!_scanStack.empty() && dirs.size() < kMaxScanBatchSize)
+		dirs.push_back(_scanStack.pop());
+
+	Common::Array<Common::FSList> files;
+	Common::Array<bool> listed;
+	files.resize(dirs.size());
+	listed.resize(dirs.size());
+
+	ListDirectoriesJob job = { &dirs, &files, &listed };
+	_threadPool.run(listDirectory, &job, dirs.size());
+
+	// Directories which could not be listed are skipped
+	for (uint i = 0; i < dirs.size(); i++) {
+		if (!listed[i])
+			files[i].clear();
+	}
 
-			_list->append(result.description);
-		}
+	Common::Array<DetectionResults> detectionResults = EngineMan.detectGamesOnPool(files, _threadPool);
 
+	for (uint i = 0; i < dirs.size(); i++) {
+		if (!listed[i])
+			continue;
 
 		// Recurse into all subdirs
-		for (Common::FSList::const_iterator file = files.begin(); file != files.end(); ++file) {
+		int subdirs = 0;
+		for (Common::FSList::const_iterator file = files[i].begin(); file != files[i].end(); ++file) {
 			if (file->isDirectory()) {
 				_scanStack.push(*file);
 
-				_dirTotal++;
+				subdirs++;
 			}
 		}
 
+		Common::StackLock lock(_scanMutex);
+		_scannedDirs.push_back(ScannedDirectory(dirs[i], detectionResults[i], subdirs));
+	}
+}
+
+void MassAddDialog::addDetectedGames(const Common::FSNode &dir, const DetectionResults &detectionResults) {
+	if (detectionResults.foundUnknownGames()) {
+		Common::U32String report = detectionResults.generateUnknownGameReport(false, 80);
+		g_system->logMessage(LogMessageType::kInfo, report.encode().c_str());
+	}
+
+	// Just add all detected games / game variants. If we get more than one,
+	// that either means the directory contains multiple games, or the detector
+	// could not fully determine which game variant it was seeing. In either
+	// case, let the user choose which entries he wants to keep.
+	//
+	// However, we only add games which are not already in the config file.
+	DetectedGames candidates = detectionResults.listRecognizedGames();
+	for (DetectedGames::const_iterator cand = candidates.begin(); cand != candidates.end(); ++cand) {
+		const DetectedGame &result = *cand;
+
+		Common::String path = dir.getPath();
+
+		// Remove trailing slashes
+		while (path != "/" && path.lastChar() == '/')
+			path.deleteLastChar();
+
+		// Check for existing config entries for this path/engineid/gameid/lang/platform combination
+		if (_pathToTargets.contains(path)) {
+			Common::String resultPlatformCode = Common::getPlatformCode(result.platform);
+			Common::String resultLanguageCode = Common::getLanguageCode(result.language);
+
+			bool duplicate = false;
+			const StringArray &targets = _pathToTargets[path];
+			for (StringArray::const_iterator iter = targets.begin(); iter != targets.end(); ++iter) {
+				// If the engineid, gameid, platform and language match -> skip it
+				Common::ConfigManager::Domain *dom = ConfMan.getDomain(*iter);
+				assert(dom);
+
+				if ((*dom)["engineid"] == result.engineId &&
+					(*dom)["gameid"] == result.gameId &&
+				    (*dom)["platform"] == resultPlatformCode &&
+				    (*dom)["language"] == resultLanguageCode) {
+					duplicate = true;
+					break;
+				}
+			}
+			if (duplicate) {
+				_oldGamesCount++;
+				continue;	// Skip duplicates
+			}
+		}
+		_games.push_back(result);
+
+		_list->append(result.description);
+	}
+}
+
+void MassAddDialog::handleTickle() {
+	if (!_detecting)
+		return;	// We have finished scanning
+
+	if (!_scanThread) {
+		uint32 t = g_system->getMillis();
+
+		// Perform a breadth-first scan of the filesystem.
+		while (!_scanStack.empty() && (g_system->getMillis() - t) < kMaxScanTime)
+			scanDirectories();
+	}
+
+	// Merge the directories scanned so far
+	Common::Array<ScannedDirectory> scannedDirs;
+	bool finished;
+	{
+		Common::StackLock lock(_scanMutex);
+		scannedDirs = _scannedDirs;
+		_scannedDirs.clear();
+		finished = _scanThread ? _scanFinished : _scanStack.empty();
+	}
+
+	for (uint i = 0; i < scannedDirs.size(); i++) {
+		addDetectedGames(scannedDirs[i].dir, scannedDirs[i].detectionResults);
+		_dirTotal += scannedDirs[i].subdirs;
 		_dirsScanned++;
+	}
+
+	if (finished)
+		stopScan();
 
 #if defined(USE_TASKBAR)
-		g_system->getTaskbarManager()->setProgressValue(_dirsScanned, _dirTotal);
-		g_system->getTaskbarManager()->setCount(_games.size());
+	g_system->getTaskbarManager()->setProgressValue(_dirsScanned, _dirTotal);
+	g_system->getTaskbarManager()->setCount(_games.size());
 #endif
-	}
-
 
 	// Update the dialog
 	Common::U32String buf;
 
-	if (_scanStack.empty()) {
+	if (finished) {
 		// Enable the OK button
 		_okButton->setEnabled(true);
 
@@ -23,12 +23,16 @@
 #ifndef MASSADD_DIALOG_H
 #define MASSADD_DIALOG_H
 
+#include "engines/game.h"
 #include "gui/dialog.h"
 #include "gui/widgets/list.h"
 #include "common/fs.h"
 #include "common/hashmap.h"
+#include "common/mutex.h"
 #include "common/stack.h"
 #include "common/str.h"
+#include "common/system.h"
+#include "common/threadpool.h"
 
 namespace GUI {
 
@@ -39,8 +43,10 @@ class MassAddDialog : public Dialog {
 	typedef Common::Array<Common::U32String> U32StringArray;
 public:
 	MassAddDialog(const Common::FSNode &startDir);
+	~MassAddDialog() override;
 
-	//void open();
+	void open() override;
+	void close() override;
 	void handleCommand(CommandSender *sender, uint32 cmd, uint32 data) override;
 	void handleTickle() override;
 
@@ -51,9 +57,46 @@ public:
 	}
 
 private:
+	/** A directory scanned by scanDirectories(), waiting to be merged. */
+	struct ScannedDirectory {
+		Common::FSNode dir;
+		DetectionResults detectionResults;
+		int subdirs;
+
+		ScannedDirectory(const Common::FSNode &d, const DetectionResults &results, int s) :
+			dir(d), detectionResults(results), subdirs(s) {}
+	};
+
+	static void scanThread(void *arg);
+	void scanDirectories();
+	void stopScan();
+	void addDetectedGames(const Common::FSNode &dir, const DetectionResults &detectionResults);
+
+	/**
+	 * The directories left to scan. While the scan thread is running,
+	 * only that thread uses this.
+	 */
 	Common::Stack<Common::FSNode>  _scanStack;
 	DetectedGames _games;
 
+	/** The threads listing and scanning the directories. */
+	Common::ThreadPool _threadPool;
+
+	/**
+	 * The thread taking batches of directories from the stack and scanning
+	 * them on the pool, or 0 when the batches are scanned in handleTickle().
+	 */
+	OSystem::ThreadRef _scanThread;
+
+	/** Guards _scannedDirs, _stopScan and _scanFinished. */
+	Common::Mutex _scanMutex;
+	Common::Array<ScannedDirectory> _scannedDirs;
+	bool _stopScan;
+	bool _scanFinished;
+
+	/** Whether detection was started with EngineManager::beginDetection(). */
+	bool _detecting;
+
 	/**
 	 * Map each path occuring in the config file to the target(s) using that path.
 	 * Used to detect whether a potential new target is already present in the
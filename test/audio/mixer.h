@@ -0,0 +1,208 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/audiostream.h"
+#include "audio/mixer_intern.h"
+
+#include "common/system.h"
+
+#ifdef POSIX
+#include <pthread.h>
+#endif
+
+class ConstantAudioStream : public Audio::AudioStream {
+public:
+	ConstantAudioStream(int16 value, bool finished = false) : _value(value), _finished(finished) {}
+
+	virtual int readBuffer(int16 *buffer, const int numSamples) {
+		for (int i = 0; i < numSamples; ++i)
+			buffer[i] = _value;
+		return numSamples;
+	}
+
+	virtual bool isStereo() const { return false; }
+	virtual int getRate() const { return 44100; }
+	virtual bool endOfData() const { return _finished; }
+
+	void finish() { _finished = true; }
+
+private:
+	int16 _value;
+	bool _finished;
+};
+
+class MixerTestSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kSampleRate = 44100,
+		kThreads = 4,
+		kIterations = 20000
+	};
+
+	struct ThreadState {
+		Audio::MixerImpl *mixer;
+		Audio::SoundHandle handle;
+		int id;
+		volatile uint32 *done;
+		int errors;
+	};
+
+	static Audio::MixerImpl *createMixer() {
+		Common::install_null_g_system();
+
+		Audio::MixerImpl *mixer = new Audio::MixerImpl(kSampleRate);
+		mixer->setReady(true);
+		return mixer;
+	}
+
+	static Audio::SoundHandle play(Audio::Mixer *mixer, Audio::Mixer::SoundType type, Audio::AudioStream *stream,
+	                               int id = -1, byte volume = Audio::Mixer::kMaxChannelVolume, int8 balance = 0) {
+		Audio::SoundHandle handle;
+		mixer->playStream(type, &handle, stream, id, volume, balance);
+		return handle;
+	}
+
+	static int16 mixOneSample(Audio::MixerImpl *mixer) {
+		int16 buf[2 * 16];
+		mixer->mixCallback((byte *)buf, sizeof(buf));
+		return buf[2 * 15];
+	}
+
+#ifdef POSIX
+	static void *hammer(void *arg) {
+		ThreadState *state = (ThreadState *)arg;
+		Audio::MixerImpl *mixer = state->mixer;
+
+		for (int i = 0; i < kIterations; ++i) {
+			// Only this thread changes the volume of its own channel, so it
+			// must always read back what it has set
+			const byte volume = (byte)(i * 7);
+			mixer->setChannelVolume(state->handle, volume);
+			if (mixer->getChannelVolume(state->handle) != volume)
+				state->errors++;
+
+			mixer->setChannelBalance(state->handle, (int8)(i % 127));
+			if (mixer->getChannelBalance(state->handle) != (int8)(i % 127))
+				state->errors++;
+
+			if (!mixer->isSoundHandleActive(state->handle))
+				state->errors++;
+			if (mixer->getSoundID(state->handle) != state->id)
+				state->errors++;
+
+			// The other channels come and go, just make sure querying them
+			// is safe
+			mixer->isSoundIDActive(i % 8);
+			mixer->hasActiveChannelOfType(Audio::Mixer::kSFXSoundType);
+			mixer->getElapsedTime(state->handle);
+		}
+
+		Common::atomicAdd(state->done, 1);
+		return 0;
+	}
+#endif
+
+public:
+	void test_handle_lifetime() {
+		Audio::MixerImpl *mixer = createMixer();
+
+		TS_ASSERT(!mixer->isSoundHandleActive(Audio::SoundHandle()));
+
+		Audio::SoundHandle handle = play(mixer, Audio::Mixer::kSFXSoundType, new ConstantAudioStream(1000), 42, 128, -64);
+
+		TS_ASSERT(mixer->isSoundHandleActive(handle));
+		TS_ASSERT(mixer->isSoundIDActive(42));
+		TS_ASSERT(!mixer->isSoundIDActive(43));
+		TS_ASSERT(mixer->hasActiveChannelOfType(Audio::Mixer::kSFXSoundType));
+		TS_ASSERT(!mixer->hasActiveChannelOfType(Audio::Mixer::kMusicSoundType));
+		TS_ASSERT_EQUALS(mixer->getSoundID(handle), 42);
+		TS_ASSERT_EQUALS(mixer->getChannelVolume(handle), 128);
+		TS_ASSERT_EQUALS(mixer->getChannelBalance(handle), -64);
+
+		mixer->stopHandle(handle);
+		TS_ASSERT(!mixer->isSoundHandleActive(handle));
+		TS_ASSERT(!mixer->isSoundIDActive(42));
+		TS_ASSERT_EQUALS(mixer->getChannelVolume(handle), 0);
+
+		// Changing a stopped channel must not affect the next one in its slot
+		Audio::SoundHandle handle2 = play(mixer, Audio::Mixer::kSFXSoundType, new ConstantAudioStream(1000), -1, 100);
+		mixer->setChannelVolume(handle, 10);
+		TS_ASSERT_EQUALS(mixer->getChannelVolume(handle2), 100);
+
+		// Channels are deleted by the mixer once their stream has ended
+		ConstantAudioStream *stream3 = new ConstantAudioStream(1000);
+		Audio::SoundHandle handle3 = play(mixer, Audio::Mixer::kSFXSoundType, stream3);
+		stream3->finish();
+		mixOneSample(mixer);
+		TS_ASSERT(!mixer->isSoundHandleActive(handle3));
+		TS_ASSERT(mixer->isSoundHandleActive(handle2));
+
+		delete mixer;
+	}
+
+	void test_queued_commands() {
+		Audio::MixerImpl *mixer = createMixer();
+
+		Audio::SoundHandle handle = play(mixer, Audio::Mixer::kPlainSoundType, new ConstantAudioStream(1000));
+		TS_ASSERT_EQUALS(mixOneSample(mixer), 1000);
+
+		// Overflow the command queue, so that it has to be drained early
+		for (int i = 0; i < 1000; ++i)
+			mixer->setChannelVolume(handle, (byte)i);
+		mixer->setChannelVolume(handle, 128);
+		TS_ASSERT_EQUALS(mixer->getChannelVolume(handle), 128);
+
+		// 1000 * (256 * 128 / 255) / 256
+		TS_ASSERT_EQUALS(mixOneSample(mixer), 500);
+
+		delete mixer;
+	}
+
+	void test_concurrent_access() {
+#ifdef POSIX
+		Audio::MixerImpl *mixer = createMixer();
+
+		volatile uint32 done = 0;
+		ThreadState states[kThreads];
+		pthread_t threads[kThreads];
+
+		for (int i = 0; i < kThreads; ++i) {
+			states[i].mixer = mixer;
+			states[i].done = &done;
+			states[i].errors = 0;
+			states[i].id = 1000 + i;
+			states[i].handle = play(mixer, Audio::Mixer::kMusicSoundType, new ConstantAudioStream(100), states[i].id);
+		}
+
+		for (int i = 0; i < kThreads; ++i)
+			pthread_create(&threads[i], 0, hammer, &states[i]);
+
+		// Keep mixing, while starting and stopping other channels
+		Audio::SoundHandle handles[8];
+		uint32 round = 0;
+		while (Common::atomicLoad(&done) != kThreads) {
+			Audio::SoundHandle &handle = handles[round % 8];
+			if (round & 8) {
+				mixer->stopHandle(handle);
+			} else {
+				// Some channels end on their own during the next mix
+				handle = play(mixer, Audio::Mixer::kSFXSoundType, new ConstantAudioStream(100, round & 1), round % 8);
+			}
+
+			mixOneSample(mixer);
+			round++;
+		}
+
+		for (int i = 0; i < kThreads; ++i) {
+			pthread_join(threads[i], 0);
+			TS_ASSERT_EQUALS(states[i].errors, 0);
+		}
+
+		mixer->stopAll();
+		for (int i = 0; i < kThreads; ++i)
+			TS_ASSERT(!mixer->isSoundHandleActive(states[i].handle));
+
+		delete mixer;
+#endif
+	}
+};
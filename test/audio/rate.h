@@ -0,0 +1,286 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/audiostream.h"
+#include "audio/mixer.h"
+#include "audio/rate.h"
+#include "audio/decoders/raw.h"
+
+#include "common/system.h"
+
+class RateTestSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kMaxPairs = 67
+	};
+
+	uint32 _seed;
+
+	int16 randomSample() {
+		_seed = _seed * 1103515245 + 12345;
+		// Favor the extremes, so clamping is exercised as well
+		switch ((_seed >> 28) & 3) {
+		case 0:
+			return 32767;
+		case 1:
+			return -32768;
+		default:
+			return (int16)(_seed >> 8);
+		}
+	}
+
+	void mixTestTemplate(Audio::MixProc proc, bool stereo, bool reverseStereo) {
+		_seed = 1;
+
+		int16 in[kMaxPairs * 2];
+		int16 expected[kMaxPairs * 2];
+		int16 out[kMaxPairs * 2];
+
+		const Audio::st_volume_t volumes[] = { 0, 1, 127, 255, Audio::Mixer::kMaxMixerVolume };
+
+		for (int len = 0; len <= kMaxPairs; ++len) {
+			for (int l = 0; l < ARRAYSIZE(volumes); ++l) {
+				const Audio::st_volume_t volL = volumes[l];
+				const Audio::st_volume_t volR = volumes[ARRAYSIZE(volumes) - 1 - l];
+
+				for (int i = 0; i < kMaxPairs * 2; ++i) {
+					in[i] = randomSample();
+					expected[i] = out[i] = randomSample();
+				}
+
+				Audio::mixSamplesScalar(expected, in, len, volL, volR, stereo, reverseStereo);
+				proc(out, in, len, volL, volR, stereo, reverseStereo);
+
+				TS_ASSERT_EQUALS(memcmp(expected, out, sizeof(out)), 0);
+			}
+		}
+	}
+
+	void accumulateTestTemplate(Audio::AccumulateProc proc, bool stereo, bool reverseStereo) {
+		_seed = 1;
+
+		int16 in[kMaxPairs * 2];
+		int32 expected[kMaxPairs * 2];
+		int32 out[kMaxPairs * 2];
+
+		for (int len = 0; len <= kMaxPairs; ++len) {
+			const Audio::st_volume_t volL = len % (Audio::Mixer::kMaxMixerVolume + 1);
+			const Audio::st_volume_t volR = Audio::Mixer::kMaxMixerVolume - volL;
+
+			for (int i = 0; i < kMaxPairs * 2; ++i) {
+				in[i] = randomSample();
+				expected[i] = out[i] = randomSample() * 1000;
+			}
+
+			Audio::accumulateSamplesScalar(expected, in, len, volL, volR, stereo, reverseStereo);
+			proc(out, in, len, volL, volR, stereo, reverseStereo);
+
+			TS_ASSERT_EQUALS(memcmp(expected, out, sizeof(out)), 0);
+		}
+	}
+
+	void accumulateTest(Audio::AccumulateProc proc) {
+		accumulateTestTemplate(proc, false, false);
+		accumulateTestTemplate(proc, false, true);
+		accumulateTestTemplate(proc, true, false);
+		accumulateTestTemplate(proc, true, true);
+	}
+
+	void mixTest(Audio::MixProc proc) {
+		mixTestTemplate(proc, false, false);
+		mixTestTemplate(proc, false, true);
+		mixTestTemplate(proc, true, false);
+		mixTestTemplate(proc, true, true);
+	}
+
+	void firTest(Audio::FIRProc proc) {
+		_seed = 1;
+
+		int16 samples[64];
+		int16 coeffs[64];
+		for (int i = 0; i < ARRAYSIZE(samples); ++i) {
+			samples[i] = randomSample();
+			// Keep the coefficients in the range the converter produces
+			coeffs[i] = randomSample() >> (16 - Audio::kFIRCoeffBits);
+		}
+
+		for (uint taps = 8; taps <= ARRAYSIZE(samples); taps += 8)
+			TS_ASSERT_EQUALS(proc(samples, coeffs, taps), Audio::firDotProductScalar(samples, coeffs, taps));
+	}
+
+	Audio::AudioStream *makeConstantStream(int frames, int16 value, int rate, bool stereo) {
+		int16 *data = (int16 *)malloc(frames * (stereo ? 4 : 2));
+		for (int i = 0; i < frames * (stereo ? 2 : 1); ++i)
+			data[i] = value;
+
+		return Audio::makeRawStream((const byte *)data, frames * (stereo ? 4 : 2), rate,
+		                            Audio::FLAG_16BITS | (stereo ? Audio::FLAG_STEREO : 0)
+#ifdef SCUMM_LITTLE_ENDIAN
+		                            | Audio::FLAG_LITTLE_ENDIAN
+#endif
+		                            , DisposeAfterUse::YES);
+	}
+
+	void firConstantTemplate(int inRate, int outRate, bool stereo) {
+		const int frames = 4096;
+		const int16 value = 12345;
+
+		Audio::AudioStream *input = makeConstantStream(frames, value, inRate, stereo);
+		Audio::RateConverter *converter = Audio::makeRateConverter(inRate, outRate, stereo, false, Audio::kRateConverterFIR);
+
+		const int outFrames = 1024;
+		int16 out[outFrames * 2];
+		memset(out, 0, sizeof(out));
+		TS_ASSERT_EQUALS(converter->flow(*input, out, outFrames, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume), outFrames);
+
+		// The filter has unity gain, so once the initial silence has left
+		// the filter window, the output has to match the input exactly
+		for (int i = 256; i < outFrames * 2; ++i)
+			TS_ASSERT_EQUALS(out[i], value);
+
+		delete converter;
+		delete input;
+	}
+
+	void firTailTemplate(int inRate, int outRate, bool stereo) {
+		const int frames = 1000;
+		const int16 value = 12345;
+
+		Audio::AudioStream *input = makeConstantStream(frames, value, inRate, stereo);
+		Audio::RateConverter *converter = Audio::makeRateConverter(inRate, outRate, stereo, false, Audio::kRateConverterFIR);
+
+		// Every output frame before the end of the input is produced, even
+		// though the filter window reaches past the last input frame
+		const int expectedFrames = (frames * outRate + inRate - 1) / inRate;
+		int16 out[5000 * 2];
+		memset(out, 0, sizeof(out));
+		TS_ASSERT_EQUALS(converter->flow(*input, out, 5000, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume), expectedFrames);
+
+		// The last frames are filtered with the silence after the input, but
+		// still close to the end of it
+		TS_ASSERT_LESS_THAN(0, out[(expectedFrames - 1) * 2]);
+		TS_ASSERT_EQUALS(out[expectedFrames * 2], 0);
+		TS_ASSERT_EQUALS(out[expectedFrames / 2 * 2], value);
+
+		delete converter;
+		delete input;
+	}
+
+	/** Return the time the converter takes for one output frame, in nanoseconds. */
+	uint32 benchmarkConverter(Audio::RateConverterType type, int inRate, int outRate, bool stereo) {
+		enum {
+			kInputFrames = 65536,
+			kBlockFrames = 512,
+			kRounds = 8
+		};
+
+		int16 *out = new int16[kBlockFrames * 2];
+		uint32 outFrames = 0;
+		const uint32 start = g_system->getMillis();
+		for (int round = 0; round < kRounds; ++round) {
+			Audio::AudioStream *input = makeConstantStream(kInputFrames, 1000, inRate, stereo);
+			Audio::RateConverter *converter = Audio::makeRateConverter(inRate, outRate, stereo, false, type);
+			int count;
+			do {
+				count = converter->flow(*input, out, kBlockFrames, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume);
+				outFrames += count;
+			} while (count == kBlockFrames);
+			delete converter;
+			delete input;
+		}
+		const uint32 time = MAX<uint32>(g_system->getMillis() - start, 1);
+
+		delete[] out;
+		return (uint32)((uint64)time * 1000000 / outFrames);
+	}
+
+public:
+	void test_mix_scalar_clamps() {
+		int16 in[2] = { 32767, -32768 };
+		int16 out[2] = { 32000, -32000 };
+
+		Audio::mixSamplesScalar(out, in, 1, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume, true, false);
+		TS_ASSERT_EQUALS(out[0], 32767);
+		TS_ASSERT_EQUALS(out[1], -32768);
+	}
+
+	void test_mix_scalar_reverse_stereo() {
+		int16 in[2] = { 1000, -1000 };
+		int16 out[2] = { 0, 0 };
+
+		Audio::mixSamplesScalar(out, in, 1, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume / 2, true, true);
+		TS_ASSERT_EQUALS(out[0], -500);
+		TS_ASSERT_EQUALS(out[1], 1000);
+	}
+
+	void test_mix_default() {
+		mixTest(Audio::getMixProc());
+	}
+
+	void test_mix_sse2() {
+#ifdef SCUMMVM_SSE2
+		mixTest(Audio::mixSamplesSSE2);
+#endif
+	}
+
+	void test_accumulate_scalar_does_not_clamp() {
+		int16 in[2] = { 32767, -32768 };
+		int32 out[2] = { 32000 * 256, -32000 * 256 };
+
+		Audio::accumulateSamplesScalar(out, in, 1, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume / 2, true, false);
+		TS_ASSERT_EQUALS(out[0], (32000 + 32767) * 256);
+		TS_ASSERT_EQUALS(out[1], (-32000 - 16384) * 256);
+	}
+
+	void test_accumulate_default() {
+		accumulateTest(Audio::getAccumulateProc());
+	}
+
+	void test_accumulate_sse2() {
+#ifdef SCUMMVM_SSE2
+		accumulateTest(Audio::accumulateSamplesSSE2);
+#endif
+	}
+
+	void test_fir_default() {
+		firTest(Audio::getFIRProc());
+	}
+
+	void test_fir_sse2() {
+#ifdef SCUMMVM_SSE2
+		firTest(Audio::firDotProductSSE2);
+#endif
+	}
+
+	void test_fir_upsample_constant() {
+		firConstantTemplate(11025, 44100, false);
+		firConstantTemplate(22050, 48000, true);
+	}
+
+	void test_fir_downsample_constant() {
+		firConstantTemplate(44100, 22050, true);
+		firConstantTemplate(48000, 44100, false);
+	}
+
+	void test_fir_tail() {
+		firTailTemplate(22050, 44100, true);
+		firTailTemplate(11025, 48000, false);
+		firTailTemplate(44100, 22050, false);
+	}
+
+	void test_benchmark() {
+		// Not a regression test as such, but shows how much more time the
+		// FIR converter takes per output frame than the linear one
+		Common::install_null_g_system();
+
+		static const int rates[][2] = { { 22050, 44100 }, { 11025, 48000 }, { 48000, 44100 } };
+		for (int i = 0; i < ARRAYSIZE(rates); ++i) {
+			for (int stereo = 0; stereo < 2; ++stereo) {
+				const uint32 linear = benchmarkConverter(Audio::kRateConverterLinear, rates[i][0], rates[i][1], stereo);
+				const uint32 fir = benchmarkConverter(Audio::kRateConverterFIR, rates[i][0], rates[i][1], stereo);
+				TS_TRACE(Common::String::format("Converting %d Hz %s to %d Hz: %u ns per frame linear, %u ns per frame FIR",
+				                                rates[i][0], stereo ? "stereo" : "mono", rates[i][1], linear, fir).c_str());
+			}
+		}
+	}
+};
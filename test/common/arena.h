@@ -0,0 +1,234 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/arena.h"
+#include "common/atomic.h"
+#include "common/threadpool.h"
+
+#include "test/null_osystem.h"
+
+class ArenaTestSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kJobs = 16,
+		kBlocksPerJob = 500
+	};
+
+	struct JobState {
+		Common::SizeClassArena *arena;
+		void *blocks[kJobs][kBlocksPerJob];
+		volatile uint32 errors;
+	};
+
+	static size_t blockSize(uint job, uint block) {
+		return ((job * 131 + block * 17) % 1100) + 1;
+	}
+
+	static void allocateJob(void *arg, uint index) {
+		JobState *state = (JobState *)arg;
+		Common::SizeClassArena::ThreadCache cache(*state->arena);
+
+		for (uint i = 0; i < kBlocksPerJob; i++) {
+			const size_t size = blockSize(index, i);
+			byte *ptr = (byte *)cache.allocate(size);
+			memset(ptr, (byte)(index + i), size);
+			state->blocks[index][i] = ptr;
+
+			// Some short lived blocks in between
+			cache.deallocate(cache.allocate(size), size);
+		}
+	}
+
+	static void freeJob(void *arg, uint index) {
+		JobState *state = (JobState *)arg;
+		Common::SizeClassArena::ThreadCache cache(*state->arena);
+
+		// Free the blocks allocated by another job
+		const uint job = (index + 1) % kJobs;
+		for (uint i = 0; i < kBlocksPerJob; i++) {
+			const size_t size = blockSize(job, i);
+			const byte *ptr = (const byte *)state->blocks[job][i];
+			for (size_t j = 0; j < size; j++) {
+				if (ptr[j] != (byte)(job + i)) {
+					Common::atomicAdd(&state->errors, 1);
+					break;
+				}
+			}
+			cache.deallocate(state->blocks[job][i], size);
+		}
+	}
+
+public:
+	void test_size_classes() {
+		TS_ASSERT_EQUALS(Common::SizeClassArena::getSizeClass(0), 0u);
+		TS_ASSERT_EQUALS(Common::SizeClassArena::getSizeClass(16), 0u);
+		TS_ASSERT_EQUALS(Common::SizeClassArena::getSizeClass(17), 1u);
+		TS_ASSERT_EQUALS(Common::SizeClassArena::getSizeClass(1025), (uint)Common::SizeClassArena::kNumSizeClasses);
+
+		size_t prevSize = 0;
+		for (uint i = 0; i < Common::SizeClassArena::kNumSizeClasses; i++) {
+			const size_t size = Common::SizeClassArena::getBlockSize(i);
+			TS_ASSERT_LESS_THAN(prevSize, size);
+			TS_ASSERT_EQUALS(size % 16, 0u);
+			TS_ASSERT_EQUALS(Common::SizeClassArena::getSizeClass(size), i);
+			TS_ASSERT_EQUALS(Common::SizeClassArena::getSizeClass(prevSize + 1), i);
+			prevSize = size;
+		}
+		TS_ASSERT_EQUALS(prevSize, (size_t)Common::SizeClassArena::kMaxSmallSize);
+	}
+
+	void test_size_class_arena() {
+		Common::install_null_g_system();
+		Common::SizeClassArena arena("test");
+
+		void *small = arena.allocate(20);
+		void *big = arena.allocate(5000);
+		TS_ASSERT(small);
+		TS_ASSERT(big);
+		memset(small, 0, 20);
+		memset(big, 0, 5000);
+
+		Common::SizeClassArena::ClassStats stats = arena.getStats(1);
+		TS_ASSERT_EQUALS(stats.blockSize, 32u);
+		TS_ASSERT_EQUALS(stats.allocations, 1u);
+		TS_ASSERT_EQUALS(stats.bytesInUse, 32u);
+		TS_ASSERT_LESS_THAN_EQUALS(32u, stats.bytesReserved);
+
+		stats = arena.getStats(Common::SizeClassArena::kNumSizeClasses);
+		TS_ASSERT_EQUALS(stats.bytesInUse, 5000u);
+
+		arena.deallocate(small, 20);
+		arena.deallocate(big, 5000);
+		arena.deallocate(nullptr, 20);
+
+		stats = arena.getStats(1);
+		TS_ASSERT_EQUALS(stats.frees, 1u);
+		TS_ASSERT_EQUALS(stats.bytesInUse, 0u);
+		TS_ASSERT_EQUALS(stats.peakBytesInUse, 32u);
+
+		arena.freeUnusedPages();
+		TS_ASSERT_EQUALS(arena.getStats(1).bytesReserved, 0u);
+
+		Common::String out;
+		arena.printStats(out);
+		TS_ASSERT(out.contains("'test'"));
+		TS_ASSERT(Common::Arena::printAllStats().contains("'test'"));
+	}
+
+	void test_placement_new() {
+		Common::install_null_g_system();
+		Common::SizeClassArena arena("objects");
+
+		Common::String *str = new (arena) Common::String("arena");
+		TS_ASSERT_EQUALS(*str, "arena");
+		arena.destroy(str);
+		TS_ASSERT_EQUALS(arena.getStats(Common::SizeClassArena::getSizeClass(sizeof(Common::String))).bytesInUse, 0u);
+	}
+
+	void test_thread_cache() {
+		Common::install_null_g_system();
+		Common::SizeClassArena arena("cache");
+
+		{
+			Common::SizeClassArena::ThreadCache cache(arena);
+			void *blocks[1000];
+			for (int i = 0; i < 1000; i++)
+				blocks[i] = cache.allocate(48);
+			for (int i = 0; i < 1000; i++)
+				TS_ASSERT_DIFFERS(blocks[i], blocks[(i + 1) % 1000]);
+
+			// The cache fetches blocks in batches
+			TS_ASSERT_LESS_THAN(arena.getStats(2).allocations, 1000u);
+
+			for (int i = 0; i < 1000; i++)
+				cache.deallocate(blocks[i], 48);
+		}
+
+		// Everything is returned when the cache is destroyed
+		const Common::SizeClassArena::ClassStats stats = arena.getStats(2);
+		TS_ASSERT_EQUALS(stats.allocations, 1000u);
+		TS_ASSERT_EQUALS(stats.frees, 1000u);
+		TS_ASSERT_EQUALS(stats.bytesInUse, 0u);
+	}
+
+	void test_concurrent_caches() {
+		Common::install_null_g_system();
+		Common::SizeClassArena arena("threads");
+		Common::ThreadPool pool(4);
+
+		JobState *state = new JobState;
+		state->arena = &arena;
+		state->errors = 0;
+
+		pool.run(allocateJob, state, kJobs);
+		pool.run(freeJob, state, kJobs);
+		TS_ASSERT_EQUALS(state->errors, 0u);
+
+		for (uint i = 0; i <= Common::SizeClassArena::kNumSizeClasses; i++) {
+			const Common::SizeClassArena::ClassStats stats = arena.getStats(i);
+			TS_ASSERT_EQUALS(stats.allocations, stats.frees);
+			TS_ASSERT_EQUALS(stats.bytesInUse, 0u);
+		}
+
+		delete state;
+	}
+
+	void test_frame_arena() {
+		Common::FrameArena arena("frame", 256);
+
+		byte *a = (byte *)arena.allocate(10);
+		byte *b = (byte *)arena.allocate(10, 64);
+		TS_ASSERT_EQUALS((uintptr)a % Common::FrameArena::kDefaultAlignment, 0u);
+		TS_ASSERT_EQUALS((uintptr)b % 64, 0u);
+		TS_ASSERT_LESS_THAN_EQUALS(a + 10, b);
+		TS_ASSERT_EQUALS(arena.getBytesInUse(), 20u);
+
+		// Bigger than a block
+		byte *c = (byte *)arena.allocate(1000);
+		memset(c, 0, 1000);
+		// Needs another block
+		int *d = arena.allocateArray<int>(50);
+		memset(d, 0, 50 * sizeof(int));
+		TS_ASSERT_LESS_THAN_EQUALS(1476u, arena.getBytesReserved());
+
+		// The blocks are merged into one
+		const size_t reserved = arena.getBytesReserved();
+		arena.reset();
+		TS_ASSERT_EQUALS(arena.getBytesInUse(), 0u);
+		TS_ASSERT_EQUALS(arena.getBytesReserved(), reserved);
+		byte *e = (byte *)arena.allocate(reserved - Common::FrameArena::kDefaultAlignment);
+		TS_ASSERT_EQUALS(arena.getBytesReserved(), reserved);
+
+		arena.reset();
+		TS_ASSERT_EQUALS((byte *)arena.allocate(1), e);
+
+		arena.releaseMemory();
+		TS_ASSERT_EQUALS(arena.getBytesReserved(), 0u);
+	}
+
+	void test_frame_arena_scope() {
+		Common::FrameArena arena("scope", 128);
+
+		void *a = arena.allocate(16);
+		void *b;
+		{
+			Common::FrameArena::Scope scope(arena);
+			b = arena.allocate(16);
+			TS_ASSERT_EQUALS(arena.getBytesInUse(), 32u);
+
+			// Spills into more blocks, which are kept
+			for (int i = 0; i < 20; i++)
+				arena.allocate(100);
+		}
+		TS_ASSERT_EQUALS(arena.getBytesInUse(), 16u);
+		TS_ASSERT_EQUALS(arena.allocate(16), b);
+		TS_ASSERT_DIFFERS(a, b);
+
+		struct Point {
+			int x, y;
+			Point(int x_, int y_) : x(x_), y(y_) {}
+		};
+		Point *p = new (arena) Point(1, 2);
+		TS_ASSERT_EQUALS(p->y, 2);
+	}
+};
@@ -0,0 +1,280 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/flathashmap.h"
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+#include "common/str.h"
+#include "common/system.h"
+
+#include "test/null_osystem.h"
+
+struct ConstantHash {
+	uint operator()(int x) const { return 42; }
+};
+
+class FlatHashMapTestSuite : public CxxTest::TestSuite
+{
+	typedef Common::FlatHashMap<Common::String, Common::String, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> FlatStringMap;
+
+	// Simple LCG, so that the test does not depend on the platform's rand()
+	static uint32 nextRandom(uint32 &seed) {
+		seed = seed * 1103515245 + 12345;
+		return seed >> 8;
+	}
+
+	public:
+	void test_empty_clear() {
+		Common::FlatHashMap<int, int> container;
+		TS_ASSERT(container.empty());
+		container[0] = 17;
+		container[1] = 33;
+		TS_ASSERT(!container.empty());
+		container.clear();
+		TS_ASSERT(container.empty());
+
+		FlatStringMap container2;
+		TS_ASSERT(container2.empty());
+		container2["foo"] = "bar";
+		container2["quux"] = "blub";
+		TS_ASSERT(!container2.empty());
+		container2.clear(true);
+		TS_ASSERT(container2.empty());
+	}
+
+	void test_contains() {
+		Common::FlatHashMap<int, int> container;
+		container[0] = 17;
+		container[1] = 33;
+		TS_ASSERT(container.contains(0));
+		TS_ASSERT(container.contains(1));
+		TS_ASSERT(!container.contains(17));
+		TS_ASSERT(!container.contains(-1));
+
+		FlatStringMap container2;
+		container2["foo"] = "bar";
+		container2["quux"] = "blub";
+		TS_ASSERT(container2.contains("foo"));
+		TS_ASSERT(container2.contains("QUUX"));
+		TS_ASSERT(!container2.contains("bar"));
+		TS_ASSERT(!container2.contains("asdf"));
+	}
+
+	void test_add_remove() {
+		Common::FlatHashMap<int, int> container;
+		container[0] = 17;
+		container[1] = 33;
+		container[2] = 45;
+		TS_ASSERT(container.contains(1));
+		container.erase(1);
+		TS_ASSERT(!container.contains(1));
+		container[1] = 42;
+		TS_ASSERT(container.contains(1));
+		TS_ASSERT_EQUALS(container[1], 42);
+		container.erase(container.find(0));
+		container.erase(1);
+		container.erase(container.find(2));
+		TS_ASSERT(container.empty());
+		TS_ASSERT_EQUALS(container.find(2), container.end());
+
+		// Erasing a missing key does nothing
+		container.erase(5);
+		TS_ASSERT(container.empty());
+	}
+
+	void test_lookup_with_default() {
+		Common::FlatHashMap<int, int> container;
+		container[0] = 17;
+		container[1] = -1;
+
+		// We take a const ref now to ensure that the map
+		// is not modified by getVal.
+		const Common::FlatHashMap<int, int> &containerRef = container;
+
+		TS_ASSERT_EQUALS(containerRef.getVal(0), 17);
+		TS_ASSERT_EQUALS(containerRef[1], -1);
+		TS_ASSERT_EQUALS(containerRef.getVal(17), 0);
+		TS_ASSERT_EQUALS(containerRef.getVal(0, -10), 17);
+		TS_ASSERT_EQUALS(containerRef.getVal(17, -10), -10);
+		TS_ASSERT_EQUALS(container.size(), 2u);
+
+		int out = 5;
+		TS_ASSERT(!containerRef.tryGetVal(17, out));
+		TS_ASSERT_EQUALS(out, 5);
+		TS_ASSERT(containerRef.tryGetVal(0, out));
+		TS_ASSERT_EQUALS(out, 17);
+	}
+
+	void test_iterator() {
+		Common::FlatHashMap<int, int> container;
+
+		// The container is initially empty ...
+		TS_ASSERT_EQUALS(container.begin(), container.end());
+
+		container[0] = 17;
+		container[1] = 33;
+		container[2] = 45;
+		container[3] = 12;
+		container[4] = 96;
+		container.erase(1);
+		container[1] = 42;
+		container.erase(0);
+		container.erase(1);
+
+		int found = 0;
+		Common::FlatHashMap<int, int>::iterator i;
+		for (i = container.begin(); i != container.end(); ++i) {
+			int key = i->_key;
+			TS_ASSERT(key >= 0 && key <= 4);
+			TS_ASSERT(!(found & (1 << key)));
+			found |= 1 << key;
+			i->_value = key;
+		}
+		TS_ASSERT(found == 16+8+4);
+
+		found = 0;
+		Common::FlatHashMap<int, int>::const_iterator j;
+		for (j = container.begin(); j != container.end(); ++j) {
+			TS_ASSERT_EQUALS(j->_key, j->_value);
+			found |= 1 << j->_key;
+		}
+		TS_ASSERT(found == 16+8+4);
+
+		// Erasing while iterating keeps the iterator valid
+		for (i = container.begin(); i != container.end(); ++i)
+			container.erase(i);
+		TS_ASSERT(container.empty());
+		TS_ASSERT_EQUALS(container.begin(), container.end());
+	}
+
+	void test_copy() {
+		FlatStringMap map1, map2;
+		for (int i = 0; i < 100; ++i)
+			map1[Common::String::format("key%d", i)] = Common::String::format("value%d", i);
+		map1.erase("key50");
+
+		map2["other"] = "value";
+		map2 = map1;
+		FlatStringMap map3(map1);
+		map1.clear();
+
+		TS_ASSERT_EQUALS(map2.size(), 99u);
+		TS_ASSERT_EQUALS(map3.size(), 99u);
+		TS_ASSERT(!map2.contains("other"));
+		TS_ASSERT(!map3.contains("key50"));
+		TS_ASSERT_EQUALS(map2["key99"], "value99");
+		TS_ASSERT_EQUALS(map3["KEY0"], "value0");
+	}
+
+	void test_collision() {
+		// All keys share the same hash, so lookups have to probe across
+		// several groups and compare every key.
+		Common::FlatHashMap<int, int, ConstantHash> h;
+		for (int i = 0; i < 100; ++i)
+			h[i] = i * 2;
+		for (int i = 0; i < 100; i += 3)
+			h.erase(i);
+		for (int i = 0; i < 100; ++i) {
+			TS_ASSERT_EQUALS(h.contains(i), (i % 3) != 0);
+			if (i % 3)
+				TS_ASSERT_EQUALS(h[i], i * 2);
+		}
+		TS_ASSERT(!h.contains(100));
+	}
+
+	void test_against_hashmap() {
+		// Random insertions and removals, which also exercise the clean up
+		// of deleted slots and growing the storage.
+		Common::FlatHashMap<uint32, uint32> flat;
+		Common::HashMap<uint32, uint32> reference;
+		uint32 seed = 1;
+
+		for (int i = 0; i < 50000; ++i) {
+			const uint32 key = nextRandom(seed) % 3000;
+			if (nextRandom(seed) & 1) {
+				flat[key] = i;
+				reference[key] = i;
+			} else {
+				flat.erase(key);
+				reference.erase(key);
+			}
+		}
+
+		TS_ASSERT_EQUALS(flat.size(), reference.size());
+
+		uint count = 0;
+		for (Common::FlatHashMap<uint32, uint32>::const_iterator i = flat.begin(); i != flat.end(); ++i) {
+			TS_ASSERT(reference.contains(i->_key));
+			TS_ASSERT_EQUALS(reference[i->_key], i->_value);
+			count++;
+		}
+		TS_ASSERT_EQUALS(count, flat.size());
+
+		for (uint32 key = 0; key < 3000; ++key)
+			TS_ASSERT_EQUALS(flat.contains(key), reference.contains(key));
+	}
+
+	void test_benchmark() {
+		// Not a regression test as such, but shows how the lookup speed
+		// compares to HashMap for integer and string keys.
+		enum {
+			kKeys = 20000,
+			kRounds = 25
+		};
+
+		Common::install_null_g_system();
+
+		Common::FlatHashMap<uint32, uint32> flatInt;
+		Common::HashMap<uint32, uint32> int_;
+		Common::FlatHashMap<Common::String, uint32, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> flatStr;
+		Common::HashMap<Common::String, uint32, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> str;
+		Common::String names[kKeys];
+		const Common::String missing("missing");
+
+		uint32 seed = 7;
+		for (uint i = 0; i < kKeys; ++i) {
+			const uint32 key = nextRandom(seed);
+			flatInt[key] = i;
+			int_[key] = i;
+			names[i] = Common::String::format("selector_%u", key);
+			flatStr[names[i]] = i;
+			str[names[i]] = i;
+		}
+
+		uint32 sums[4] = { 0, 0, 0, 0 };
+		uint32 times[4];
+
+		for (int variant = 0; variant < 4; ++variant) {
+			const uint32 start = g_system->getMillis();
+			for (int round = 0; round < kRounds; ++round) {
+				// Look up the keys as well as the same number of missing keys
+				uint32 lookupSeed = 7;
+				for (uint i = 0; i < kKeys; ++i) {
+					const uint32 key = nextRandom(lookupSeed);
+					switch (variant) {
+					case 0:
+						sums[0] += flatInt.getVal(key, 0) + flatInt.getVal(key + 1, 0);
+						break;
+					case 1:
+						sums[1] += int_.getVal(key, 0) + int_.getVal(key + 1, 0);
+						break;
+					case 2:
+						sums[2] += flatStr.getVal(names[i], 0) + flatStr.getVal(missing, 0);
+						break;
+					default:
+						sums[3] += str.getVal(names[i], 0) + str.getVal(missing, 0);
+						break;
+					}
+				}
+			}
+			times[variant] = g_system->getMillis() - start;
+		}
+
+		TS_ASSERT_EQUALS(sums[0], sums[1]);
+		TS_ASSERT_EQUALS(sums[2], sums[3]);
+
+		TS_TRACE(Common::String::format("%d integer lookups: FlatHashMap %u ms, HashMap %u ms",
+		                                2 * kKeys * kRounds, times[0], times[1]).c_str());
+		TS_TRACE(Common::String::format("%d string lookups: FlatHashMap %u ms, HashMap %u ms",
+		                                2 * kKeys * kRounds, times[2], times[3]).c_str());
+	}
+};
@@ -0,0 +1,191 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/fs.h"
+#include "common/hasher.h"
+#include "common/memstream.h"
+#include "common/str.h"
+#include "common/threadpool.h"
+
+#include "test/null_osystem.h"
+
+/**
+ * A stream which is not a MemoryReadStream, so that the hasher has to
+ * read it in blocks.
+ */
+class PlainReadStream : public Common::ReadStream {
+public:
+	PlainReadStream(const byte *data, uint32 size) : _data(data), _size(size), _pos(0) {}
+
+	uint32 read(void *dataPtr, uint32 dataSize) {
+		dataSize = MIN(dataSize, _size - _pos);
+		memcpy(dataPtr, _data + _pos, dataSize);
+		_pos += dataSize;
+		return dataSize;
+	}
+
+	bool eos() const { return _pos == _size; }
+
+private:
+	const byte *_data;
+	uint32 _size;
+	uint32 _pos;
+};
+
+class HasherTestSuite : public CxxTest::TestSuite {
+private:
+	enum {
+		kSize = 200000,
+		kBenchmarkSize = 16 * 1024 * 1024
+	};
+
+	static Common::String hash(Common::Hasher::Algorithm algorithm, const void *data, uint32 size, uint64 seed = 0) {
+		Common::Hasher hasher(algorithm, seed);
+		hasher.update(data, size);
+		return hasher.finishAsString();
+	}
+
+	static void fillData(byte *data, uint32 size) {
+		for (uint32 i = 0; i < size; i++)
+			data[i] = (byte)(i * 7 + (i >> 8));
+	}
+
+public:
+	void test_md5() {
+		TS_ASSERT_EQUALS(hash(Common::Hasher::kMD5, "", 0), "d41d8cd98f00b204e9800998ecf8427e");
+		TS_ASSERT_EQUALS(hash(Common::Hasher::kMD5, "abc", 3), "900150983cd24fb0d6963f7d28e17f72");
+		TS_ASSERT_EQUALS(hash(Common::Hasher::kMD5, "message digest", 14), "f96b697d7cb7938d525a2f31aaf161d0");
+	}
+
+	void test_xxh64() {
+		const char *alnum = "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+		TS_ASSERT_EQUALS(hash(Common::Hasher::kXXH64, "", 0), "ef46db3751d8e999");
+		TS_ASSERT_EQUALS(hash(Common::Hasher::kXXH64, "a", 1), "d24ec4f1a98c6e5b");
+		TS_ASSERT_EQUALS(hash(Common::Hasher::kXXH64, "abc", 3), "44bc2cf5ad770999");
+		TS_ASSERT_EQUALS(hash(Common::Hasher::kXXH64, "abc", 3, 1), "bea9ca8199328908");
+		TS_ASSERT_EQUALS(hash(Common::Hasher::kXXH64, alnum, strlen(alnum)), "7639d419de614eed");
+
+		byte data[768];
+		for (uint i = 0; i < sizeof(data); i++)
+			data[i] = (byte)i;
+		TS_ASSERT_EQUALS(hash(Common::Hasher::kXXH64, data, sizeof(data)), "8e03c838c596036f");
+		TS_ASSERT_EQUALS(Common::Hasher::xxHash64(data, sizeof(data)), 0x8e03c838c596036fULL);
+	}
+
+	void test_incremental() {
+		static byte data[kSize];
+		fillData(data, kSize);
+
+		for (int algorithm = Common::Hasher::kMD5; algorithm <= Common::Hasher::kXXH64; algorithm++) {
+			const Common::String expected = hash((Common::Hasher::Algorithm)algorithm, data, kSize);
+
+			// Pieces of all sizes, crossing the internal block boundaries
+			Common::Hasher hasher((Common::Hasher::Algorithm)algorithm);
+			uint32 pos = 0, size = 1;
+			while (pos < kSize) {
+				size = MIN<uint32>(size, kSize - pos);
+				hasher.update(data + pos, size);
+				pos += size;
+				size = (size * 5 + 3) % 97;
+			}
+			TS_ASSERT_EQUALS(hasher.finishAsString(), expected);
+
+			// Reusing the hasher after a reset
+			hasher.reset();
+			hasher.update(data, kSize);
+			TS_ASSERT_EQUALS(hasher.finishAsString(), expected);
+		}
+	}
+
+	void test_stream() {
+		static byte data[kSize];
+		fillData(data, kSize);
+
+		for (int algorithm = Common::Hasher::kMD5; algorithm <= Common::Hasher::kXXH64; algorithm++) {
+			const Common::Hasher::Algorithm algo = (Common::Hasher::Algorithm)algorithm;
+
+			// Memory streams are hashed in place, others in blocks
+			Common::MemoryReadStream memStream(data, kSize);
+			Common::Hasher memHasher(algo);
+			TS_ASSERT(memHasher.update(memStream));
+			TS_ASSERT_EQUALS(memStream.pos(), kSize);
+			TS_ASSERT_EQUALS(memHasher.finishAsString(), hash(algo, data, kSize));
+
+			PlainReadStream plainStream(data, kSize);
+			Common::Hasher plainHasher(algo);
+			TS_ASSERT(plainHasher.update(plainStream));
+			TS_ASSERT_EQUALS(plainHasher.finishAsString(), hash(algo, data, kSize));
+
+			// Only hashing the beginning, from the current position
+			memStream.seek(10);
+			memHasher.reset();
+			TS_ASSERT(memHasher.update(memStream, 100000));
+			TS_ASSERT_EQUALS(memStream.pos(), 100010);
+			TS_ASSERT_EQUALS(memHasher.finishAsString(), hash(algo, data + 10, 100000));
+
+			PlainReadStream plainStream2(data, kSize);
+			plainHasher.reset();
+			TS_ASSERT(plainHasher.update(plainStream2, 100000));
+			TS_ASSERT_EQUALS(plainHasher.finishAsString(), hash(algo, data, 100000));
+		}
+	}
+
+	void test_hash_files() {
+#ifdef POSIX
+		Common::install_null_g_system();
+
+		static byte data[kSize];
+		fillData(data, kSize);
+
+		Common::Array<Common::FSNode> files;
+		for (int i = 0; i < 8; i++) {
+			Common::FSNode node(Common::String::format("/tmp/scummvm-hasher-test-%d", i));
+			Common::WriteStream *stream = node.createWriteStream();
+			TS_ASSERT(stream);
+			if (!stream)
+				return;
+			stream->write(data + i, kSize - i);
+			delete stream;
+			files.push_back(node);
+		}
+		files.push_back(Common::FSNode("/tmp/scummvm-hasher-test-missing"));
+
+		Common::ThreadPool pool(4);
+		Common::Array<Common::String> digests;
+		Common::Hasher::hashFiles(files, Common::Hasher::kMD5, digests, pool);
+		TS_ASSERT_EQUALS(digests.size(), files.size());
+		for (int i = 0; i < 8; i++)
+			TS_ASSERT_EQUALS(digests[i], hash(Common::Hasher::kMD5, data + i, kSize - i));
+		TS_ASSERT(digests[8].empty());
+
+		Common::Hasher::hashFiles(files, Common::Hasher::kXXH64, digests, pool, 5000);
+		for (int i = 0; i < 8; i++)
+			TS_ASSERT_EQUALS(digests[i], hash(Common::Hasher::kXXH64, data + i, 5000));
+
+		for (int i = 0; i < 8; i++)
+			remove(files[i].getPath().c_str());
+#endif
+	}
+
+	void test_benchmark() {
+		Common::install_null_g_system();
+
+		byte *data = new byte[kBenchmarkSize];
+		fillData(data, kBenchmarkSize);
+
+		uint32 times[2];
+		for (int algorithm = Common::Hasher::kMD5; algorithm <= Common::Hasher::kXXH64; algorithm++) {
+			PlainReadStream stream(data, kBenchmarkSize);
+			const uint32 start = g_system->getMillis();
+			Common::Hasher hasher((Common::Hasher::Algorithm)algorithm);
+			hasher.update(stream);
+			hasher.finishAsString();
+			times[algorithm] = MAX<uint32>(g_system->getMillis() - start, 1);
+		}
+
+		delete[] data;
+
+		TS_TRACE(Common::String::format("Hashing %d MB: MD5 %u ms (%u MB/s), XXH64 %u ms (%u MB/s)",
+		                                kBenchmarkSize >> 20, times[0], (kBenchmarkSize >> 10) / times[0],
+		                                times[1], (kBenchmarkSize >> 10) / times[1]).c_str());
+	}
+};
@@ -0,0 +1,156 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/macresman.h"
+#include "common/memstream.h"
+
+class MacResManagerTestSuite : public CxxTest::TestSuite {
+private:
+	struct TestResource {
+		uint32 type;
+		uint16 id;
+		const char *name;
+		const char *data;
+	};
+
+	Common::MemoryWriteStreamDynamic *_file;
+
+	/**
+	 * Build a MacBinary file without data fork, whose resource fork
+	 * contains the given resources. The resources of each type must be
+	 * next to each other.
+	 */
+	void buildMacBinary(const TestResource *resources, uint count) {
+		Common::MemoryWriteStreamDynamic data(DisposeAfterUse::YES);
+		Common::MemoryWriteStreamDynamic names(DisposeAfterUse::YES);
+		Common::MemoryWriteStreamDynamic types(DisposeAfterUse::YES);
+		Common::MemoryWriteStreamDynamic refs(DisposeAfterUse::YES);
+
+		uint numTypes = 0;
+		for (uint i = 0; i < count; i++)
+			if (i == 0 || resources[i].type != resources[i - 1].type)
+				numTypes++;
+
+		for (uint i = 0; i < count; i++) {
+			if (i == 0 || resources[i].type != resources[i - 1].type) {
+				uint items = 0;
+				while (i + items < count && resources[i + items].type == resources[i].type)
+					items++;
+
+				types.writeUint32BE(resources[i].type);
+				types.writeUint16BE(items - 1);
+				types.writeUint16BE(2 + numTypes * 8 + refs.size());
+			}
+
+			refs.writeUint16BE(resources[i].id);
+			if (resources[i].name) {
+				refs.writeUint16BE(names.size());
+				names.writeByte(strlen(resources[i].name));
+				names.writeString(resources[i].name);
+			} else {
+				refs.writeUint16BE(0xFFFF);
+			}
+			refs.writeUint32BE(data.size());
+			refs.writeUint32BE(0);
+
+			data.writeUint32BE(strlen(resources[i].data));
+			data.writeString(resources[i].data);
+		}
+
+		const uint32 mapHeaderSize = 30;
+		const uint32 mapLength = mapHeaderSize + types.size() + refs.size() + names.size();
+		const int32 dataOffset = 256;
+		const uint32 mapOffset = dataOffset + data.size();
+
+		Common::MemoryWriteStreamDynamic fork(DisposeAfterUse::YES);
+		fork.writeUint32BE(dataOffset);
+		fork.writeUint32BE(mapOffset);
+		fork.writeUint32BE(data.size());
+		fork.writeUint32BE(mapLength);
+		while (fork.size() < dataOffset)
+			fork.writeByte(0);
+		fork.write(data.getData(), data.size());
+
+		for (uint i = 0; i < 22; i++)
+			fork.writeByte(0);
+		fork.writeUint16BE(0);
+		fork.writeUint16BE(mapHeaderSize - 2);
+		fork.writeUint16BE(mapHeaderSize + types.size() + refs.size());
+		fork.writeUint16BE(numTypes - 1);
+		fork.write(types.getData(), types.size());
+		fork.write(refs.getData(), refs.size());
+		fork.write(names.getData(), names.size());
+
+		_file = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::YES);
+		byte header[128];
+		memset(header, 0, sizeof(header));
+		header[1] = 4;
+		WRITE_BE_UINT32(header + 87, fork.size());
+		_file->write(header, sizeof(header));
+		_file->write(fork.getData(), fork.size());
+	}
+
+	static Common::String readAll(Common::SeekableReadStream *stream) {
+		if (!stream)
+			return "<none>";
+
+		Common::String result;
+		while (true) {
+			const byte b = stream->readByte();
+			if (stream->eos())
+				break;
+			result += (char)b;
+		}
+		delete stream;
+		return result;
+	}
+
+public:
+	void test_lookup() {
+		static const TestResource resources[] = {
+			{ MKTAG('P', 'I', 'C', 'T'), 128, "Title", "abc" },
+			{ MKTAG('P', 'I', 'C', 'T'), 129, nullptr, "defg" },
+			{ MKTAG('s', 'n', 'd', ' '), 128, "title", "xyz" },
+			{ MKTAG('s', 'n', 'd', ' '), 200, "Boom", "" },
+			{ MKTAG('s', 'n', 'd', ' '), 128, "Dup", "zz" }
+		};
+		buildMacBinary(resources, ARRAYSIZE(resources));
+
+		Common::MacResManager resMan;
+		TS_ASSERT(resMan.loadFromMacBinary(*new Common::MemoryReadStream(_file->getData(), _file->size())));
+
+		TS_ASSERT_EQUALS(readAll(resMan.getResource(MKTAG('P', 'I', 'C', 'T'), 128)), "abc");
+		TS_ASSERT_EQUALS(readAll(resMan.getResource(MKTAG('P', 'I', 'C', 'T'), 129)), "defg");
+		TS_ASSERT_EQUALS(readAll(resMan.getResource(MKTAG('s', 'n', 'd', ' '), 128)), "xyz");
+		TS_ASSERT_EQUALS(readAll(resMan.getResource(MKTAG('P', 'I', 'C', 'T'), 130)), "<none>");
+		TS_ASSERT_EQUALS(readAll(resMan.getResource(MKTAG('c', 'u', 'r', 's'), 128)), "<none>");
+
+		// Resources with 0 length are ignored
+		TS_ASSERT_EQUALS(readAll(resMan.getResource(MKTAG('s', 'n', 'd', ' '), 200)), "<none>");
+
+		TS_ASSERT_EQUALS(resMan.getResName(MKTAG('P', 'I', 'C', 'T'), 128), "Title");
+		TS_ASSERT_EQUALS(resMan.getResName(MKTAG('P', 'I', 'C', 'T'), 129), "");
+		TS_ASSERT_EQUALS(resMan.getResName(MKTAG('s', 'n', 'd', ' '), 200), "Boom");
+
+		// Lookups by name ignore the case, and the first match wins
+		TS_ASSERT_EQUALS(readAll(resMan.getResource("TITLE")), "abc");
+		TS_ASSERT_EQUALS(readAll(resMan.getResource(MKTAG('s', 'n', 'd', ' '), "TITLE")), "xyz");
+		TS_ASSERT_EQUALS(readAll(resMan.getResource("dup")), "zz");
+		TS_ASSERT_EQUALS(readAll(resMan.getResource("missing")), "<none>");
+		TS_ASSERT_EQUALS(readAll(resMan.getResource(MKTAG('P', 'I', 'C', 'T'), "Dup")), "<none>");
+
+		Common::MacResIDArray ids = resMan.getResIDArray(MKTAG('s', 'n', 'd', ' '));
+		TS_ASSERT_EQUALS(ids.size(), 3u);
+		TS_ASSERT_EQUALS(ids[1], 200);
+		TS_ASSERT_EQUALS(resMan.getResTagArray().size(), 0u);
+
+		// Reopening works with fresh indexes
+		resMan.close();
+		TS_ASSERT_EQUALS(readAll(resMan.getResource("Title")), "<none>");
+		TS_ASSERT(resMan.loadFromMacBinary(*new Common::MemoryReadStream(_file->getData(), _file->size())));
+		TS_ASSERT_EQUALS(readAll(resMan.getResource("Boom")), "<none>");
+		TS_ASSERT_EQUALS(readAll(resMan.getResource(MKTAG('P', 'I', 'C', 'T'), 129)), "defg");
+
+		resMan.close();
+		delete _file;
+	}
+};
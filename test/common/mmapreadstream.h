@@ -0,0 +1,173 @@
+#include <cxxtest/TestSuite.h>
+
+// Befriended by common/span.h, which is included before test/common/span.h
+class SpanTestSuite;
+
+#include "common/fs.h"
+#include "common/streamspan.h"
+
+#include "test/null_osystem.h"
+
+#if defined(POSIX) && defined(USE_MMAP)
+#include "backends/fs/posix/posix-iostream.h"
+#endif
+
+class MmapReadStreamTestSuite : public CxxTest::TestSuite {
+private:
+#if defined(POSIX) && defined(USE_MMAP)
+	static byte fileByte(uint32 pos) {
+		return (byte)((pos * 7) ^ (pos >> 9));
+	}
+
+	Common::FSNode writeFile(int index, uint32 size) {
+		Common::FSNode node(Common::String::format("/tmp/scummvm-mmap-test-%d", index));
+		Common::WriteStream *out = node.createWriteStream();
+		TS_ASSERT(out);
+		if (!out)
+			return node;
+
+		byte buffer[4096];
+		for (uint32 pos = 0; pos < size; pos += sizeof(buffer)) {
+			const uint32 count = MIN<uint32>(sizeof(buffer), size - pos);
+			for (uint32 i = 0; i < count; i++)
+				buffer[i] = fileByte(pos + i);
+			out->write(buffer, count);
+		}
+		delete out;
+		return node;
+	}
+#endif
+
+public:
+	void test_small_files() {
+#if defined(POSIX) && defined(USE_MMAP)
+		Common::install_null_g_system();
+
+		// Files below the minimum size are read with stdio instead
+		const uint32 sizes[] = { 0, 1000, PosixMmapReadStream::kMinMappedSize - 1 };
+		for (uint i = 0; i < ARRAYSIZE(sizes); i++) {
+			Common::FSNode node = writeFile(i, sizes[i]);
+			TS_ASSERT(!PosixMmapReadStream::makeFromPath(node.getPath()));
+
+			Common::SeekableReadStream *stream = node.createReadStream();
+			TS_ASSERT(stream);
+			if (stream) {
+				TS_ASSERT_EQUALS(stream->size(), (int32)sizes[i]);
+				if (sizes[i]) {
+					stream->seek(-1, SEEK_END);
+					TS_ASSERT_EQUALS(stream->readByte(), fileByte(sizes[i] - 1));
+				}
+				delete stream;
+			}
+
+			remove(node.getPath().c_str());
+		}
+
+		// So are directories and missing files
+		TS_ASSERT(!PosixMmapReadStream::makeFromPath("/tmp"));
+		TS_ASSERT(!PosixMmapReadStream::makeFromPath("/tmp/scummvm-mmap-test-missing"));
+#endif
+	}
+
+	void test_read() {
+#if defined(POSIX) && defined(USE_MMAP)
+		Common::install_null_g_system();
+
+		const uint32 size = 512 * 1024 + 7;
+		Common::FSNode node = writeFile(0, size);
+		PosixMmapReadStream *stream = PosixMmapReadStream::makeFromPath(node.getPath());
+		TS_ASSERT(stream);
+		if (!stream)
+			return;
+
+		TS_ASSERT_EQUALS(stream->size(), (int32)size);
+		TS_ASSERT_EQUALS(stream->pos(), 0);
+
+		bool same = true;
+		for (uint32 pos = 0; pos < size; pos++)
+			same &= stream->getData()[pos] == fileByte(pos);
+		TS_ASSERT(same);
+
+		// Reading goes through the mapping
+		byte buffer[1000];
+		TS_ASSERT_EQUALS(stream->read(buffer, sizeof(buffer)), sizeof(buffer));
+		for (uint32 i = 0; i < sizeof(buffer); i++)
+			same &= buffer[i] == fileByte(i);
+		TS_ASSERT(same);
+		TS_ASSERT_EQUALS(stream->pos(), (int32)sizeof(buffer));
+
+		TS_ASSERT(stream->seek(300000));
+		TS_ASSERT_EQUALS(stream->readByte(), fileByte(300000));
+		TS_ASSERT(stream->seek(-10, SEEK_CUR));
+		TS_ASSERT_EQUALS(stream->readByte(), fileByte(299991));
+		TS_ASSERT(!stream->eos());
+
+		// Reading past the end stops at the end
+		TS_ASSERT(stream->seek(-5, SEEK_END));
+		TS_ASSERT_EQUALS(stream->read(buffer, sizeof(buffer)), 5u);
+		for (uint32 i = 0; i < 5; i++)
+			same &= buffer[i] == fileByte(size - 5 + i);
+		TS_ASSERT(same);
+		TS_ASSERT(stream->eos());
+		TS_ASSERT_EQUALS(stream->pos(), (int32)size);
+
+		TS_ASSERT(stream->seek(0));
+		TS_ASSERT(!stream->eos());
+		TS_ASSERT_EQUALS(stream->readByte(), fileByte(0));
+
+		delete stream;
+
+		// Files opened by their node are mapped as well
+		Common::SeekableReadStream *nodeStream = node.createReadStream();
+		TS_ASSERT(nodeStream);
+		if (nodeStream) {
+			Common::StreamSpan span = nodeStream->readSpan(100);
+			TS_ASSERT(span.isBorrowed());
+			delete nodeStream;
+		}
+
+		remove(node.getPath().c_str());
+#endif
+	}
+
+	void test_span_owner() {
+#if defined(POSIX) && defined(USE_MMAP)
+		Common::install_null_g_system();
+
+		const uint32 size = PosixMmapReadStream::kMinMappedSize;
+		Common::FSNode node = writeFile(0, size);
+		PosixMmapReadStream *stream = PosixMmapReadStream::makeFromPath(node.getPath());
+		TS_ASSERT(stream);
+		if (!stream)
+			return;
+
+		const byte *data = stream->getData();
+		TS_ASSERT(stream->seek(1000));
+		Common::StreamSpan span = stream->readSpan(2000);
+		TS_ASSERT(span.isBorrowed());
+		TS_ASSERT_EQUALS(span.getData(), data + 1000);
+		TS_ASSERT_EQUALS(span.size(), 2000u);
+
+		// Spans made after the first one share the same mapping
+		TS_ASSERT(stream->seek(-100, SEEK_END));
+		Common::StreamSpan last = stream->readSpan(200);
+		TS_ASSERT_EQUALS(last.getData(), data + size - 100);
+		TS_ASSERT_EQUALS(last.size(), 100u);
+
+		// The spans keep the mapping alive after the stream is gone, and
+		// the file itself is not needed either
+		delete stream;
+		remove(node.getPath().c_str());
+
+		bool same = true;
+		for (uint32 i = 0; i < span.size(); i++)
+			same &= data[1000 + i] == fileByte(1000 + i);
+		for (uint32 i = 0; i < last.size(); i++)
+			same &= last.getData()[i] == fileByte(size - 100 + i);
+		TS_ASSERT(same);
+
+		span = Common::StreamSpan();
+		TS_ASSERT_EQUALS(last.getData()[99], fileByte(size - 1));
+#endif
+	}
+};
@@ -0,0 +1,153 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/memstream.h"
+#include "common/prefetchstream.h"
+
+#include "test/null_osystem.h"
+
+/**
+ * A memory stream which fails to read past a given position, and counts
+ * its reads.
+ */
+class FailingReadStream : public Common::MemoryReadStream {
+public:
+	FailingReadStream(const byte *data, uint32 size, uint32 failPos)
+		: Common::MemoryReadStream(data, size), _reads(0), _failPos(failPos), _failed(false) {}
+
+	uint32 read(void *dataPtr, uint32 dataSize) {
+		_reads++;
+		if (pos() + dataSize > _failPos) {
+			dataSize = _failPos > (uint32)pos() ? _failPos - pos() : 0;
+			_failed = true;
+		}
+		return Common::MemoryReadStream::read(dataPtr, dataSize);
+	}
+
+	bool err() const { return _failed; }
+	void clearErr() { _failed = false; Common::MemoryReadStream::clearErr(); }
+
+	uint32 _reads;
+
+private:
+	uint32 _failPos;
+	bool _failed;
+};
+
+class PrefetchReadStreamTestSuite : public CxxTest::TestSuite {
+private:
+	enum {
+		kSize = 100000,
+		kChunkSize = 1000,
+		kChunkCount = 4
+	};
+
+	byte _data[kSize];
+
+	void fillData() {
+		Common::install_null_g_system();
+		for (uint32 i = 0; i < kSize; i++)
+			_data[i] = (byte)(i * 7 + (i >> 8));
+	}
+
+	bool checkRead(Common::SeekableReadStream &stream, uint32 size) {
+		byte buf[5000];
+		const uint32 start = stream.pos();
+		const uint32 expected = MIN<uint32>(size, kSize - start);
+		if (stream.read(buf, size) != expected)
+			return false;
+		return memcmp(buf, _data + start, expected) == 0 && (uint32)stream.pos() == start + expected;
+	}
+
+public:
+	void test_sequential_read() {
+		fillData();
+		Common::MemoryReadStream *parent = new Common::MemoryReadStream(_data, kSize);
+		Common::PrefetchReadStream stream(parent, DisposeAfterUse::YES, kChunkSize, kChunkCount);
+#ifdef POSIX
+		// The test runner's backend supports worker threads
+		TS_ASSERT(stream.isPrefetching());
+#endif
+		TS_ASSERT_EQUALS(stream.size(), kSize);
+
+		// Reads of all sizes, including ones crossing several chunks
+		uint32 size = 1;
+		while (!stream.eos()) {
+			TS_ASSERT(checkRead(stream, size));
+			size = (size * 3 + 1) % 4999 + 1;
+		}
+		TS_ASSERT_EQUALS(stream.pos(), kSize);
+		TS_ASSERT(!stream.err());
+	}
+
+	void test_start_position() {
+		fillData();
+		Common::MemoryReadStream *parent = new Common::MemoryReadStream(_data, kSize);
+		parent->seek(12345);
+		Common::PrefetchReadStream stream(parent, DisposeAfterUse::YES, kChunkSize, kChunkCount);
+
+		TS_ASSERT_EQUALS(stream.pos(), 12345);
+		TS_ASSERT(checkRead(stream, 3000));
+	}
+
+	void test_seek() {
+		fillData();
+		Common::PrefetchReadStream stream(new Common::MemoryReadStream(_data, kSize), DisposeAfterUse::YES, kChunkSize, kChunkCount);
+
+		// Seeks inside and outside of the window, forward and backward
+		static const int32 offsets[] = { 500, 1500, 100, 3999, 70000, 69000, 99999, 0, 42000, 41999, 98000 };
+		for (uint i = 0; i < ARRAYSIZE(offsets); i++) {
+			TS_ASSERT(stream.seek(offsets[i]));
+			TS_ASSERT(checkRead(stream, 2500));
+		}
+
+		TS_ASSERT(stream.seek(-10, SEEK_END));
+		TS_ASSERT_EQUALS(stream.pos(), kSize - 10);
+		TS_ASSERT(stream.seek(-100, SEEK_CUR));
+		TS_ASSERT(checkRead(stream, 110));
+		TS_ASSERT(!stream.eos());
+
+		// Reading past the end sets eos, which seeking resets
+		byte b;
+		TS_ASSERT_EQUALS(stream.read(&b, 1), 0u);
+		TS_ASSERT(stream.eos());
+		TS_ASSERT(stream.seek(0));
+		TS_ASSERT(!stream.eos());
+
+		TS_ASSERT(!stream.seek(kSize + 1));
+		TS_ASSERT(!stream.seek(-1));
+		TS_ASSERT(!stream.err());
+	}
+
+	void test_read_error() {
+		fillData();
+		FailingReadStream *parent = new FailingReadStream(_data, kSize, 5500);
+		Common::PrefetchReadStream stream(parent, DisposeAfterUse::YES, kChunkSize, kChunkCount);
+
+		byte buf[6000];
+		TS_ASSERT_EQUALS(stream.read(buf, 6000), 5500u);
+		TS_ASSERT(memcmp(buf, _data, 5500) == 0);
+		TS_ASSERT(stream.err());
+
+		// Data before the error can still be read
+		stream.clearErr();
+		TS_ASSERT(stream.seek(100));
+		TS_ASSERT(checkRead(stream, 1000));
+		TS_ASSERT(!stream.err());
+	}
+
+	void test_read_ahead() {
+		fillData();
+		FailingReadStream *parent = new FailingReadStream(_data, kSize, kSize);
+		Common::PrefetchReadStream stream(parent, DisposeAfterUse::YES, kChunkSize, kChunkCount);
+
+		// Small reads are served from the chunks read ahead
+		for (uint32 i = 0; i < kSize / 10; i++)
+			TS_ASSERT(checkRead(stream, 10));
+		TS_ASSERT_LESS_THAN_EQUALS(parent->_reads, (uint32)(kSize / kChunkSize));
+		TS_ASSERT_LESS_THAN_EQUALS(stream.getStallCount(), parent->_reads);
+
+		stream.resetStallCounters();
+		TS_ASSERT_EQUALS(stream.getStallCount(), 0u);
+		TS_ASSERT_EQUALS(stream.getStallTime(), 0u);
+	}
+};
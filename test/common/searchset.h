@@ -0,0 +1,159 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/memstream.h"
+
+class SearchSetTestSuite : public CxxTest::TestSuite
+{
+private:
+	/**
+	 * An archive whose members contain its id. It also finds the names in
+	 * its hidden list, without listing them.
+	 */
+	class TestArchive : public Common::Archive {
+	public:
+		TestArchive(byte id, const char *const *names, const char *const *hidden = nullptr) : _id(id), _listCalls(0) {
+			for (; *names; names++)
+				_names.push_back(*names);
+			for (; hidden && *hidden; hidden++)
+				_hidden.push_back(*hidden);
+		}
+
+		bool hasFile(const Common::String &name) const override {
+			return contains(_names, name) || contains(_hidden, name);
+		}
+
+		int listMembers(Common::ArchiveMemberList &list) const override {
+			_listCalls++;
+			for (uint i = 0; i < _names.size(); i++)
+				list.push_back(Common::ArchiveMemberPtr(new Common::GenericArchiveMember(_names[i], this)));
+			return _names.size();
+		}
+
+		const Common::ArchiveMemberPtr getMember(const Common::String &name) const override {
+			return Common::ArchiveMemberPtr(new Common::GenericArchiveMember(name, this));
+		}
+
+		Common::SeekableReadStream *createReadStreamForMember(const Common::String &name) const override {
+			if (!hasFile(name))
+				return nullptr;
+			return new Common::MemoryReadStream(&_id, 1);
+		}
+
+		mutable int _listCalls;
+
+	private:
+		static bool contains(const Common::Array<Common::String> &names, const Common::String &name) {
+			for (uint i = 0; i < names.size(); i++) {
+				if (names[i].equalsIgnoreCase(name))
+					return true;
+			}
+			return false;
+		}
+
+		byte _id;
+		Common::Array<Common::String> _names;
+		Common::Array<Common::String> _hidden;
+	};
+
+	static int open(const Common::SearchSet &set, const char *name) {
+		Common::SeekableReadStream *stream = set.createReadStreamForMember(name);
+		if (!stream)
+			return -1;
+		int id = stream->readByte();
+		delete stream;
+		return id;
+	}
+
+	void checkLookups(bool useNameIndex) {
+		static const char *const names1[] = { "a.dat", "shared.dat", nullptr };
+		static const char *const names2[] = { "b.dat", "SHARED.DAT", nullptr };
+		static const char *const names3[] = { "c.dat", nullptr };
+		static const char *const hidden3[] = { "dir/c.dat", nullptr };
+
+		Common::SearchSet set;
+		set.setUseNameIndex(useNameIndex);
+		set.add("one", new TestArchive(1, names1), 1);
+		set.add("two", new TestArchive(2, names2), 2);
+
+		TS_ASSERT_EQUALS(open(set, "a.dat"), 1);
+		TS_ASSERT_EQUALS(open(set, "B.dat"), 2);
+		TS_ASSERT_EQUALS(open(set, "shared.dat"), 2);
+		TS_ASSERT_EQUALS(open(set, "c.dat"), -1);
+		TS_ASSERT(set.hasFile("a.dat"));
+		TS_ASSERT(!set.hasFile("c.dat"));
+		TS_ASSERT(set.getMember("b.dat"));
+		TS_ASSERT(!set.getMember("c.dat"));
+
+		// Adding, removing and reordering archives updates the index
+		set.add("three", new TestArchive(3, names3, hidden3), 3);
+		TS_ASSERT_EQUALS(open(set, "c.dat"), 3);
+		TS_ASSERT_EQUALS(open(set, "dir/c.dat"), 3);
+		set.setPriority("one", 4);
+		TS_ASSERT_EQUALS(open(set, "shared.dat"), 1);
+		set.remove("one");
+		TS_ASSERT_EQUALS(open(set, "shared.dat"), 2);
+		TS_ASSERT_EQUALS(open(set, "a.dat"), -1);
+	}
+
+public:
+	void test_lookups() {
+		checkLookups(false);
+	}
+
+	void test_name_index() {
+		checkLookups(true);
+	}
+
+	void test_name_index_built_once() {
+		static const char *const names[] = { "a.dat", nullptr };
+
+		Common::SearchSet set;
+		set.setUseNameIndex(true);
+		TestArchive *archive = new TestArchive(1, names);
+		set.add("one", archive);
+
+		for (int i = 0; i < 10; i++) {
+			TS_ASSERT(set.hasFile("a.dat"));
+			TS_ASSERT(!set.hasFile("b.dat"));
+		}
+		TS_ASSERT_EQUALS(archive->_listCalls, 1);
+
+		set.invalidateNameIndex();
+		TS_ASSERT(set.hasFile("a.dat"));
+		TS_ASSERT_EQUALS(archive->_listCalls, 2);
+	}
+
+	void test_lookup_stats() {
+		static const char *const names1[] = { "a.dat", nullptr };
+		static const char *const names2[] = { "b.dat", nullptr };
+
+		for (int useNameIndex = 0; useNameIndex < 2; useNameIndex++) {
+			Common::SearchSet set;
+			set.setUseNameIndex(useNameIndex);
+			set.add("one", new TestArchive(1, names1), 1);
+			set.add("two", new TestArchive(2, names2), 0);
+
+			open(set, "a.dat");
+			open(set, "b.dat");
+			open(set, "b.dat");
+
+			Common::Array<Common::SearchSet::ArchiveStats> stats;
+			set.getLookupStats(stats);
+			TS_ASSERT_EQUALS(stats.size(), 2u);
+			TS_ASSERT_EQUALS(stats[0].name, "one");
+			TS_ASSERT_EQUALS(stats[0].hits, 1u);
+			TS_ASSERT_EQUALS(stats[1].name, "two");
+			TS_ASSERT_EQUALS(stats[1].hits, 2u);
+
+			// Without the index, every lookup of b.dat asks archive one first
+			TS_ASSERT_EQUALS(stats[0].lookups, useNameIndex ? 1u : 3u);
+			TS_ASSERT_EQUALS(stats[1].lookups, 2u);
+
+			set.resetLookupStats();
+			stats.clear();
+			set.getLookupStats(stats);
+			TS_ASSERT_EQUALS(stats[0].lookups, 0u);
+		}
+	}
+};
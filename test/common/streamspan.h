@@ -0,0 +1,144 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/fs.h"
+#include "common/memstream.h"
+#include "common/streamspan.h"
+#include "common/substream.h"
+
+#include "test/null_osystem.h"
+
+/**
+ * A stream which is not a MemoryReadStream, so that its spans have to
+ * be copied.
+ */
+class CopyOnlyReadStream : public Common::ReadStream {
+public:
+	CopyOnlyReadStream(const byte *data, uint32 size) : _data(data), _size(size), _pos(0) {}
+
+	uint32 read(void *dataPtr, uint32 dataSize) {
+		dataSize = MIN(dataSize, _size - _pos);
+		memcpy(dataPtr, _data + _pos, dataSize);
+		_pos += dataSize;
+		return dataSize;
+	}
+
+	bool eos() const { return _pos == _size; }
+
+private:
+	const byte *_data;
+	uint32 _size;
+	uint32 _pos;
+};
+
+class StreamSpanTestSuite : public CxxTest::TestSuite {
+public:
+	void test_memory_stream() {
+		const byte data[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+		Common::StreamSpan::resetCounters();
+
+		Common::MemoryReadStream stream(data, sizeof(data));
+		stream.skip(2);
+		Common::StreamSpan span = stream.readSpan(4);
+		TS_ASSERT(span.isBorrowed());
+		TS_ASSERT_EQUALS(span.getData(), data + 2);
+		TS_ASSERT_EQUALS(span.size(), 4u);
+		TS_ASSERT_EQUALS(span.getSpan()[3], 6);
+		TS_ASSERT_EQUALS(stream.pos(), 6);
+		TS_ASSERT(!stream.eos());
+
+		// Reading past the end is cut off, like read() does
+		span = stream.readSpan(10);
+		TS_ASSERT_EQUALS(span.size(), 2u);
+		TS_ASSERT(stream.eos());
+
+		TS_ASSERT_EQUALS(Common::StreamSpan::getBorrowedBytes(), 6u);
+		TS_ASSERT_EQUALS(Common::StreamSpan::getCopiedBytes(), 0u);
+	}
+
+	void test_shared_ownership() {
+		byte *data = (byte *)malloc(1000);
+		for (int i = 0; i < 1000; i++)
+			data[i] = (byte)i;
+
+		Common::MemoryReadStream *stream = new Common::MemoryReadStream(data, 1000, DisposeAfterUse::YES);
+		Common::StreamSpan span1 = stream->readSpan(500);
+		Common::StreamSpan span2 = stream->readSpan(500);
+
+		// The data has to outlive the stream, but is still freed once the
+		// last span is gone
+		delete stream;
+		TS_ASSERT_EQUALS(span1.getData(), data);
+		TS_ASSERT_EQUALS(span2.getData()[499], (byte)999);
+		span1 = Common::StreamSpan();
+		TS_ASSERT_EQUALS(span2.getData()[0], (byte)500);
+	}
+
+	void test_copy() {
+		const byte data[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+		Common::StreamSpan::resetCounters();
+
+		CopyOnlyReadStream stream(data, sizeof(data));
+		Common::StreamSpan span = stream.readSpan(5);
+		TS_ASSERT(!span.isBorrowed());
+		TS_ASSERT_DIFFERS(span.getData(), data);
+		TS_ASSERT_EQUALS(span.size(), 5u);
+		TS_ASSERT_EQUALS(memcmp(span.getData(), data, 5), 0);
+
+		span = stream.readSpan(5);
+		TS_ASSERT_EQUALS(span.size(), 3u);
+		TS_ASSERT_EQUALS(span.getData()[2], 8);
+
+		TS_ASSERT_EQUALS(Common::StreamSpan::getBorrowedBytes(), 0u);
+		TS_ASSERT_EQUALS(Common::StreamSpan::getCopiedBytes(), 8u);
+	}
+
+	void test_sub_stream() {
+		const byte data[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+
+		Common::MemoryReadStream parent(data, sizeof(data));
+		Common::SeekableSubReadStream sub(&parent, 2, 6);
+		sub.skip(1);
+		Common::StreamSpan span = sub.readSpan(10);
+		TS_ASSERT(span.isBorrowed());
+		TS_ASSERT_EQUALS(span.getData(), data + 3);
+		TS_ASSERT_EQUALS(span.size(), 3u);
+		TS_ASSERT_EQUALS(sub.pos(), 4);
+		TS_ASSERT(sub.eos());
+
+		// Safe substreams move the parent to their own position first
+		Common::SafeSeekableSubReadStream safe(&parent, 4, 8);
+		parent.seek(0);
+		span = safe.readSpan(2);
+		TS_ASSERT_EQUALS(span.getData(), data + 4);
+	}
+
+	void test_map_span() {
+#ifdef POSIX
+		Common::install_null_g_system();
+
+		// Big files are mapped, small ones are read by stdio
+		const uint32 sizes[] = { 1000, 512 * 1024 };
+		for (int i = 0; i < 2; i++) {
+			Common::FSNode node(Common::String::format("/tmp/scummvm-streamspan-test-%d", i));
+			Common::WriteStream *out = node.createWriteStream();
+			TS_ASSERT(out);
+			if (!out)
+				return;
+			for (uint32 j = 0; j < sizes[i]; j++)
+				out->writeByte((byte)(j * 3));
+			delete out;
+
+			Common::StreamSpan span = node.mapSpan();
+			TS_ASSERT_EQUALS(span.size(), sizes[i]);
+			TS_ASSERT_EQUALS(span.getData()[sizes[i] - 1], (byte)((sizes[i] - 1) * 3));
+#ifdef USE_MMAP
+			TS_ASSERT_EQUALS(span.isBorrowed(), i == 1);
+#endif
+
+			remove(node.getPath().c_str());
+		}
+
+		TS_ASSERT(Common::FSNode("/tmp/scummvm-streamspan-test-missing").mapSpan().empty());
+#endif
+	}
+};
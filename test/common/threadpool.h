@@ -0,0 +1,55 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/atomic.h"
+#include "common/threadpool.h"
+
+class ThreadPoolTestSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kJobs = 1000
+	};
+
+	struct JobState {
+		volatile uint32 runs[kJobs];
+		volatile uint32 total;
+	};
+
+	static void countJob(void *arg, uint index) {
+		JobState *state = (JobState *)arg;
+		Common::atomicAdd(&state->runs[index], 1);
+		Common::atomicAdd(&state->total, index);
+	}
+
+	void runTest(uint numThreads) {
+		Common::install_null_g_system();
+		Common::ThreadPool pool(numThreads);
+#ifdef POSIX
+		// The test runner's backend supports worker threads
+		TS_ASSERT_EQUALS(pool.getThreadCount(), numThreads);
+#endif
+
+		JobState state;
+		// Run several batches, so the workers have to be woken up again
+		for (uint count = 0; count <= kJobs; count += 111) {
+			for (uint i = 0; i < kJobs; i++)
+				state.runs[i] = 0;
+			state.total = 0;
+
+			pool.run(countJob, &state, count);
+
+			for (uint i = 0; i < kJobs; i++)
+				TS_ASSERT_EQUALS(state.runs[i], i < count ? 1U : 0U);
+			TS_ASSERT_EQUALS(state.total, count * (count - 1) / 2);
+		}
+	}
+
+public:
+	void test_serial() {
+		runTest(1);
+	}
+
+	void test_parallel() {
+		runTest(4);
+	}
+};
@@ -0,0 +1,279 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/array.h"
+#include "common/fs.h"
+#include "common/memstream.h"
+#include "common/threadpool.h"
+#include "common/unzip.h"
+#include "common/zlib.h"
+
+#ifdef USE_ZLIB
+
+class UnzipTestSuite : public CxxTest::TestSuite
+{
+private:
+	struct Member {
+		const char *name;
+		Common::Array<byte> data;
+		bool deflate;
+		uint32 crc;
+		uint32 compressedSize;
+		uint32 offset;
+	};
+
+	Member _members[3];
+
+	static void fill(Common::Array<byte> &data, uint32 size, uint32 seed) {
+		// Compressible, but not trivially
+		data.resize(size);
+		for (uint32 i = 0; i < size; i++) {
+			seed = seed * 1103515245 + 12345;
+			data[i] = (byte)('a' + ((seed >> 16) % 8) + (i / 4096) % 4);
+		}
+	}
+
+	/**
+	 * Compress the data in the gzip format, and return the raw deflate data
+	 * inside, as well as the CRC from the gzip trailer.
+	 */
+	static Common::Array<byte> deflateData(const Common::Array<byte> &data, uint32 &crc) {
+		Common::MemoryWriteStreamDynamic *gzip = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::YES);
+		Common::WriteStream *stream = Common::wrapCompressedWriteStream(gzip);
+		stream->write(data.begin(), data.size());
+		stream->finalize();
+
+		// Skip the 10 bytes gzip header, and the CRC and size at the end
+		const byte *gzipData = gzip->getData();
+		crc = READ_LE_UINT32(gzipData + gzip->size() - 8);
+		Common::Array<byte> out(gzipData + 10, gzip->size() - 18);
+		delete stream;
+		return out;
+	}
+
+	Common::SeekableReadStream *createZip() {
+		Common::MemoryWriteStreamDynamic zip(DisposeAfterUse::NO);
+
+		for (int i = 0; i < 3; i++) {
+			Member &member = _members[i];
+			const Common::Array<byte> deflated = deflateData(member.data, member.crc);
+			const Common::Array<byte> &stored = member.deflate ? deflated : member.data;
+			member.compressedSize = stored.size();
+			member.offset = zip.pos();
+
+			zip.writeUint32LE(0x04034b50);
+			zip.writeUint16LE(20);
+			zip.writeUint16LE(0);
+			zip.writeUint16LE(member.deflate ? 8 : 0);
+			zip.writeUint32LE(0);
+			zip.writeUint32LE(member.crc);
+			zip.writeUint32LE(member.compressedSize);
+			zip.writeUint32LE(member.data.size());
+			zip.writeUint16LE(strlen(member.name));
+			zip.writeUint16LE(0);
+			zip.writeString(member.name);
+			zip.write(stored.begin(), stored.size());
+		}
+
+		const uint32 centralDir = zip.pos();
+		for (int i = 0; i < 3; i++) {
+			const Member &member = _members[i];
+			zip.writeUint32LE(0x02014b50);
+			zip.writeUint16LE(20);
+			zip.writeUint16LE(20);
+			zip.writeUint16LE(0);
+			zip.writeUint16LE(member.deflate ? 8 : 0);
+			zip.writeUint32LE(0);
+			zip.writeUint32LE(member.crc);
+			zip.writeUint32LE(member.compressedSize);
+			zip.writeUint32LE(member.data.size());
+			zip.writeUint16LE(strlen(member.name));
+			zip.writeUint16LE(0);
+			zip.writeUint16LE(0);
+			zip.writeUint16LE(0);
+			zip.writeUint16LE(0);
+			zip.writeUint32LE(0);
+			zip.writeUint32LE(member.offset);
+			zip.writeString(member.name);
+		}
+		const uint32 centralDirSize = zip.pos() - centralDir;
+
+		zip.writeUint32LE(0x06054b50);
+		zip.writeUint16LE(0);
+		zip.writeUint16LE(0);
+		zip.writeUint16LE(3);
+		zip.writeUint16LE(3);
+		zip.writeUint32LE(centralDirSize);
+		zip.writeUint32LE(centralDir);
+		zip.writeUint16LE(0);
+
+		return new Common::MemoryReadStream(zip.getData(), zip.size(), DisposeAfterUse::YES);
+	}
+
+	struct ThreadedRead {
+		Common::SeekableReadStream *streams[8];
+		const Member *members[8];
+		bool ok[8];
+	};
+
+	static void readJob(void *arg, uint index) {
+		ThreadedRead *state = (ThreadedRead *)arg;
+		Common::SeekableReadStream *stream = state->streams[index];
+		const Member &member = *state->members[index];
+
+		// Small reads at scattered positions, to switch between the members
+		// as often as possible
+		byte buf[512];
+		bool ok = true;
+		for (uint32 offset = index * 1000; offset + sizeof(buf) <= 200 * 1024; offset += 4099) {
+			ok = ok && stream->seek(offset) && stream->read(buf, sizeof(buf)) == sizeof(buf) &&
+			     !memcmp(buf, &member.data[offset], sizeof(buf));
+		}
+		state->ok[index] = ok;
+	}
+
+	/** Read the big members on several threads at once. */
+	void testThreadedRead(Common::Archive *archive) {
+		ThreadedRead state;
+		for (int i = 0; i < 8; i++) {
+			state.members[i] = &_members[1 + i % 2];
+			state.streams[i] = archive->createReadStreamForMember(state.members[i]->name);
+			state.ok[i] = false;
+		}
+
+		Common::ThreadPool pool(4);
+		pool.run(readJob, &state, 8);
+
+		for (int i = 0; i < 8; i++) {
+			TS_ASSERT(state.ok[i]);
+			delete state.streams[i];
+		}
+	}
+
+	bool compare(Common::SeekableReadStream *stream, const Member &member, uint32 offset, uint32 size) {
+		byte buf[1000];
+		assert(size <= sizeof(buf));
+		if (!stream->seek(offset) || stream->pos() != (int32)offset)
+			return false;
+		if (stream->read(buf, size) != size)
+			return false;
+		return !memcmp(buf, &member.data[offset], size);
+	}
+
+public:
+	void setUp() {
+		// The members of archives made from streams share them under a lock
+		Common::install_null_g_system();
+
+		_members[0].name = "small.txt";
+		_members[0].deflate = true;
+		fill(_members[0].data, 1000, 1);
+
+		_members[1].name = "stored.bin";
+		_members[1].deflate = false;
+		fill(_members[1].data, 300 * 1024, 2);
+
+		_members[2].name = "deflated.bin";
+		_members[2].deflate = true;
+		fill(_members[2].data, 3 * 1024 * 1024 + 123, 3);
+	}
+
+	void test_read_members() {
+		Common::Archive *archive = Common::makeZipArchive(createZip());
+		TS_ASSERT(archive);
+
+		for (int i = 0; i < 3; i++) {
+			const Member &member = _members[i];
+			Common::SeekableReadStream *stream = archive->createReadStreamForMember(member.name);
+			TS_ASSERT(stream);
+			TS_ASSERT_EQUALS(stream->size(), (int32)member.data.size());
+
+			Common::Array<byte> data;
+			data.resize(member.data.size());
+			TS_ASSERT_EQUALS(stream->read(data.begin(), data.size()), data.size());
+			TS_ASSERT(data == member.data);
+			TS_ASSERT(!stream->err());
+			TS_ASSERT(!stream->eos());
+
+			byte b;
+			TS_ASSERT_EQUALS(stream->read(&b, 1), 0u);
+			TS_ASSERT(stream->eos());
+			delete stream;
+		}
+
+		TS_ASSERT(!archive->createReadStreamForMember("missing"));
+		delete archive;
+	}
+
+	void test_seek() {
+		Common::Archive *archive = Common::makeZipArchive(createZip());
+		const Member &member = _members[2];
+		Common::SeekableReadStream *stream = archive->createReadStreamForMember(member.name);
+
+		const uint32 size = member.data.size();
+		const uint32 offsets[] = {
+			size - 1000, 10, 2 * 1024 * 1024 - 7, 1024 * 1024, 5000, 1024 * 1024 - 500, size - 1000, 0
+		};
+		for (uint i = 0; i < ARRAYSIZE(offsets); i++)
+			TS_ASSERT(compare(stream, member, offsets[i], 1000));
+
+		TS_ASSERT(stream->seek(-10, SEEK_END));
+		TS_ASSERT_EQUALS(stream->pos(), (int32)size - 10);
+		TS_ASSERT(stream->seek(-100, SEEK_CUR));
+		TS_ASSERT_EQUALS(stream->readByte(), member.data[size - 110]);
+		TS_ASSERT(!stream->seek(size + 1));
+		TS_ASSERT(!stream->err());
+
+		delete stream;
+		delete archive;
+	}
+
+	void test_independent_streams() {
+		Common::Archive *archive = Common::makeZipArchive(createZip());
+		Common::SeekableReadStream *streams[4];
+		for (int i = 0; i < 4; i++)
+			streams[i] = archive->createReadStreamForMember(_members[1 + i % 2].name);
+
+		// The streams outlive the archive
+		delete archive;
+
+		for (uint32 offset = 0; offset < 200 * 1024; offset += 7919) {
+			for (int i = 0; i < 4; i++)
+				TS_ASSERT(compare(streams[i], _members[1 + i % 2], offset + i * 100, 500));
+		}
+
+		for (int i = 0; i < 4; i++)
+			delete streams[i];
+	}
+
+	void test_threaded_shared_stream() {
+		Common::Archive *archive = Common::makeZipArchive(createZip());
+		testThreadedRead(archive);
+		delete archive;
+	}
+
+	void test_threaded_file() {
+#ifdef POSIX
+		Common::FSNode node("/tmp/scummvm-unzip-test.zip");
+		Common::WriteStream *file = node.createWriteStream();
+		TS_ASSERT(file);
+		if (!file)
+			return;
+		Common::SeekableReadStream *zip = createZip();
+		file->writeStream(zip);
+		delete zip;
+		delete file;
+
+		Common::Archive *archive = Common::makeZipArchive(node);
+		TS_ASSERT(archive);
+		if (archive) {
+			testThreadedRead(archive);
+			delete archive;
+		}
+
+		remove(node.getPath().c_str());
+#endif
+	}
+};
+
+#endif
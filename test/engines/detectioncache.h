@@ -0,0 +1,238 @@
+#include <cxxtest/TestSuite.h>
+
+#include "engines/detectioncache.h"
+#include "engines/game.h"
+
+#include "common/fs.h"
+#include "common/hashmap.h"
+#include "common/memstream.h"
+#include "common/savefile.h"
+#include "common/system.h"
+
+#include "test/null_osystem.h"
+
+#ifdef POSIX
+#include <utime.h>
+#endif
+
+/**
+ * Keeps the save files in memory, so that the detection cache can be
+ * written and read again.
+ */
+class MemorySaveFileManager : public Common::SaveFileManager {
+public:
+	typedef Common::Array<byte> Data;
+	typedef Common::HashMap<Common::String, Data, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> FileMap;
+
+	FileMap _files;
+
+	Common::OutSaveFile *openForSaving(const Common::String &name, bool compress = true) override {
+		_files[name].clear();
+		return new Common::OutSaveFile(new MemorySaveFile(_files[name]));
+	}
+
+	Common::InSaveFile *openForLoading(const Common::String &name) override {
+		if (!_files.contains(name))
+			return nullptr;
+		const Data &data = _files[name];
+		return new Common::MemoryReadStream(data.empty() ? nullptr : &data.front(), data.size());
+	}
+
+	Common::InSaveFile *openRawFile(const Common::String &name) override {
+		return openForLoading(name);
+	}
+
+	bool removeSavefile(const Common::String &name) override {
+		_files.erase(name);
+		return true;
+	}
+
+	Common::StringArray listSavefiles(const Common::String &pattern) override {
+		return Common::StringArray();
+	}
+
+	void updateSavefilesList(Common::StringArray &lockedFiles) override {
+	}
+
+private:
+	class MemorySaveFile : public Common::WriteStream {
+	public:
+		MemorySaveFile(Data &data) : _data(data) {}
+
+		uint32 write(const void *dataPtr, uint32 dataSize) override {
+			const byte *bytes = (const byte *)dataPtr;
+			for (uint32 i = 0; i < dataSize; i++)
+				_data.push_back(bytes[i]);
+			return dataSize;
+		}
+
+		int32 pos() const override {
+			return _data.size();
+		}
+
+	private:
+		Data &_data;
+	};
+};
+
+class DetectionCacheTestSuite : public CxxTest::TestSuite {
+private:
+	MemorySaveFileManager *_saveFileMan;
+
+	void writeFile(const Common::FSNode &node, const char *contents) {
+		Common::WriteStream *stream = node.createWriteStream();
+		TS_ASSERT(stream);
+		if (!stream)
+			return;
+		stream->write(contents, strlen(contents));
+		delete stream;
+	}
+
+	FileProperties makeProperties(int32 size, const char *md5) {
+		FileProperties fileProps;
+		fileProps.size = size;
+		fileProps.md5 = md5;
+		return fileProps;
+	}
+
+public:
+	void setUp() {
+		Common::install_null_g_system();
+		_saveFileMan = new MemorySaveFileManager();
+		Common::install_null_g_system_savefile_manager(_saveFileMan);
+		DetectionCache::destroy();
+	}
+
+	void tearDown() {
+		DetectionCache::destroy();
+	}
+
+#ifdef POSIX
+	void test_lookup() {
+		Common::FSNode node("/tmp/scummvm-detectioncache-test");
+		writeFile(node, "detection cache test");
+
+		FileProperties fileProps;
+		TS_ASSERT(!DetectionCacheMan.lookup(node, 5000, fileProps));
+
+		DetectionCacheMan.store(node, 5000, makeProperties(20, "0123456789abcdef0123456789abcdef"));
+		TS_ASSERT(DetectionCacheMan.lookup(node, 5000, fileProps));
+		TS_ASSERT_EQUALS(fileProps.size, 20);
+		TS_ASSERT_EQUALS(fileProps.md5, "0123456789abcdef0123456789abcdef");
+
+		// The MD5 of another number of bytes is another entry
+		TS_ASSERT(!DetectionCacheMan.lookup(node, 1000, fileProps));
+		DetectionCacheMan.store(node, 1000, makeProperties(20, "fedcba9876543210fedcba9876543210"));
+		TS_ASSERT(DetectionCacheMan.lookup(node, 1000, fileProps));
+		TS_ASSERT_EQUALS(fileProps.md5, "fedcba9876543210fedcba9876543210");
+		TS_ASSERT(DetectionCacheMan.lookup(node, 5000, fileProps));
+		TS_ASSERT_EQUALS(fileProps.md5, "0123456789abcdef0123456789abcdef");
+
+		// Properties which do not match the file are not stored
+		DetectionCacheMan.store(node, 2000, makeProperties(21, "0123456789abcdef0123456789abcdef"));
+		TS_ASSERT(!DetectionCacheMan.lookup(node, 2000, fileProps));
+
+		TS_ASSERT(!DetectionCacheMan.lookup(Common::FSNode("/tmp/scummvm-detectioncache-test-missing"), 5000, fileProps));
+		DetectionCacheMan.store(Common::FSNode("/tmp/scummvm-detectioncache-test-missing"), 5000, makeProperties(20, "0123456789abcdef0123456789abcdef"));
+		TS_ASSERT(!DetectionCacheMan.lookup(Common::FSNode("/tmp/scummvm-detectioncache-test-missing"), 5000, fileProps));
+
+		TS_ASSERT_EQUALS(DetectionCacheMan.getStats(), "Detection: 5 files hashed, 3 served from the cache");
+		DetectionCacheMan.resetStats();
+		TS_ASSERT_EQUALS(DetectionCacheMan.getStats(), "Detection: 0 files hashed, 0 served from the cache");
+
+		remove(node.getPath().c_str());
+	}
+
+	void test_changed_file() {
+		Common::FSNode node("/tmp/scummvm-detectioncache-test");
+		writeFile(node, "detection cache test");
+
+		FileProperties fileProps;
+		DetectionCacheMan.store(node, 5000, makeProperties(20, "0123456789abcdef0123456789abcdef"));
+		TS_ASSERT(DetectionCacheMan.lookup(node, 5000, fileProps));
+
+		// Another modification time with the same size is a miss
+		uint32 size, modificationTime;
+		TS_ASSERT(node.getFileStats(size, modificationTime));
+		utimbuf times;
+		times.actime = modificationTime - 100;
+		times.modtime = modificationTime - 100;
+		TS_ASSERT_EQUALS(utime(node.getPath().c_str(), &times), 0);
+		TS_ASSERT(!DetectionCacheMan.lookup(node, 5000, fileProps));
+
+		DetectionCacheMan.store(node, 5000, makeProperties(20, "0123456789abcdef0123456789abcdef"));
+		TS_ASSERT(DetectionCacheMan.lookup(node, 5000, fileProps));
+
+		// So is another size with the same modification time
+		writeFile(node, "detection cache test, changed");
+		TS_ASSERT_EQUALS(utime(node.getPath().c_str(), &times), 0);
+		TS_ASSERT(!DetectionCacheMan.lookup(node, 5000, fileProps));
+
+		remove(node.getPath().c_str());
+	}
+
+	void test_max_entries() {
+		Common::FSNode node("/tmp/scummvm-detectioncache-test");
+		writeFile(node, "detection cache test");
+
+		// When the cache is full, it starts again from scratch
+		const uint kMaxEntries = 100000;
+		const FileProperties stored = makeProperties(20, "0123456789abcdef0123456789abcdef");
+		for (uint i = 0; i < kMaxEntries; i++)
+			DetectionCacheMan.store(node, i, stored);
+
+		FileProperties fileProps;
+		TS_ASSERT(DetectionCacheMan.lookup(node, 0, fileProps));
+		TS_ASSERT(DetectionCacheMan.lookup(node, kMaxEntries - 1, fileProps));
+
+		DetectionCacheMan.store(node, kMaxEntries, stored);
+		TS_ASSERT(!DetectionCacheMan.lookup(node, 0, fileProps));
+		TS_ASSERT(!DetectionCacheMan.lookup(node, kMaxEntries - 1, fileProps));
+		TS_ASSERT(DetectionCacheMan.lookup(node, kMaxEntries, fileProps));
+
+		remove(node.getPath().c_str());
+	}
+
+	void test_flush() {
+		Common::FSNode node("/tmp/scummvm-detectioncache-test");
+		Common::FSNode other("/tmp/scummvm-detectioncache-test other");
+		writeFile(node, "detection cache test");
+		writeFile(other, "other file");
+
+		// Nothing is written before anything is stored
+		DetectionCacheMan.flush();
+		TS_ASSERT(!_saveFileMan->_files.contains("detection.cache"));
+
+		DetectionCacheMan.store(node, 5000, makeProperties(20, "0123456789abcdef0123456789abcdef"));
+		DetectionCacheMan.store(node, 1000, makeProperties(20, "fedcba9876543210fedcba9876543210"));
+		DetectionCacheMan.store(other, 5000, makeProperties(10, "00112233445566778899aabbccddeeff"));
+		DetectionCacheMan.flush();
+		TS_ASSERT(_saveFileMan->_files.contains("detection.cache"));
+
+		// The entries are read again by the next lookup
+		DetectionCache::destroy();
+		FileProperties fileProps;
+		TS_ASSERT(DetectionCacheMan.lookup(node, 5000, fileProps));
+		TS_ASSERT_EQUALS(fileProps.size, 20);
+		TS_ASSERT_EQUALS(fileProps.md5, "0123456789abcdef0123456789abcdef");
+		TS_ASSERT(DetectionCacheMan.lookup(node, 1000, fileProps));
+		TS_ASSERT_EQUALS(fileProps.md5, "fedcba9876543210fedcba9876543210");
+		TS_ASSERT(DetectionCacheMan.lookup(other, 5000, fileProps));
+		TS_ASSERT_EQUALS(fileProps.size, 10);
+		TS_ASSERT_EQUALS(fileProps.md5, "00112233445566778899aabbccddeeff");
+
+		// Files changed since then are misses
+		writeFile(other, "other file, changed");
+		TS_ASSERT(!DetectionCacheMan.lookup(other, 5000, fileProps));
+
+		// Caches written in another format are ignored
+		const char *outdated = "ScummVM detection cache 0\n";
+		_saveFileMan->_files["detection.cache"] = MemorySaveFileManager::Data((const byte *)outdated, strlen(outdated));
+		DetectionCache::destroy();
+		TS_ASSERT(!DetectionCacheMan.lookup(node, 5000, fileProps));
+
+		remove(node.getPath().c_str());
+		remove(other.getPath().c_str());
+	}
+#endif
+};
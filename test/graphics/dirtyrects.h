@@ -0,0 +1,139 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/dirtyrects.h"
+
+class DirtyRectListTestSuite : public CxxTest::TestSuite
+{
+public:
+	void test_join_overlapping() {
+		Graphics::DirtyRectList list(10);
+		list.addRect(Common::Rect(0, 0, 10, 10));
+		list.addRect(Common::Rect(5, 5, 15, 15));
+
+		TS_ASSERT_EQUALS(list.size(), 1U);
+		TS_ASSERT_EQUALS(list[0], Common::Rect(0, 0, 15, 15));
+		TS_ASSERT_EQUALS(list.getStats().rectsAdded, 2U);
+		TS_ASSERT_EQUALS(list.getStats().pixelsAdded, 200U);
+		TS_ASSERT_EQUALS(list.getStats().pixelsDirty, 225U);
+		TS_ASSERT_EQUALS(list.getStats().pixelsSaved(), -25);
+	}
+
+	void test_join_adjacent() {
+		Graphics::DirtyRectList list(10);
+		list.addRect(Common::Rect(0, 0, 10, 10));
+		list.addRect(Common::Rect(10, 0, 20, 10));
+		list.addRect(Common::Rect(0, 10, 20, 12));
+
+		TS_ASSERT_EQUALS(list.size(), 1U);
+		TS_ASSERT_EQUALS(list[0], Common::Rect(0, 0, 20, 12));
+		TS_ASSERT_EQUALS(list.getStats().pixelsSaved(), 0);
+	}
+
+	void test_contained() {
+		Graphics::DirtyRectList list(10);
+		list.addRect(Common::Rect(0, 0, 100, 100));
+		list.addRect(Common::Rect(10, 10, 20, 20));
+		list.addRect(Common::Rect(10, 10, 20, 20));
+		list.addRect(Common::Rect());
+
+		TS_ASSERT_EQUALS(list.size(), 1U);
+		TS_ASSERT(list.contains(Common::Rect(5, 5, 50, 50)));
+		TS_ASSERT(!list.contains(Common::Rect(5, 5, 150, 50)));
+		TS_ASSERT_EQUALS(list.getStats().rectsAdded, 3U);
+		TS_ASSERT_EQUALS(list.getStats().pixelsSaved(), 200);
+
+		list.clear();
+		TS_ASSERT(list.empty());
+		TS_ASSERT_EQUALS(list.getStats().rectsAdded, 0U);
+	}
+
+	void test_separate() {
+		Graphics::DirtyRectList list(10);
+		list.addRect(Common::Rect(0, 0, 10, 10));
+		list.addRect(Common::Rect(20, 0, 30, 10));
+		// Joining diagonal neighbours would redraw twice the pixels
+		list.addRect(Common::Rect(10, 10, 20, 20));
+
+		TS_ASSERT_EQUALS(list.size(), 3U);
+		TS_ASSERT_EQUALS(list.getStats().pixelsDirty, 300U);
+	}
+
+	void test_cut_off() {
+		Graphics::DirtyRectList list(10);
+		list.addRect(Common::Rect(0, 0, 10, 100));
+		list.addRect(Common::Rect(5, 40, 100, 50));
+
+		TS_ASSERT_EQUALS(list.size(), 2U);
+		TS_ASSERT(list.contains(Common::Rect(0, 0, 10, 100)));
+		TS_ASSERT(list.contains(Common::Rect(10, 40, 100, 50)));
+		TS_ASSERT_EQUALS(list.getStats().pixelsDirty, 1900U);
+		TS_ASSERT_EQUALS(list.getStats().pixelsSaved(), 50);
+	}
+
+	void test_crossing() {
+		// The overlap can not be cut off, so the rects have to be joined
+		Graphics::DirtyRectList list(10);
+		list.addRect(Common::Rect(40, 0, 50, 100));
+		list.addRect(Common::Rect(0, 40, 100, 50));
+
+		TS_ASSERT_EQUALS(list.size(), 1U);
+		TS_ASSERT_EQUALS(list[0], Common::Rect(0, 0, 100, 100));
+	}
+
+	void test_full() {
+		Graphics::DirtyRectList list(2);
+		list.addRect(Common::Rect(0, 0, 10, 10));
+		list.addRect(Common::Rect(100, 0, 110, 10));
+		list.addRect(Common::Rect(0, 20, 10, 30));
+
+		TS_ASSERT_EQUALS(list.size(), 2U);
+		TS_ASSERT(list.contains(Common::Rect(0, 0, 10, 30)));
+		TS_ASSERT(list.contains(Common::Rect(100, 0, 110, 10)));
+	}
+
+	void test_coverage() {
+		enum {
+			kWidth = 64,
+			kHeight = 48
+		};
+
+		Graphics::DirtyRectList list(8);
+		byte added[kWidth * kHeight];
+		memset(added, 0, sizeof(added));
+
+		uint32 seed = 1;
+		for (int i = 0; i < 200; ++i) {
+			seed = seed * 1103515245 + 12345;
+			const int16 x = (seed >> 8) % kWidth;
+			const int16 y = (seed >> 16) % kHeight;
+			const int16 w = 1 + (seed >> 4) % 12;
+			const int16 h = 1 + (seed >> 20) % 12;
+
+			Common::Rect r(x, y, MIN<int16>(x + w, kWidth), MIN<int16>(y + h, kHeight));
+			list.addRect(r);
+			for (int py = r.top; py < r.bottom; ++py)
+				for (int px = r.left; px < r.right; ++px)
+					added[py * kWidth + px] = 1;
+
+			// Every added pixel must be covered by exactly one rect
+			byte covered[kWidth * kHeight];
+			memset(covered, 0, sizeof(covered));
+			uint area = 0;
+			for (uint j = 0; j < list.size(); ++j) {
+				const Common::Rect &d = list[j];
+				area += d.width() * d.height();
+				for (int py = d.top; py < d.bottom; ++py)
+					for (int px = d.left; px < d.right; ++px)
+						covered[py * kWidth + px]++;
+			}
+
+			TS_ASSERT(list.size() <= 8);
+			TS_ASSERT_EQUALS(area, list.getStats().pixelsDirty);
+			for (int p = 0; p < kWidth * kHeight; ++p) {
+				TS_ASSERT(covered[p] <= 1);
+				if (added[p])
+					TS_ASSERT_EQUALS(covered[p], 1);
+			}
+		}
+	}
+};
@@ -0,0 +1,203 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/scaler.h"
+#include "graphics/scaler/intern.h"
+
+#include "common/system.h"
+#include "common/threadpool.h"
+
+class ScalerTestSuite : public CxxTest::TestSuite
+{
+#ifdef USE_HQ_SCALERS
+private:
+	enum {
+		kWidth = 301,
+		kHeight = 13,
+		kPitch = kWidth + 2
+	};
+
+	uint32 _seed;
+	uint16 _src[kPitch * (kHeight + 2)];
+
+	void fillSource() {
+		_seed = 1;
+		for (int i = 0; i < ARRAYSIZE(_src); ++i) {
+			_seed = _seed * 1103515245 + 12345;
+			// Use few different colors, so that neighbours are equal or
+			// similar quite often
+			_src[i] = (_seed >> 16) & 0x8C63;
+			if (_seed & 0x100)
+				_src[i] = _src[i > 0 ? i - 1 : 0];
+		}
+	}
+
+	const uint16 *firstPixel() const {
+		return _src + kPitch + 1;
+	}
+
+	void patternTest(HQPatternProc proc, int bitFormat) {
+		Common::install_null_g_system();
+		InitScalers(bitFormat);
+		fillSource();
+
+		uint16 expected[kWidth];
+		uint16 flags[kWidth];
+		for (int y = 0; y < kHeight; ++y) {
+			for (int width = 0; width <= kWidth; width += (width < 40 ? 1 : 37)) {
+				const uint16 *src = firstPixel() + y * kPitch;
+				hqPatternsScalar(src, kPitch, expected, width);
+				proc(src, kPitch, flags, width);
+				for (int x = 0; x < width; ++x)
+					TS_ASSERT_EQUALS(flags[x], expected[x]);
+			}
+		}
+
+		DestroyScalers();
+	}
+
+	void patternTest(HQPatternProc proc565, HQPatternProc proc555) {
+		patternTest(proc565, 565);
+		patternTest(proc555, 555);
+	}
+
+	void scalerTest(ScalerProc *scaler, int factor, int bitFormat) {
+		Common::install_null_g_system();
+		InitScalers(bitFormat);
+		fillSource();
+
+		const uint32 dstPitch = kWidth * factor * sizeof(uint16);
+		const uint32 dstSize = kWidth * factor * kHeight * factor;
+		uint16 *expected = new uint16[dstSize];
+		uint16 *dst = new uint16[dstSize];
+
+		const HQPatternProc proc = g_hqPatterns;
+		g_hqPatterns = 0;
+		scaler((const uint8 *)firstPixel(), kPitch * sizeof(uint16), (uint8 *)expected, dstPitch, kWidth, kHeight);
+		g_hqPatterns = proc;
+		scaler((const uint8 *)firstPixel(), kPitch * sizeof(uint16), (uint8 *)dst, dstPitch, kWidth, kHeight);
+
+		TS_ASSERT_SAME_DATA(dst, expected, dstSize * sizeof(uint16));
+
+		delete[] expected;
+		delete[] dst;
+		DestroyScalers();
+	}
+#endif
+
+#ifdef USE_SCALERS
+	struct BenchmarkScaler {
+		const char *name;
+		ScalerProc *proc;
+		int factor;
+	};
+
+	/** Return the time it takes to scale the frame @p frames times, in milliseconds. */
+	uint32 benchmarkScaler(Common::ThreadPool *pool, const BenchmarkScaler &scaler, const uint16 *src, uint32 srcPitch,
+	                       uint16 *dst, uint32 dstPitch, int width, int height, int frames) {
+		const uint32 start = g_system->getMillis();
+		for (int i = 0; i < frames; ++i) {
+			if (pool)
+				ScaleParallel(*pool, scaler.proc, scaler.factor, (const uint8 *)src, srcPitch, (uint8 *)dst, dstPitch, width, height);
+			else
+				scaler.proc((const uint8 *)src, srcPitch, (uint8 *)dst, dstPitch, width, height);
+		}
+		return MAX<uint32>(g_system->getMillis() - start, 1);
+	}
+#endif
+
+public:
+	void test_hq_patterns_sse2() {
+#if defined(USE_HQ_SCALERS) && defined(SCUMMVM_SSE2)
+		patternTest(hqPatterns565SSE2, hqPatterns555SSE2);
+#endif
+	}
+
+	void test_hq_patterns_avx2() {
+#if defined(USE_HQ_SCALERS) && defined(SCUMMVM_AVX2) && defined(__GNUC__)
+		// The test runner's backend does not report the CPU features
+		if (__builtin_cpu_supports("avx2"))
+			patternTest(hqPatterns565AVX2, hqPatterns555AVX2);
+#endif
+	}
+
+	void test_hq2x() {
+#ifdef USE_HQ_SCALERS
+		scalerTest(HQ2x, 2, 565);
+		scalerTest(HQ2x, 2, 555);
+#endif
+	}
+
+	void test_hq3x() {
+#ifdef USE_HQ_SCALERS
+		scalerTest(HQ3x, 3, 565);
+		scalerTest(HQ3x, 3, 555);
+#endif
+	}
+
+	void test_benchmark() {
+		// Not a regression test as such, but shows the frame rate of every
+		// scaler with and without ScaleParallel(). The parallel output must
+		// be identical to the serial one, though.
+#ifdef USE_SCALERS
+		enum {
+			kFrameWidth = 320,
+			kFrameHeight = 200,
+			kFrames = 50
+		};
+
+		static const BenchmarkScaler scalers[] = {
+			{ "Normal2x", Normal2x, 2 },
+			{ "Normal3x", Normal3x, 3 },
+			{ "2xSaI", _2xSaI, 2 },
+			{ "Super2xSaI", Super2xSaI, 2 },
+			{ "SuperEagle", SuperEagle, 2 },
+			{ "AdvMame2x", AdvMame2x, 2 },
+			{ "AdvMame3x", AdvMame3x, 3 },
+			{ "TV2x", TV2x, 2 },
+			{ "DotMatrix", DotMatrix, 2 },
+#ifdef USE_HQ_SCALERS
+			{ "HQ2x", HQ2x, 2 },
+			{ "HQ3x", HQ3x, 3 },
+#endif
+		};
+
+		Common::install_null_g_system();
+		InitScalers(565);
+
+		// The scalers read one pixel around the scaled rect
+		const uint32 srcPitch = (kFrameWidth + 2) * sizeof(uint16);
+		uint16 *srcBuffer = new uint16[(kFrameWidth + 2) * (kFrameHeight + 2)];
+		uint32 seed = 1;
+		for (int i = 0; i < (kFrameWidth + 2) * (kFrameHeight + 2); ++i) {
+			seed = seed * 1103515245 + 12345;
+			srcBuffer[i] = (seed & 0x100) && i > 0 ? srcBuffer[i - 1] : (seed >> 16) & 0x8C63;
+		}
+		const uint16 *src = srcBuffer + kFrameWidth + 2 + 1;
+
+		const uint32 dstPitch = kFrameWidth * 3 * sizeof(uint16);
+		const uint32 dstSize = kFrameWidth * 3 * kFrameHeight * 3;
+		uint16 *serial = new uint16[dstSize];
+		uint16 *parallel = new uint16[dstSize];
+
+		// As many threads as the SDL backend uses by default, so that the
+		// frames are split into bands even on machines with fewer cores
+		Common::ThreadPool pool(4);
+		for (int i = 0; i < ARRAYSIZE(scalers); ++i) {
+			memset(serial, 0, dstSize * sizeof(uint16));
+			memset(parallel, 0, dstSize * sizeof(uint16));
+			const uint32 serialTime = benchmarkScaler(nullptr, scalers[i], src, srcPitch, serial, dstPitch, kFrameWidth, kFrameHeight, kFrames);
+			const uint32 parallelTime = benchmarkScaler(&pool, scalers[i], src, srcPitch, parallel, dstPitch, kFrameWidth, kFrameHeight, kFrames);
+			TS_ASSERT_SAME_DATA(parallel, serial, dstSize * sizeof(uint16));
+
+			TS_TRACE(Common::String::format("Scaling %dx%d frames with %s: %u frames/s, %u frames/s with ScaleParallel() on %u threads",
+			                                kFrameWidth, kFrameHeight, scalers[i].name, kFrames * 1000 / serialTime,
+			                                kFrames * 1000 / parallelTime, pool.getThreadCount()).c_str());
+		}
+
+		delete[] srcBuffer;
+		delete[] serial;
+		delete[] parallel;
+		DestroyScalers();
+#endif
+	}
+};
@@ -0,0 +1,253 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/system.h"
+
+#include "graphics/pixelformat.h"
+
+#ifdef USE_TINYGL
+#include "graphics/tinygl/zblit.h"
+#include "graphics/tinygl/zgl.h"
+#include "graphics/tinygl/zhiz.h"
+#include "graphics/tinygl/ztiles.h"
+#endif
+
+class TinyGLTestSuite : public CxxTest::TestSuite
+{
+#ifdef USE_TINYGL
+private:
+	enum {
+		kWidth = 320,
+		kHeight = 240,
+		kFrames = 3,
+		kBenchmarkWidth = 640,
+		kBenchmarkHeight = 480,
+		kBenchmarkFrames = 5,
+		kBenchmarkTriangles = 100
+	};
+
+	uint32 _seed;
+	Graphics::BlitImage *_depthImage;
+
+	float nextRandom() {
+		_seed = _seed * 1103515245 + 12345;
+		return ((_seed >> 8) & 0xffff) / 65535.0f;
+	}
+
+	void vertex(float z) {
+		tglColor4f(nextRandom(), nextRandom(), nextRandom(), nextRandom());
+		tglTexCoord2f(nextRandom(), nextRandom());
+		tglVertex3f(nextRandom() * 2.4f - 1.2f, nextRandom() * 2.4f - 1.2f, z);
+	}
+
+	void drawFrame(int frame) {
+		// Every frame draws the same scene with a few changes, so that
+		// there are several dirty rectangles
+		tglClearColor(0.1f, 0.2f, 0.3f, 1.0f);
+		tglClear(TGL_COLOR_BUFFER_BIT | TGL_DEPTH_BUFFER_BIT);
+		tglEnable(TGL_DEPTH_TEST);
+
+		// Some triangles are hidden by a bitmap blitted into the z buffer
+		Graphics::tglBlitZBuffer(_depthImage, 40 + frame * 8, 30);
+
+		for (int i = 0; i < 60; i++) {
+			_seed = i * 7919 + (i % 10 == 0 ? frame : 0);
+
+			tglShadeModel(i % 2 ? TGL_SMOOTH : TGL_FLAT);
+			if (i % 3 == 0) {
+				tglEnable(TGL_BLEND);
+				tglBlendFunc(TGL_SRC_ALPHA, TGL_ONE_MINUS_SRC_ALPHA);
+			}
+			if (i % 5 == 0)
+				tglEnable(TGL_TEXTURE_2D);
+			if (i % 7 == 0)
+				tglPolygonMode(TGL_FRONT_AND_BACK, TGL_LINE);
+			if (i % 4 == 3)
+				tglDepthMask(TGL_FALSE);
+			if (i % 13 == 4)
+				tglDepthFunc(TGL_GEQUAL);
+			if (i % 17 == 8) {
+				tglEnable(TGL_ALPHA_TEST);
+				tglAlphaFunc(TGL_GREATER, 0.5f);
+			}
+
+			static const int types[] = { TGL_TRIANGLES, TGL_QUADS, TGL_TRIANGLE_STRIP, TGL_TRIANGLE_FAN, TGL_POLYGON, TGL_LINES, TGL_POINTS };
+			tglBegin(types[i % ARRAYSIZE(types)]);
+			for (int j = 0; j < 12; j++) {
+				// Some vertices are clipped by the near plane
+				vertex(i % 11 == 0 && j % 4 == 0 ? -1.5f : nextRandom() * 1.8f - 0.9f);
+			}
+			tglEnd();
+
+			tglPolygonMode(TGL_FRONT_AND_BACK, TGL_FILL);
+			tglDisable(TGL_TEXTURE_2D);
+			tglDisable(TGL_BLEND);
+			tglDisable(TGL_ALPHA_TEST);
+			tglDepthMask(TGL_TRUE);
+			tglDepthFunc(TGL_LESS);
+		}
+
+		TinyGL::tglPresentBuffer();
+	}
+
+	TinyGL::FrameBuffer *createContext(int width, int height, bool spanFillers, bool hierarchicalZ) {
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 0, 8, 16, 24);
+		TinyGL::FrameBuffer *fb = new TinyGL::FrameBuffer(width, height, format);
+		if (!spanFillers)
+			fb->_spanFillers = 0;
+		fb->enableHierarchicalZ(hierarchicalZ);
+		TinyGL::glInit(fb, 256);
+
+		unsigned int texture;
+		byte texels[16 * 16 * 4];
+		for (uint i = 0; i < sizeof(texels); i++)
+			texels[i] = i * 37;
+		tglGenTextures(1, &texture);
+		tglBindTexture(TGL_TEXTURE_2D, texture);
+		tglTexImage2D(TGL_TEXTURE_2D, 0, TGL_RGBA, 16, 16, 0, TGL_RGBA, TGL_UNSIGNED_BYTE, texels);
+
+		// Depths around the middle of the range of the depths of vertices
+		Graphics::Surface depths;
+		depths.create(96, 64, format);
+		for (int y = 0; y < depths.h; y++) {
+			for (int x = 0; x < depths.w; x++)
+				*(uint32 *)depths.getBasePtr(x, y) = (1 << 29) + (x * y % 37) * (1 << 22);
+		}
+		_depthImage = Graphics::tglGenBlitImage();
+		Graphics::tglUploadBlitImage(_depthImage, depths, 0, false);
+		depths.free();
+		return fb;
+	}
+
+	void destroyContext(TinyGL::FrameBuffer *fb) {
+		Graphics::tglDeleteBlitImage(_depthImage);
+		TinyGL::glClose();
+		delete fb;
+	}
+
+	void render(int threads, bool dirtyRects, bool spanFillers, bool hierarchicalZ, Common::Array<byte> &pixels) {
+		TinyGL::FrameBuffer *fb = createContext(kWidth, kHeight, spanFillers, hierarchicalZ);
+		tglEnableDirtyRects(dirtyRects);
+		tglSetRenderThreads(threads);
+
+		TinyGL::RenderStats stats;
+		TS_ASSERT_EQUALS(TinyGL::tglGetRenderStats(stats), threads != 1);
+
+		// Keep the pixels and depths of every frame
+		const uint size = kWidth * kHeight * 4;
+		pixels.clear();
+		for (int frame = 0; frame < kFrames; frame++) {
+			drawFrame(frame);
+			pixels.resize(pixels.size() + 2 * size);
+			memcpy(&pixels[pixels.size() - 2 * size], fb->getPixelBuffer(), size);
+			memcpy(&pixels[pixels.size() - size], fb->getZBuffer(), size);
+		}
+
+		if (TinyGL::tglGetRenderStats(stats)) {
+			TS_ASSERT_EQUALS(stats.frames, (uint32)kFrames);
+			TS_ASSERT(stats.tiledDrawCalls > 0);
+			TS_ASSERT_EQUALS(stats.tiles.size(), (uint)(kHeight + TinyGL::TileRenderer::kTileHeight - 1) / TinyGL::TileRenderer::kTileHeight);
+		}
+
+		TinyGL::HierarchicalZStats hierarchicalZStats;
+		TS_ASSERT_EQUALS(TinyGL::tglGetHierarchicalZStats(hierarchicalZStats), hierarchicalZ);
+		if (hierarchicalZ && threads == 1) {
+			TS_ASSERT(hierarchicalZStats.rejectedTriangles > 0);
+			TS_ASSERT(hierarchicalZStats.rejectedSpans > 0);
+			TS_ASSERT(hierarchicalZStats.rejectedFragments > 0);
+		}
+
+		destroyContext(fb);
+	}
+
+	void runTest(bool dirtyRects) {
+		Common::install_null_g_system();
+
+		Common::Array<byte> serial, tiled;
+		render(1, dirtyRects, true, true, serial);
+		render(4, dirtyRects, true, true, tiled);
+
+		TS_ASSERT_EQUALS(serial.size(), tiled.size());
+		TS_ASSERT(serial.size() == tiled.size() && memcmp(serial.data(), tiled.data(), serial.size()) == 0);
+	}
+
+	uint32 benchmark(bool spanFillers, bool hierarchicalZ) {
+		TinyGL::FrameBuffer *fb = createContext(kBenchmarkWidth, kBenchmarkHeight, spanFillers, hierarchicalZ);
+		tglEnableDirtyRects(false);
+		tglSetRenderThreads(1);
+
+		const uint32 start = g_system->getMillis();
+		for (int frame = 0; frame < kBenchmarkFrames; frame++) {
+			tglClear(TGL_COLOR_BUFFER_BIT | TGL_DEPTH_BUFFER_BIT);
+			tglEnable(TGL_DEPTH_TEST);
+			_seed = 1;
+			for (int i = 0; i < kBenchmarkTriangles; i++) {
+				// Flat, smooth, textured and blended textured triangles
+				tglShadeModel(i % 4 == 0 ? TGL_FLAT : TGL_SMOOTH);
+				if (i % 4 >= 2)
+					tglEnable(TGL_TEXTURE_2D);
+				if (i % 4 == 3) {
+					tglEnable(TGL_BLEND);
+					tglBlendFunc(TGL_SRC_ALPHA, TGL_ONE_MINUS_SRC_ALPHA);
+				}
+				tglBegin(TGL_TRIANGLES);
+				for (int j = 0; j < 3; j++)
+					vertex(nextRandom() * 1.8f - 0.9f);
+				tglEnd();
+				tglDisable(TGL_TEXTURE_2D);
+				tglDisable(TGL_BLEND);
+			}
+			TinyGL::tglPresentBuffer();
+		}
+		const uint32 time = MAX<uint32>(g_system->getMillis() - start, 1);
+
+		destroyContext(fb);
+		return time;
+	}
+
+public:
+	void test_span_fillers() {
+		Common::install_null_g_system();
+
+		Common::Array<byte> scalar, vectorized;
+		render(1, false, false, true, scalar);
+		render(1, false, true, true, vectorized);
+
+		TS_ASSERT_EQUALS(scalar.size(), vectorized.size());
+		TS_ASSERT(scalar.size() == vectorized.size() && memcmp(scalar.data(), vectorized.data(), scalar.size()) == 0);
+	}
+
+	void test_hierarchical_z() {
+		Common::install_null_g_system();
+
+		for (int dirtyRects = 0; dirtyRects < 2; dirtyRects++) {
+			Common::Array<byte> perPixel, early;
+			render(1, dirtyRects, true, false, perPixel);
+			render(1, dirtyRects, true, true, early);
+
+			TS_ASSERT_EQUALS(perPixel.size(), early.size());
+			TS_ASSERT(perPixel.size() == early.size() && memcmp(perPixel.data(), early.data(), perPixel.size()) == 0);
+		}
+	}
+
+	void test_benchmark() {
+		Common::install_null_g_system();
+
+		const uint32 scalar = benchmark(false, false);
+		const uint32 vectorized = benchmark(true, false);
+		const uint32 early = benchmark(true, true);
+		const uint triangles = kBenchmarkFrames * kBenchmarkTriangles;
+		TS_TRACE(Common::String::format("Drawing %u triangles at %dx%d: %u ms (%u triangles/s) pixel by pixel, %u ms (%u triangles/s) with span fillers, "
+		                                "%u ms (%u triangles/s) with span fillers and early depth test",
+		                                triangles, kBenchmarkWidth, kBenchmarkHeight, scalar, triangles * 1000 / scalar,
+		                                vectorized, triangles * 1000 / vectorized, early, triangles * 1000 / early).c_str());
+	}
+
+	void test_tiles() {
+		runTest(false);
+	}
+
+	void test_tiles_dirty_rects() {
+		runTest(true);
+	}
+#endif
+};
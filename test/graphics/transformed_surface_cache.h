@@ -0,0 +1,161 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/transformed_surface_cache.h"
+
+class TransformedSurfaceCacheTestSuite : public CxxTest::TestSuite
+{
+private:
+	void createSurface(Graphics::TransparentSurface &surface, int width, int height) {
+		surface.create(width, height, Graphics::TransparentSurface::getSupportedPixelFormat());
+		byte *pixels = (byte *)surface.getPixels();
+		for (int i = 0; i < surface.pitch * surface.h; i++)
+			pixels[i] = (i * 37) ^ (i >> 5);
+	}
+
+	uint32 size(const Graphics::Surface &surface) {
+		return surface.pitch * surface.h;
+	}
+
+	bool sameSurface(const Graphics::Surface &a, const Graphics::Surface &b) {
+		if (a.w != b.w || a.h != b.h)
+			return false;
+		for (int y = 0; y < a.h; y++) {
+			if (memcmp(a.getBasePtr(0, y), b.getBasePtr(0, y), a.w * a.format.bytesPerPixel))
+				return false;
+		}
+		return true;
+	}
+
+public:
+	void test_scale() {
+		Graphics::TransparentSurface source;
+		createSurface(source, 16, 8);
+		Graphics::TransformedSurfaceCache cache(1024 * 1024);
+
+		Graphics::TransformedSurfaceCache::SurfacePtr scaled = cache.scale(source, 40, 20, false);
+		Graphics::TransparentSurface *expected = source.scale(40, 20, false);
+		TS_ASSERT(sameSurface(*scaled, *expected));
+		TS_ASSERT_EQUALS(cache.getMisses(), 1u);
+		TS_ASSERT_EQUALS(cache.getMemoryUsage(), size(*expected));
+
+		// The same transform of the same pixels is shared
+		const Graphics::TransparentSurface view(source, false);
+		TS_ASSERT_EQUALS(cache.scale(view, 40, 20, false), scaled);
+		TS_ASSERT_EQUALS(cache.getHits(), 1u);
+
+		// Another size or filter is another surface
+		TS_ASSERT_DIFFERS(cache.scale(source, 40, 21, false), scaled);
+		TS_ASSERT_DIFFERS(cache.scale(source, 40, 20, true), scaled);
+		TS_ASSERT_EQUALS(cache.getMisses(), 3u);
+
+		expected->free();
+		delete expected;
+		source.free();
+	}
+
+	void test_rotoscale() {
+		Graphics::TransparentSurface source;
+		createSurface(source, 16, 8);
+		Graphics::TransformedSurfaceCache cache(1024 * 1024);
+
+		const Graphics::TransformStruct transform(150, 120, 30, 4, 2);
+		Graphics::TransformedSurfaceCache::SurfacePtr rotated = cache.rotoscale(source, transform, Graphics::FILTER_BILINEAR);
+		Graphics::TransparentSurface *expected = source.rotoscaleT<Graphics::FILTER_BILINEAR>(transform);
+		TS_ASSERT(sameSurface(*rotated, *expected));
+
+		// Members of the transform which do not change the surface are ignored
+		Graphics::TransformStruct blended = transform;
+		blended._rgbaMod = 0x80FFFFFF;
+		blended._flip = Graphics::FLIP_H;
+		TS_ASSERT_EQUALS(cache.rotoscale(source, blended, Graphics::FILTER_BILINEAR), rotated);
+
+		Graphics::TransformStruct turned = transform;
+		turned._angle = 31;
+		TS_ASSERT_DIFFERS(cache.rotoscale(source, turned, Graphics::FILTER_BILINEAR), rotated);
+		TS_ASSERT_DIFFERS(cache.rotoscale(source, transform, Graphics::FILTER_NEAREST), rotated);
+
+		expected->free();
+		delete expected;
+		source.free();
+	}
+
+	void test_budget() {
+		Graphics::TransparentSurface source;
+		createSurface(source, 16, 16);
+		const uint32 scaledSize = 32 * 32 * 4;
+		Graphics::TransformedSurfaceCache cache(scaledSize * 2);
+
+		Graphics::TransformedSurfaceCache::SurfacePtr first = cache.scale(source, 32, 32, false);
+		Graphics::TransformedSurfaceCache::SurfacePtr second = cache.scale(source, 32, 32, true);
+		TS_ASSERT_EQUALS(cache.getMemoryUsage(), scaledSize * 2);
+
+		// Using the first surface makes the second one the least recently used
+		cache.scale(source, 32, 32, false);
+		cache.scale(source, 33, 31, false);
+		TS_ASSERT_LESS_THAN_EQUALS(cache.getMemoryUsage(), cache.getMemoryBudget());
+		TS_ASSERT_EQUALS(cache.scale(source, 32, 32, false), first);
+		TS_ASSERT_DIFFERS(cache.scale(source, 32, 32, true), second);
+
+		// The surfaces stay valid after being dropped
+		TS_ASSERT_EQUALS(second->w, 32);
+
+		// Surfaces larger than the budget are returned without being kept
+		const uint32 usage = cache.getMemoryUsage();
+		Graphics::TransformedSurfaceCache::SurfacePtr large = cache.scale(source, 64, 64, false);
+		TS_ASSERT_EQUALS(large->w, 64);
+		TS_ASSERT_EQUALS(cache.getMemoryUsage(), usage);
+		TS_ASSERT_DIFFERS(cache.scale(source, 64, 64, false), large);
+
+		cache.setMemoryBudget(scaledSize);
+		TS_ASSERT_LESS_THAN_EQUALS(cache.getMemoryUsage(), scaledSize);
+		cache.clear();
+		TS_ASSERT_EQUALS(cache.getMemoryUsage(), 0u);
+
+		source.free();
+	}
+
+	void test_invalidate() {
+		Graphics::TransparentSurface source, other;
+		createSurface(source, 16, 16);
+		createSurface(other, 16, 16);
+		Graphics::TransformedSurfaceCache cache(1024 * 1024);
+
+		const Graphics::Surface part = source.getSubArea(Common::Rect(4, 4, 12, 8));
+		Graphics::TransformedSurfaceCache::SurfacePtr whole = cache.scale(source, 20, 20, false);
+		Graphics::TransformedSurfaceCache::SurfacePtr scaledPart = cache.scale(part, 20, 20, false);
+		Graphics::TransformedSurfaceCache::SurfacePtr scaledOther = cache.scale(other, 20, 20, false);
+
+		// Changing a part of the source invalidates everything using its pixels
+		cache.invalidate(source.getSubArea(Common::Rect(0, 5, 16, 6)));
+		TS_ASSERT_DIFFERS(cache.scale(source, 20, 20, false), whole);
+		TS_ASSERT_DIFFERS(cache.scale(part, 20, 20, false), scaledPart);
+		TS_ASSERT_EQUALS(cache.scale(other, 20, 20, false), scaledOther);
+
+		source.free();
+		other.free();
+	}
+
+	void test_blit() {
+		Graphics::TransparentSurface sprite, expected, target;
+		createSurface(sprite, 16, 12);
+		createSurface(expected, 64, 48);
+		target.copyFrom(expected);
+
+		Graphics::TransformedSurfaceCache cache(1024 * 1024);
+		sprite.blit(expected, 3, 5, Graphics::FLIP_H, nullptr, 0xC0FFFFFF, 40, 30);
+		sprite.setTransformedSurfaceCache(&cache);
+		for (int i = 0; i < 2; i++) {
+			Graphics::TransparentSurface result;
+			result.copyFrom(target);
+			sprite.blit(result, 3, 5, Graphics::FLIP_H, nullptr, 0xC0FFFFFF, 40, 30);
+			TS_ASSERT_SAME_DATA(result.getPixels(), expected.getPixels(), size(expected));
+			result.free();
+		}
+		TS_ASSERT_EQUALS(cache.getHits(), 1u);
+		TS_ASSERT_EQUALS(cache.getMisses(), 1u);
+
+		sprite.free();
+		expected.free();
+		target.free();
+	}
+};
@@ -0,0 +1,175 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/transparent_surface.h"
+#include "graphics/transparent_surface_blend.h"
+
+#include "common/system.h"
+
+class TransparentSurfaceTestSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kWidth = 45,
+		kHeight = 7,
+		kBenchmarkWidth = 320,
+		kBenchmarkHeight = 200,
+		kBenchmarkBlits = 200
+	};
+
+	uint32 _seed;
+
+	byte nextRandom() {
+		_seed = _seed * 1103515245 + 12345;
+		return _seed >> 16;
+	}
+
+	void fill(Graphics::Surface &surface) {
+		byte *pixels = (byte *)surface.getPixels();
+		for (int i = 0; i < surface.pitch * surface.h; i += 4) {
+			for (int j = 0; j < 4; j++)
+				pixels[i + j] = nextRandom();
+			// Fully transparent and opaque pixels are handled separately
+			const byte kind = nextRandom() & 7;
+			if (kind == 0)
+				*(uint32 *)(pixels + i) &= ~TS_ARGB(255, 0, 0, 0);
+			else if (kind == 1)
+				*(uint32 *)(pixels + i) |= TS_ARGB(255, 0, 0, 0);
+		}
+	}
+
+	void createSurface(Graphics::TransparentSurface &surface, int width, int height) {
+		surface.create(width, height, Graphics::TransparentSurface::getSupportedPixelFormat());
+		fill(surface);
+	}
+
+	static const uint32 *colors() {
+		static const uint32 colors[] = {
+			0xFFFFFFFF, 0xFFFFFFFE, 0x80FFFFFF, 0xFF20A0FF, 0xC0FF8040, 0x01FFFFFF, 0x7F102030, 0
+		};
+		return colors;
+	}
+
+	void kernelTest(const Graphics::BlendBlitters &blitters) {
+		const Graphics::BlendBlitProc scalarProcs[] = {
+			Graphics::blendBlittersScalar.alphaBlend, Graphics::blendBlittersScalar.additiveBlend,
+			Graphics::blendBlittersScalar.subtractiveBlend, Graphics::blendBlittersScalar.multiplyBlend
+		};
+		const Graphics::BlendBlitProc vectorProcs[] = {
+			blitters.alphaBlend, blitters.additiveBlend, blitters.subtractiveBlend, blitters.multiplyBlend
+		};
+
+		_seed = 1;
+		Graphics::TransparentSurface src, dst, expected, result;
+		createSurface(src, kWidth, kHeight);
+		createSurface(dst, kWidth, kHeight);
+
+		for (int proc = 0; proc < ARRAYSIZE(scalarProcs); proc++) {
+			for (const uint32 *color = colors(); *color; color++) {
+				for (int flipping = 0; flipping < 4; flipping++) {
+					for (int width = 0; width <= kWidth; width += (width < 20 ? 1 : 5)) {
+						const int32 inStep = (flipping & Graphics::FLIP_H) ? -4 : 4;
+						const int32 inoStep = (flipping & Graphics::FLIP_V) ? -src.pitch : src.pitch;
+						byte *in = (byte *)src.getBasePtr((flipping & Graphics::FLIP_H) ? width - 1 : 0,
+						                                  (flipping & Graphics::FLIP_V) ? kHeight - 1 : 0);
+
+						expected.copyFrom(dst);
+						result.copyFrom(dst);
+						scalarProcs[proc](in, (byte *)expected.getPixels(), width, kHeight, expected.pitch, inStep, inoStep, *color);
+						vectorProcs[proc](in, (byte *)result.getPixels(), width, kHeight, result.pitch, inStep, inoStep, *color);
+						TS_ASSERT_SAME_DATA(result.getPixels(), expected.getPixels(), expected.pitch * expected.h);
+					}
+				}
+			}
+		}
+
+		src.free();
+		dst.free();
+		expected.free();
+		result.free();
+	}
+
+	uint32 benchmark(bool vectorized, Graphics::TSpriteBlendMode blendMode, uint32 color) {
+		_seed = 1;
+		Graphics::TransparentSurface sprite, target;
+		createSurface(sprite, kBenchmarkWidth, kBenchmarkHeight);
+		createSurface(target, kBenchmarkWidth, kBenchmarkHeight);
+
+		const Graphics::BlendBlitters *previous = Graphics::g_blendBlitters;
+		Graphics::g_blendBlitters = vectorized ? 0 : &Graphics::blendBlittersScalar;
+		const uint32 start = g_system->getMillis();
+		for (int i = 0; i < kBenchmarkBlits; i++)
+			sprite.blit(target, 0, 0, i & Graphics::FLIP_HV, nullptr, color, -1, -1, blendMode);
+		const uint32 time = MAX<uint32>(g_system->getMillis() - start, 1);
+		Graphics::g_blendBlitters = previous;
+
+		sprite.free();
+		target.free();
+		return time;
+	}
+
+public:
+	void test_blend_sse2() {
+#ifdef SCUMMVM_SSE2
+		kernelTest(Graphics::blendBlittersSSE2);
+#endif
+	}
+
+	void test_blend_avx2() {
+#if defined(SCUMMVM_AVX2) && defined(__GNUC__)
+		// The test runner's backend does not report the CPU features
+		if (__builtin_cpu_supports("avx2"))
+			kernelTest(Graphics::blendBlittersAVX2);
+#endif
+	}
+
+	void test_blit() {
+		Common::install_null_g_system();
+
+		_seed = 1;
+		Graphics::TransparentSurface sprite, target, expected;
+		createSurface(sprite, kWidth, kHeight * 3);
+		createSurface(target, kWidth * 2, kHeight * 4);
+
+		const Graphics::BlendBlitters *previous = Graphics::g_blendBlitters;
+		Common::Rect part(3, 2, kWidth - 1, kHeight * 3);
+		for (int blendMode = Graphics::BLEND_NORMAL; blendMode <= Graphics::BLEND_MULTIPLY; blendMode++) {
+			for (int flipping = 0; flipping < 4; flipping++) {
+				for (int x = -9; x < kWidth + 9; x += 9) {
+					const uint32 color = (x & 1) ? 0xFFFFFFFF : 0xE0FFC080;
+					expected.copyFrom(target);
+					Graphics::g_blendBlitters = &Graphics::blendBlittersScalar;
+					sprite.blit(expected, x, x / 4, flipping, &part, color, -1, -1, (Graphics::TSpriteBlendMode)blendMode);
+
+					// The blend functions are chosen for the CPU on the first blit
+					Graphics::g_blendBlitters = 0;
+					sprite.blit(target, x, x / 4, flipping, &part, color, -1, -1, (Graphics::TSpriteBlendMode)blendMode);
+					TS_ASSERT_SAME_DATA(target.getPixels(), expected.getPixels(), target.pitch * target.h);
+					target.copyFrom(expected);
+				}
+			}
+		}
+		Graphics::g_blendBlitters = previous;
+
+		sprite.free();
+		target.free();
+		expected.free();
+	}
+
+	void test_benchmark() {
+		Common::install_null_g_system();
+
+		static const char *const names[] = { "normal", "additive", "subtractive", "multiply" };
+
+		for (int blendMode = Graphics::BLEND_NORMAL; blendMode <= Graphics::BLEND_MULTIPLY; blendMode++) {
+			const Graphics::TSpriteBlendMode mode = (Graphics::TSpriteBlendMode)blendMode;
+			const uint32 scalar = benchmark(false, mode, 0xFFFFFFFF);
+			const uint32 vectorized = benchmark(true, mode, 0xFFFFFFFF);
+			const uint32 scalarColor = benchmark(false, mode, 0xC0FF8040);
+			const uint32 vectorizedColor = benchmark(true, mode, 0xC0FF8040);
+			TS_TRACE(Common::String::format("Blitting %d %dx%d sprites with %s blending: %u ms per pixel, %u ms vectorized, "
+			                                "%u ms per pixel and %u ms vectorized with color modulation",
+			                                kBenchmarkBlits, kBenchmarkWidth, kBenchmarkHeight, names[blendMode],
+			                                scalar, vectorized, scalarColor, vectorizedColor).c_str());
+		}
+	}
+};
@@ -5,7 +5,7 @@
 #
 ######################################################################
 
-TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h $(srcdir)/test/math/*.h
+TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h $(srcdir)/test/graphics/*.h $(srcdir)/test/math/*.h
 TEST_LIBS    :=
 
 ifdef POSIX
@@ -16,7 +16,10 @@ TEST_LIBS += test/null_osystem.o \
 	backends/fs/abstract-fs.o \
 	backends/fs/stdiostream.o \
 	backends/modular-backend.o \
+	backends/mutex/pthread/pthread-mutex.o \
+	engines/detectioncache.o \
 	test/stubs.o
+TESTS += $(srcdir)/test/engines/*.h
 endif
 
 ifdef WIN32
@@ -27,10 +30,12 @@ TEST_LIBS += test/null_osystem.o \
 	backends/fs/abstract-fs.o \
 	backends/fs/stdiostream.o \
 	backends/modular-backend.o \
+	engines/detectioncache.o \
 	test/stubs.o
+TESTS += $(srcdir)/test/engines/*.h
 endif
 
-TEST_LIBS +=	audio/libaudio.a math/libmath.a common/libcommon.a
+TEST_LIBS +=	audio/libaudio.a graphics/libgraphics.a math/libmath.a common/libcommon.a
 
 ifeq ($(ENABLE_WINTERMUTE), STATIC_PLUGIN)
 	TESTS += $(srcdir)/test/engines/wintermute/*.h
@@ -53,6 +58,10 @@ TEST_LDFLAGS := $(filter-out -mwindows,$(TEST_LDFLAGS))
 TEST_LIBS += backends/fs/windows/windows-fs-factory.o backends/fs/windows/windows-fs.o
 endif
 
+ifdef POSIX
+TEST_LDFLAGS += -lpthread
+endif
+
 ifdef N64
 TEST_LDFLAGS := $(filter-out -mno-crt0,$(TEST_LDFLAGS))
 endif
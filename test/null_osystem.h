@@ -1,8 +1,10 @@
 #ifndef TEST_NULL_OSYSTEM
 #define TEST_NULL_OSYSTEM 1
 namespace Common {
+class SaveFileManager;
 #if defined(POSIX) || defined(WIN32)
 void install_null_g_system();
+void install_null_g_system_savefile_manager(SaveFileManager *saveFileMan);
 #define NULL_OSYSTEM_IS_AVAILABLE 1
 #else
 #define NULL_OSYSTEM_IS_AVAILABLE 0
@@ -6,6 +6,7 @@
 #include "backends/base-backend.h"
 #include "backends/mixer/null/null-mixer.h"
 #include "engines/engine.h"
+#include "engines/metaengine.h"
 
 Engine *g_engine = 0;
 
@@ -13,6 +14,12 @@ GUI::Debugger *Engine::getOrCreateDebugger() {
 	assert(0);
 }
 
+DetectionLock::DetectionLock() : _mutex(0) {
+}
+
+DetectionLock::~DetectionLock() {
+}
+
 NullMixerManager::NullMixerManager() : MixerManager() {
 	_outputRate = 22050;
 	_callsCounter = 0;
@@ -151,6 +158,37 @@ Common::String DefaultSaveFileManager::concatWithSavesPath(Common::String name)
 	assert(0);
 }
 
+Common::OutSaveFile::OutSaveFile(WriteStream *w) : _wrapped(w) {
+}
+
+Common::OutSaveFile::~OutSaveFile() {
+	delete _wrapped;
+}
+
+bool Common::OutSaveFile::err() const {
+	return _wrapped->err();
+}
+
+void Common::OutSaveFile::clearErr() {
+	_wrapped->clearErr();
+}
+
+void Common::OutSaveFile::finalize() {
+	_wrapped->finalize();
+}
+
+bool Common::OutSaveFile::flush() {
+	return _wrapped->flush();
+}
+
+uint32 Common::OutSaveFile::write(const void *dataPtr, uint32 dataSize) {
+	return _wrapped->write(dataPtr, dataSize);
+}
+
+int32 Common::OutSaveFile::pos() const {
+	return _wrapped->pos();
+}
+
 bool Common::SaveFileManager::copySavefile(const Common::String &oldFilename, const Common::String &newFilename, bool compress) {
 	assert(0);
 }
@@ -399,7 +399,7 @@ bool AVIDecoder::loadStream(Common::SeekableReadStream *stream) {
 		return false;
 	}
 
-	_fileStream = stream;
+	_fileStream = wrapPrefetchStream(stream);
 
 	// Go through all chunks in the file
 	while (_fileStream->pos() < fileSize && parseNextChunk())
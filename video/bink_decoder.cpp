@@ -97,7 +97,7 @@ bool BinkDecoder::loadStream(Common::SeekableReadStream *stream) {
 		return false;
 	}
 
-	_bink = stream;
+	_bink = wrapPrefetchStream(stream);
 
 	uint32 videoFlags = _bink->readUint32LE();
 
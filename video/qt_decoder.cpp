@@ -65,7 +65,7 @@ bool QuickTimeDecoder::loadFile(const Common::String &filename) {
 }
 
 bool QuickTimeDecoder::loadStream(Common::SeekableReadStream *stream) {
-	if (!Common::QuickTimeParser::parseStream(stream))
+	if (!Common::QuickTimeParser::parseStream(wrapPrefetchStream(stream)))
 		return false;
 
 	init();
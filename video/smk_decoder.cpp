@@ -290,7 +290,7 @@ SmackerDecoder::~SmackerDecoder() {
 bool SmackerDecoder::loadStream(Common::SeekableReadStream *stream) {
 	close();
 
-	_fileStream = stream;
+	_fileStream = wrapPrefetchStream(stream);
 
 	// Read in the Smacker header
 	_header.signature = _fileStream->readUint32BE();
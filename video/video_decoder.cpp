@@ -27,6 +27,7 @@
 
 #include "common/rational.h"
 #include "common/file.h"
+#include "common/prefetchstream.h"
 #include "common/system.h"
 
 #include "graphics/palette.h"
@@ -49,6 +50,7 @@ VideoDecoder::VideoDecoder() {
 	_nextVideoTrack = 0;
 	_mainAudioTrack = 0;
 	_canSetDither = true;
+	_prefetchWindow = 0;
 
 	// Find the best format for output
 	_defaultHighColorFormat = g_system->getScreenFormat();
@@ -93,6 +95,14 @@ bool VideoDecoder::loadFile(const Common::String &filename) {
 	return loadStream(file);
 }
 
+Common::SeekableReadStream *VideoDecoder::wrapPrefetchStream(Common::SeekableReadStream *stream) const {
+	if (!stream || _prefetchWindow == 0)
+		return stream;
+
+	const uint chunkCount = MAX<uint32>(_prefetchWindow / Common::PrefetchReadStream::kDefaultChunkSize, 2);
+	return new Common::PrefetchReadStream(stream, DisposeAfterUse::YES, MAX<uint32>(_prefetchWindow / chunkCount, 1), chunkCount);
+}
+
 bool VideoDecoder::needsUpdate() const {
 	return hasFramesLeft() && getTimeToNextFrame() == 0;
 }
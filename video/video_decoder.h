@@ -365,6 +365,21 @@ public:
 	 */
 	void setDefaultHighColorFormat(const Graphics::PixelFormat &format) { _defaultHighColorFormat = format; }
 
+	/**
+	 * Set the size of the window to read ahead of the decoder.
+	 *
+	 * Reading ahead is done on a background thread, which avoids stalls
+	 * when the video is played from slow storage. By default, nothing is
+	 * read ahead. Decoders which do not read their stream mostly
+	 * sequentially ignore this.
+	 *
+	 * This must be set before calling loadStream().
+	 *
+	 * @see Common::PrefetchReadStream
+	 * @param size the size of the window in bytes, 0 to disable reading ahead
+	 */
+	void setPrefetchWindow(uint32 size) { _prefetchWindow = size; }
+
 	/**
 	 * Set the video to decode frames in reverse.
 	 *
@@ -870,6 +885,13 @@ protected:
 	 */
 	Graphics::PixelFormat getDefaultHighColorFormat() const { return _defaultHighColorFormat; }
 
+	/**
+	 * Wrap the stream passed to loadStream() in a stream reading ahead of
+	 * the decoder, if enabled with setPrefetchWindow(). The returned stream
+	 * takes over the ownership of the given one.
+	 */
+	Common::SeekableReadStream *wrapPrefetchStream(Common::SeekableReadStream *stream) const;
+
 	/**
 	 * Set _nextVideoTrack to the video track with the lowest start time for the next frame.
 	 *
@@ -949,6 +971,9 @@ private:
 	// Default PixelFormat settings
 	Graphics::PixelFormat _defaultHighColorFormat;
 
+	// Size of the window read ahead of the decoder
+	uint32 _prefetchWindow;
+
 	// Internal helper functions
 	void stopAudio();
 	void startAudio();